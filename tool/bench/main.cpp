@@ -0,0 +1,490 @@
+﻿//-----------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Benchmark Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "FxParser.h"
+#include "Tokenizer.h"
+#include "MappedFile.h"
+#include "SourceCache.h"
+#include "ShaderPack.h"
+#include "VariationInfoWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const size_t kTargetSize = 256 * 1024 * 1024;    // 1回の計測で処理するバイト数の目安.
+static const int    kParseCount = 10;                   // 解析の計測回数.
+static const int    kLoadCount  = 10;                   // 読み込みの計測回数.
+static const char*  kScanModeName[] = {
+    "auto",
+    "scalar",
+    "sse",
+    "avx2",
+};
+
+//-----------------------------------------------------------------------------
+//      エフェクトファイルを解析して, 展開後のソースコードを取得します.
+//-----------------------------------------------------------------------------
+bool LoadExpandedSource(const char* path, std::string& result)
+{
+    asura::FxParser parser;
+    if (!parser.Parse(path))
+    {
+        fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", path);
+        return false;
+    }
+
+    result.assign(parser.GetSourceCode(), parser.GetSourceCodeSize());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      トークンの切り出し速度を走査モードごとに計測します.
+//-----------------------------------------------------------------------------
+int BenchTokenizer(const char* path)
+{
+    std::string source;
+    if (!LoadExpandedSource(path, source))
+    { return -1; }
+
+    // 1回では短すぎるので, 一定量を処理するまで繰り返す.
+    auto repeat = std::max<size_t>(1, kTargetSize / std::max<size_t>(1, source.size()));
+
+    for(auto mode : { SCAN_MODE_SCALAR, SCAN_MODE_SSE, SCAN_MODE_AVX2 })
+    {
+        Tokenizer tokenizer;
+        tokenizer.SetScanMode(mode);
+
+        // CPUが対応していないモードは計測しない.
+        if (tokenizer.GetScanMode() != mode)
+        { continue; }
+
+        // FxParser と同じ区切り文字を使う.
+        tokenizer.SetSeparator( " \t\r\n,\"" );
+        tokenizer.SetCutOff( "{}()=#<>;" );
+
+        size_t count = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for(size_t i=0; i<repeat; ++i)
+        {
+            tokenizer.SetBuffer(&source[0], source.size());
+            while(!tokenizer.IsEnd())
+            {
+                tokenizer.Next();
+                count++;
+            }
+        }
+        auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        printf_s("TokenizerBench : mode = %s, tokens = %zu, bytes = %zu, throughput = %.2f Mtokens/s, %.2f MB/s, path = %s\n",
+            kScanModeName[mode],
+            count / repeat,
+            source.size(),
+            (time > 0.0) ? double(count) / 1000000.0 / time : 0.0,
+            (time > 0.0) ? double(source.size() * repeat) / (1024.0 * 1024.0) / time : 0.0,
+            path);
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      解析速度計測用のエフェクトファイルを生成します.
+//-----------------------------------------------------------------------------
+bool WriteSyntheticEffect(const char* path, size_t lineCount)
+{
+    FILE* pFile;
+
+    auto err = fopen_s(&pFile, path, "w");
+    if ( err != 0 )
+    {
+        fprintf_s(stderr, "Error : File Open Failed. path = %s\n", path);
+        return false;
+    }
+
+    // 大半のトークンがキーワード以外の識別子になるように, 宣言と関数を繰り返す.
+    size_t lines = 0;
+    for(size_t i=0; lines<lineCount; ++i)
+    {
+        fprintf_s(pFile, "struct VSOutput%zu\n{\n", i);
+        fprintf_s(pFile, "    float4 Position : SV_POSITION;\n");
+        fprintf_s(pFile, "    float2 TexCoord : TEXCOORD0;\n");
+        fprintf_s(pFile, "    float3 Normal   : NORMAL;\n");
+        fprintf_s(pFile, "};\n");
+        fprintf_s(pFile, "cbuffer CbMaterial%zu : register(b0)\n{\n", i);
+        fprintf_s(pFile, "    float4x4 World%zu;\n", i);
+        fprintf_s(pFile, "    float4   Color%zu;\n", i);
+        fprintf_s(pFile, "};\n");
+        fprintf_s(pFile, "Texture2D    ColorMap%zu : register(t0);\n", i);
+        fprintf_s(pFile, "SamplerState ColorSmp%zu : register(s0);\n", i);
+        fprintf_s(pFile, "BlendState BlendState%zu\n{\n", i);
+        fprintf_s(pFile, "    BlendEnable = true;\n");
+        fprintf_s(pFile, "    SrcBlend = SRC_ALPHA;\n");
+        fprintf_s(pFile, "    DstBlend = INV_SRC_ALPHA;\n");
+        fprintf_s(pFile, "};\n");
+        fprintf_s(pFile, "VSOutput%zu VSFunc%zu(float3 position : POSITION, float2 texcoord : TEXCOORD0, float3 normal : NORMAL)\n{\n", i, i);
+        fprintf_s(pFile, "    VSOutput%zu output = (VSOutput%zu)0;\n", i, i);
+        fprintf_s(pFile, "    output.Position = mul(World%zu, float4(position, 1.0f));\n", i);
+        fprintf_s(pFile, "    output.TexCoord = texcoord;\n");
+        fprintf_s(pFile, "    output.Normal   = normalize(mul((float3x3)World%zu, normal));\n", i);
+        fprintf_s(pFile, "    return output;\n");
+        fprintf_s(pFile, "}\n");
+        fprintf_s(pFile, "float4 PSFunc%zu(VSOutput%zu input) : SV_TARGET\n{\n", i, i);
+        fprintf_s(pFile, "    float  lighting = saturate(dot(input.Normal, float3(0.0f, 1.0f, 0.0f)));\n");
+        fprintf_s(pFile, "    float4 albedo   = ColorMap%zu.Sample(ColorSmp%zu, input.TexCoord);\n", i, i);
+        fprintf_s(pFile, "    return albedo * Color%zu * lighting;\n", i);
+        fprintf_s(pFile, "}\n");
+        fprintf_s(pFile, "technique Technique%zu\n{\n", i);
+        fprintf_s(pFile, "    pass Pass0\n    {\n");
+        fprintf_s(pFile, "        VertexShader = compile vs_6_0 VSFunc%zu();\n", i);
+        fprintf_s(pFile, "        PixelShader  = compile ps_6_0 PSFunc%zu();\n", i);
+        fprintf_s(pFile, "        BlendState   = BlendState%zu;\n", i);
+        fprintf_s(pFile, "    }\n}\n");
+        lines += 41;
+    }
+
+    fclose(pFile);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      エフェクトファイルの解析速度を計測します.
+//-----------------------------------------------------------------------------
+int BenchParse(const char* path)
+{
+    asura::MappedFile file;
+    if (!file.Open(path))
+    {
+        fprintf_s(stderr, "Error : File Open Failed. path = %s\n", path);
+        return -1;
+    }
+
+    auto view  = file.GetView();
+    auto lines = std::count(view.begin(), view.end(), '\n');
+
+    // 解析結果を再利用しないように毎回作り直す.
+    double best  = 0.0;
+    double total = 0.0;
+    for(auto i=0; i<kParseCount; ++i)
+    {
+        asura::FxParser parser;
+
+        auto begin = std::chrono::steady_clock::now();
+        if (!parser.Parse(path))
+        {
+            fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", path);
+            return -1;
+        }
+        auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        best   = (i == 0) ? time : std::min(best, time);
+        total += time;
+    }
+
+    printf_s("ParseBench : lines = %zu, bytes = %zu, best = %.2f ms, average = %.2f ms, throughput = %.2f MB/s, path = %s\n",
+        size_t(lines),
+        view.size(),
+        best,
+        total / double(kParseCount),
+        (best > 0.0) ? double(view.size()) / (1024.0 * 1024.0) / (best / 1000.0) : 0.0,
+        path);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      プロセスの最大メモリ使用量を取得します.
+//-----------------------------------------------------------------------------
+uint64_t GetPeakMemorySize()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    { return 0; }
+
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    { return 0; }
+
+    return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      ソースファイルの読み込み時間と最大メモリ使用量を計測します.
+//-----------------------------------------------------------------------------
+int BenchLoad(const char* path)
+{
+    // 読み込むファイルは1回目の解析結果から求める.
+    std::vector<std::string> paths;
+    uint64_t sourceSize = 0;
+    double   parseBest  = 0.0;
+    for(auto i=0; i<kLoadCount; ++i)
+    {
+        asura::FxParser parser;
+
+        auto begin = std::chrono::steady_clock::now();
+        if (!parser.Parse(path))
+        {
+            fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", path);
+            return -1;
+        }
+        auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        parseBest = (i == 0) ? time : std::min(parseBest, time);
+
+        if (i == 0)
+        {
+            for(auto& itr : parser.GetSourceFiles())
+            {
+                paths.push_back(itr.second->Path);
+                sourceSize += itr.second->Code.size();
+            }
+        }
+    }
+
+    // 解析と同じようにキャッシュを通してルートファイルとインクルードファイルを読み込む.
+    double loadBest = 0.0;
+    for(auto i=0; i<kLoadCount; ++i)
+    {
+        asura::SourceCache cache;
+
+        auto begin = std::chrono::steady_clock::now();
+        for(auto& itr : paths)
+        {
+            if (!cache.Load(itr))
+            {
+                fprintf_s(stderr, "Error : File Open Failed. path = %s\n", itr.c_str());
+                return -1;
+            }
+        }
+        auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        loadBest = (i == 0) ? time : std::min(loadBest, time);
+    }
+
+    printf_s("LoadBench : files = %zu, bytes = %llu, load = %.3f ms, parse = %.2f ms, peak = %llu KB, path = %s\n",
+        paths.size(),
+        static_cast<unsigned long long>(sourceSize),
+        loadBest,
+        parseBest,
+        static_cast<unsigned long long>(GetPeakMemorySize() / 1024),
+        path);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      パックファイルの展開速度をバイナリのサイズ帯ごとに計測します.
+//-----------------------------------------------------------------------------
+int BenchPack(const char* path)
+{
+    struct SizeClass
+    {
+        const char*                         Tag;        //!< 表示名.
+        size_t                              Limit;      //!< 上限サイズ (このサイズ未満).
+        std::vector<asura::ShaderPackBlob>  Blobs;      //!< 対象バイナリ.
+        uint64_t                            RawSize;    //!< 展開後の合計サイズ.
+    };
+
+    SizeClass classes[] = {
+        { "< 1KiB",      1024,              {}, 0 },
+        { "1-4KiB",      4 * 1024,          {}, 0 },
+        { "4-16KiB",     16 * 1024,         {}, 0 },
+        { "16-64KiB",    64 * 1024,         {}, 0 },
+        { ">= 64KiB",    SIZE_MAX,          {}, 0 },
+    };
+
+    asura::MappedFile file;
+    if (!file.Open(path))
+    {
+        fprintf_s(stderr, "Error : File Open Failed. path = %s\n", path);
+        return -1;
+    }
+
+    auto view = file.GetView();
+    asura::ShaderPackReader reader;
+    if (!reader.Init(view.data(), view.size()))
+    {
+        fprintf_s(stderr, "Error : Shader Pack Read Failed. path = %s\n", path);
+        return -1;
+    }
+
+    // 同じバイナリを指すエントリーは1回だけ数える.
+    std::set<const void*> visited;
+    size_t maxSize = 0;
+    for(uint32_t i=0; i<reader.GetCount(); ++i)
+    {
+        asura::ShaderPackBlob blob;
+        if (!reader.GetBlob(i, blob))
+        {
+            fprintf_s(stderr, "Error : Shader Pack Read Failed. path = %s\n", path);
+            return -1;
+        }
+
+        if (!visited.insert(blob.pData).second)
+        { continue; }
+
+        for(auto& sizeClass : classes)
+        {
+            if (blob.RawSize < sizeClass.Limit)
+            {
+                sizeClass.Blobs.push_back(blob);
+                sizeClass.RawSize += blob.RawSize;
+                break;
+            }
+        }
+
+        maxSize = std::max(maxSize, blob.RawSize);
+    }
+
+    // 1回では短すぎるので, サイズ帯ごとに一定量を展開するまで繰り返す.
+    std::vector<uint8_t> buffer(maxSize);
+    for(auto& sizeClass : classes)
+    {
+        if (sizeClass.Blobs.empty())
+        { continue; }
+
+        auto repeat = std::max<uint64_t>(1, kTargetSize / std::max<uint64_t>(1, sizeClass.RawSize));
+        auto begin  = std::chrono::steady_clock::now();
+        for(uint64_t i=0; i<repeat; ++i)
+        {
+            for(auto& blob : sizeClass.Blobs)
+            {
+                if (!asura::ShaderPackReader::Decode(blob, buffer.data(), buffer.size()))
+                {
+                    fprintf_s(stderr, "Error : Shader Pack Decode Failed. path = %s\n", path);
+                    return -1;
+                }
+            }
+        }
+        auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        printf_s("PackBench : class = %s, blobs = %zu, raw = %llu bytes, throughput = %.2f MB/s\n",
+            sizeClass.Tag,
+            sizeClass.Blobs.size(),
+            static_cast<unsigned long long>(sizeClass.RawSize),
+            (time > 0.0) ? double(sizeClass.RawSize * repeat) / (1024.0 * 1024.0) / time : 0.0);
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      バリエーション情報の XML 出力速度を計測します.
+//-----------------------------------------------------------------------------
+int BenchVariationInfo(const char* path)
+{
+    asura::FxParser parser;
+    if (!parser.Parse(path))
+    {
+        fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", path);
+        return -1;
+    }
+
+    std::vector<asura::KeywordVariant> variants;
+    if (!asura::EnumerateVariants(parser, path, variants))
+    { return -1; }
+
+    // まとめた組み合わせはコンパイルしないと求まらないので出力しない.
+    std::vector<asura::VariantAlias> aliases;
+    const char* hlslpath = "input_source.fx";
+
+    size_t passCount = 0;
+    for(auto& technique : parser.GetTechniques())
+    { passCount += technique.Pass.size(); }
+
+    asura::XmlWriter writer;
+    asura::FormatVariationInfo(writer, parser, variants, aliases, hlslpath);
+
+    // 1回では短すぎるので, 一定量を書き込むまで繰り返す.
+    auto size   = writer.GetSize();
+    auto repeat = std::max<size_t>(1, kTargetSize / std::max<size_t>(1, size));
+
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i=0; i<repeat; ++i)
+    {
+        writer.Reset();
+        asura::FormatVariationInfo(writer, parser, variants, aliases, hlslpath);
+    }
+    auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    printf_s("MetaBench : passes = %zu, bytes = %zu, time = %.3f ms, throughput = %.2f MB/s, path = %s\n",
+        passCount,
+        size,
+        time * 1000.0 / double(repeat),
+        (time > 0.0) ? double(size * repeat) / (1024.0 * 1024.0) / time : 0.0,
+        path);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc <= 2)
+    {
+        printf_s("asfxc_bench.exe tokenizer input_path\n");
+        printf_s("asfxc_bench.exe parse input_path [-generate lines]\n");
+        printf_s("asfxc_bench.exe load input_path\n");
+        printf_s("asfxc_bench.exe pack pack_path\n");
+        printf_s("asfxc_bench.exe meta input_path [-generate lines]\n");
+        return 0;
+    }
+
+    if (_stricmp(argv[1], "tokenizer") == 0)
+    { return BenchTokenizer(argv[2]); }
+
+    // 指定した行数のエフェクトファイルを生成してから計測する.
+    auto generate = (argc > 4 && _stricmp(argv[3], "-generate") == 0);
+
+    if (_stricmp(argv[1], "parse") == 0)
+    {
+        if (generate && !WriteSyntheticEffect(argv[2], size_t(strtoull(argv[4], nullptr, 10))))
+        { return -1; }
+
+        return BenchParse(argv[2]);
+    }
+
+    if (_stricmp(argv[1], "load") == 0)
+    { return BenchLoad(argv[2]); }
+
+    if (_stricmp(argv[1], "pack") == 0)
+    { return BenchPack(argv[2]); }
+
+    if (_stricmp(argv[1], "meta") == 0)
+    {
+        if (generate && !WriteSyntheticEffect(argv[2], size_t(strtoull(argv[4], nullptr, 10))))
+        { return -1; }
+
+        return BenchVariationInfo(argv[2]);
+    }
+
+    fprintf_s(stderr, "Error : Invalid Arguments.\n");
+    return -1;
+}
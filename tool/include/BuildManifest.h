@@ -0,0 +1,192 @@
+﻿//-----------------------------------------------------------------------------
+// File : BuildManifest.h
+// Desc : Build Dependency Manifest Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// MANIFEST_KIND enum
+///////////////////////////////////////////////////////////////////////////////
+enum MANIFEST_KIND
+{
+    MANIFEST_INPUT,     //!< 入力ファイル.
+    MANIFEST_MISSING,   //!< 見つからなかったファイル.
+    MANIFEST_OUTPUT,    //!< 出力ファイル.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ManifestEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct ManifestEntry
+{
+    MANIFEST_KIND   Kind;       //!< 種別.
+    std::string     Path;       //!< ファイルパス.
+    std::string     Hash;       //!< 内容のハッシュ値.
+    uint64_t        Size;       //!< ファイルサイズ.
+    int64_t         Time;       //!< 更新日時.
+    std::string     Key;        //!< 出力を生成した入力のキー.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// BuildManifest class
+///////////////////////////////////////////////////////////////////////////////
+class BuildManifest
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    BuildManifest();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~BuildManifest();
+
+    //------------------------------------------------------------------------
+    //! @brief      マニフェストを読み込みます.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //------------------------------------------------------------------------
+    bool Load(const std::string& path);
+
+    //------------------------------------------------------------------------
+    //! @brief      マニフェストを書き出します.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @retval true    書き出しに成功.
+    //! @retval false   書き出しに失敗.
+    //------------------------------------------------------------------------
+    bool Save(const std::string& path) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      記録を破棄し, 記録開始時刻を設定します.
+    //! 
+    //! @param[in]      option      出力に影響する設定のハッシュ値.
+    //! @note       入力を読み込む前に呼び出してください. 開始時刻以降に更新されたファイルは必ず内容を比較します.
+    //------------------------------------------------------------------------
+    void Reset(const std::string& option);
+
+    //------------------------------------------------------------------------
+    //! @brief      入力ファイルを記録します.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      code        読み込んだ内容.
+    //------------------------------------------------------------------------
+    void AddInput(const std::string& path, std::string_view code);
+
+    //------------------------------------------------------------------------
+    //! @brief      見つからなかったファイルを記録します.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //------------------------------------------------------------------------
+    void AddMissing(const std::string& path);
+
+    //------------------------------------------------------------------------
+    //! @brief      出力ファイルを記録します.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      key         出力を生成した入力のキー.
+    //! @param[in]      pData       書き出した内容.
+    //! @param[in]      size        書き出したサイズ.
+    //------------------------------------------------------------------------
+    void AddOutput(const std::string& path, const std::string& key, const void* pData, size_t size);
+
+    //------------------------------------------------------------------------
+    //! @brief      書き出し済みの出力ファイルを読み込んで記録します.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      key         出力を生成した入力のキー.
+    //! @retval true    記録に成功.
+    //! @retval false   ファイルを読み込めませんでした.
+    //------------------------------------------------------------------------
+    bool AddOutputFile(const std::string& path, const std::string& key);
+
+    //------------------------------------------------------------------------
+    //! @brief      他のマニフェストの出力ファイルの記録を引き継ぎます.
+    //! 
+    //! @param[in]      other       引き継ぎ元のマニフェスト.
+    //! @param[in]      path        ファイルパス.
+    //------------------------------------------------------------------------
+    void CopyOutput(const BuildManifest& other, const std::string& path);
+
+    //------------------------------------------------------------------------
+    //! @brief      全ての入出力が記録時から変更されていないかチェックします.
+    //! 
+    //! @param[in]      option      出力に影響する設定のハッシュ値.
+    //! @retval true    変更されていません.
+    //! @retval false   変更されているか, 記録がありません.
+    //------------------------------------------------------------------------
+    bool IsUpToDate(const std::string& option) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      出力ファイルが同じキーで生成され, 変更されていないかチェックします.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      key         出力を生成する入力のキー.
+    //! @retval true    再生成の必要はありません.
+    //! @retval false   再生成が必要です.
+    //------------------------------------------------------------------------
+    bool IsOutputUpToDate(const std::string& path, const std::string& key) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      記録数を取得します.
+    //------------------------------------------------------------------------
+    size_t GetCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      記録を取得します.
+    //! 
+    //! @return     記録した順に返却します.
+    //------------------------------------------------------------------------
+    const std::vector<ManifestEntry>& GetEntries() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::string                             m_Option;       //!< 出力に影響する設定のハッシュ値.
+    int64_t                                 m_Stamp;        //!< 記録開始時刻.
+    std::vector<ManifestEntry>              m_Entries;      //!< 記録.
+    std::map<std::string, size_t>           m_Outputs;      //!< 出力ファイルパスから記録へのインデックス.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    void Add        (ManifestEntry&& entry);
+    bool IsUnchanged(const ManifestEntry& entry) const;
+
+    BuildManifest               (const BuildManifest&) = delete;
+    BuildManifest& operator =   (const BuildManifest&) = delete;
+};
+
+} // namespace asura
@@ -0,0 +1,129 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompileCache.h
+// Desc : Shader Compile Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderCompiler.h"
+#include <atomic>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileCacheStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct CompileCacheStats
+{
+    uint32_t    HitCount;       //!< ヒット数.
+    uint32_t    MissCount;      //!< ミス数.
+    uint32_t    EvictCount;     //!< 削除したエントリー数.
+    uint64_t    TotalSize;      //!< 削除後のキャッシュサイズ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileCache class
+///////////////////////////////////////////////////////////////////////////////
+class CompileCache
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      directory       キャッシュディレクトリ.
+    //! @param[in]      maxSize         キャッシュの最大サイズ(バイト).
+    //------------------------------------------------------------------------
+    CompileCache(const std::string& directory, uint64_t maxSize);
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~CompileCache();
+
+    //------------------------------------------------------------------------
+    //! @brief      キャッシュディレクトリを作成します.
+    //! 
+    //! @retval true    作成に成功.
+    //! @retval false   作成に失敗.
+    //------------------------------------------------------------------------
+    bool Init();
+
+    //------------------------------------------------------------------------
+    //! @brief      コンパイルジョブのキーを生成します.
+    //! 
+    //! @param[in]      job         コンパイルジョブ.
+    //! @param[in]      backend     コンパイラバックエンド.
+    //! @return     コンパイル結果を一意に決める入力のハッシュ値を返却します.
+    //------------------------------------------------------------------------
+    static std::string MakeKey(const CompileJob& job, const ShaderCompilerBackend& backend);
+
+    //------------------------------------------------------------------------
+    //! @brief      キャッシュからバイナリを読み込みます.
+    //! 
+    //! @param[in]      key         キー.
+    //! @param[out]     result      読み込んだバイナリ.
+    //! @retval true    ヒット.
+    //! @retval false   ミス.
+    //------------------------------------------------------------------------
+    bool Load(const std::string& key, std::vector<uint8_t>& result);
+
+    //------------------------------------------------------------------------
+    //! @brief      キャッシュにバイナリを登録します.
+    //! 
+    //! @param[in]      key         キー.
+    //! @param[in]      binary      登録するバイナリ.
+    //! @note       他のプロセスと同時に同じキーを登録しても安全です.
+    //------------------------------------------------------------------------
+    void Store(const std::string& key, const std::vector<uint8_t>& binary);
+
+    //------------------------------------------------------------------------
+    //! @brief      最大サイズを超えている場合に, 古いエントリーから削除します.
+    //------------------------------------------------------------------------
+    void Trim();
+
+    //------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //! 
+    //! @return     統計情報を返却します.
+    //------------------------------------------------------------------------
+    CompileCacheStats GetStats() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::string             m_Directory;    //!< キャッシュディレクトリ.
+    uint64_t                m_MaxSize;      //!< 最大サイズ.
+    std::atomic<uint32_t>   m_HitCount;     //!< ヒット数.
+    std::atomic<uint32_t>   m_MissCount;    //!< ミス数.
+    std::atomic<uint32_t>   m_EvictCount;   //!< 削除したエントリー数.
+    std::atomic<uint64_t>   m_TotalSize;    //!< 削除後のキャッシュサイズ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    std::string GetPath(const std::string& key) const;
+
+    CompileCache            (const CompileCache&) = delete;
+    CompileCache& operator= (const CompileCache&) = delete;
+};
+
+} // namespace asura
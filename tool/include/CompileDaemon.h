@@ -0,0 +1,49 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompileDaemon.h
+// Desc : Resident Compile Daemon Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//! @brief      デーモンが受け付けた要求を処理する関数です.
+//! 
+//! @param[in]      args        実行ファイル名を除くコマンドライン引数.
+//! @return     終了コードを返却します.
+//! @note       要求元の作業ディレクトリで1件ずつ呼び出され, 標準出力と標準エラー出力は要求元に転送されます.
+//-----------------------------------------------------------------------------
+using DaemonHandler = std::function<int(const std::vector<std::string>& args)>;
+
+//-----------------------------------------------------------------------------
+//! @brief      ローカルソケットで要求を待ち受けて処理します.
+//! 
+//! @param[in]      socketPath  ソケットファイルパス.
+//! @param[in]      handler     要求を処理する関数.
+//! @return     終了コードを返却します.
+//! @note       -shutdown 要求を受け取るまで処理を続けます.
+//!             処理待ちの同じ要求は1回だけ処理し, 結果を全ての要求元に返します.
+//-----------------------------------------------------------------------------
+int RunDaemon(const std::string& socketPath, const DaemonHandler& handler);
+
+//-----------------------------------------------------------------------------
+//! @brief      コマンドライン引数をデーモンに転送して処理させます.
+//! 
+//! @param[in]      socketPath  ソケットファイルパス.
+//! @param[in]      args        実行ファイル名を除くコマンドライン引数.
+//! @param[out]     exitCode    デーモンが返却した終了コード.
+//! @retval true    デーモンが要求を受け付けました.
+//! @retval false   デーモンに接続できませんでした.
+//-----------------------------------------------------------------------------
+bool RunDaemonClient(const std::string& socketPath, const std::vector<std::string>& args, int& exitCode);
+
+} // namespace asura
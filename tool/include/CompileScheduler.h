@@ -0,0 +1,115 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompileScheduler.h
+// Desc : Shader Compile Scheduler Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderCompiler.h"
+#include "CompileCache.h"
+#include "ThreadPool.h"
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileSchedulerStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct CompileSchedulerStats
+{
+    uint32_t    JobCount;       //!< ジョブ数.
+    uint32_t    UniqueCount;    //!< 重複を除いたジョブ数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileScheduler class
+///////////////////////////////////////////////////////////////////////////////
+class CompileScheduler
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      pBackend        コンパイラバックエンド.
+    //! @param[in]      threadCount     ワーカースレッド数. 0の場合は論理コア数になります.
+    //! @param[in]      pCache          コンパイルキャッシュ. nullptr の場合は常にコンパイルします.
+    //------------------------------------------------------------------------
+    CompileScheduler(ShaderCompilerBackend* pBackend, uint32_t threadCount, CompileCache* pCache = nullptr);
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~CompileScheduler();
+
+    //------------------------------------------------------------------------
+    //! @brief      コンパイルジョブを並列に実行し, 完了まで待機します.
+    //! 
+    //! @param[in]      jobs        コンパイルジョブ.
+    //! @retval true    全てのジョブが成功.
+    //! @retval false   1つ以上のジョブが失敗.
+    //! @note       入力が同じジョブは1回だけコンパイルし, 他の出力はハードリンクにします.
+    //!             エラーは完了後にジョブの順番で出力します.
+    //!             複数スレッドから同時に呼び出せます.
+    //------------------------------------------------------------------------
+    bool Run(const std::vector<CompileJob>& jobs);
+
+    //------------------------------------------------------------------------
+    //! @brief      ジョブの出力を一意に決めるキーを生成します.
+    //! 
+    //! @param[in]      job         コンパイルジョブ.
+    //! @return     ソースコード, エントリーポイント, プロファイル, フラグ, バックエンドから求めたキーを返却します.
+    //------------------------------------------------------------------------
+    std::string MakeKey(const CompileJob& job) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ワーカースレッド数を取得します.
+    //! 
+    //! @return     ワーカースレッド数を返却します.
+    //------------------------------------------------------------------------
+    uint32_t GetThreadCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //! 
+    //! @return     統計情報を返却します.
+    //------------------------------------------------------------------------
+    CompileSchedulerStats GetStats() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    ShaderCompilerBackend*  m_pBackend;     //!< コンパイラバックエンド.
+    CompileCache*           m_pCache;       //!< コンパイルキャッシュ.
+    ThreadPool              m_Pool;         //!< スレッドプール.
+    std::atomic<uint32_t>   m_JobCount;     //!< ジョブ数.
+    std::atomic<uint32_t>   m_UniqueCount;  //!< 重複を除いたジョブ数.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    void Execute    (const CompileJob& job, const std::string& key, CompileResult& result);
+    void Duplicate  (const CompileJob& srcJob, const CompileResult& srcResult, const CompileJob& dstJob, CompileResult& dstResult);
+
+    CompileScheduler            (const CompileScheduler&) = delete;
+    CompileScheduler& operator= (const CompileScheduler&) = delete;
+};
+
+} // namespace asura
@@ -0,0 +1,138 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompilerWorker.h
+// Desc : Shader Compiler Worker Process Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderCompiler.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+// Forward Declarations.
+//-----------------------------------------------------------------------------
+class WorkerProcess;
+
+///////////////////////////////////////////////////////////////////////////////
+// WorkerPoolBackend class
+///////////////////////////////////////////////////////////////////////////////
+class WorkerPoolBackend : public ShaderCompilerBackend
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      command     ワーカープロセスの起動コマンド.
+    //! @param[in]      count       ワーカープロセス数.
+    //! @param[in]      backend     ワーカープロセス内で使用するバックエンド.
+    //! @note       ワーカープロセスは最初に使用する時に起動します.
+    //------------------------------------------------------------------------
+    WorkerPoolBackend(const std::vector<std::string>& command, uint32_t count, const ShaderCompilerBackend& backend);
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~WorkerPoolBackend();
+
+    //------------------------------------------------------------------------
+    //! @brief      シェーダをコンパイルします.
+    //! 
+    //! @param[in]      job         コンパイルジョブ.
+    //! @param[out]     result      コンパイル結果.
+    //! @retval true    コンパイルに成功.
+    //! @retval false   コンパイルに失敗.
+    //! @note       ワーカープロセスが異常終了した場合は再起動して1回だけ再試行します.
+    //------------------------------------------------------------------------
+    bool Compile(const CompileJob& job, CompileResult& result) override;
+
+    //------------------------------------------------------------------------
+    //! @brief      バックエンド名を取得します.
+    //! 
+    //! @return     ワーカープロセス内のバックエンド名を返却します.
+    //------------------------------------------------------------------------
+    const char* GetName() const override;
+
+    //------------------------------------------------------------------------
+    //! @brief      バックエンドのバージョンを取得します.
+    //! 
+    //! @return     ワーカープロセス内のバックエンドのバージョンを返却します.
+    //------------------------------------------------------------------------
+    std::string GetVersion() const override;
+
+    //------------------------------------------------------------------------
+    //! @brief      ワーカープロセス数を取得します.
+    //! 
+    //! @return     ワーカープロセス数を返却します.
+    //------------------------------------------------------------------------
+    uint32_t GetWorkerCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ワーカープロセスを再起動した回数を取得します.
+    //! 
+    //! @return     再起動した回数を返却します.
+    //------------------------------------------------------------------------
+    uint32_t GetRestartCount() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::vector<std::string>                    m_Command;      //!< 起動コマンド.
+    std::string                                 m_Name;         //!< バックエンド名.
+    std::string                                 m_Version;      //!< バージョン文字列.
+    std::vector<std::unique_ptr<WorkerProcess>> m_Workers;      //!< ワーカープロセス.
+    std::vector<WorkerProcess*>                 m_Idle;         //!< 待機中のワーカープロセス.
+    std::mutex                                  m_Mutex;        //!< ミューテックス.
+    std::condition_variable                     m_Released;     //!< ワーカー解放の通知.
+    std::atomic<uint32_t>                       m_RestartCount; //!< 再起動した回数.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    WorkerProcess*  Acquire ();
+    void            Release (WorkerProcess* pWorker);
+
+    WorkerPoolBackend               (const WorkerPoolBackend&) = delete;
+    WorkerPoolBackend& operator =   (const WorkerPoolBackend&) = delete;
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      ワーカープロセスとして, 標準入力から受け取ったジョブをコンパイルします.
+//! 
+//! @param[in]      backend     使用するバックエンド.
+//! @return     終了コードを返却します.
+//! @note       標準入力が閉じられるまで処理を続けます.
+//-----------------------------------------------------------------------------
+int RunCompilerWorker(ShaderCompilerBackend& backend);
+
+//-----------------------------------------------------------------------------
+//! @brief      実行中のプログラムのファイルパスを取得します.
+//! 
+//! @param[in]      argv0       main() に渡された argv[0].
+//! @return     実行ファイルパスを返却します.
+//-----------------------------------------------------------------------------
+std::string GetExecutablePath(const char* argv0);
+
+} // namespace asura
@@ -0,0 +1,238 @@
+﻿//-----------------------------------------------------------------------------
+// File : EffectBuild.h
+// Desc : Effect Build Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "FxParser.h"
+#include "ShaderCompiler.h"
+#include "CompilerWorker.h"
+#include "CompileCache.h"
+#include "CompileScheduler.h"
+#include "SourceCache.h"
+#include "RenderStateTable.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// Argument structure
+///////////////////////////////////////////////////////////////////////////////
+struct Argument
+{
+    std::vector<std::string>    InputPaths;
+    std::string                 OutputDir;
+    std::string                 OutFxName   = "input_source.fx";
+    std::string                 OutXmlName  = "variation.xml";
+    std::string                 OutBinName  = "variation.bin";
+    std::string                 OutManifestName = "asfxc.manifest";
+    std::string                 OutPackName = "shader.pack";
+    std::string                 OutStateXmlName = "render_state.xml";
+    std::string                 OutStateBinName = "render_state.bin";
+    std::string                 OutObjName  = "obj";
+    std::string                 BuildOption;
+    std::string                 DepFile;
+    std::string                 DepTarget;
+    std::string                 Compiler;
+    std::string                 CacheDir;
+    uint64_t                    CacheSize   = 1024;
+    bool                        Compile     = false;
+    bool                        Stats       = false;
+    bool                        Serve       = false;
+    bool                        Force       = false;
+    bool                        Verify      = false;
+    std::string                 DaemonPath;
+    std::string                 ClientPath;
+    bool                        Shutdown    = false;
+    bool                        Watch       = false;
+    bool                        Strip       = false;
+    bool                        StripOut    = false;
+    bool                        Collapse    = false;
+    bool                        Pack        = false;
+    bool                        Compress    = false;
+    bool                        MetaXml     = true;
+    bool                        MetaBinary  = false;
+    uint32_t                    ThreadCount = 0;
+    uint32_t                    WorkerCount = 0;
+    bool                        Fake        = false;
+    uint32_t                    FakeDelay   = 0;
+    std::string                 FakeFail;
+    uint32_t                    FakeCrash   = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileContext structure
+///////////////////////////////////////////////////////////////////////////////
+struct CompileContext
+{
+    std::unique_ptr<ShaderCompilerBackend>   Backend;    //!< コンパイラバックエンド.
+    std::unique_ptr<WorkerPoolBackend>       Workers;    //!< ワーカープロセス.
+    std::unique_ptr<CompileCache>            Cache;      //!< コンパイルキャッシュ.
+    std::unique_ptr<CompileScheduler>        Scheduler;  //!< スケジューラ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ContextStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct ContextStats
+{
+    CompileSchedulerStats    Scheduler;      //!< スケジューラの統計情報.
+    CompileCacheStats        Cache;          //!< コンパイルキャッシュの統計情報.
+    uint32_t                 RestartCount;   //!< ワーカープロセスの再起動回数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseCache structure
+///////////////////////////////////////////////////////////////////////////////
+struct ParseCache
+{
+    std::mutex                                               Mutex;      //!< ミューテックス.
+    std::map<std::string, std::shared_ptr<const FxParser>>   Parsers;    //!< 作業ディレクトリと入力ファイルの絶対パスをキーとした解析結果.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      コマンドライン引数を解析します.
+//! 
+//! @param[in]      argc        引数の数.
+//! @param[in]      argv        引数.
+//! @param[out]     result      解析結果.
+//! @retval true    解析に成功.
+//! @retval false   引数が不正です.
+//-----------------------------------------------------------------------------
+bool ParseArg(int argc, char** argv, Argument& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      コンパイラバックエンドを生成します.
+//! 
+//! @param[in]      args        コマンドライン引数.
+//! @return     生成したバックエンドを返却します. 利用できない場合は nullptr を返却します.
+//-----------------------------------------------------------------------------
+ShaderCompilerBackend* CreateBackend(const Argument& args);
+
+//-----------------------------------------------------------------------------
+//! @brief      コンパイラバックエンドとスケジューラを生成します.
+//! 
+//! @param[in]      args        コマンドライン引数.
+//! @param[in]      argv0       実行ファイルパス. ワーカープロセスの起動に使います.
+//! @param[out]     context     生成したコンパイルコンテキスト.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//-----------------------------------------------------------------------------
+bool CreateCompileContext(const Argument& args, const char* argv0, CompileContext& context);
+
+//-----------------------------------------------------------------------------
+//! @brief      コンパイラバックエンドとスケジューラの設定を文字列にします.
+//! 
+//! @param[in]      args        コマンドライン引数.
+//! @return     同じ設定なら同じになる文字列を返却します.
+//-----------------------------------------------------------------------------
+std::string GetCompileConfig(const Argument& args);
+
+//-----------------------------------------------------------------------------
+//! @brief      統計情報を取得します.
+//! 
+//! @param[in]      context     コンパイルコンテキスト.
+//! @return     現在までの統計情報を返却します.
+//-----------------------------------------------------------------------------
+ContextStats GetContextStats(const CompileContext& context);
+
+//-----------------------------------------------------------------------------
+//! @brief      前回からの統計情報を出力します.
+//! 
+//! @param[in]      context     コンパイルコンテキスト.
+//! @param[in]      prev        GetContextStats() で取得した前回の統計情報.
+//-----------------------------------------------------------------------------
+void PrintContextStats(CompileContext& context, const ContextStats& prev);
+
+//-----------------------------------------------------------------------------
+//! @brief      バッチ処理用の出力先ディレクトリ名を決定します.
+//! 
+//! @param[in]      outputDir   出力先ディレクトリ.
+//! @param[in]      inputPath   入力ファイルパス.
+//! @param[in,out]  used        使用済みのディレクトリ名.
+//! @return     入力ファイル名から拡張子を除いたディレクトリパスを返却します.
+//-----------------------------------------------------------------------------
+std::string GetBatchOutputDir(const std::string& outputDir, const std::string& inputPath, std::set<std::string>& used);
+
+//-----------------------------------------------------------------------------
+//! @brief      マニフェストに記録する設定のハッシュ値を求めます.
+//! 
+//! @param[in]      args        コマンドライン引数.
+//! @param[in]      inputPath   入力ファイルパス.
+//! @return     ハッシュ値を返却します.
+//-----------------------------------------------------------------------------
+std::string GetManifestOption(const Argument& args, const std::string& inputPath);
+
+//-----------------------------------------------------------------------------
+//! @brief      全ての入力のステートを共通のステートテーブルに登録します.
+//! 
+//! @param[in]      args        コマンドライン引数.
+//! @param[in]      pCache      インクルードファイルのキャッシュ. 使用しない場合は nullptr.
+//! @param[in]      pParsed     解析結果のキャッシュ. 使用しない場合は nullptr.
+//! @param[out]     table       ステートテーブル.
+//! @retval true    登録に成功.
+//! @retval false   解析に失敗したか, ステートIDが衝突しました.
+//-----------------------------------------------------------------------------
+bool CollectRenderStates
+(
+    const Argument&     args,
+    SourceCache*        pCache,
+    ParseCache*         pParsed,
+    RenderStateTable&   table
+);
+
+//-----------------------------------------------------------------------------
+//! @brief      1つのエフェクトファイルを処理します.
+//! 
+//! @param[in]      inputPath   入力ファイルパス.
+//! @param[in]      outputDir   出力先ディレクトリ.
+//! @param[in]      args        コマンドライン引数.
+//! @param[in]      pCache      インクルードファイルのキャッシュ. 使用しない場合は nullptr.
+//! @param[in]      pParsed     解析結果のキャッシュ. 使用しない場合は nullptr.
+//! @param[in]      pScheduler  スケジューラ. コンパイルしない場合は nullptr.
+//! @param[out]     pStates     共通のステートテーブル. 使用しない場合は nullptr.
+//! @retval true    処理に成功.
+//! @retval false   処理に失敗.
+//-----------------------------------------------------------------------------
+bool ProcessFile
+(
+    const std::string&  inputPath,
+    const std::string&  outputDir,
+    const Argument&     args,
+    SourceCache*        pCache,
+    ParseCache*         pParsed,
+    CompileScheduler*   pScheduler,
+    RenderStateTable*   pStates
+);
+
+//-----------------------------------------------------------------------------
+//! @brief      ビルドを実行します.
+//! 
+//! @param[in,out]  args        コマンドライン引数. 設定のハッシュ値を更新します.
+//! @param[in]      argv0       実行ファイルパス.
+//! @param[in]      context     コンパイルコンテキスト.
+//! @param[in]      pCache      インクルードファイルのキャッシュ. 使用しない場合は nullptr.
+//! @param[in]      pParsed     解析結果のキャッシュ. 使用しない場合は nullptr.
+//! @return     終了コードを返却します.
+//! @note       複数入力の場合は入力ごとのディレクトリに出力します.
+//-----------------------------------------------------------------------------
+int RunBuild
+(
+    Argument&           args,
+    const char*         argv0,
+    CompileContext&     context,
+    SourceCache*        pCache,
+    ParseCache*         pParsed
+);
+
+} // namespace asura
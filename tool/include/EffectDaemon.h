@@ -0,0 +1,26 @@
+﻿//-----------------------------------------------------------------------------
+// File : EffectDaemon.h
+// Desc : Effect Build Daemon Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <string>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//! @brief      デーモンとして常駐し, 転送されたビルド要求を処理します.
+//! 
+//! @param[in]      path        ソケットファイルパス.
+//! @param[in]      argv0       実行ファイルパス.
+//! @return     終了コードを返却します.
+//! @note       インクルードファイル, 解析結果, コンパイルコンテキストを要求をまたいで再利用します.
+//-----------------------------------------------------------------------------
+int RunDaemonServer(const std::string& path, const char* argv0);
+
+} // namespace asura
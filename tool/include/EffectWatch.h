@@ -0,0 +1,27 @@
+﻿//-----------------------------------------------------------------------------
+// File : EffectWatch.h
+// Desc : Effect Watch Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "EffectBuild.h"
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//! @brief      入力ファイルの変更を監視して再処理します.
+//! 
+//! @param[in,out]  args        コマンドライン引数.
+//! @param[in]      argv0       実行ファイルパス.
+//! @param[in]      context     コンパイルコンテキスト.
+//! @return     監視を開始できなかった場合は -1 を返却します.
+//! @note       最初に全て処理してから, 変更された入力と依存ファイルを持つ入力だけを処理し直します.
+//-----------------------------------------------------------------------------
+int RunWatch(Argument& args, const char* argv0, CompileContext& context);
+
+} // namespace asura
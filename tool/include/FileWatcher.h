@@ -0,0 +1,126 @@
+﻿//-----------------------------------------------------------------------------
+// File : FileWatcher.h
+// Desc : File Change Watcher Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// FileWatcher class
+///////////////////////////////////////////////////////////////////////////////
+class FileWatcher
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    FileWatcher();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~FileWatcher();
+
+    //------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //! 
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //------------------------------------------------------------------------
+    bool Init();
+
+    //------------------------------------------------------------------------
+    //! @brief      監視するファイルを追加します.
+    //! 
+    //! @param[in]      path        ファイルパス. 存在しないファイルも指定できます.
+    //! @param[out]     pKey        Wait() で返却される正規化済みパスが設定されます.
+    //! @retval true    追加に成功.
+    //! @retval false   ディレクトリを監視できなかった.
+    //! @note       ファイルを含むディレクトリを監視するので, 置き換えによる保存も検出できます.
+    //------------------------------------------------------------------------
+    bool Add(const std::string& path, std::string* pKey = nullptr);
+
+    //------------------------------------------------------------------------
+    //! @brief      監視しているファイルが変更されるまで待機します.
+    //! 
+    //! @param[in]      timeoutMsec     タイムアウト時間(ミリ秒).
+    //! @param[out]     changed         変更されたファイルの正規化済みパス.
+    //! @retval true    1つ以上のファイルが変更された.
+    //! @retval false   タイムアウトまたはエラー.
+    //! @note       続けて発生した通知はまとめ, サイズと更新日時が変わったファイルだけを返却します.
+    //------------------------------------------------------------------------
+    bool Wait(uint32_t timeoutMsec, std::vector<std::string>& changed);
+
+    //------------------------------------------------------------------------
+    //! @brief      監視しているファイル数を取得します.
+    //! 
+    //! @return     監視しているファイル数を返却します.
+    //------------------------------------------------------------------------
+    size_t GetCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        std::string     FullPath;   //!< 絶対パス.
+        std::string     Directory;  //!< ディレクトリの正規化済みパス.
+        bool            Exists;     //!< ファイルが存在するかどうか.
+        uint64_t        Size;       //!< ファイルサイズ.
+        int64_t         Time;       //!< 更新日時.
+        bool            Dirty;      //!< 通知を受け取ったかどうか.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Directory structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Directory
+    {
+        std::string     FullPath;   //!< 絶対パス.
+        intptr_t        Handle;     //!< 監視ハンドル.
+    };
+
+    //========================================================================
+    // private variables.
+    //========================================================================
+    intptr_t                            m_Handle;       //!< 通知を受け取るハンドル.
+    std::map<std::string, Entry>        m_Files;        //!< 正規化済みパスをキーとしたファイル.
+    std::map<std::string, Directory>    m_Directories;  //!< 正規化済みパスをキーとしたディレクトリ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    bool ReadEvents (uint32_t timeoutMsec);
+    void MarkDirty  (const std::string& directory, const std::string& name);
+
+    FileWatcher             (const FileWatcher&) = delete;
+    FileWatcher& operator = (const FileWatcher&) = delete;
+};
+
+} // namespace asura
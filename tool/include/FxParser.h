@@ -9,8 +9,10 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include "Tokenizer.h"
+#include "SourceCache.h"
 #include <vector>
 #include <map>
+#include <set>
 
 
 namespace asura {
@@ -28,6 +30,7 @@ enum SHADER_TYPE
     SHADER_TYPE_COMPUTE,            //!< コンピュートシェーダ.
     SHADER_TYPE_AMPLIFICATION,      //!< 増幅シェーダ.
     SHADER_TYPE_MESH,               //!< メッシュシェーダ.
+    SHADER_TYPE_COUNT,              //!< シェーダの種類数.
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -323,6 +326,15 @@ enum RESOURCE_TYPE
     RESOURCE_TYPE_SAMPLER_COMPRISON_STATE,
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// KEYWORD_RULE_TYPE
+///////////////////////////////////////////////////////////////////////////////
+enum KEYWORD_RULE_TYPE
+{
+    KEYWORD_RULE_EXCLUDE = 0,       //!< 列挙したキーワードのうち2つ以上を同時に有効にしない.
+    KEYWORD_RULE_REQUIRE,           //!< 先頭のキーワードを有効にする場合は残りのキーワードも全て有効にする.
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // Shader 
 ///////////////////////////////////////////////////////////////////////////////
@@ -488,6 +500,43 @@ struct Technique
     std::vector<Pass>   Pass;   //!< パスデータです.
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// KeywordGroup
+///////////////////////////////////////////////////////////////////////////////
+struct KeywordGroup
+{
+    std::vector<std::string>    Keywords;   //!< 1つだけを有効にするキーワードです. 空文字列はどれも定義しないことを表します.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// KeywordRule
+///////////////////////////////////////////////////////////////////////////////
+struct KeywordRule
+{
+    KEYWORD_RULE_TYPE           Type;       //!< 規則の種類です.
+    std::vector<std::string>    Keywords;   //!< 対象のキーワードです.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Keywords
+///////////////////////////////////////////////////////////////////////////////
+struct Keywords
+{
+    std::vector<KeywordGroup>   Groups;     //!< キーワードグループです.
+    std::vector<KeywordRule>    Rules;      //!< 組み合わせの規則です.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IncludeStats
+///////////////////////////////////////////////////////////////////////////////
+struct IncludeStats
+{
+    uint32_t    OpenCount;      //!< ファイルオープンを試みた回数です.
+    uint32_t    UniqueCount;    //!< 読み込んだファイルのユニーク数です.
+    uint32_t    DirectiveCount; //!< 走査したインクルード文の数です.
+    uint32_t    ResolveCount;   //!< 解決を行ったインクルード文の数です.
+};
+
 // 文字列に変換.
 const char* ToString(SHADER_TYPE value);
 const char* ToString(POLYGON_MODE mode);
@@ -503,17 +552,18 @@ const char* ToString(DEPTH_WRITE_MASK type);
 const char* ToString(BLEND_OP_TYPE type);
 
 // 文字列から変換.
-POLYGON_MODE        ParsePolygonMode    (const char* value);
-BLEND_TYPE          ParseBlendType      (const char* value);
-FILTER_MODE         ParseFilterMode     (const char* value);
-MIPMAP_MODE         ParseMipmapMode     (const char* value);
-ADDRESS_MODE        ParseAddressMode    (const char* value);
-BORDER_COLOR        ParseBorderColor    (const char* value);
-CULL_TYPE           ParseCullType       (const char* value);
-COMPARE_TYPE        ParseCompareType    (const char* value);
-STENCIL_OP_TYPE     ParseStencilOpType  (const char* value);
-DEPTH_WRITE_MASK    ParseDepthWriteMask (const char* value);
-BLEND_OP_TYPE       ParseBlendOpType    (const char* value);
+POLYGON_MODE        ParsePolygonMode    (std::string_view value);
+BLEND_TYPE          ParseBlendType      (std::string_view value);
+FILTER_MODE         ParseFilterMode     (std::string_view value);
+MIPMAP_MODE         ParseMipmapMode     (std::string_view value);
+ADDRESS_MODE        ParseAddressMode    (std::string_view value);
+BORDER_COLOR        ParseBorderColor    (std::string_view value);
+CULL_TYPE           ParseCullType       (std::string_view value);
+COMPARE_TYPE        ParseCompareType    (std::string_view value);
+STENCIL_OP_TYPE     ParseStencilOpType  (std::string_view value);
+DEPTH_WRITE_MASK    ParseDepthWriteMask (std::string_view value);
+BLEND_OP_TYPE       ParseBlendOpType    (std::string_view value);
+MEMBER_TYPE         ParseMemberType     (std::string_view value);
 
 ///////////////////////////////////////////////////////////////////////////////
 // FxParser class
@@ -629,15 +679,50 @@ public:
     //------------------------------------------------------------------------
     const Properties& GetProperties() const;
 
+    //------------------------------------------------------------------------
+    //! @brief      キーワード宣言を取得します.
+    //! 
+    //! @return     キーワード宣言を返却します.
+    //------------------------------------------------------------------------
+    const Keywords& GetKeywords() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      インクルードの統計情報を取得します.
+    //! 
+    //! @return     インクルードの統計情報を返却します.
+    //------------------------------------------------------------------------
+    const IncludeStats& GetIncludeStats() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      読み込んだファイルを取得します.
+    //! 
+    //! @return     入力ファイルと解決したインクルードファイルを正規化済みパスをキーとして返却します.
+    //------------------------------------------------------------------------
+    const std::map<std::string, std::shared_ptr<const SourceFile>>& GetSourceFiles() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      インクルードの解決で見つからなかったファイルパスを取得します.
+    //! 
+    //! @return     見つからなかったファイルパスを返却します.
+    //------------------------------------------------------------------------
+    const std::set<std::string>& GetMissingFiles() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ファイルの読み込みに使うキャッシュを設定します.
+    //! 
+    //! @param[in]      pCache      複数のパーサーで共有するキャッシュ. nullptrの場合はパーサー毎のキャッシュを使います.
+    //------------------------------------------------------------------------
+    void SetSourceCache(SourceCache* pCache);
+
 private:
     ///////////////////////////////////////////////////////////////////////////
     // Info structure
     ///////////////////////////////////////////////////////////////////////////
     struct Info
     {
-        std::string     IncludeFile;    //!< インクルード文
-        std::string     FindPath;       //!< 解決済みファイルパス.
-        std::string     Code;           //!< 該当ファイル.
+        std::string         IncludeFile;    //!< インクルード文
+        std::string         FindPath;       //!< 解決済みファイルパス.
+        const SourceFile*   pFile;          //!< 該当ファイル(見つからない場合はnullptr).
     };
 
     //========================================================================
@@ -654,11 +739,19 @@ private:
     std::map<std::string, Structure>            m_Structures;
     std::map<std::string, Resource>             m_Resources;
     Properties                                  m_Properties;
+    Keywords                                    m_Keywords;
     std::string                                 m_SourceCode;
     int                                         m_ShaderCounter;
     std::vector<std::string>                    m_DirPaths;
     std::vector<Info>                           m_Includes;
+    std::map<std::string, size_t, std::less<>>  m_IncludeMap;
+    std::map<std::string, std::shared_ptr<const SourceFile>>   m_SourceFiles;
+    std::set<std::string>                       m_MissingFiles;
+    SourceCache                                 m_LocalCache;
+    SourceCache*                                m_pSourceCache;
+    IncludeStats                                m_IncludeStats;
     std::string                                 m_Expanded;
+    std::string_view                            m_Input;
 
     //========================================================================
     // private methods.
@@ -675,14 +768,15 @@ private:
     void ParseConstantBufferMember(MEMBER_TYPE type, ConstantBuffer& buffer, TYPE_MODIFIER& modifier);
     void ParseStruct();
     void ParseProperties();
+    void ParseKeywords();
     void ParseStructMember(MEMBER_TYPE type, Structure& structure, TYPE_MODIFIER& modifier);
     void ParseResource();
     void ParseResourceDetail(RESOURCE_TYPE type);
     void ParseTextureProperty(PROPERTY_TYPE type);
     SHADER_TYPE GetShaderType();
 
-    bool CorrectIncludes(const char* filename);
-    bool Expand(std::string& inout);
+    const SourceFile* CorrectIncludes(const std::string& path);
+    bool Expand(const SourceFile* pFile, std::string& output, std::vector<const SourceFile*>& stack, std::set<const SourceFile*>& onceFiles);
 };
 
 } // namespace asura
\ No newline at end of file
@@ -0,0 +1,177 @@
+﻿//-----------------------------------------------------------------------------
+// File : KeywordPermutation.h
+// Desc : Shader Keyword Permutation Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "FxParser.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// KeywordPermutation class
+///////////////////////////////////////////////////////////////////////////////
+class KeywordPermutation
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    KeywordPermutation();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~KeywordPermutation();
+
+    //------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //! 
+    //! @param[in]      keywords    キーワード宣言.
+    //! @param[out]     error       失敗した場合のエラーメッセージ.
+    //! @retval true    初期化に成功.
+    //! @retval false   規則に未宣言のキーワードがあるなど, 宣言が不正.
+    //------------------------------------------------------------------------
+    bool Init(const Keywords& keywords, std::string& error);
+
+    //------------------------------------------------------------------------
+    //! @brief      規則を満たす次の組み合わせを取得します.
+    //! 
+    //! @param[out]     selection   グループごとに有効にしたキーワードのインデックス.
+    //! @retval true    組み合わせを取得した.
+    //! @retval false   全ての組み合わせを列挙した.
+    //! @note       グループを先頭から順に決め, 規則に反した時点で残りのグループの展開を打ち切ります.
+    //!             全ての組み合わせを保持することはありません.
+    //------------------------------------------------------------------------
+    bool Next(std::vector<uint32_t>& selection);
+
+    //------------------------------------------------------------------------
+    //! @brief      列挙を最初からやり直します.
+    //------------------------------------------------------------------------
+    void Reset();
+
+    //------------------------------------------------------------------------
+    //! @brief      組み合わせのマクロ定義を取得します.
+    //! 
+    //! @param[in]      selection   Next() で取得した組み合わせ.
+    //! @param[out]     result      NAME=1 形式のマクロ定義.
+    //------------------------------------------------------------------------
+    void GetDefines(const std::vector<uint32_t>& selection, std::vector<std::string>& result) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      組み合わせを表すキーを取得します.
+    //! 
+    //! @param[in]      selection   Next() で取得した組み合わせ.
+    //! @return     有効なキーワードを宣言順に空白で区切った文字列を返却します. 1つも無い場合は "_" を返却します.
+    //------------------------------------------------------------------------
+    std::string GetKey(const std::vector<uint32_t>& selection) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      規則を適用する前の組み合わせ数を取得します.
+    //! 
+    //! @return     各グループのキーワード数の積を返却します.
+    //------------------------------------------------------------------------
+    double GetRawCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      規則を評価した部分的な組み合わせの数を取得します.
+    //! 
+    //! @return     列挙開始から評価した数を返却します.
+    //------------------------------------------------------------------------
+    uint64_t GetVisitCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      グループ数を取得します.
+    //! 
+    //! @return     グループ数を返却します.
+    //------------------------------------------------------------------------
+    size_t GetGroupCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      規則数を取得します.
+    //! 
+    //! @return     規則数を返却します.
+    //------------------------------------------------------------------------
+    size_t GetRuleCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Item structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Item
+    {
+        uint32_t    Group;      //!< グループ番号.
+        uint32_t    Index;      //!< グループ内のインデックス.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Rule structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Rule
+    {
+        KEYWORD_RULE_TYPE   Type;       //!< 規則の種類.
+        std::vector<Item>   Items;      //!< 対象のキーワード.
+    };
+
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::vector<std::vector<std::string>>   m_Groups;       //!< グループごとのキーワード名.
+    std::vector<Rule>                       m_Rules;        //!< 規則.
+    std::vector<std::vector<uint32_t>>      m_GroupRules;   //!< グループを参照する規則の番号.
+    std::vector<uint32_t>                   m_Selection;    //!< 現在の組み合わせ.
+    size_t                                  m_Depth;        //!< 決定済みのグループ数.
+    bool                                    m_Started;      //!< 列挙を開始したかどうか.
+    bool                                    m_Finished;     //!< 列挙を終えたかどうか.
+    uint64_t                                m_VisitCount;   //!< 評価した部分的な組み合わせの数.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    bool IsValid(uint32_t group) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// KeywordVariant structure
+///////////////////////////////////////////////////////////////////////////////
+struct KeywordVariant
+{
+    std::string                 Key;        //!< 有効なキーワードを空白で区切った文字列.
+    std::string                 Suffix;     //!< 出力ファイル名に付ける接尾辞.
+    std::vector<std::string>    Defines;    //!< マクロ定義.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      規則を満たすキーワードの組み合わせを列挙します.
+//! 
+//! @param[in]      parser      解析済みのエフェクト.
+//! @param[in]      inputPath   エラーと統計情報に表示する入力ファイルパス.
+//! @param[out]     result      キーワードの組み合わせ. キーワードが無い場合は接尾辞の無い1件です.
+//! @retval true    列挙に成功.
+//! @retval false   キーワードの定義が不正です.
+//-----------------------------------------------------------------------------
+bool EnumerateVariants(const FxParser& parser, const std::string& inputPath, std::vector<KeywordVariant>& result);
+
+} // namespace asura
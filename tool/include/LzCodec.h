@@ -0,0 +1,42 @@
+﻿//-----------------------------------------------------------------------------
+// File : LzCodec.h
+// Desc : LZ Compression Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//! @brief      データを圧縮します.
+//! 
+//! @param[in]      pSrc        圧縮するデータ.
+//! @param[in]      srcSize     圧縮するデータのサイズ.
+//! @param[out]     result      圧縮したデータ.
+//! @note       トークン(上位4bit: リテラル長, 下位4bit: 一致長 - 4), リテラル, 2バイトのオフセットを繰り返す形式です.
+//!             長さが 15 以上の場合は 255 未満のバイトが現れるまで加算します. 最後のシーケンスはリテラルのみです.
+//-----------------------------------------------------------------------------
+void LzCompress(const void* pSrc, size_t srcSize, std::vector<uint8_t>& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      データを展開します.
+//! 
+//! @param[in]      pSrc        圧縮されたデータ.
+//! @param[in]      srcSize     圧縮されたデータのサイズ.
+//! @param[out]     pDst        展開先.
+//! @param[in]      dstSize     展開後のサイズ.
+//! @retval true    展開に成功.
+//! @retval false   データが壊れているか, 展開後のサイズが一致しません.
+//! @note       不正なデータでも pDst の範囲外には書き込みません.
+//-----------------------------------------------------------------------------
+bool LzDecompress(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize);
+
+} // namespace asura
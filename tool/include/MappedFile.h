@@ -0,0 +1,82 @@
+﻿//-----------------------------------------------------------------------------
+// File : MappedFile.h
+// Desc : Memory Mapped File Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string_view>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    MappedFile();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~MappedFile();
+
+    //------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でメモリにマップします.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @retval true    マップに成功.
+    //! @retval false   マップに失敗.
+    //------------------------------------------------------------------------
+    bool Open(const char* path);
+
+    //------------------------------------------------------------------------
+    //! @brief      マップを解除します.
+    //------------------------------------------------------------------------
+    void Close();
+
+    //------------------------------------------------------------------------
+    //! @brief      ファイルの内容を取得します.
+    //! 
+    //! @return     マップしたファイルの内容を返却します. 終端文字は付きません.
+    //------------------------------------------------------------------------
+    std::string_view GetView() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    const char*     m_pData;    //!< マップ先の先頭ポインタ.
+    size_t          m_Size;     //!< ファイルサイズ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    MappedFile              (const MappedFile&) = delete;
+    MappedFile& operator =  (const MappedFile&) = delete;
+};
+
+} // namespace asura
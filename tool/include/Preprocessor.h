@@ -0,0 +1,112 @@
+﻿//-----------------------------------------------------------------------------
+// File : Preprocessor.h
+// Desc : Conditional Compilation Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// Preprocessor class
+///////////////////////////////////////////////////////////////////////////////
+class Preprocessor
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    Preprocessor();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~Preprocessor();
+
+    //------------------------------------------------------------------------
+    //! @brief      条件コンパイルを評価し, 有効な行だけを残したソースコードを生成します.
+    //! 
+    //! @param[in]      code        ソースコード.
+    //! @param[in]      defines     NAME=VALUE 形式のマクロ定義.
+    //! @param[out]     result      生成したソースコード. 無効な行は空行にして行番号を保ちます.
+    //! @retval true    評価に成功.
+    //! @retval false   関数形式マクロや #include など, 評価できない条件がありました.
+    //! @note       条件式以外のマクロの展開は行いません.
+    //------------------------------------------------------------------------
+    bool Evaluate(std::string_view code, const std::vector<std::string>& defines, std::string& result);
+
+    //------------------------------------------------------------------------
+    //! @brief      ソースコードから識別子として参照されているマクロ定義を探します.
+    //! 
+    //! @param[in]      code        ソースコード.
+    //! @param[in]      defines     NAME=VALUE 形式のマクロ定義.
+    //! @param[out]     result      参照されているマクロ定義のインデックス(昇順).
+    //! @note       コメントと文字列の中は参照として扱いません.
+    //------------------------------------------------------------------------
+    static void FindReferences(std::string_view code, const std::vector<std::string>& defines, std::vector<uint32_t>& result);
+
+    //------------------------------------------------------------------------
+    //! @brief      比較用に空白を正規化したソースコードを生成します.
+    //! 
+    //! @param[in]      code        ソースコード.
+    //! @param[out]     result      生成したソースコード.
+    //! @note       空白とコメントの並びを1つの空白にまとめ, 空行を取り除きます. 文字列の中はそのまま残します.
+    //------------------------------------------------------------------------
+    static void Normalize(std::string_view code, std::string& result);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Condition structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Condition
+    {
+        bool    Parent;     //!< 外側のブロックが有効かどうか.
+        bool    Active;     //!< 現在の分岐が有効かどうか.
+        bool    Taken;      //!< いずれかの分岐が有効になったかどうか.
+        bool    Else;       //!< #else を処理済みかどうか.
+    };
+
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::unordered_map<std::string, std::string>        m_Values;       //!< オブジェクト形式マクロの値.
+    std::unordered_set<std::string>                     m_Functions;    //!< 関数形式マクロ名.
+    std::vector<Condition>                              m_Conditions;   //!< 条件コンパイルのネスト.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    bool IsActive   () const;
+    bool Directive  (std::string_view name, std::string_view text, bool& output);
+    bool Test       (std::string_view text, bool& value) const;
+
+    Preprocessor             (const Preprocessor&) = delete;
+    Preprocessor& operator = (const Preprocessor&) = delete;
+};
+
+} // namespace asura
@@ -0,0 +1,204 @@
+﻿//-----------------------------------------------------------------------------
+// File : RenderStateTable.h
+// Desc : Render State Deduplication Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "FxParser.h"
+#include "VariationInfo.h"
+#include "XmlWriter.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// RenderStateCount structure
+///////////////////////////////////////////////////////////////////////////////
+struct RenderStateCount
+{
+    uint32_t    RasterizerStates    = 0;    //!< ラスタライザーステート数.
+    uint32_t    DepthStencilStates  = 0;    //!< 深度ステンシルステート数.
+    uint32_t    BlendStates         = 0;    //!< ブレンドステート数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// RenderStateTable class
+///////////////////////////////////////////////////////////////////////////////
+class RenderStateTable
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    RenderStateTable();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~RenderStateTable();
+
+    //------------------------------------------------------------------------
+    //! @brief      エフェクトで定義されている全てのステートを正規化して登録します.
+    //! 
+    //! @param[in]      parser      解析済みのエフェクト.
+    //! @retval true    登録に成功.
+    //! @retval false   内容の異なるステートが同じ ID になりました.
+    //! @note       複数スレッドから同時に呼び出せます.
+    //------------------------------------------------------------------------
+    bool Add(const FxParser& parser);
+
+    //------------------------------------------------------------------------
+    //! @brief      メタデータに記録されている全てのステートを正規化して登録します.
+    //! 
+    //! @param[in]      reader      読み込み済みのメタデータ.
+    //! @retval true    登録に成功.
+    //! @retval false   内容の異なるステートが同じ ID になりました.
+    //! @note       複数スレッドから同時に呼び出せます.
+    //------------------------------------------------------------------------
+    bool Add(const VariationInfoReader& reader);
+
+    //------------------------------------------------------------------------
+    //! @brief      登録した名前付きステートの数を取得します.
+    //------------------------------------------------------------------------
+    RenderStateCount GetNamedCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      重複を除いたステートの数を取得します.
+    //------------------------------------------------------------------------
+    RenderStateCount GetUniqueCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ID 順に並んだ正規化済みのラスタライザーステートを取得します.
+    //! 
+    //! @note       登録が終わってから呼び出してください.
+    //------------------------------------------------------------------------
+    const std::map<uint64_t, RasterizerState>& GetRasterizerStates() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ID 順に並んだ正規化済みの深度ステンシルステートを取得します.
+    //! 
+    //! @note       登録が終わってから呼び出してください.
+    //------------------------------------------------------------------------
+    const std::map<uint64_t, DepthStencilState>& GetDepthStencilStates() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ID 順に並んだ正規化済みのブレンドステートを取得します.
+    //! 
+    //! @note       登録が終わってから呼び出してください.
+    //------------------------------------------------------------------------
+    const std::map<uint64_t, BlendState>& GetBlendStates() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    mutable std::mutex                              m_Mutex;                //!< ミューテックス.
+    RenderStateCount                                m_Named;                //!< 登録した名前付きステートの数.
+    std::map<uint64_t, RasterizerState>             m_RasterizerStates;     //!< ID をキーとした正規化済みのラスタライザーステート.
+    std::map<uint64_t, DepthStencilState>           m_DepthStencilStates;   //!< ID をキーとした正規化済みの深度ステンシルステート.
+    std::map<uint64_t, BlendState>                  m_BlendStates;          //!< ID をキーとした正規化済みのブレンドステート.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    RenderStateTable             (const RenderStateTable&) = delete;
+    RenderStateTable& operator = (const RenderStateTable&) = delete;
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      効果の無いフィールドを既定値に揃えたラスタライザーステートを求めます.
+//! 
+//! @note       深度バイアスが掛からない場合はクランプ値を 0 にします.
+//-----------------------------------------------------------------------------
+RasterizerState Canonicalize(const RasterizerState& state);
+
+//-----------------------------------------------------------------------------
+//! @brief      効果の無いフィールドを既定値に揃えた深度ステンシルステートを求めます.
+//! 
+//! @note       深度テストやステンシルテストが無効な場合は, それぞれの設定を既定値にします.
+//-----------------------------------------------------------------------------
+DepthStencilState Canonicalize(const DepthStencilState& state);
+
+//-----------------------------------------------------------------------------
+//! @brief      効果の無いフィールドを既定値に揃えたブレンドステートを求めます.
+//! 
+//! @note       ブレンドが無効な場合はブレンド係数と演算を, MIN/MAX 演算の場合はブレンド係数を既定値にします.
+//-----------------------------------------------------------------------------
+BlendState Canonicalize(const BlendState& state);
+
+//-----------------------------------------------------------------------------
+//! @brief      正規化した内容からステート ID を求めます.
+//! 
+//! @return     内容が同じステートはエフェクトをまたいでも同じ ID を返却します.
+//-----------------------------------------------------------------------------
+uint64_t GetStateId(const RasterizerState&   state);
+uint64_t GetStateId(const DepthStencilState& state);
+uint64_t GetStateId(const BlendState&        state);
+
+//-----------------------------------------------------------------------------
+//! @brief      ステートを XML 要素として書き込みます.
+//! 
+//! @param[in]      writer      書き込み先.
+//! @param[in]      name        ステート名. 空の場合は name 属性を省略します.
+//! @param[in]      id          ステート ID.
+//! @param[in]      state       ステート.
+//-----------------------------------------------------------------------------
+void FormatRasterizerState  (XmlWriter& writer, const std::string& name, uint64_t id, const RasterizerState&   state);
+void FormatDepthStencilState(XmlWriter& writer, const std::string& name, uint64_t id, const DepthStencilState& state);
+void FormatBlendState       (XmlWriter& writer, const std::string& name, uint64_t id, const BlendState&        state);
+
+//-----------------------------------------------------------------------------
+//! @brief      エフェクトのステートだけをバイナリ形式で出力します.
+//! 
+//! @param[in]      parser      解析済みのエフェクト.
+//! @param[in]      path        出力ファイルパス.
+//! @retval true    出力に成功.
+//! @retval false   出力に失敗.
+//! @note       出力済みのエフェクトを RenderStateTable::Add() で登録し直すために使います.
+//-----------------------------------------------------------------------------
+bool WriteEffectRenderStates(const FxParser& parser, const std::string& path);
+
+//-----------------------------------------------------------------------------
+//! @brief      全エフェクト共通のステートテーブルを出力し, 重複を除いた数を表示します.
+//! 
+//! @param[in]      table       登録が終わったステートテーブル.
+//! @param[in]      xmlPath     XML 形式の出力ファイルパス.
+//! @param[in]      binPath     バイナリ形式の出力ファイルパス.
+//! @param[in]      xml         XML 形式で出力する場合は true.
+//! @param[in]      binary      バイナリ形式で出力する場合は true.
+//! @param[in]      verify      両方出力した場合に, バイナリを読み直して XML と比較する場合は true.
+//! @retval true    出力に成功.
+//! @retval false   出力か検証に失敗.
+//-----------------------------------------------------------------------------
+bool WriteRenderStateTable
+(
+    const RenderStateTable&     table,
+    const std::string&          xmlPath,
+    const std::string&          binPath,
+    bool                        xml,
+    bool                        binary,
+    bool                        verify
+);
+
+} // namespace asura
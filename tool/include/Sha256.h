@@ -0,0 +1,90 @@
+﻿//-----------------------------------------------------------------------------
+// File : Sha256.h
+// Desc : SHA-256 Hash Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// Sha256 class
+///////////////////////////////////////////////////////////////////////////////
+class Sha256
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    Sha256();
+
+    //------------------------------------------------------------------------
+    //! @brief      データを追加します.
+    //! 
+    //! @param[in]      pData       データ.
+    //! @param[in]      size        データサイズ.
+    //------------------------------------------------------------------------
+    void Update(const void* pData, size_t size);
+
+    //------------------------------------------------------------------------
+    //! @brief      文字列を終端文字を含めて追加します.
+    //! 
+    //! @param[in]      value       文字列.
+    //! @note       区切りを含めることで "ab"+"c" と "a"+"bc" を区別します.
+    //------------------------------------------------------------------------
+    void Update(const std::string& value);
+
+    //------------------------------------------------------------------------
+    //! @brief      ハッシュ値を16進文字列で取得します.
+    //! 
+    //! @return     64文字のハッシュ値を返却します.
+    //! @note       呼び出し後は Update() できません.
+    //------------------------------------------------------------------------
+    std::string Finish();
+
+    //------------------------------------------------------------------------
+    //! @brief      データのハッシュ値を16進文字列で取得します.
+    //! 
+    //! @param[in]      pData       データ.
+    //! @param[in]      size        データサイズ.
+    //! @return     64文字のハッシュ値を返却します.
+    //------------------------------------------------------------------------
+    static std::string Compute(const void* pData, size_t size);
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    uint32_t    m_State[8];     //!< ハッシュ状態.
+    uint8_t     m_Block[64];    //!< 未処理のブロック.
+    size_t      m_BlockSize;    //!< 未処理のバイト数.
+    uint64_t    m_TotalSize;    //!< 追加した総バイト数.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    void Transform(const uint8_t* pBlock);
+};
+
+} // namespace asura
@@ -0,0 +1,181 @@
+﻿//-----------------------------------------------------------------------------
+// File : ShaderCompiler.h
+// Desc : Shader Compiler Backend Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileJob structure
+///////////////////////////////////////////////////////////////////////////////
+struct CompileJob
+{
+    const char*     pSource;        //!< ソースコード.
+    size_t          SourceSize;     //!< ソースコードのサイズ.
+    std::string     SourcePath;     //!< ソースコードを書き出したファイルパス(空の場合は未出力).
+    std::string     EntryPoint;     //!< エントリーポイント名.
+    std::string     Profile;        //!< シェーダプロファイル.
+    std::string     OutputPath;     //!< 出力ファイルパス.
+    uint32_t        Flags;          //!< コンパイルフラグ.
+    std::string     SourceHash;     //!< ソースコードのハッシュ値.
+    std::vector<std::string> Defines;   //!< NAME=VALUE 形式のマクロ定義.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileResult structure
+///////////////////////////////////////////////////////////////////////////////
+struct CompileResult
+{
+    bool                    Success = false;    //!< 成功したかどうか.
+    std::vector<uint8_t>    Binary;             //!< シェーダバイナリ.
+    std::string             Message;            //!< エラーメッセージ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+class ShaderCompilerBackend
+{
+public:
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    virtual ~ShaderCompilerBackend()
+    { /* DO_NOTHING */ }
+
+    //------------------------------------------------------------------------
+    //! @brief      シェーダをコンパイルします.
+    //! 
+    //! @param[in]      job         コンパイルジョブ.
+    //! @param[out]     result      コンパイル結果.
+    //! @retval true    コンパイルに成功.
+    //! @retval false   コンパイルに失敗.
+    //! @note       複数スレッドから同時に呼び出されます.
+    //------------------------------------------------------------------------
+    virtual bool Compile(const CompileJob& job, CompileResult& result) = 0;
+
+    //------------------------------------------------------------------------
+    //! @brief      バックエンド名を取得します.
+    //! 
+    //! @return     バックエンド名を返却します.
+    //------------------------------------------------------------------------
+    virtual const char* GetName() const = 0;
+
+    //------------------------------------------------------------------------
+    //! @brief      バックエンドのバージョンを取得します.
+    //! 
+    //! @return     コンパイル結果が変わり得る場合に異なる文字列を返却します.
+    //------------------------------------------------------------------------
+    virtual std::string GetVersion() const = 0;
+};
+
+#if defined(_WIN32)
+///////////////////////////////////////////////////////////////////////////////
+// D3DCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+class D3DCompilerBackend : public ShaderCompilerBackend
+{
+public:
+    bool        Compile     (const CompileJob& job, CompileResult& result) override;
+    const char* GetName     () const override;
+    std::string GetVersion  () const override;
+};
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// ProcessCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+class ProcessCompilerBackend : public ShaderCompilerBackend
+{
+public:
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      command     コンパイラの実行ファイルパス.
+    //! @note       コンパイラは "command source_path entry_point profile output_path [NAME=VALUE ...]" の形式で起動し,
+    //!             終了コード 0 を成功とみなします. 標準エラー出力はエラーメッセージとして扱います.
+    //------------------------------------------------------------------------
+    explicit ProcessCompilerBackend(const std::string& command);
+
+    bool        Compile     (const CompileJob& job, CompileResult& result) override;
+    const char* GetName     () const override;
+    std::string GetVersion  () const override;
+
+private:
+    std::string     m_Command;      //!< コンパイラの実行ファイルパス.
+    std::string     m_Version;      //!< バージョン文字列.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// FakeCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+class FakeCompilerBackend : public ShaderCompilerBackend
+{
+public:
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      delay       1回のコンパイルにかける時間(ミリ秒).
+    //! @param[in]      failEntry   失敗させるエントリーポイント名.
+    //! @param[in]      crashCount  指定回数目のコンパイルでプロセスを異常終了させます. 0の場合は終了しません.
+    //! @note       DirectX の無い環境でコンパイル経路を検証するためのものです.
+    //!             入力のハッシュ値を含むテキストをバイナリとして返却します.
+    //------------------------------------------------------------------------
+    FakeCompilerBackend(uint32_t delay, const std::string& failEntry, uint32_t crashCount);
+
+    bool        Compile     (const CompileJob& job, CompileResult& result) override;
+    const char* GetName     () const override;
+    std::string GetVersion  () const override;
+
+private:
+    uint32_t                m_Delay;        //!< コンパイル時間(ミリ秒).
+    std::string             m_FailEntry;    //!< 失敗させるエントリーポイント名.
+    uint32_t                m_CrashCount;   //!< 異常終了させる回数.
+    std::atomic<uint32_t>   m_Count;        //!< コンパイル回数.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      一時ファイルを経由してファイルを書き出します.
+//! 
+//! @param[in]      path        出力ファイルパス.
+//! @param[in]      pData       書き出すデータ.
+//! @param[in]      size        書き出すデータサイズ.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//! @note       書き込み途中のファイルが path に現れることはありません.
+//-----------------------------------------------------------------------------
+bool WriteFileAtomic(const std::string& path, const void* pData, size_t size);
+
+//-----------------------------------------------------------------------------
+//! @brief      一時ファイルを経由してハードリンクを作成します.
+//! 
+//! @param[in]      target      リンク先のファイルパス.
+//! @param[in]      path        作成するファイルパス.
+//! @retval true    作成に成功.
+//! @retval false   作成に失敗.
+//! @note       path に既にファイルがある場合は置き換えます.
+//-----------------------------------------------------------------------------
+bool LinkFileAtomic(const std::string& target, const std::string& path);
+
+//-----------------------------------------------------------------------------
+//! @brief      ファイルを読み込みます.
+//! 
+//! @param[in]      path        ファイルパス.
+//! @param[out]     result      読み込んだデータ.
+//! @retval true    読み込みに成功.
+//! @retval false   読み込みに失敗.
+//-----------------------------------------------------------------------------
+bool LoadBinary(const std::string& path, std::vector<uint8_t>& result);
+
+} // namespace asura
@@ -0,0 +1,228 @@
+﻿//-----------------------------------------------------------------------------
+// File : ShaderPack.h
+// Desc : Shader Pack Format Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kShaderPackMagic     = 0x4B505341;   // 'ASPK'
+static const uint32_t kShaderPackVersion   = 2;            // フォーマットのバージョン.
+static const uint32_t kShaderPackAlignment = 16;           // バイナリの配置境界.
+static const uint32_t kShaderPackEmptySlot = 0xFFFFFFFF;   // 空きスロット.
+
+///////////////////////////////////////////////////////////////////////////////
+// SHADER_PACK_CODEC enum
+///////////////////////////////////////////////////////////////////////////////
+enum SHADER_PACK_CODEC
+{
+    SHADER_PACK_CODEC_NONE = 0,     //!< 無圧縮.
+    SHADER_PACK_CODEC_LZ   = 1,     //!< LzCompress() で圧縮.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct ShaderPackHeader
+{
+    uint32_t    Magic;          //!< kShaderPackMagic.
+    uint32_t    Version;        //!< kShaderPackVersion.
+    uint32_t    EntryCount;     //!< エントリー数.
+    uint32_t    SlotCount;      //!< ハッシュテーブルのスロット数(2のべき乗).
+    uint64_t    SlotOffset;     //!< スロット配列の位置.
+    uint64_t    EntryOffset;    //!< エントリー配列の位置.
+    uint64_t    NameOffset;     //!< 名前テーブルの位置.
+    uint64_t    NameSize;       //!< 名前テーブルのサイズ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackSlot structure
+///////////////////////////////////////////////////////////////////////////////
+struct ShaderPackSlot
+{
+    uint64_t    Hash;           //!< 名前のハッシュ値.
+    uint32_t    Entry;          //!< エントリー番号. 空きスロットは kShaderPackEmptySlot.
+    uint32_t    Reserved;       //!< 予約領域.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct ShaderPackEntry
+{
+    uint64_t    DataOffset;     //!< バイナリの位置.
+    uint64_t    DataSize;       //!< 格納しているバイナリのサイズ.
+    uint64_t    RawSize;        //!< 展開後のサイズ.
+    uint32_t    NameOffset;     //!< 名前テーブル内の名前の位置.
+    uint32_t    NameSize;       //!< 名前のサイズ.
+    uint32_t    Codec;          //!< 圧縮形式 (SHADER_PACK_CODEC).
+    uint32_t    Reserved;       //!< 予約領域.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackBlob structure
+///////////////////////////////////////////////////////////////////////////////
+struct ShaderPackBlob
+{
+    const void*     pData;      //!< 格納しているバイナリの先頭ポインタ.
+    size_t          Size;       //!< 格納しているバイナリのサイズ.
+    size_t          RawSize;    //!< 展開後のサイズ.
+    uint32_t        Codec;      //!< 圧縮形式 (SHADER_PACK_CODEC).
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      エントリー名のハッシュ値を求めます.
+//! 
+//! @param[in]      technique   テクニック名.
+//! @param[in]      pass        パス名.
+//! @param[in]      stage       シェーダステージ名 (vs, ps など).
+//! @param[in]      key         キーワードの組み合わせを表すキー. キーワードが無い場合は空文字.
+//! @return     各文字列を '\0' で区切って連結した名前の FNV-1a ハッシュ値を返却します.
+//-----------------------------------------------------------------------------
+inline uint64_t ComputeShaderPackHash
+(
+    std::string_view technique,
+    std::string_view pass,
+    std::string_view stage,
+    std::string_view key
+)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(auto part : { technique, pass, stage, key })
+    {
+        for(auto c : part)
+        {
+            hash ^= uint8_t(c);
+            hash *= 0x100000001b3ull;
+        }
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackReader class
+///////////////////////////////////////////////////////////////////////////////
+class ShaderPackReader
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    ShaderPackReader();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~ShaderPackReader();
+
+    //------------------------------------------------------------------------
+    //! @brief      メモリ上のパックファイルを読み込みます.
+    //! 
+    //! @param[in]      pData       パックファイルの内容. 8バイト境界に配置されている必要があります.
+    //! @param[in]      size        パックファイルのサイズ.
+    //! @retval true    読み込みに成功.
+    //! @retval false   ヘッダーまたはテーブルの範囲が不正.
+    //! @note       データはコピーしません. pData は本オブジェクトより長く生存している必要があります.
+    //------------------------------------------------------------------------
+    bool Init(const void* pData, size_t size);
+
+    //------------------------------------------------------------------------
+    //! @brief      読み込んだ内容を破棄します.
+    //------------------------------------------------------------------------
+    void Term();
+
+    //------------------------------------------------------------------------
+    //! @brief      シェーダバイナリを検索します.
+    //! 
+    //! @param[in]      technique   テクニック名.
+    //! @param[in]      pass        パス名.
+    //! @param[in]      stage       シェーダステージ名 (vs, ps など).
+    //! @param[in]      key         キーワードの組み合わせを表すキー. キーワードが無い場合は空文字.
+    //! @param[out]     result      格納しているバイナリ.
+    //! @retval true    見つかった.
+    //! @retval false   見つからなかった, またはエントリーの範囲が不正.
+    //! @note       無圧縮の場合は result.pData をそのまま使えます.
+    //!             圧縮されている場合は Decode() で展開します. 他のエントリーには触れません.
+    //------------------------------------------------------------------------
+    bool Find
+    (
+        std::string_view    technique,
+        std::string_view    pass,
+        std::string_view    stage,
+        std::string_view    key,
+        ShaderPackBlob&     result
+    ) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      エントリー番号を指定してシェーダバイナリを取得します.
+    //! 
+    //! @param[in]      index       エントリー番号. GetCount() 未満の値を指定します.
+    //! @param[out]     result      格納しているバイナリ.
+    //! @retval true    取得に成功.
+    //! @retval false   番号またはエントリーの範囲が不正.
+    //! @note       同じバイナリを共有するエントリーは同じ pData を返却します.
+    //------------------------------------------------------------------------
+    bool GetBlob(uint32_t index, ShaderPackBlob& result) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      バイナリを展開します.
+    //! 
+    //! @param[in]      blob        Find() で取得したバイナリ.
+    //! @param[out]     pBuffer     展開先.
+    //! @param[in]      bufferSize  展開先のサイズ. blob.RawSize 以上である必要があります.
+    //! @retval true    展開に成功.
+    //! @retval false   未対応の圧縮形式か, データが壊れています.
+    //------------------------------------------------------------------------
+    static bool Decode(const ShaderPackBlob& blob, void* pBuffer, size_t bufferSize);
+
+    //------------------------------------------------------------------------
+    //! @brief      エントリー数を取得します.
+    //------------------------------------------------------------------------
+    uint32_t GetCount() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    const uint8_t*          m_pData;        //!< パックファイルの内容.
+    size_t                  m_Size;         //!< パックファイルのサイズ.
+    const ShaderPackHeader* m_pHeader;      //!< ヘッダー.
+    const ShaderPackSlot*   m_pSlots;       //!< スロット配列.
+    const ShaderPackEntry*  m_pEntries;     //!< エントリー配列.
+    const char*             m_pNames;       //!< 名前テーブル.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    ShaderPackReader             (const ShaderPackReader&) = delete;
+    ShaderPackReader& operator = (const ShaderPackReader&) = delete;
+};
+
+} // namespace asura
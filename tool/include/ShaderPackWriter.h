@@ -0,0 +1,147 @@
+﻿//-----------------------------------------------------------------------------
+// File : ShaderPackWriter.h
+// Desc : Shader Pack Writer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderPack.h"
+#include <string>
+#include <vector>
+#include <map>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackWriter class
+///////////////////////////////////////////////////////////////////////////////
+class ShaderPackWriter
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      compress    バイナリごとに圧縮するかどうか. 小さくならないバイナリは無圧縮で格納します.
+    //------------------------------------------------------------------------
+    explicit ShaderPackWriter(bool compress);
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~ShaderPackWriter();
+
+    //------------------------------------------------------------------------
+    //! @brief      シェーダバイナリを追加します.
+    //! 
+    //! @param[in]      technique   テクニック名.
+    //! @param[in]      pass        パス名.
+    //! @param[in]      stage       シェーダステージ名 (vs, ps など).
+    //! @param[in]      key         キーワードの組み合わせを表すキー. キーワードが無い場合は空文字.
+    //! @param[in]      data        シェーダバイナリ.
+    //! @note       同じ内容のバイナリは1つだけ格納します.
+    //!             同じ名前で追加した場合は後から追加したものに置き換えます.
+    //------------------------------------------------------------------------
+    void Add
+    (
+        const std::string&          technique,
+        const std::string&          pass,
+        const std::string&          stage,
+        const std::string&          key,
+        const std::vector<uint8_t>& data
+    );
+
+    //------------------------------------------------------------------------
+    //! @brief      パックファイルを書き出します.
+    //! 
+    //! @param[in]      path        出力ファイルパス.
+    //! @retval true    書き出しに成功.
+    //! @retval false   書き出しに失敗.
+    //------------------------------------------------------------------------
+    bool Write(const std::string& path);
+
+    //------------------------------------------------------------------------
+    //! @brief      書き出したパックファイルを読み直し, 追加した内容と一致するか検証します.
+    //! 
+    //! @param[in]      path        パックファイルパス.
+    //! @retval true    全てのエントリーが一致.
+    //! @retval false   読み込みに失敗したか, 一致しないエントリーがありました.
+    //------------------------------------------------------------------------
+    bool Verify(const std::string& path) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      エントリー数を取得します.
+    //------------------------------------------------------------------------
+    size_t GetEntryCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      重複を除いたバイナリ数を取得します.
+    //------------------------------------------------------------------------
+    size_t GetBlobCount() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に書き出したパックファイルのサイズを取得します.
+    //------------------------------------------------------------------------
+    uint64_t GetFileSize() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に書き出したバイナリの展開後の合計サイズを取得します.
+    //------------------------------------------------------------------------
+    uint64_t GetRawSize() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に書き出したバイナリの格納時の合計サイズを取得します.
+    //------------------------------------------------------------------------
+    uint64_t GetStoredSize() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Item structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Item
+    {
+        std::string     Technique;  //!< テクニック名.
+        std::string     Pass;       //!< パス名.
+        std::string     Stage;      //!< シェーダステージ名.
+        std::string     Key;        //!< キーワードの組み合わせを表すキー.
+        std::string     Name;       //!< '\0' で区切って連結した名前.
+        uint32_t        Blob;       //!< バイナリ番号.
+    };
+
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::vector<Item>                   m_Items;        //!< エントリー.
+    std::map<std::string, size_t>       m_Names;        //!< 名前からエントリー番号を引く表.
+    std::vector<std::vector<uint8_t>>   m_Blobs;        //!< バイナリ.
+    std::map<std::string, uint32_t>     m_BlobIndex;    //!< バイナリのハッシュ値からバイナリ番号を引く表.
+    bool                                m_Compress;     //!< 圧縮するかどうか.
+    uint64_t                            m_FileSize;     //!< ファイルサイズ.
+    uint64_t                            m_RawSize;      //!< 展開後の合計サイズ.
+    uint64_t                            m_StoredSize;   //!< 格納時の合計サイズ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    ShaderPackWriter             (const ShaderPackWriter&) = delete;
+    ShaderPackWriter& operator = (const ShaderPackWriter&) = delete;
+};
+
+} // namespace asura
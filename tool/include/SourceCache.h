@@ -0,0 +1,131 @@
+﻿//-----------------------------------------------------------------------------
+// File : SourceCache.h
+// Desc : Source File Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "MappedFile.h"
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// SourceFile structure
+///////////////////////////////////////////////////////////////////////////////
+struct SourceFile
+{
+    std::string         Path;           //!< 読み込んだファイルパス.
+    std::string         Key;            //!< 正規化済みパス.
+    std::string         FullPath;       //!< 絶対パス.
+    MappedFile          File;           //!< マップしたファイル.
+    std::string         Buffer;         //!< コピーしたファイルの内容.
+    std::string_view    Code;           //!< ファイルの内容(File または Buffer を参照).
+    bool                PragmaOnce;     //!< #pragma once 指定があるかどうか.
+    bool                IncludeGuard;   //!< ファイル全体がインクルードガードで囲まれているかどうか.
+    uint64_t            Size;           //!< 読み込んだ時点のファイルサイズ.
+    int64_t             Time;           //!< 読み込んだ時点の更新日時.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SourceCache class
+///////////////////////////////////////////////////////////////////////////////
+class SourceCache
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      copy        true の場合はマップしたままにせず内容をコピーします.
+    //! @note       長時間保持する場合はファイルの書き換えを妨げないように copy を指定してください.
+    //------------------------------------------------------------------------
+    SourceCache(bool copy = false);
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~SourceCache();
+
+    //------------------------------------------------------------------------
+    //! @brief      ファイルを取得します. 未読み込みの場合はマップして登録します.
+    //! 
+    //! @param[in]      path        ファイルパス.
+    //! @param[out]     pOpened     ファイルを開こうとした場合に true が設定されます.
+    //! @return     ファイルを返却します. 開けなかった場合は nullptr を返却します.
+    //! @note       複数スレッドから同時に呼び出せます.
+    //------------------------------------------------------------------------
+    std::shared_ptr<const SourceFile> Load(const std::string& path, bool* pOpened = nullptr);
+
+    //------------------------------------------------------------------------
+    //! @brief      キャッシュを破棄します.
+    //------------------------------------------------------------------------
+    void Clear();
+
+    //------------------------------------------------------------------------
+    //! @brief      読み込み後に変更されたファイルをキャッシュから取り除きます.
+    //! 
+    //! @return     取り除いたファイル数を返却します.
+    //! @note       開けなかったファイルが作成された場合も取り除きます.
+    //------------------------------------------------------------------------
+    size_t Refresh();
+
+    //------------------------------------------------------------------------
+    //! @brief      登録されているファイル数を取得します.
+    //! 
+    //! @return     開けなかったファイルを含む登録数を返却します.
+    //------------------------------------------------------------------------
+    size_t GetCount() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    mutable std::mutex                                          m_Mutex;    //!< ミューテックス.
+    bool                                                        m_Copy;     //!< 内容をコピーするかどうか.
+    std::map<std::string, std::shared_ptr<const SourceFile>>    m_Files;    //!< 正規化済みパスをキーとしたファイル.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    SourceCache             (const SourceCache&) = delete;
+    SourceCache& operator = (const SourceCache&) = delete;
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      絶対パスを取得します.
+//! 
+//! @param[in]      path        ファイルパス.
+//! @return     絶対パスを返却します. 取得できない場合は path をそのまま返却します.
+//-----------------------------------------------------------------------------
+std::string GetFullPath(const std::string& path);
+
+//-----------------------------------------------------------------------------
+//! @brief      キャッシュのキーとして使う正規化済みパスを取得します.
+//! 
+//! @param[in]      fullPath    絶対パス.
+//! @return     区切り文字を \ に, 英字を小文字に揃えたパスを返却します.
+//-----------------------------------------------------------------------------
+std::string GetCanonicalPath(const std::string& fullPath);
+
+} // namespace asura
@@ -0,0 +1,108 @@
+﻿//-----------------------------------------------------------------------------
+// File : SourceGraph.h
+// Desc : Source Declaration Graph Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// SourceGraph class
+///////////////////////////////////////////////////////////////////////////////
+class SourceGraph
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    SourceGraph();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~SourceGraph();
+
+    //------------------------------------------------------------------------
+    //! @brief      ソースコードをトップレベルの宣言に分割し, 参照関係を構築します.
+    //! 
+    //! @param[in]      code        前処理済みのソースコード.
+    //! @note       code は本オブジェクトより長く生存している必要があります.
+    //------------------------------------------------------------------------
+    void Build(std::string_view code);
+
+    //------------------------------------------------------------------------
+    //! @brief      エントリーポイントから到達可能な宣言のみを含むソースコードを生成します.
+    //! 
+    //! @param[in]      entryPoint  エントリーポイント名.
+    //! @param[out]     result      生成したソースコード.
+    //! @retval true    生成に成功.
+    //! @retval false   エントリーポイントが見つかりませんでした.
+    //! @note       プリプロセッサ行と解析できなかった宣言は常に残します.
+    //------------------------------------------------------------------------
+    bool Strip(const std::string& entryPoint, std::string& result) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      宣言数を取得します.
+    //------------------------------------------------------------------------
+    size_t GetDeclarationCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Declaration structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Declaration
+    {
+        size_t                  Offset;         //!< 開始位置.
+        size_t                  Size;           //!< サイズ.
+        bool                    Always;         //!< 常に出力するかどうか.
+        std::vector<uint32_t>   References;     //!< 参照している識別子番号.
+    };
+
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::string_view                                m_Code;             //!< ソースコード.
+    std::vector<Declaration>                        m_Declarations;     //!< 宣言.
+    std::unordered_map<std::string_view, uint32_t>  m_Names;            //!< 識別子番号.
+    std::vector<std::vector<uint32_t>>              m_Definitions;      //!< 識別子番号ごとの定義している宣言.
+    std::vector<uint32_t>                           m_Roots;            //!< 常に出力する宣言から参照される識別子番号.
+    std::unordered_set<std::string_view>            m_Macros;           //!< #define で定義されたマクロ名.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    uint32_t Intern     (std::string_view name);
+    size_t   ParseLine  (size_t pos, Declaration& decl);
+    size_t   ParseDecl  (size_t pos, Declaration& decl, std::vector<uint32_t>& defines);
+
+    SourceGraph             (const SourceGraph&) = delete;
+    SourceGraph& operator = (const SourceGraph&) = delete;
+};
+
+} // namespace asura
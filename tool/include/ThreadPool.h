@@ -0,0 +1,109 @@
+﻿//-----------------------------------------------------------------------------
+// File : ThreadPool.h
+// Desc : Work Stealing Thread Pool Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+///////////////////////////////////////////////////////////////////////////////
+class ThreadPool
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //! 
+    //! @param[in]      threadCount     ワーカースレッド数. 0の場合は論理コア数になります.
+    //------------------------------------------------------------------------
+    explicit ThreadPool(uint32_t threadCount = 0);
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~ThreadPool();
+
+    //------------------------------------------------------------------------
+    //! @brief      タスクを追加します.
+    //! 
+    //! @param[in]      task        実行するタスク.
+    //! @note       ワーカースレッドから呼び出した場合は, そのスレッドのキューに積みます.
+    //------------------------------------------------------------------------
+    void Push(std::function<void()>&& task);
+
+    //------------------------------------------------------------------------
+    //! @brief      追加したタスクが全て完了するまで待機します.
+    //------------------------------------------------------------------------
+    void Wait();
+
+    //------------------------------------------------------------------------
+    //! @brief      ワーカースレッド数を取得します.
+    //! 
+    //! @return     ワーカースレッド数を返却します.
+    //------------------------------------------------------------------------
+    uint32_t GetThreadCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Queue structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Queue
+    {
+        std::mutex                          Mutex;  //!< ミューテックス.
+        std::deque<std::function<void()>>   Tasks;  //!< タスク.
+    };
+
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::vector<std::thread>                m_Threads;      //!< ワーカースレッド.
+    std::vector<std::unique_ptr<Queue>>     m_Queues;       //!< スレッド毎のタスクキュー.
+    std::mutex                              m_Mutex;        //!< 待機用ミューテックス.
+    std::condition_variable                 m_WakeUp;       //!< タスク追加の通知.
+    std::condition_variable                 m_Done;         //!< 全タスク完了の通知.
+    std::atomic<uint32_t>                   m_Queued;       //!< キューに積まれているタスク数.
+    std::atomic<uint32_t>                   m_Pending;      //!< 未完了のタスク数.
+    uint32_t                                m_NextQueue;    //!< 次に積むキュー番号.
+    bool                                    m_Exit;         //!< 終了フラグ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    bool Pop (uint32_t index, std::function<void()>& task);
+    void Run (uint32_t index);
+
+    ThreadPool              (const ThreadPool&) = delete;
+    ThreadPool& operator =  (const ThreadPool&) = delete;
+};
+
+} // namespace asura
@@ -10,6 +10,30 @@
 //-----------------------------------------------------------------------------
 #include <cstdint>
 #include <string>
+#include <string_view>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CHAR_TYPE enum
+///////////////////////////////////////////////////////////////////////////////
+enum CHAR_TYPE : uint8_t
+{
+    CHAR_TYPE_NONE          = 0,            //!< 通常文字.
+    CHAR_TYPE_SEPARATOR     = 0x1 << 0,     //!< 区切り文字.
+    CHAR_TYPE_CUTOFF        = 0x1 << 1,     //!< 切り出し文字.
+    CHAR_TYPE_TERMINATOR    = 0x1 << 2,     //!< 終端文字.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SCAN_MODE enum
+///////////////////////////////////////////////////////////////////////////////
+enum SCAN_MODE
+{
+    SCAN_MODE_AUTO = 0,     //!< CPUに応じて自動選択.
+    SCAN_MODE_SCALAR,       //!< 1バイトずつ走査.
+    SCAN_MODE_SSE,          //!< 16バイト単位で走査(SSSE3).
+    SCAN_MODE_AVX2,         //!< 32バイト単位で走査(AVX2).
+};
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,49 +58,69 @@ public:
     Tokenizer();
     virtual ~Tokenizer();
 
-    bool        Init            ( uint32_t size );
-    void        Term            ();
-    void        SetSeparator    ( const char* separator );
-    void        SetCutOff       ( const char* cutoff );
-    void        SetBuffer       ( char *buffer, size_t bufferSize);
-    bool        Compare         ( const char *token ) const;
-    bool        CompareAsLower  ( const char *token ) const;
-    char*       Contain         ( const char *token ) const;
-    bool        IsEnd           () const;
-    bool        IsValidToken    () const;
-    char*       GetAsChar       () const;
-    double      GetAsDouble     () const;
-    float       GetAsFloat      () const;
-    int         GetAsInt        () const;
-    bool        GetAsBool       () const;
-    uint32_t    GetAsUint       () const;
-    void        Next            ();
-    char*       NextAsChar      ();
-    double      NextAsDouble    ();
-    float       NextAsFloat     ();
-    int         NextAsInt       ();
-    bool        NextAsBool      ();
-    uint32_t    NextAsUint      ();
-    char*       GetPtr          () const;
-    char*       GetBuffer       () const;
-    void        SkipTo          ( const char* text );
-    void        SkipLine        ();
+    void             Term            ();
+    void             SetSeparator    ( const char* separator );
+    void             SetCutOff       ( const char* cutoff );
+    void             SetScanMode     ( SCAN_MODE mode );
+    SCAN_MODE        GetScanMode     () const;
+    void             SetBuffer       ( char *buffer, size_t bufferSize);
+    bool             Compare         ( const char *token ) const;
+    bool             CompareAsLower  ( const char *token ) const;
+    bool             Contain         ( const char *token ) const;
+    bool             IsEnd           () const;
+    bool             IsValidToken    () const;
+    std::string_view GetAsView       () const;
+    double           GetAsDouble     () const;
+    float            GetAsFloat      () const;
+    int              GetAsInt        () const;
+    bool             GetAsBool       () const;
+    uint32_t         GetAsUint       () const;
+    void             Next            ();
+    std::string_view NextAsView      ();
+    double           NextAsDouble    ();
+    float            NextAsFloat     ();
+    int              NextAsInt       ();
+    bool             NextAsBool      ();
+    uint32_t         NextAsUint      ();
+    char*            GetPtr          () const;
+    char*            GetBuffer       () const;
+    void             SkipTo          ( const char* text );
+    void             SkipLine        ();
 
 private:
+    ///////////////////////////////////////////////////////////////////////////
+    // CharClass structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct CharClass
+    {
+        uint8_t     Lo[16];     //!< 下位4bitに対応するビットマスク.
+        uint8_t     Hi[16];     //!< 上位4bitに対応するビットマスク.
+        bool        Valid;      //!< SIMD走査が可能かどうか.
+    };
+
     //=========================================================================
     // private variables
     //=========================================================================
-    char*           m_pBuffer;      //!< 先頭ポインタ.
-    char*           m_pPtr;         //!< バッファ位置です.
-    char*           m_pToken;       //!< トークン.
-    std::string     m_Separator;    //!< 区切り文字.
-    std::string     m_CutOff;       //!< 切り出し文字.
-    size_t          m_BufferSize;   //!< バッファサイズ.
+    char*               m_pBuffer;          //!< 先頭ポインタ.
+    char*               m_pPtr;             //!< バッファ位置です.
+    std::string_view    m_Token;            //!< トークン(バッファ上の範囲).
+    size_t              m_BufferSize;       //!< バッファサイズ.
+    uint8_t             m_CharType[256];    //!< 文字種別テーブル.
+    CharClass           m_SkipClass;        //!< 読み飛ばし用の文字クラス(区切り文字).
+    CharClass           m_SplitClass;       //!< 切り出し用の文字クラス(区切り文字+切り出し文字+終端文字).
+    SCAN_MODE           m_ScanMode;         //!< 走査モード.
 
     //=========================================================================
     // private methods
     //=========================================================================
     Tokenizer       (const Tokenizer&) = delete;
     void operator = (const Tokenizer&) = delete;
+
+    void        ResetCharType   ();
+    void        SetCharType     ( const char* chars, uint8_t type );
+    void        BuildCharClass  ( uint8_t mask, CharClass& result ) const;
+    uint8_t*    SkipSeparator   ( uint8_t* ptr ) const;
+    uint8_t*    FindSplit       ( uint8_t* ptr ) const;
+    void        CopyToken       ( char* buffer, size_t bufferSize ) const;
 };
 
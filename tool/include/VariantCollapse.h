@@ -0,0 +1,41 @@
+﻿//-----------------------------------------------------------------------------
+// File : VariantCollapse.h
+// Desc : Keyword Variant Collapse Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "KeywordPermutation.h"
+#include "ShaderCompiler.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// VariantAlias structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariantAlias
+{
+    size_t                  Technique;  //!< テクニック番号.
+    size_t                  Pass;       //!< パス番号.
+    size_t                  Shader;     //!< シェーダ番号.
+    std::vector<uint32_t>   Targets;    //!< 組み合わせごとに, 代わりにコンパイルする組み合わせの番号.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      前処理後のソースコードが同じになるキーワードの組み合わせをまとめます.
+//! 
+//! @param[in]      job         エントリーポイントとソースコードを設定したコンパイルジョブ.
+//! @param[in]      variants    キーワードの組み合わせ.
+//! @param[out]     result      組み合わせごとに, 代わりにコンパイルする組み合わせの番号.
+//! @note       空行と字下げの違いは区別しません. 評価できない組み合わせはまとめません.
+//-----------------------------------------------------------------------------
+void CollapseVariants(const CompileJob& job, const std::vector<KeywordVariant>& variants, std::vector<uint32_t>& result);
+
+} // namespace asura
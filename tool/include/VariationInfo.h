@@ -0,0 +1,378 @@
+﻿//-----------------------------------------------------------------------------
+// File : VariationInfo.h
+// Desc : Shader Variation Info Binary Format Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kVariationInfoMagic   = 0x49565341;   // 'ASVI'
+static const uint32_t kVariationInfoVersion = 2;            // フォーマットのバージョン.
+static const uint32_t kVariationInfoNone    = 0xFFFFFFFF;   // 参照なし.
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoString structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationInfoString
+{
+    uint32_t    Offset;         //!< 文字列テーブル内の位置. 末尾は '\0' で終端されています.
+    uint32_t    Length;         //!< 文字列の長さ('\0' は含みません).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationStateId structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationStateId
+{
+    uint32_t    Low;            //!< 下位32ビット.
+    uint32_t    High;           //!< 上位32ビット.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      ステート ID を64ビット値に変換します.
+//-----------------------------------------------------------------------------
+inline uint64_t ToStateId(const VariationStateId& value)
+{ return (uint64_t(value.High) << 32) | value.Low; }
+
+//-----------------------------------------------------------------------------
+//! @brief      64ビット値をステート ID に変換します.
+//-----------------------------------------------------------------------------
+inline VariationStateId ToVariationStateId(uint64_t value)
+{ return VariationStateId{ uint32_t(value), uint32_t(value >> 32) }; }
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoSection structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationInfoSection
+{
+    uint32_t    Offset;         //!< ファイル先頭からの位置.
+    uint32_t    Count;          //!< 要素数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationInfoHeader
+{
+    uint32_t                Magic;              //!< kVariationInfoMagic.
+    uint32_t                Version;            //!< kVariationInfoVersion.
+    uint32_t                FileSize;           //!< ファイルサイズ.
+    uint32_t                StringOffset;       //!< 文字列テーブルの位置.
+    uint32_t                StringSize;         //!< 文字列テーブルのサイズ.
+    VariationInfoString     Source;             //!< ソースコードのパス.
+    VariationInfoSection    RasterizerStates;   //!< VariationRasterizerState 配列.
+    VariationInfoSection    DepthStencilStates; //!< VariationDepthStencilState 配列.
+    VariationInfoSection    BlendStates;        //!< VariationBlendState 配列.
+    VariationInfoSection    ValueProperties;    //!< VariationValueProperty 配列.
+    VariationInfoSection    TextureProperties;  //!< VariationTextureProperty 配列.
+    VariationInfoSection    KeywordGroups;      //!< VariationKeywordGroup 配列.
+    VariationInfoSection    Keywords;           //!< VariationInfoString 配列. 空文字列はどれも定義しないことを表します.
+    VariationInfoSection    Variants;           //!< VariationVariant 配列.
+    VariationInfoSection    Techniques;         //!< VariationTechnique 配列.
+    VariationInfoSection    Passes;             //!< VariationPass 配列.
+    VariationInfoSection    Shaders;            //!< VariationShader 配列.
+    VariationInfoSection    Aliases;            //!< VariationAlias 配列.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationRasterizerState structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationRasterizerState
+{
+    VariationInfoString     Name;                       //!< ステート名. 全エフェクト共通のステートテーブルでは空文字列です.
+    VariationStateId        Id;                         //!< 正規化した内容から求めたステート ID.
+    uint32_t                PolygonMode;                //!< POLYGON_MODE.
+    uint32_t                CullMode;                   //!< CULL_TYPE.
+    uint32_t                FrontCCW;                   //!< 反時計回りを前面にするかどうか.
+    uint32_t                DepthBias;                  //!< 深度バイアス.
+    float                   DepthBiasClamp;             //!< 深度バイアスのクランプ値.
+    float                   SlopeScaledDepthBias;       //!< 傾斜スケール深度バイアス.
+    uint32_t                DepthClipEnable;            //!< 深度クリップを有効化するかどうか.
+    uint32_t                EnableConservativeRaster;   //!< コンサバティブラスタライゼーションを有効化するかどうか.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationDepthStencilState structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationDepthStencilState
+{
+    VariationInfoString     Name;                       //!< ステート名. 全エフェクト共通のステートテーブルでは空文字列です.
+    VariationStateId        Id;                         //!< 正規化した内容から求めたステート ID.
+    uint32_t                DepthEnable;                //!< 深度テストを有効化するかどうか.
+    uint32_t                DepthWriteMask;             //!< DEPTH_WRITE_MASK.
+    uint32_t                DepthFunc;                  //!< COMPARE_TYPE.
+    uint32_t                StencilEnable;              //!< ステンシルテストを有効化するかどうか.
+    uint32_t                StencilReadMask;            //!< ステンシル読み取りマスク.
+    uint32_t                StencilWriteMask;           //!< ステンシル書き込みマスク.
+    uint32_t                FrontFaceStencilFail;       //!< STENCIL_OP_TYPE.
+    uint32_t                FrontFaceStencilDepthFail;  //!< STENCIL_OP_TYPE.
+    uint32_t                FrontFaceStencilPass;       //!< STENCIL_OP_TYPE.
+    uint32_t                FrontFaceStencilFunc;       //!< COMPARE_TYPE.
+    uint32_t                BackFaceStencilFail;        //!< STENCIL_OP_TYPE.
+    uint32_t                BackFaceStencilDepthFail;   //!< STENCIL_OP_TYPE.
+    uint32_t                BackFaceStencilPass;        //!< STENCIL_OP_TYPE.
+    uint32_t                BackFaceStencilFunc;        //!< COMPARE_TYPE.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationBlendState structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationBlendState
+{
+    VariationInfoString     Name;                       //!< ステート名. 全エフェクト共通のステートテーブルでは空文字列です.
+    VariationStateId        Id;                         //!< 正規化した内容から求めたステート ID.
+    uint32_t                AlphaToCoverageEnable;      //!< アルファトゥカバレッジを有効化するかどうか.
+    uint32_t                BlendEnable;                //!< ブレンドを有効化するかどうか.
+    uint32_t                SrcBlend;                   //!< BLEND_TYPE.
+    uint32_t                DstBlend;                   //!< BLEND_TYPE.
+    uint32_t                BlendOp;                    //!< BLEND_OP_TYPE.
+    uint32_t                SrcBlendAlpha;              //!< BLEND_TYPE.
+    uint32_t                DstBlendAlpha;              //!< BLEND_TYPE.
+    uint32_t                BlendOpAlpha;               //!< BLEND_OP_TYPE.
+    uint32_t                RenderTargetWriteMask;      //!< レンダーターゲット書き込みマスク.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationValueProperty structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationValueProperty
+{
+    VariationInfoString     Name;               //!< 変数名.
+    VariationInfoString     DisplayTag;         //!< UI表示名.
+    uint32_t                Type;               //!< PROPERTY_TYPE.
+    uint32_t                Offset;             //!< 先頭からのオフセット(バイト単位).
+    float                   Min;                //!< 最小値.
+    float                   Max;                //!< 最大値.
+    float                   Step;               //!< 値を増やす量.
+    VariationInfoString     DefaultValue[4];    //!< 要素ごとのデフォルト値.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationTextureProperty structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationTextureProperty
+{
+    VariationInfoString     Name;               //!< 変数名.
+    VariationInfoString     DisplayTag;         //!< UI表示名.
+    uint32_t                Type;               //!< PROPERTY_TYPE.
+    uint32_t                EnableSRGB;         //!< sRGBを有効にするかどうか.
+    VariationInfoString     DefaultValue;       //!< デフォルト値.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationKeywordGroup structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationKeywordGroup
+{
+    uint32_t    KeywordIndex;   //!< 先頭のキーワード番号.
+    uint32_t    KeywordCount;   //!< キーワード数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationVariant structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationVariant
+{
+    VariationInfoString     Key;        //!< キーワードの組み合わせを表すキー.
+    VariationInfoString     Suffix;     //!< 出力ファイル名の接尾辞.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationTechnique structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationTechnique
+{
+    VariationInfoString     Name;       //!< テクニック名.
+    uint32_t                PassIndex;  //!< 先頭のパス番号.
+    uint32_t                PassCount;  //!< パス数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationPass structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationPass
+{
+    VariationInfoString     Name;               //!< パス名.
+    uint32_t                ShaderIndex;        //!< 先頭のシェーダ番号.
+    uint32_t                ShaderCount;        //!< シェーダ数.
+    uint32_t                RasterizerState;    //!< ラスタライザーステート番号. 指定が無い場合は kVariationInfoNone.
+    uint32_t                DepthStencilState;  //!< 深度ステンシルステート番号. 指定が無い場合は kVariationInfoNone.
+    uint32_t                BlendState;         //!< ブレンドステート番号. 指定が無い場合は kVariationInfoNone.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationShader structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationShader
+{
+    uint32_t                Type;           //!< SHADER_TYPE.
+    VariationInfoString     Profile;        //!< シェーダプロファイル.
+    VariationInfoString     EntryPoint;     //!< エントリーポイント名.
+    uint32_t                AliasIndex;     //!< 先頭の別名番号.
+    uint32_t                AliasCount;     //!< 別名数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationAlias structure
+///////////////////////////////////////////////////////////////////////////////
+struct VariationAlias
+{
+    uint32_t    Variant;        //!< 組み合わせ番号.
+    uint32_t    Target;         //!< 出力ファイルを共有する代表の組み合わせ番号.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoReader class
+///////////////////////////////////////////////////////////////////////////////
+class VariationInfoReader
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    VariationInfoReader();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~VariationInfoReader();
+
+    //------------------------------------------------------------------------
+    //! @brief      メモリ上のメタデータを読み込みます.
+    //! 
+    //! @param[in]      pData       メタデータの内容. 4バイト境界に配置されている必要があります.
+    //! @param[in]      size        メタデータのサイズ.
+    //! @retval true    読み込みに成功.
+    //! @retval false   ヘッダー, 配列, 文字列, 番号のいずれかの範囲が不正.
+    //! @note       データはコピーしません. pData は本オブジェクトより長く生存している必要があります.
+    //!             読み込み時に全ての範囲を検証するので, 以降の取得関数は検証無しでそのまま参照できます.
+    //------------------------------------------------------------------------
+    bool Init(const void* pData, size_t size);
+
+    //------------------------------------------------------------------------
+    //! @brief      読み込んだ内容を破棄します.
+    //------------------------------------------------------------------------
+    void Term();
+
+    //------------------------------------------------------------------------
+    //! @brief      ヘッダーを取得します. 各配列の要素数はヘッダーから取得します.
+    //------------------------------------------------------------------------
+    const VariationInfoHeader* GetHeader() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      文字列を取得します.
+    //------------------------------------------------------------------------
+    std::string_view GetString(const VariationInfoString& value) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ラスタライザーステート配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationRasterizerState* GetRasterizerStates() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      深度ステンシルステート配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationDepthStencilState* GetDepthStencilStates() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      ブレンドステート配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationBlendState* GetBlendStates() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      値プロパティ配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationValueProperty* GetValueProperties() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      テクスチャプロパティ配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationTextureProperty* GetTextureProperties() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      キーワードグループ配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationKeywordGroup* GetKeywordGroups() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      キーワード配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationInfoString* GetKeywords() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      キーワードの組み合わせ配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationVariant* GetVariants() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      テクニック配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationTechnique* GetTechniques() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      パス配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationPass* GetPasses() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      シェーダ配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationShader* GetShaders() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      別名配列を取得します.
+    //------------------------------------------------------------------------
+    const VariationAlias* GetAliases() const;
+
+    //------------------------------------------------------------------------
+    //! @brief      テクニックを名前から検索します.
+    //! 
+    //! @param[in]      name        テクニック名.
+    //! @return     テクニック番号を返却します. 見つからない場合は kVariationInfoNone を返却します.
+    //------------------------------------------------------------------------
+    uint32_t FindTechnique(std::string_view name) const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    const uint8_t*              m_pData;        //!< メタデータの内容.
+    const VariationInfoHeader*  m_pHeader;      //!< ヘッダー.
+    const char*                 m_pStrings;     //!< 文字列テーブル.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    const void* GetSection(const VariationInfoSection& section) const;
+
+    VariationInfoReader             (const VariationInfoReader&) = delete;
+    VariationInfoReader& operator = (const VariationInfoReader&) = delete;
+};
+
+} // namespace asura
@@ -0,0 +1,242 @@
+﻿//-----------------------------------------------------------------------------
+// File : VariationInfoWriter.h
+// Desc : Shader Variation Info Binary Writer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "VariationInfo.h"
+#include "FxParser.h"
+#include "VariantCollapse.h"
+#include "XmlWriter.h"
+#include <string>
+#include <vector>
+#include <map>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoWriter class
+///////////////////////////////////////////////////////////////////////////////
+class VariationInfoWriter
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    VariationInfoWriter();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~VariationInfoWriter();
+
+    //------------------------------------------------------------------------
+    //! @brief      ソースコードのパスを設定します.
+    //------------------------------------------------------------------------
+    void SetSource(const std::string& path);
+
+    //------------------------------------------------------------------------
+    //! @brief      ラスタライザーステートを追加します.
+    //! 
+    //! @note       ステート ID は正規化した内容から求めます.
+    //------------------------------------------------------------------------
+    void AddRasterizerState(const std::string& name, const RasterizerState& state);
+
+    //------------------------------------------------------------------------
+    //! @brief      深度ステンシルステートを追加します.
+    //! 
+    //! @note       ステート ID は正規化した内容から求めます.
+    //------------------------------------------------------------------------
+    void AddDepthStencilState(const std::string& name, const DepthStencilState& state);
+
+    //------------------------------------------------------------------------
+    //! @brief      ブレンドステートを追加します.
+    //! 
+    //! @note       ステート ID は正規化した内容から求めます.
+    //------------------------------------------------------------------------
+    void AddBlendState(const std::string& name, const BlendState& state);
+
+    //------------------------------------------------------------------------
+    //! @brief      値プロパティを追加します.
+    //------------------------------------------------------------------------
+    void AddValueProperty(const ValueProperty& prop);
+
+    //------------------------------------------------------------------------
+    //! @brief      テクスチャプロパティを追加します.
+    //------------------------------------------------------------------------
+    void AddTextureProperty(const TextureProperty& prop);
+
+    //------------------------------------------------------------------------
+    //! @brief      キーワードグループを追加します.
+    //------------------------------------------------------------------------
+    void AddKeywordGroup(const KeywordGroup& group);
+
+    //------------------------------------------------------------------------
+    //! @brief      キーワードの組み合わせを追加します.
+    //! 
+    //! @param[in]      key         キーワードの組み合わせを表すキー.
+    //! @param[in]      suffix      出力ファイル名の接尾辞.
+    //------------------------------------------------------------------------
+    void AddVariant(const std::string& key, const std::string& suffix);
+
+    //------------------------------------------------------------------------
+    //! @brief      テクニックを追加します.
+    //------------------------------------------------------------------------
+    void AddTechnique(const std::string& name);
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に追加したテクニックにパスを追加します.
+    //! 
+    //! @param[in]      pass        パス. ステートは追加済みのステートを名前で参照します.
+    //! @note       シェーダは含みません. AddShader() で追加します.
+    //------------------------------------------------------------------------
+    void AddPass(const Pass& pass);
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に追加したパスにシェーダを追加します.
+    //------------------------------------------------------------------------
+    void AddShader(const Shader& shader);
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に追加したシェーダに別名を追加します.
+    //! 
+    //! @param[in]      variant     組み合わせ番号.
+    //! @param[in]      target      出力ファイルを共有する代表の組み合わせ番号.
+    //------------------------------------------------------------------------
+    void AddAlias(uint32_t variant, uint32_t target);
+
+    //------------------------------------------------------------------------
+    //! @brief      メタデータを書き出します.
+    //! 
+    //! @param[in]      path        出力ファイルパス.
+    //! @retval true    書き出しに成功.
+    //! @retval false   書き出しに失敗.
+    //------------------------------------------------------------------------
+    bool Write(const std::string& path);
+
+    //------------------------------------------------------------------------
+    //! @brief      書き出したメタデータが XML と同じ内容か検証します.
+    //! 
+    //! @param[in]      path        メタデータのパス.
+    //! @param[in]      xmlPath     同じエフェクトから出力した variation.xml のパス.
+    //! @retval true    XML の要素と属性が全て一致.
+    //! @retval false   読み込みに失敗したか, 一致しない要素がある.
+    //! @note       XML に出力していないフィールドは比較しません.
+    //------------------------------------------------------------------------
+    static bool Verify(const std::string& path, const std::string& xmlPath);
+
+    //------------------------------------------------------------------------
+    //! @brief      最後に書き出したメタデータのサイズを取得します.
+    //------------------------------------------------------------------------
+    uint32_t GetFileSize() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::string                                 m_Strings;              //!< 文字列テーブル.
+    std::map<std::string, uint32_t>             m_StringIndex;          //!< 文字列から文字列テーブル内の位置を引く表.
+    VariationInfoString                         m_Source;               //!< ソースコードのパス.
+    std::vector<VariationRasterizerState>       m_RasterizerStates;     //!< ラスタライザーステート.
+    std::vector<VariationDepthStencilState>     m_DepthStencilStates;   //!< 深度ステンシルステート.
+    std::vector<VariationBlendState>            m_BlendStates;          //!< ブレンドステート.
+    std::vector<VariationValueProperty>         m_ValueProperties;      //!< 値プロパティ.
+    std::vector<VariationTextureProperty>       m_TextureProperties;    //!< テクスチャプロパティ.
+    std::vector<VariationKeywordGroup>          m_KeywordGroups;        //!< キーワードグループ.
+    std::vector<VariationInfoString>            m_Keywords;             //!< キーワード.
+    std::vector<VariationVariant>               m_Variants;             //!< キーワードの組み合わせ.
+    std::vector<VariationTechnique>             m_Techniques;           //!< テクニック.
+    std::vector<VariationPass>                  m_Passes;               //!< パス.
+    std::vector<VariationShader>                m_Shaders;              //!< シェーダ.
+    std::vector<VariationAlias>                 m_Aliases;              //!< 別名.
+    std::map<std::string, uint32_t>             m_RasterizerIndex;      //!< ステート名からラスタライザーステート番号を引く表.
+    std::map<std::string, uint32_t>             m_DepthStencilIndex;    //!< ステート名から深度ステンシルステート番号を引く表.
+    std::map<std::string, uint32_t>             m_BlendIndex;           //!< ステート名からブレンドステート番号を引く表.
+    uint32_t                                    m_FileSize;             //!< ファイルサイズ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    VariationInfoString AddString(const std::string& value);
+
+    VariationInfoWriter             (const VariationInfoWriter&) = delete;
+    VariationInfoWriter& operator = (const VariationInfoWriter&) = delete;
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      バリエーション情報を XML 形式でバッファに書き込みます.
+//! 
+//! @param[in]      writer      書き込み先.
+//! @param[in]      parser      解析済みのエフェクト.
+//! @param[in]      variants    キーワードの組み合わせ.
+//! @param[in]      aliases     シェーダごとにまとめた組み合わせ. テクニック, パス, シェーダの順に並べます.
+//! @param[in]      hlslpath    出力したソースコードのパス.
+//-----------------------------------------------------------------------------
+void FormatVariationInfo
+(
+    XmlWriter&                          writer,
+    const FxParser&                     parser,
+    const std::vector<KeywordVariant>&  variants,
+    const std::vector<VariantAlias>&    aliases,
+    const char*                         hlslpath
+);
+
+//-----------------------------------------------------------------------------
+//! @brief      バリエーション情報を XML 形式で出力します.
+//! 
+//! @param[in]      xmlpath     出力ファイルパス.
+//! @retval true    出力に成功.
+//! @retval false   出力に失敗.
+//! @note       その他の引数は FormatVariationInfo() と同じです.
+//-----------------------------------------------------------------------------
+bool WriteVariationInfo
+(
+    const FxParser&                     parser,
+    const std::vector<KeywordVariant>&  variants,
+    const std::vector<VariantAlias>&    aliases,
+    const char*                         xmlpath,
+    const char*                         hlslpath
+);
+
+//-----------------------------------------------------------------------------
+//! @brief      バリエーション情報をバイナリ形式で出力します.
+//! 
+//! @param[in]      parser      解析済みのエフェクト.
+//! @param[in]      variants    キーワードの組み合わせ.
+//! @param[in]      aliases     シェーダごとにまとめた組み合わせ. テクニック, パス, シェーダの順に並べます.
+//! @param[in]      binpath     出力ファイルパス.
+//! @param[in]      hlslpath    出力したソースコードのパス.
+//! @param[out]     fileSize    出力したファイルのサイズ.
+//! @retval true    出力に成功.
+//! @retval false   出力に失敗.
+//-----------------------------------------------------------------------------
+bool WriteVariationBinary
+(
+    const FxParser&                     parser,
+    const std::vector<KeywordVariant>&  variants,
+    const std::vector<VariantAlias>&    aliases,
+    const std::string&                  binpath,
+    const char*                         hlslpath,
+    uint32_t&                           fileSize
+);
+
+} // namespace asura
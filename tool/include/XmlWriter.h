@@ -0,0 +1,118 @@
+﻿//-----------------------------------------------------------------------------
+// File : XmlWriter.h
+// Desc : Buffered XML Writer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// XmlWriter class
+///////////////////////////////////////////////////////////////////////////////
+class XmlWriter
+{
+    //========================================================================
+    // list of friend classes and methods.
+    //========================================================================
+    /* NOTHING */
+
+public:
+    //========================================================================
+    // public variables.
+    //========================================================================
+    /* NOTHING */
+
+    //========================================================================
+    // public methods.
+    //========================================================================
+
+    //------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //------------------------------------------------------------------------
+    XmlWriter();
+
+    //------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //------------------------------------------------------------------------
+    ~XmlWriter();
+
+    //------------------------------------------------------------------------
+    //! @brief      書き込んだ内容を破棄します. 確保済みのバッファは再利用します.
+    //------------------------------------------------------------------------
+    void Reset();
+
+    //------------------------------------------------------------------------
+    //! @brief      文字列をそのまま書き込みます.
+    //! 
+    //! @param[in]      text        タグやインデントなど, エスケープが不要な文字列.
+    //------------------------------------------------------------------------
+    void Raw(std::string_view text);
+
+    //------------------------------------------------------------------------
+    //! @brief      文字列を属性値としてエスケープして書き込みます.
+    //------------------------------------------------------------------------
+    void Escape(std::string_view text);
+
+    //------------------------------------------------------------------------
+    //! @brief      属性を書き込みます.
+    //! 
+    //! @param[in]      name        属性名.
+    //! @param[in]      value       属性値. エスケープして書き込みます.
+    //! @note       属性の前に空白を1つ書き込みます.
+    //------------------------------------------------------------------------
+    void Attribute(std::string_view name, std::string_view value);
+
+    //------------------------------------------------------------------------
+    //! @brief      整数値の属性を10進数で書き込みます.
+    //------------------------------------------------------------------------
+    void Attribute(std::string_view name, uint32_t value);
+
+    //------------------------------------------------------------------------
+    //! @brief      浮動小数点数の属性を小数点以下6桁で書き込みます.
+    //! 
+    //! @note       std::to_string() と同じ表記になります.
+    //------------------------------------------------------------------------
+    void Attribute(std::string_view name, float value);
+
+    //------------------------------------------------------------------------
+    //! @brief      整数値の属性を 0x 付きの16進数で書き込みます.
+    //------------------------------------------------------------------------
+    void AttributeHex(std::string_view name, uint64_t value);
+
+    //------------------------------------------------------------------------
+    //! @brief      書き込んだ内容を1回の書き込みでファイルに出力します.
+    //! 
+    //! @param[in]      path        出力ファイルパス.
+    //! @retval true    出力に成功.
+    //! @retval false   出力に失敗.
+    //------------------------------------------------------------------------
+    bool Flush(const char* path) const;
+
+    //------------------------------------------------------------------------
+    //! @brief      書き込んだ内容のサイズを取得します.
+    //------------------------------------------------------------------------
+    size_t GetSize() const;
+
+private:
+    //========================================================================
+    // private variables.
+    //========================================================================
+    std::string     m_Buffer;       //!< 書き込みバッファ.
+
+    //========================================================================
+    // private methods.
+    //========================================================================
+    XmlWriter             (const XmlWriter&) = delete;
+    XmlWriter& operator = (const XmlWriter&) = delete;
+};
+
+} // namespace asura
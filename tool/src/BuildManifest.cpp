@@ -0,0 +1,362 @@
+﻿//-----------------------------------------------------------------------------
+// File : BuildManifest.cpp
+// Desc : Build Dependency Manifest Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "BuildManifest.h"
+#include "ShaderCompiler.h"
+#include "Sha256.h"
+#include <cstdlib>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char  kMagic[]     = "asfxc_manifest 1";
+static const char* kKindNames[] = {
+    "input",
+    "missing",
+    "output",
+};
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズと更新日時を取得します.
+//-----------------------------------------------------------------------------
+bool GetFileStat(const std::string& path, uint64_t& size, int64_t& time)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    { return false; }
+
+    size = uint64_t(info.st_size);
+    time = int64_t(info.st_mtime);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      空白で区切られた次のフィールドを取り出します.
+//-----------------------------------------------------------------------------
+bool NextField(std::string_view& line, std::string_view& field)
+{
+    auto pos = line.find(' ');
+    if (pos == std::string_view::npos)
+    { return false; }
+
+    field = line.substr(0, pos);
+    line  = line.substr(pos + 1);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      空文字を "-" として書き出せる形にします.
+//-----------------------------------------------------------------------------
+inline std::string_view ToField(const std::string& value)
+{ return value.empty() ? std::string_view("-") : std::string_view(value); }
+
+//-----------------------------------------------------------------------------
+//      "-" を空文字に戻します.
+//-----------------------------------------------------------------------------
+inline std::string FromField(std::string_view value)
+{ return (value == "-") ? std::string() : std::string(value); }
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// BuildManifest class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+BuildManifest::BuildManifest()
+: m_Stamp(0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+BuildManifest::~BuildManifest()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      マニフェストを読み込みます.
+//-----------------------------------------------------------------------------
+bool BuildManifest::Load(const std::string& path)
+{
+    Reset(std::string());
+    m_Stamp = 0;
+
+    std::vector<uint8_t> data;
+    if (!LoadBinary(path, data))
+    { return false; }
+
+    std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+
+    bool header = false;
+    while(!text.empty())
+    {
+        auto pos  = text.find('\n');
+        auto line = text.substr(0, pos);
+        text = (pos == std::string_view::npos) ? std::string_view() : text.substr(pos + 1);
+
+        if (!line.empty() && line.back() == '\r')
+        { line.remove_suffix(1); }
+
+        if (line.empty())
+        { continue; }
+
+        if (!header)
+        {
+            if (line != kMagic)
+            { return false; }
+            header = true;
+            continue;
+        }
+
+        std::string_view name;
+        if (!NextField(line, name))
+        { return false; }
+
+        if (name == "option")
+        {
+            m_Option = std::string(line);
+            continue;
+        }
+
+        if (name == "stamp")
+        {
+            m_Stamp = strtoll(std::string(line).c_str(), nullptr, 10);
+            continue;
+        }
+
+        // 種別 ハッシュ値 サイズ 更新日時 キー パス の順に並ぶ.
+        ManifestEntry entry;
+        entry.Kind = MANIFEST_INPUT;
+        while(entry.Kind <= MANIFEST_OUTPUT && name != kKindNames[entry.Kind])
+        { entry.Kind = MANIFEST_KIND(entry.Kind + 1); }
+
+        std::string_view hash, size, time, key;
+        if (entry.Kind > MANIFEST_OUTPUT
+         || !NextField(line, hash)
+         || !NextField(line, size)
+         || !NextField(line, time)
+         || !NextField(line, key)
+         || line.empty())
+        { return false; }
+
+        entry.Path = std::string(line);
+        entry.Hash = FromField(hash);
+        entry.Size = strtoull(std::string(size).c_str(), nullptr, 10);
+        entry.Time = strtoll (std::string(time).c_str(), nullptr, 10);
+        entry.Key  = FromField(key);
+        Add(std::move(entry));
+    }
+
+    return header;
+}
+
+//-----------------------------------------------------------------------------
+//      マニフェストを書き出します.
+//-----------------------------------------------------------------------------
+bool BuildManifest::Save(const std::string& path) const
+{
+    std::string text;
+    text.reserve(128 * (m_Entries.size() + 1));
+
+    text += kMagic;
+    text += "\noption ";
+    text += ToField(m_Option);
+    text += "\nstamp ";
+    text += std::to_string(m_Stamp);
+    text += "\n";
+
+    for(auto& entry : m_Entries)
+    {
+        text += kKindNames[entry.Kind];
+        text += " ";
+        text += ToField(entry.Hash);
+        text += " ";
+        text += std::to_string(entry.Size);
+        text += " ";
+        text += std::to_string(entry.Time);
+        text += " ";
+        text += ToField(entry.Key);
+        text += " ";
+        text += entry.Path;
+        text += "\n";
+    }
+
+    return WriteFileAtomic(path, text.data(), text.size());
+}
+
+//-----------------------------------------------------------------------------
+//      記録を破棄し, 記録開始時刻を設定します.
+//-----------------------------------------------------------------------------
+void BuildManifest::Reset(const std::string& option)
+{
+    m_Option = option;
+    m_Stamp  = int64_t(time(nullptr));
+    m_Entries.clear();
+    m_Outputs.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      入力ファイルを記録します.
+//-----------------------------------------------------------------------------
+void BuildManifest::AddInput(const std::string& path, std::string_view code)
+{
+    ManifestEntry entry;
+    entry.Kind = MANIFEST_INPUT;
+    entry.Path = path;
+    entry.Hash = Sha256::Compute(code.data(), code.size());
+    entry.Size = code.size();
+    entry.Time = -1;
+    GetFileStat(path, entry.Size, entry.Time);
+    Add(std::move(entry));
+}
+
+//-----------------------------------------------------------------------------
+//      見つからなかったファイルを記録します.
+//-----------------------------------------------------------------------------
+void BuildManifest::AddMissing(const std::string& path)
+{
+    ManifestEntry entry;
+    entry.Kind = MANIFEST_MISSING;
+    entry.Path = path;
+    entry.Size = 0;
+    entry.Time = 0;
+    Add(std::move(entry));
+}
+
+//-----------------------------------------------------------------------------
+//      出力ファイルを記録します.
+//-----------------------------------------------------------------------------
+void BuildManifest::AddOutput(const std::string& path, const std::string& key, const void* pData, size_t size)
+{
+    ManifestEntry entry;
+    entry.Kind = MANIFEST_OUTPUT;
+    entry.Path = path;
+    entry.Hash = Sha256::Compute(pData, size);
+    entry.Size = size;
+    entry.Time = -1;
+    entry.Key  = key;
+    GetFileStat(path, entry.Size, entry.Time);
+    Add(std::move(entry));
+}
+
+//-----------------------------------------------------------------------------
+//      書き出し済みの出力ファイルを読み込んで記録します.
+//-----------------------------------------------------------------------------
+bool BuildManifest::AddOutputFile(const std::string& path, const std::string& key)
+{
+    std::vector<uint8_t> data;
+    if (!LoadBinary(path, data))
+    { return false; }
+
+    AddOutput(path, key, data.data(), data.size());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      他のマニフェストの出力ファイルの記録を引き継ぎます.
+//-----------------------------------------------------------------------------
+void BuildManifest::CopyOutput(const BuildManifest& other, const std::string& path)
+{
+    auto itr = other.m_Outputs.find(path);
+    if (itr == other.m_Outputs.end())
+    { return; }
+
+    auto entry = other.m_Entries[itr->second];
+    Add(std::move(entry));
+}
+
+//-----------------------------------------------------------------------------
+//      全ての入出力が記録時から変更されていないかチェックします.
+//-----------------------------------------------------------------------------
+bool BuildManifest::IsUpToDate(const std::string& option) const
+{
+    if (m_Entries.empty() || m_Option.empty() || m_Option != option)
+    { return false; }
+
+    for(auto& entry : m_Entries)
+    {
+        if (!IsUnchanged(entry))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      出力ファイルが同じキーで生成され, 変更されていないかチェックします.
+//-----------------------------------------------------------------------------
+bool BuildManifest::IsOutputUpToDate(const std::string& path, const std::string& key) const
+{
+    auto itr = m_Outputs.find(path);
+    if (itr == m_Outputs.end())
+    { return false; }
+
+    auto& entry = m_Entries[itr->second];
+    return !key.empty() && entry.Key == key && IsUnchanged(entry);
+}
+
+//-----------------------------------------------------------------------------
+//      記録数を取得します.
+//-----------------------------------------------------------------------------
+size_t BuildManifest::GetCount() const
+{ return m_Entries.size(); }
+
+//-----------------------------------------------------------------------------
+//      記録を取得します.
+//-----------------------------------------------------------------------------
+const std::vector<ManifestEntry>& BuildManifest::GetEntries() const
+{ return m_Entries; }
+
+//-----------------------------------------------------------------------------
+//      記録を追加します.
+//-----------------------------------------------------------------------------
+void BuildManifest::Add(ManifestEntry&& entry)
+{
+    if (entry.Kind == MANIFEST_OUTPUT)
+    { m_Outputs[entry.Path] = m_Entries.size(); }
+
+    m_Entries.push_back(std::move(entry));
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルが記録時から変更されていないかチェックします.
+//-----------------------------------------------------------------------------
+bool BuildManifest::IsUnchanged(const ManifestEntry& entry) const
+{
+    uint64_t size = 0;
+    int64_t  time = 0;
+    if (!GetFileStat(entry.Path, size, time))
+    { return entry.Kind == MANIFEST_MISSING; }
+
+    if (entry.Kind == MANIFEST_MISSING || size != entry.Size)
+    { return false; }
+
+    // 記録開始後に更新された入力は同じ秒内に書き換えられた可能性があるので内容を比較する.
+    if (time == entry.Time && (entry.Kind == MANIFEST_OUTPUT || time < m_Stamp))
+    { return true; }
+
+    std::vector<uint8_t> data;
+    if (!LoadBinary(entry.Path, data))
+    { return false; }
+
+    return Sha256::Compute(data.data(), data.size()) == entry.Hash;
+}
+
+} // namespace asura
@@ -0,0 +1,268 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompileCache.cpp
+// Desc : Shader Compile Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "CompileCache.h"
+#include "Sha256.h"
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <sys/utime.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+    #include <utime.h>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char kHexChars[]    = "0123456789abcdef";
+static const char kEntrySuffix[] = ".bin";
+
+///////////////////////////////////////////////////////////////////////////////
+// Entry structure
+///////////////////////////////////////////////////////////////////////////////
+struct Entry
+{
+    std::string     Path;       //!< ファイルパス.
+    uint64_t        Size;       //!< ファイルサイズ.
+    int64_t         Time;       //!< 最終アクセス時刻.
+};
+
+//-----------------------------------------------------------------------------
+//      ディレクトリを作成します. 既に存在する場合も成功とします.
+//-----------------------------------------------------------------------------
+bool MakeDirectory(const std::string& path)
+{
+#if defined(_WIN32)
+    return CreateDirectoryA(path.c_str(), nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      ディレクトリ内のエントリーを列挙します.
+//-----------------------------------------------------------------------------
+void ListEntries(const std::string& directory, std::vector<Entry>& result)
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    auto pattern = directory + "\\*" + kEntrySuffix;
+    auto handle  = FindFirstFileA(pattern.c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+    { return; }
+
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        { continue; }
+
+        Entry entry;
+        entry.Path = directory + "\\" + data.cFileName;
+        entry.Size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        entry.Time = (int64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        result.push_back(entry);
+    }
+    while (FindNextFileA(handle, &data));
+
+    FindClose(handle);
+#else
+    auto suffixLen = sizeof(kEntrySuffix) - 1;
+
+    auto pDir = opendir(directory.c_str());
+    if (pDir == nullptr)
+    { return; }
+
+    while (auto pEntry = readdir(pDir))
+    {
+        std::string name = pEntry->d_name;
+        if (name.size() <= suffixLen || name.compare(name.size() - suffixLen, suffixLen, kEntrySuffix) != 0)
+        { continue; }
+
+        Entry entry;
+        entry.Path = directory + "/" + name;
+
+        struct stat info;
+        if (stat(entry.Path.c_str(), &info) != 0)
+        { continue; }
+
+        entry.Size = uint64_t(info.st_size);
+        entry.Time = int64_t(info.st_mtime);
+        result.push_back(entry);
+    }
+
+    closedir(pDir);
+#endif
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileCache class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+CompileCache::CompileCache(const std::string& directory, uint64_t maxSize)
+: m_Directory (directory)
+, m_MaxSize   (maxSize)
+, m_HitCount  (0)
+, m_MissCount (0)
+, m_EvictCount(0)
+, m_TotalSize (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+CompileCache::~CompileCache()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      キャッシュディレクトリを作成します.
+//-----------------------------------------------------------------------------
+bool CompileCache::Init()
+{
+    if (!MakeDirectory(m_Directory))
+    { return false; }
+
+    // キーの先頭2文字で256個のディレクトリに分散させる.
+    for(auto i=0; i<256; ++i)
+    {
+        std::string shard = m_Directory + "/";
+        shard += kHexChars[i >> 4];
+        shard += kHexChars[i & 0xf];
+
+        if (!MakeDirectory(shard))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      コンパイルジョブのキーを生成します.
+//-----------------------------------------------------------------------------
+std::string CompileCache::MakeKey(const CompileJob& job, const ShaderCompilerBackend& backend)
+{
+    Sha256 hash;
+    hash.Update(job.SourceHash);
+    hash.Update(job.EntryPoint);
+    hash.Update(job.Profile);
+    hash.Update(std::to_string(job.Flags));
+    for(auto& define : job.Defines)
+    { hash.Update("-D" + define); }
+    hash.Update(backend.GetName());
+    hash.Update(backend.GetVersion());
+    return hash.Finish();
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュからバイナリを読み込みます.
+//-----------------------------------------------------------------------------
+bool CompileCache::Load(const std::string& key, std::vector<uint8_t>& result)
+{
+    auto path = GetPath(key);
+    if (!LoadBinary(path, result))
+    {
+        m_MissCount++;
+        return false;
+    }
+
+    // 最終アクセス時刻を更新して, 削除対象から外す.
+#if defined(_WIN32)
+    _utime(path.c_str(), nullptr);
+#else
+    utime(path.c_str(), nullptr);
+#endif
+
+    m_HitCount++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュにバイナリを登録します.
+//-----------------------------------------------------------------------------
+void CompileCache::Store(const std::string& key, const std::vector<uint8_t>& binary)
+{
+    // 一時ファイルからのリネームなので, 読み込み側が書き込み途中のファイルを見ることはない.
+    WriteFileAtomic(GetPath(key), binary.data(), binary.size());
+}
+
+//-----------------------------------------------------------------------------
+//      最大サイズを超えている場合に, 古いエントリーから削除します.
+//-----------------------------------------------------------------------------
+void CompileCache::Trim()
+{
+    std::vector<Entry> entries;
+    for(auto i=0; i<256; ++i)
+    {
+        std::string shard = m_Directory + "/";
+        shard += kHexChars[i >> 4];
+        shard += kHexChars[i & 0xf];
+        ListEntries(shard, entries);
+    }
+
+    uint64_t totalSize = 0;
+    for(auto& entry : entries)
+    { totalSize += entry.Size; }
+
+    if (totalSize > m_MaxSize)
+    {
+        std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs)
+        { return lhs.Time < rhs.Time; });
+
+        // 他のプロセスが使用中で削除できない場合は読み飛ばす.
+        for(size_t i=0; i<entries.size() && totalSize > m_MaxSize; ++i)
+        {
+            if (remove(entries[i].Path.c_str()) != 0)
+            { continue; }
+
+            totalSize -= entries[i].Size;
+            m_EvictCount++;
+        }
+    }
+
+    m_TotalSize = totalSize;
+}
+
+//-----------------------------------------------------------------------------
+//      統計情報を取得します.
+//-----------------------------------------------------------------------------
+CompileCacheStats CompileCache::GetStats() const
+{
+    CompileCacheStats result;
+    result.HitCount     = m_HitCount;
+    result.MissCount    = m_MissCount;
+    result.EvictCount   = m_EvictCount;
+    result.TotalSize    = m_TotalSize;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      キーに対応するファイルパスを取得します.
+//-----------------------------------------------------------------------------
+std::string CompileCache::GetPath(const std::string& key) const
+{ return m_Directory + "/" + key.substr(0, 2) + "/" + key + kEntrySuffix; }
+
+} // namespace asura
@@ -0,0 +1,679 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompileDaemon.cpp
+// Desc : Resident Compile Daemon Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "CompileDaemon.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <afunix.h>
+    #include <io.h>
+    #include <direct.h>
+    #pragma comment(lib, "ws2_32.lib")
+#else
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint8_t  kMessageRequest  = 'R';           // 処理要求.
+static const uint32_t kMaxStringSize   = 0x40000000;    // 受け付ける文字列の最大サイズ.
+static const uint32_t kMaxArgCount     = 0x10000;       // 受け付ける引数の最大数.
+static const uint32_t kSocketTimeout   = 5000;          // 要求元との送受信のタイムアウト(ミリ秒).
+static const char     kShutdown[]      = "-shutdown";   // 終了要求.
+
+#if defined(_WIN32)
+typedef SOCKET  Socket;
+static const Socket kInvalidSocket = INVALID_SOCKET;
+#else
+typedef int     Socket;
+static const Socket kInvalidSocket = -1;
+#endif
+
+//-----------------------------------------------------------------------------
+//      ソケットを閉じます.
+//-----------------------------------------------------------------------------
+void CloseSocket(Socket socket)
+{
+#if defined(_WIN32)
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      ソケットを使えるようにします.
+//-----------------------------------------------------------------------------
+bool InitSocket()
+{
+#if defined(_WIN32)
+    static bool initialized = false;
+    if (!initialized)
+    {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+        { return false; }
+        initialized = true;
+    }
+#else
+    // 要求元が先に終了しても落ちないようにする.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ソケットアドレスを設定します.
+//-----------------------------------------------------------------------------
+bool MakeAddress(const std::string& path, sockaddr_un& addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    { return false; }
+
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      作業ディレクトリを取得します.
+//-----------------------------------------------------------------------------
+std::string GetWorkDir()
+{
+    char buffer[4096] = {};
+#if defined(_WIN32)
+    if (_getcwd(buffer, sizeof(buffer)) == nullptr)
+    { return std::string(); }
+#else
+    if (getcwd(buffer, sizeof(buffer)) == nullptr)
+    { return std::string(); }
+#endif
+    return buffer;
+}
+
+//-----------------------------------------------------------------------------
+//      作業ディレクトリを変更します.
+//-----------------------------------------------------------------------------
+bool SetWorkDir(const std::string& path)
+{
+#if defined(_WIN32)
+    return _chdir(path.c_str()) == 0;
+#else
+    return chdir(path.c_str()) == 0;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SocketStream class
+///////////////////////////////////////////////////////////////////////////////
+class SocketStream
+{
+public:
+    SocketStream(Socket socket)
+    : m_Socket(socket)
+    { /* DO_NOTHING */ }
+
+    bool Read(void* pData, size_t size)
+    {
+        auto ptr = static_cast<char*>(pData);
+        while(size > 0)
+        {
+            auto ret = recv(m_Socket, ptr, int(std::min<size_t>(size, 0x10000000)), 0);
+            if (ret <= 0)
+            { return false; }
+
+            ptr  += ret;
+            size -= size_t(ret);
+        }
+        return true;
+    }
+
+    bool Write(const void* pData, size_t size)
+    {
+        auto ptr = static_cast<const char*>(pData);
+        while(size > 0)
+        {
+            auto ret = send(m_Socket, ptr, int(std::min<size_t>(size, 0x10000000)), 0);
+            if (ret <= 0)
+            { return false; }
+
+            ptr  += ret;
+            size -= size_t(ret);
+        }
+        return true;
+    }
+
+private:
+    Socket  m_Socket;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// BufferStream class
+///////////////////////////////////////////////////////////////////////////////
+class BufferStream
+{
+public:
+    bool Write(const void* pData, size_t size)
+    {
+        m_Buffer.append(static_cast<const char*>(pData), size);
+        return true;
+    }
+
+    const std::string& GetBuffer() const
+    { return m_Buffer; }
+
+private:
+    std::string     m_Buffer;
+};
+
+//-----------------------------------------------------------------------------
+//      32bit値を書き込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool WriteU32(Stream& stream, uint32_t value)
+{ return stream.Write(&value, sizeof(value)); }
+
+//-----------------------------------------------------------------------------
+//      文字列を書き込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool WriteString(Stream& stream, const std::string& value)
+{
+    return WriteU32(stream, uint32_t(value.size()))
+        && stream.Write(value.data(), value.size());
+}
+
+//-----------------------------------------------------------------------------
+//      32bit値を読み込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool ReadU32(Stream& stream, uint32_t& value)
+{ return stream.Read(&value, sizeof(value)); }
+
+//-----------------------------------------------------------------------------
+//      文字列を読み込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool ReadString(Stream& stream, std::string& value)
+{
+    uint32_t size;
+    if (!ReadU32(stream, size) || size > kMaxStringSize)
+    { return false; }
+
+    value.resize(size);
+    return stream.Read(&value[0], size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// OutputCapture class
+///////////////////////////////////////////////////////////////////////////////
+class OutputCapture
+{
+public:
+    OutputCapture()
+    : m_pOut    (nullptr)
+    , m_pErr    (nullptr)
+    , m_SavedOut(-1)
+    , m_SavedErr(-1)
+    { /* DO_NOTHING */ }
+
+    ~OutputCapture()
+    {
+        if (m_pOut != nullptr)
+        { fclose(m_pOut); }
+
+        if (m_pErr != nullptr)
+        { fclose(m_pErr); }
+    }
+
+    // 標準出力と標準エラー出力を一時ファイルに切り替える.
+    bool Begin()
+    {
+        fflush(stdout);
+        fflush(stderr);
+
+#if defined(_WIN32)
+        if (tmpfile_s(&m_pOut) != 0 || tmpfile_s(&m_pErr) != 0)
+        { return false; }
+
+        m_SavedOut = _dup(_fileno(stdout));
+        m_SavedErr = _dup(_fileno(stderr));
+        return m_SavedOut >= 0 && m_SavedErr >= 0
+            && _dup2(_fileno(m_pOut), _fileno(stdout)) == 0
+            && _dup2(_fileno(m_pErr), _fileno(stderr)) == 0;
+#else
+        m_pOut = tmpfile();
+        m_pErr = tmpfile();
+        if (m_pOut == nullptr || m_pErr == nullptr)
+        { return false; }
+
+        m_SavedOut = dup(STDOUT_FILENO);
+        m_SavedErr = dup(STDERR_FILENO);
+        return m_SavedOut >= 0 && m_SavedErr >= 0
+            && dup2(fileno(m_pOut), STDOUT_FILENO) >= 0
+            && dup2(fileno(m_pErr), STDERR_FILENO) >= 0;
+#endif
+    }
+
+    // 元に戻して書き込まれた内容を取得する.
+    void End(std::string& out, std::string& err)
+    {
+        fflush(stdout);
+        fflush(stderr);
+
+#if defined(_WIN32)
+        if (m_SavedOut >= 0)
+        {
+            _dup2(m_SavedOut, _fileno(stdout));
+            _close(m_SavedOut);
+        }
+        if (m_SavedErr >= 0)
+        {
+            _dup2(m_SavedErr, _fileno(stderr));
+            _close(m_SavedErr);
+        }
+#else
+        if (m_SavedOut >= 0)
+        {
+            dup2(m_SavedOut, STDOUT_FILENO);
+            close(m_SavedOut);
+        }
+        if (m_SavedErr >= 0)
+        {
+            dup2(m_SavedErr, STDERR_FILENO);
+            close(m_SavedErr);
+        }
+#endif
+        m_SavedOut = -1;
+        m_SavedErr = -1;
+
+        ReadAll(m_pOut, out);
+        ReadAll(m_pErr, err);
+    }
+
+private:
+    FILE*   m_pOut;
+    FILE*   m_pErr;
+    int     m_SavedOut;
+    int     m_SavedErr;
+
+    static void ReadAll(FILE* pFile, std::string& result)
+    {
+        result.clear();
+        if (pFile == nullptr || fseek(pFile, 0, SEEK_SET) != 0)
+        { return; }
+
+        char buffer[4096];
+        size_t size;
+        while((size = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        { result.append(buffer, size); }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Request structure
+///////////////////////////////////////////////////////////////////////////////
+struct Request
+{
+    std::string                 Key;        //!< 同じ要求を判定するキー.
+    std::string                 WorkDir;    //!< 要求元の作業ディレクトリ.
+    std::vector<std::string>    Args;       //!< コマンドライン引数.
+    std::vector<Socket>         Clients;    //!< 結果を返す要求元.
+};
+
+//-----------------------------------------------------------------------------
+//      送受信のタイムアウトを設定します.
+//-----------------------------------------------------------------------------
+bool SetTimeout(Socket socket, uint32_t msec)
+{
+#if defined(_WIN32)
+    DWORD value = msec;
+#else
+    timeval value = {};
+    value.tv_sec  = msec / 1000;
+    value.tv_usec = (msec % 1000) * 1000;
+#endif
+    auto ptr = reinterpret_cast<const char*>(&value);
+    return setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, ptr, sizeof(value)) == 0
+        && setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, ptr, sizeof(value)) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//      作業ディレクトリと引数を受け取ります.
+//-----------------------------------------------------------------------------
+bool ReceiveRequest(Socket client, Request& request)
+{
+    // 送ってこない要求元はタイムアウトで打ち切る.
+    if (!SetTimeout(client, kSocketTimeout))
+    { return false; }
+
+    SocketStream stream(client);
+    uint8_t      type  = 0;
+    uint32_t     count = 0;
+    if (!stream.Read(&type, sizeof(type))
+     || type != kMessageRequest
+     || !ReadString(stream, request.WorkDir)
+     || !ReadU32(stream, count)
+     || count > kMaxArgCount)
+    { return false; }
+
+    request.Args.resize(count);
+    for(uint32_t i=0; i<count; ++i)
+    {
+        if (!ReadString(stream, request.Args[i]))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了コードと出力を要求元に返します.
+//-----------------------------------------------------------------------------
+void SendReply(Socket client, int exitCode, const std::string& out, const std::string& err)
+{
+    BufferStream reply;
+    WriteU32   (reply, uint32_t(exitCode));
+    WriteString(reply, out);
+    WriteString(reply, err);
+
+    SocketStream stream(client);
+    stream.Write(reply.GetBuffer().data(), reply.GetBuffer().size());
+    CloseSocket(client);
+}
+
+} // namespace
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      ローカルソケットで要求を待ち受けて処理します.
+//-----------------------------------------------------------------------------
+int RunDaemon(const std::string& socketPath, const DaemonHandler& handler)
+{
+    sockaddr_un addr;
+    if (!InitSocket() || !MakeAddress(socketPath, addr))
+    {
+        fprintf_s(stderr, "Error : Invalid Socket Path. path = %s\n", socketPath.c_str());
+        return -1;
+    }
+
+    auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == kInvalidSocket)
+    {
+        fprintf_s(stderr, "Error : Socket Create Failed.\n");
+        return -1;
+    }
+
+    // 前回のソケットファイルが残っていれば削除する.
+    remove(socketPath.c_str());
+
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0
+     || listen(listener, SOMAXCONN) != 0)
+    {
+        fprintf_s(stderr, "Error : Socket Listen Failed. path = %s\n", socketPath.c_str());
+        CloseSocket(listener);
+        return -1;
+    }
+
+    printf_s("Daemon : listening, path = %s\n", socketPath.c_str());
+    fflush(stdout);
+
+    std::mutex                                      mutex;
+    std::condition_variable                         cond;
+    std::deque<std::shared_ptr<Request>>            queue;
+    std::map<std::string, std::shared_ptr<Request>> pending;
+    bool                                            stop    = false;
+    auto                                            baseDir = GetWorkDir();
+
+    // 標準出力を切り替えて処理するので要求は1件ずつ処理する.
+    // ジョブのコンパイルはスケジューラが並列に行う.
+    std::thread processor([&]()
+    {
+        for(;;)
+        {
+            std::shared_ptr<Request> request;
+            {
+                std::unique_lock<std::mutex> locker(mutex);
+                cond.wait(locker, [&]() { return stop || !queue.empty(); });
+                if (queue.empty())
+                { break; }
+
+                // 処理を始めた要求には合流させない. 開始後に更新された入力を見逃さないため.
+                request = queue.front();
+                queue.pop_front();
+                pending.erase(request->Key);
+            }
+
+            auto begin    = std::chrono::steady_clock::now();
+            auto exitCode = -1;
+
+            std::string out;
+            std::string err;
+            if (!SetWorkDir(request->WorkDir))
+            { err = "Error : Working Directory Not Found. path = " + request->WorkDir + "\n"; }
+            else
+            {
+                OutputCapture capture;
+                if (capture.Begin())
+                {
+                    exitCode = handler(request->Args);
+                    capture.End(out, err);
+                }
+                else
+                {
+                    capture.End(out, err);
+                    err += "Error : Output Capture Failed.\n";
+                }
+            }
+            SetWorkDir(baseDir);
+
+            for(auto client : request->Clients)
+            { SendReply(client, exitCode, out, err); }
+
+            auto end = std::chrono::steady_clock::now();
+            printf_s("Daemon : exit = %d, clients = %zu, time = %.2f ms, dir = %s\n",
+                exitCode,
+                request->Clients.size(),
+                std::chrono::duration<double, std::milli>(end - begin).count(),
+                request->WorkDir.c_str());
+            fflush(stdout);
+        }
+    });
+
+    size_t  receivers = 0;                  // 受信中の接続数.
+    auto    closing   = false;              // 終了要求を受け取ったかどうか.
+    auto    stopper   = kInvalidSocket;     // 終了要求の要求元.
+
+    // 要求の受信は接続ごとのスレッドで行い, 送ってこない要求元で待ち受けを止めない.
+    auto receive = [&](Socket client)
+    {
+        Request request;
+        if (!ReceiveRequest(client, request))
+        { CloseSocket(client); }
+        else if (request.Args.size() == 1 && request.Args[0] == kShutdown)
+        {
+            auto wake = false;
+            {
+                std::lock_guard<std::mutex> locker(mutex);
+                if (closing)
+                { CloseSocket(client); }
+                else
+                {
+                    closing  = true;
+                    stopper  = client;
+                    wake     = true;
+                }
+            }
+
+            // accept() で待っている待ち受けスレッドを起こす.
+            if (wake)
+            {
+                auto dummy = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (dummy != kInvalidSocket)
+                {
+                    connect(dummy, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+                    CloseSocket(dummy);
+                }
+            }
+        }
+        else
+        {
+            request.Key = request.WorkDir;
+            for(auto& arg : request.Args)
+            {
+                request.Key += '\0';
+                request.Key += arg;
+            }
+
+            std::lock_guard<std::mutex> locker(mutex);
+
+            // 処理待ちの同じ要求があれば合流する.
+            auto itr = pending.find(request.Key);
+            if (itr != pending.end())
+            { itr->second->Clients.push_back(client); }
+            else
+            {
+                auto ptr = std::make_shared<Request>(std::move(request));
+                ptr->Clients.push_back(client);
+                pending[ptr->Key] = ptr;
+                queue.push_back(ptr);
+            }
+        }
+
+        // 待ち受け側が先に抜けないよう, ロックを保持したまま通知する.
+        std::lock_guard<std::mutex> locker(mutex);
+        receivers--;
+        cond.notify_all();
+    };
+
+    auto result = 0;
+    for(;;)
+    {
+        auto client = accept(listener, nullptr, nullptr);
+        if (client == kInvalidSocket)
+        {
+        #if !defined(_WIN32)
+            if (errno == EINTR)
+            { continue; }
+        #endif
+            fprintf_s(stderr, "Error : Socket Accept Failed. path = %s\n", socketPath.c_str());
+            result = -1;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            if (closing)
+            {
+                CloseSocket(client);
+                break;
+            }
+            receivers++;
+        }
+
+        std::thread(receive, client).detach();
+    }
+
+    // 受信中の要求と処理待ちの要求を全て終えてから終了する.
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        cond.wait(locker, [&]() { return receivers == 0; });
+        stop = true;
+    }
+    cond.notify_all();
+    processor.join();
+
+    if (stopper != kInvalidSocket)
+    { SendReply(stopper, 0, "Daemon : shutdown.\n", ""); }
+
+    CloseSocket(listener);
+    remove(socketPath.c_str());
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      コマンドライン引数をデーモンに転送して処理させます.
+//-----------------------------------------------------------------------------
+bool RunDaemonClient(const std::string& socketPath, const std::vector<std::string>& args, int& exitCode)
+{
+    exitCode = -1;
+
+    sockaddr_un addr;
+    if (!InitSocket() || !MakeAddress(socketPath, addr))
+    { return false; }
+
+    auto client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client == kInvalidSocket)
+    { return false; }
+
+    if (connect(client, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        CloseSocket(client);
+        return false;
+    }
+
+    BufferStream request;
+    request.Write(&kMessageRequest, sizeof(kMessageRequest));
+    WriteString(request, GetWorkDir());
+    WriteU32   (request, uint32_t(args.size()));
+    for(auto& arg : args)
+    { WriteString(request, arg); }
+
+    SocketStream stream(client);
+    uint32_t     code = 0;
+    std::string  out;
+    std::string  err;
+    if (!stream.Write(request.GetBuffer().data(), request.GetBuffer().size())
+     || !ReadU32   (stream, code)
+     || !ReadString(stream, out)
+     || !ReadString(stream, err))
+    {
+        fprintf_s(stderr, "Error : Daemon Connection Lost. path = %s\n", socketPath.c_str());
+        CloseSocket(client);
+        return true;
+    }
+    CloseSocket(client);
+
+    fwrite(out.data(), 1, out.size(), stdout);
+    fwrite(err.data(), 1, err.size(), stderr);
+    fflush(stdout);
+    fflush(stderr);
+
+    exitCode = int(code);
+    return true;
+}
+
+} // namespace asura
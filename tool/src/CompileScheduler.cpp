@@ -0,0 +1,212 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompileScheduler.cpp
+// Desc : Shader Compile Scheduler Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "CompileScheduler.h"
+#include <cstdio>
+#include <map>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// CompileScheduler class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+CompileScheduler::CompileScheduler(ShaderCompilerBackend* pBackend, uint32_t threadCount, CompileCache* pCache)
+: m_pBackend    (pBackend)
+, m_pCache      (pCache)
+, m_Pool        (threadCount)
+, m_JobCount    (0)
+, m_UniqueCount (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+CompileScheduler::~CompileScheduler()
+{ m_Pool.Wait(); }
+
+//-----------------------------------------------------------------------------
+//      コンパイルジョブを並列に実行し, 完了まで待機します.
+//-----------------------------------------------------------------------------
+bool CompileScheduler::Run(const std::vector<CompileJob>& jobs)
+{
+    std::vector<CompileResult>          results(jobs.size());
+    std::vector<std::string>            keys   (jobs.size());
+    std::vector<std::vector<size_t>>    groups;
+
+    // 入力が同じジョブはまとめて, 先頭のジョブだけをコンパイルする.
+    {
+        std::map<std::string, size_t> indices;
+        for(size_t i=0; i<jobs.size(); ++i)
+        {
+            keys[i] = MakeKey(jobs[i]);
+
+            auto itr = indices.find(keys[i]);
+            if (itr != indices.end())
+            {
+                groups[itr->second].push_back(i);
+                continue;
+            }
+
+            indices[keys[i]] = groups.size();
+            groups.push_back(std::vector<size_t>(1, i));
+        }
+    }
+
+    m_JobCount    += uint32_t(jobs.size());
+    m_UniqueCount += uint32_t(groups.size());
+
+    // 他の呼び出し元のジョブと混ざるので, プール全体ではなく自分のジョブだけを待つ.
+    std::mutex              mutex;
+    std::condition_variable done;
+    auto                    remain = groups.size();
+
+    for(size_t i=0; i<groups.size(); ++i)
+    {
+        m_Pool.Push([&, i]()
+        {
+            auto& group  = groups[i];
+            auto  index  = group[0];
+
+            Execute(jobs[index], keys[index], results[index]);
+
+            for(size_t j=1; j<group.size(); ++j)
+            { Duplicate(jobs[index], results[index], jobs[group[j]], results[group[j]]); }
+
+            // 出力済みのバイナリは保持しない.
+            results[index].Binary.clear();
+            results[index].Binary.shrink_to_fit();
+
+            std::lock_guard<std::mutex> locker(mutex);
+            if (--remain == 0)
+            { done.notify_all(); }
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        done.wait(locker, [&]{ return remain == 0; });
+    }
+
+    // 実行順に依らず, ジョブの順番でエラーを出力する.
+    auto success = true;
+    for(size_t i=0; i<jobs.size(); ++i)
+    {
+        if (results[i].Success)
+        { continue; }
+
+        // 末尾の改行は取り除く.
+        auto& message = results[i].Message;
+        while (!message.empty() && (message.back() == '\n' || message.back() == '\r'))
+        { message.pop_back(); }
+
+        fprintf_s(stderr, "Error : Shader Compile Failed. entry = %s, profile = %s, path = %s, message = %s\n",
+            jobs[i].EntryPoint.c_str(),
+            jobs[i].Profile.c_str(),
+            jobs[i].OutputPath.c_str(),
+            message.c_str());
+        success = false;
+    }
+
+    return success;
+}
+
+//-----------------------------------------------------------------------------
+//      ジョブの出力を一意に決めるキーを生成します.
+//-----------------------------------------------------------------------------
+std::string CompileScheduler::MakeKey(const CompileJob& job) const
+{ return CompileCache::MakeKey(job, *m_pBackend); }
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッド数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t CompileScheduler::GetThreadCount() const
+{ return m_Pool.GetThreadCount(); }
+
+//-----------------------------------------------------------------------------
+//      統計情報を取得します.
+//-----------------------------------------------------------------------------
+CompileSchedulerStats CompileScheduler::GetStats() const
+{
+    CompileSchedulerStats result;
+    result.JobCount     = m_JobCount;
+    result.UniqueCount  = m_UniqueCount;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      1つのジョブをコンパイルして出力します.
+//-----------------------------------------------------------------------------
+void CompileScheduler::Execute(const CompileJob& job, const std::string& key, CompileResult& result)
+{
+    if (m_pCache != nullptr && m_pCache->Load(key, result.Binary))
+    {
+        result.Success = true;
+    }
+    else
+    {
+        if (!m_pBackend->Compile(job, result))
+        {
+            result.Success = false;
+            return;
+        }
+
+        if (m_pCache != nullptr)
+        { m_pCache->Store(key, result.Binary); }
+    }
+
+    if (!WriteFileAtomic(job.OutputPath, result.Binary.data(), result.Binary.size()))
+    {
+        result.Message = "File Write Failed.";
+        result.Success = false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      重複したジョブの出力を, コンパイル済みの結果から作成します.
+//-----------------------------------------------------------------------------
+void CompileScheduler::Duplicate
+(
+    const CompileJob&       srcJob,
+    const CompileResult&    srcResult,
+    const CompileJob&       dstJob,
+    CompileResult&          dstResult
+)
+{
+    if (!srcResult.Success)
+    {
+        dstResult.Message = srcResult.Message;
+        dstResult.Success = false;
+        return;
+    }
+
+    // 同じファイルに出力するジョブはコンパイル済みの出力をそのまま使う.
+    if (srcJob.OutputPath == dstJob.OutputPath)
+    {
+        dstResult.Success = true;
+        return;
+    }
+
+    // ハードリンクを作れない場合はコピーする.
+    if (!LinkFileAtomic(srcJob.OutputPath, dstJob.OutputPath)
+     && !WriteFileAtomic(dstJob.OutputPath, srcResult.Binary.data(), srcResult.Binary.size()))
+    {
+        dstResult.Message = "File Write Failed.";
+        dstResult.Success = false;
+        return;
+    }
+
+    dstResult.Success = true;
+}
+
+} // namespace asura
@@ -0,0 +1,694 @@
+﻿//-----------------------------------------------------------------------------
+// File : CompilerWorker.cpp
+// Desc : Shader Compiler Worker Process Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "CompilerWorker.h"
+#include <cstdio>
+#include <cerrno>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <io.h>
+    #include <fcntl.h>
+#else
+    #include <spawn.h>
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    extern char** environ;
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint8_t  kMessageSource   = 'S';           // ソースコードの転送.
+static const uint8_t  kMessageCompile  = 'C';           // コンパイル要求.
+static const uint32_t kMaxStringSize   = 0x40000000;    // 受け付ける文字列の最大サイズ.
+static const uint32_t kMaxDefineCount  = 0x10000;       // 受け付けるマクロ定義の最大数.
+
+///////////////////////////////////////////////////////////////////////////////
+// FileStream class
+///////////////////////////////////////////////////////////////////////////////
+class FileStream
+{
+public:
+    FileStream(FILE* pFile)
+    : m_pFile(pFile)
+    { /* DO_NOTHING */ }
+
+    bool Read(void* pData, size_t size)
+    { return size == 0 || fread(pData, size, 1, m_pFile) == 1; }
+
+    bool Write(const void* pData, size_t size)
+    { return size == 0 || fwrite(pData, size, 1, m_pFile) == 1; }
+
+private:
+    FILE*   m_pFile;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// BufferStream class
+///////////////////////////////////////////////////////////////////////////////
+class BufferStream
+{
+public:
+    bool Write(const void* pData, size_t size)
+    {
+        m_Buffer.append(static_cast<const char*>(pData), size);
+        return true;
+    }
+
+    const std::string& GetBuffer() const
+    { return m_Buffer; }
+
+private:
+    std::string     m_Buffer;
+};
+
+//-----------------------------------------------------------------------------
+//      32bit値を書き込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool WriteU32(Stream& stream, uint32_t value)
+{ return stream.Write(&value, sizeof(value)); }
+
+//-----------------------------------------------------------------------------
+//      サイズ付きでデータを書き込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool WriteData(Stream& stream, const void* pData, size_t size)
+{ return WriteU32(stream, uint32_t(size)) && stream.Write(pData, size); }
+
+//-----------------------------------------------------------------------------
+//      サイズ付きで文字列を書き込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool WriteString(Stream& stream, const std::string& value)
+{ return WriteData(stream, value.data(), value.size()); }
+
+//-----------------------------------------------------------------------------
+//      32bit値を読み込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream>
+bool ReadU32(Stream& stream, uint32_t& value)
+{ return stream.Read(&value, sizeof(value)); }
+
+//-----------------------------------------------------------------------------
+//      サイズ付きのデータを読み込みます.
+//-----------------------------------------------------------------------------
+template<typename Stream, typename Container>
+bool ReadData(Stream& stream, Container& value)
+{
+    uint32_t size;
+    if (!ReadU32(stream, size) || size > kMaxStringSize)
+    { return false; }
+
+    value.resize(size);
+    return size == 0 || stream.Read(&value[0], size);
+}
+
+//-----------------------------------------------------------------------------
+//      応答用に標準出力を複製してから, 標準出力を標準エラー出力に切り替えます.
+//      コンパイラのプロセスは標準出力を継承するので, 書き込まれても応答が壊れないようにします.
+//-----------------------------------------------------------------------------
+FILE* DetachStdout()
+{
+    fflush(stdout);
+
+#if defined(_WIN32)
+    auto fd = _dup(_fileno(stdout));
+    if (fd < 0)
+    { return nullptr; }
+
+    // 複製したハンドルはコンパイラのプロセスに継承させない.
+    SetHandleInformation(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), HANDLE_FLAG_INHERIT, 0);
+
+    // CreateProcessA() には STD_OUTPUT_HANDLE が渡るので合わせて切り替える.
+    if (_dup2(_fileno(stderr), _fileno(stdout)) != 0
+     || !SetStdHandle(STD_OUTPUT_HANDLE, reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(stdout)))))
+    {
+        _close(fd);
+        return nullptr;
+    }
+
+    _setmode(fd, _O_BINARY);
+    return _fdopen(fd, "wb");
+#else
+    auto fd = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0)
+    { return nullptr; }
+
+    if (dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    return fdopen(fd, "wb");
+#endif
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// WorkerProcess class
+///////////////////////////////////////////////////////////////////////////////
+class WorkerProcess
+{
+public:
+    //------------------------------------------------------------------------
+    //      コンストラクタです.
+    //------------------------------------------------------------------------
+    WorkerProcess()
+    { /* DO_NOTHING */ }
+
+    //------------------------------------------------------------------------
+    //      デストラクタです.
+    //------------------------------------------------------------------------
+    ~WorkerProcess()
+    { Stop(false); }
+
+    //------------------------------------------------------------------------
+    //      起動しているかどうか.
+    //------------------------------------------------------------------------
+    bool IsRunning() const
+    { return m_Running; }
+
+    //------------------------------------------------------------------------
+    //      プロセスを起動します.
+    //------------------------------------------------------------------------
+    bool Start(const std::vector<std::string>& command)
+    {
+        // 他のワーカーのパイプが子プロセスに継承されないよう, 起動は1つずつ行う.
+        static std::mutex s_Mutex;
+        std::lock_guard<std::mutex> locker(s_Mutex);
+
+        m_SourceHash.clear();
+
+    #if defined(_WIN32)
+        std::string cmd;
+        for(size_t i=0; i<command.size(); ++i)
+        {
+            if (i > 0)
+            { cmd += " "; }
+
+            cmd += "\"";
+            cmd += command[i];
+            cmd += "\"";
+        }
+
+        SECURITY_ATTRIBUTES attr = {};
+        attr.nLength        = sizeof(attr);
+        attr.bInheritHandle = TRUE;
+
+        HANDLE hChildIn  = nullptr;
+        HANDLE hChildOut = nullptr;
+        if (!CreatePipe(&hChildIn, &m_hWrite, &attr, 0))
+        { return false; }
+
+        if (!CreatePipe(&m_hRead, &hChildOut, &attr, 0))
+        {
+            CloseHandle(hChildIn);
+            CloseHandle(m_hWrite);
+            m_hWrite = nullptr;
+            return false;
+        }
+
+        // 親側の端は継承させない.
+        SetHandleInformation(m_hWrite, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(m_hRead,  HANDLE_FLAG_INHERIT, 0);
+
+        STARTUPINFOA        startup_info = {};
+        PROCESS_INFORMATION process_info = {};
+
+        startup_info.cb         = sizeof(STARTUPINFOA);
+        startup_info.dwFlags    = STARTF_USESTDHANDLES;
+        startup_info.hStdInput  = hChildIn;
+        startup_info.hStdOutput = hChildOut;
+        startup_info.hStdError  = GetStdHandle(STD_ERROR_HANDLE);
+
+        auto ret = CreateProcessA(
+            nullptr,
+            &cmd[0],
+            nullptr,
+            nullptr,
+            TRUE,
+            NORMAL_PRIORITY_CLASS,
+            nullptr,
+            nullptr,
+            &startup_info,
+            &process_info);
+
+        CloseHandle(hChildIn);
+        CloseHandle(hChildOut);
+
+        if (ret == 0)
+        {
+            CloseHandle(m_hWrite);
+            CloseHandle(m_hRead);
+            m_hWrite = nullptr;
+            m_hRead  = nullptr;
+            return false;
+        }
+
+        CloseHandle(process_info.hThread);
+        m_hProcess = process_info.hProcess;
+    #else
+        int toChild[2];
+        int fromChild[2];
+        if (pipe(toChild) != 0)
+        { return false; }
+
+        if (pipe(fromChild) != 0)
+        {
+            close(toChild[0]);
+            close(toChild[1]);
+            return false;
+        }
+
+        for(auto fd : { toChild[0], toChild[1], fromChild[0], fromChild[1] })
+        { fcntl(fd, F_SETFD, FD_CLOEXEC); }
+
+        std::vector<char*> argv;
+        for(auto& arg : command)
+        { argv.push_back(const_cast<char*>(arg.c_str())); }
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, toChild[0],   0);
+        posix_spawn_file_actions_adddup2(&actions, fromChild[1], 1);
+
+        auto ret = posix_spawnp(&m_Pid, argv[0], &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+
+        close(toChild[0]);
+        close(fromChild[1]);
+
+        if (ret != 0)
+        {
+            close(toChild[1]);
+            close(fromChild[0]);
+            return false;
+        }
+
+        m_Write = toChild[1];
+        m_Read  = fromChild[0];
+    #endif
+
+        m_Running = true;
+        return true;
+    }
+
+    //------------------------------------------------------------------------
+    //      プロセスを終了します.
+    //------------------------------------------------------------------------
+    void Stop(bool kill)
+    {
+        if (!m_Running)
+        { return; }
+
+    #if defined(_WIN32)
+        if (kill)
+        { TerminateProcess(m_hProcess, 1); }
+
+        // 入力を閉じるとワーカーは終了する.
+        CloseHandle(m_hWrite);
+        CloseHandle(m_hRead);
+        WaitForSingleObject(m_hProcess, INFINITE);
+        CloseHandle(m_hProcess);
+
+        m_hWrite   = nullptr;
+        m_hRead    = nullptr;
+        m_hProcess = nullptr;
+    #else
+        if (kill)
+        { ::kill(m_Pid, SIGKILL); }
+
+        // 入力を閉じるとワーカーは終了する.
+        close(m_Write);
+        close(m_Read);
+
+        int status;
+        while (waitpid(m_Pid, &status, 0) < 0 && errno == EINTR)
+        { /* DO_NOTHING */ }
+
+        m_Write = -1;
+        m_Read  = -1;
+        m_Pid   = 0;
+    #endif
+
+        m_Running = false;
+    }
+
+    //------------------------------------------------------------------------
+    //      データを書き込みます.
+    //------------------------------------------------------------------------
+    bool Write(const void* pData, size_t size)
+    {
+        auto ptr = static_cast<const char*>(pData);
+        while (size > 0)
+        {
+        #if defined(_WIN32)
+            DWORD written = 0;
+            if (!WriteFile(m_hWrite, ptr, DWORD(size), &written, nullptr))
+            { return false; }
+        #else
+            auto written = write(m_Write, ptr, size);
+            if (written < 0 && errno == EINTR)
+            { continue; }
+            if (written <= 0)
+            { return false; }
+        #endif
+            ptr  += written;
+            size -= size_t(written);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------
+    //      データを読み込みます.
+    //------------------------------------------------------------------------
+    bool Read(void* pData, size_t size)
+    {
+        auto ptr = static_cast<char*>(pData);
+        while (size > 0)
+        {
+        #if defined(_WIN32)
+            DWORD count = 0;
+            if (!ReadFile(m_hRead, ptr, DWORD(size), &count, nullptr) || count == 0)
+            { return false; }
+        #else
+            auto count = read(m_Read, ptr, size);
+            if (count < 0 && errno == EINTR)
+            { continue; }
+            if (count <= 0)
+            { return false; }
+        #endif
+            ptr  += count;
+            size -= size_t(count);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------
+    //      ジョブを送信して結果を受け取ります.
+    //------------------------------------------------------------------------
+    bool Execute(const CompileJob& job, CompileResult& result)
+    {
+        BufferStream request;
+
+        // ワーカーは直前のソースコードだけを保持するので, 変わった時だけ送る.
+        if (m_SourceHash != job.SourceHash)
+        {
+            uint8_t type = kMessageSource;
+            request.Write(&type, sizeof(type));
+            WriteString(request, job.SourceHash);
+            WriteString(request, job.SourcePath);
+            WriteData  (request, job.pSource, job.SourceSize);
+        }
+
+        uint8_t type = kMessageCompile;
+        request.Write(&type, sizeof(type));
+        WriteString(request, job.SourceHash);
+        WriteString(request, job.EntryPoint);
+        WriteString(request, job.Profile);
+        WriteU32   (request, job.Flags);
+        WriteU32   (request, uint32_t(job.Defines.size()));
+        for(auto& define : job.Defines)
+        { WriteString(request, define); }
+
+        if (!Write(request.GetBuffer().data(), request.GetBuffer().size()))
+        { return false; }
+
+        m_SourceHash = job.SourceHash;
+
+        uint32_t status;
+        if (!ReadU32(*this, status)
+         || !ReadData(*this, result.Binary)
+         || !ReadData(*this, result.Message))
+        { return false; }
+
+        result.Success = (status == 0);
+        return true;
+    }
+
+private:
+    bool            m_Running = false;      //!< 起動しているかどうか.
+    std::string     m_SourceHash;           //!< ワーカーが保持しているソースコードのハッシュ値.
+#if defined(_WIN32)
+    HANDLE          m_hProcess = nullptr;   //!< プロセスハンドル.
+    HANDLE          m_hWrite   = nullptr;   //!< 書き込み用パイプ.
+    HANDLE          m_hRead    = nullptr;   //!< 読み込み用パイプ.
+#else
+    pid_t           m_Pid      = 0;         //!< プロセスID.
+    int             m_Write    = -1;        //!< 書き込み用パイプ.
+    int             m_Read     = -1;        //!< 読み込み用パイプ.
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// WorkerPoolBackend class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+WorkerPoolBackend::WorkerPoolBackend
+(
+    const std::vector<std::string>& command,
+    uint32_t                        count,
+    const ShaderCompilerBackend&    backend
+)
+: m_Command     (command)
+, m_Name        (backend.GetName())
+, m_Version     (backend.GetVersion())
+, m_RestartCount(0)
+{
+#if !defined(_WIN32)
+    // 異常終了したワーカーへの書き込みでプロセスごと終了しないようにする.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    if (count == 0)
+    { count = 1; }
+
+    m_Workers.resize(count);
+    for(auto& worker : m_Workers)
+    {
+        worker.reset(new WorkerProcess());
+        m_Idle.push_back(worker.get());
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+WorkerPoolBackend::~WorkerPoolBackend()
+{ m_Workers.clear(); }
+
+//-----------------------------------------------------------------------------
+//      シェーダをコンパイルします.
+//-----------------------------------------------------------------------------
+bool WorkerPoolBackend::Compile(const CompileJob& job, CompileResult& result)
+{
+    auto pWorker = Acquire();
+
+    for(auto retry=0; retry<2; ++retry)
+    {
+        if (!pWorker->IsRunning() && !pWorker->Start(m_Command))
+        {
+            Release(pWorker);
+            result.Message = "worker launch failed. command = " + m_Command[0];
+            result.Success = false;
+            return false;
+        }
+
+        result.Binary .clear();
+        result.Message.clear();
+
+        if (pWorker->Execute(job, result))
+        {
+            Release(pWorker);
+            return result.Success;
+        }
+
+        // 通信できないワーカーは終了させて, 次の試行で起動し直す.
+        pWorker->Stop(true);
+        m_RestartCount++;
+    }
+
+    Release(pWorker);
+    result.Message = "worker process crashed.";
+    result.Success = false;
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      バックエンド名を取得します.
+//-----------------------------------------------------------------------------
+const char* WorkerPoolBackend::GetName() const
+{ return m_Name.c_str(); }
+
+//-----------------------------------------------------------------------------
+//      バックエンドのバージョンを取得します.
+//-----------------------------------------------------------------------------
+std::string WorkerPoolBackend::GetVersion() const
+{ return m_Version; }
+
+//-----------------------------------------------------------------------------
+//      ワーカープロセス数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t WorkerPoolBackend::GetWorkerCount() const
+{ return uint32_t(m_Workers.size()); }
+
+//-----------------------------------------------------------------------------
+//      ワーカープロセスを再起動した回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t WorkerPoolBackend::GetRestartCount() const
+{ return m_RestartCount; }
+
+//-----------------------------------------------------------------------------
+//      待機中のワーカープロセスを取得します.
+//-----------------------------------------------------------------------------
+WorkerProcess* WorkerPoolBackend::Acquire()
+{
+    std::unique_lock<std::mutex> locker(m_Mutex);
+    m_Released.wait(locker, [this]{ return !m_Idle.empty(); });
+
+    auto pWorker = m_Idle.back();
+    m_Idle.pop_back();
+    return pWorker;
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカープロセスを待機状態に戻します.
+//-----------------------------------------------------------------------------
+void WorkerPoolBackend::Release(WorkerProcess* pWorker)
+{
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        m_Idle.push_back(pWorker);
+    }
+    m_Released.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカープロセスとして, 標準入力から受け取ったジョブをコンパイルします.
+//-----------------------------------------------------------------------------
+int RunCompilerWorker(ShaderCompilerBackend& backend)
+{
+#if defined(_WIN32)
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    std::unique_ptr<FILE, decltype(&fclose)> pOutput(DetachStdout(), &fclose);
+    if (!pOutput)
+    {
+        fprintf_s(stderr, "Error : Worker Output Detach Failed.\n");
+        return -1;
+    }
+
+    FileStream input (stdin);
+    FileStream output(pOutput.get());
+
+    std::string sourceHash;
+    std::string sourcePath;
+    std::string source;
+
+    for(;;)
+    {
+        uint8_t type;
+        if (!input.Read(&type, sizeof(type)))
+        { break; }
+
+        if (type == kMessageSource)
+        {
+            if (!ReadData(input, sourceHash)
+             || !ReadData(input, sourcePath)
+             || !ReadData(input, source))
+            { return -1; }
+        }
+        else if (type == kMessageCompile)
+        {
+            CompileJob job;
+            if (!ReadData(input, job.SourceHash)
+             || !ReadData(input, job.EntryPoint)
+             || !ReadData(input, job.Profile)
+             || !ReadU32 (input, job.Flags))
+            { return -1; }
+
+            uint32_t defineCount;
+            if (!ReadU32(input, defineCount) || defineCount > kMaxDefineCount)
+            { return -1; }
+
+            job.Defines.resize(defineCount);
+            for(auto& define : job.Defines)
+            {
+                if (!ReadData(input, define))
+                { return -1; }
+            }
+
+            job.pSource     = source.data();
+            job.SourceSize  = source.size();
+            job.SourcePath  = sourcePath;
+
+            CompileResult result;
+            if (job.SourceHash != sourceHash)
+            { result.Message = "source code not found."; }
+            else
+            { backend.Compile(job, result); }
+
+            if (!WriteU32   (output, result.Success ? 0 : 1)
+             || !WriteData  (output, result.Binary.data(), result.Binary.size())
+             || !WriteString(output, result.Message)
+             || fflush(pOutput.get()) != 0)
+            { return -1; }
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      実行中のプログラムのファイルパスを取得します.
+//-----------------------------------------------------------------------------
+std::string GetExecutablePath(const char* argv0)
+{
+#if defined(_WIN32)
+    char path[MAX_PATH];
+    auto size = GetModuleFileNameA(nullptr, path, MAX_PATH);
+    if (size > 0 && size < MAX_PATH)
+    { return std::string(path, size); }
+#else
+    char path[4096];
+    auto size = readlink("/proc/self/exe", path, sizeof(path));
+    if (size > 0 && size_t(size) < sizeof(path))
+    { return std::string(path, size_t(size)); }
+#endif
+
+    return argv0;
+}
+
+} // namespace asura
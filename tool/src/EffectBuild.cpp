@@ -0,0 +1,1312 @@
+﻿//-----------------------------------------------------------------------------
+// File : EffectBuild.cpp
+// Desc : Effect Build Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "EffectBuild.h"
+#include "Sha256.h"
+#include "BuildManifest.h"
+#include "SourceGraph.h"
+#include "VariantCollapse.h"
+#include "ShaderPackWriter.h"
+#include "VariationInfoWriter.h"
+#include "MappedFile.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char* kShaderPrefix[] = {
+    "vs",
+    "ds",
+    "gs",
+    "hs",
+    "ps",
+    "cs",
+    "as",
+    "ms"
+};
+static_assert(std::size(kShaderPrefix) == asura::SHADER_TYPE_COUNT, "kShaderPrefix must cover every SHADER_TYPE.");
+
+///////////////////////////////////////////////////////////////////////////////
+// BatchResult
+///////////////////////////////////////////////////////////////////////////////
+struct BatchResult
+{
+    std::string     OutputDir;          //!< 出力先ディレクトリ.
+    bool            Success = false;    //!< 成功したかどうか.
+    double          Time    = 0.0;      //!< 処理時間(ミリ秒).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// PackItem
+///////////////////////////////////////////////////////////////////////////////
+struct PackItem
+{
+    std::string     Technique;  //!< テクニック名.
+    std::string     Pass;       //!< パス名.
+    std::string     Stage;      //!< シェーダステージ名.
+    std::string     Key;        //!< キーワードの組み合わせを表すキー.
+    std::string     Path;       //!< コンパイル結果のファイルパス.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CollapseStats
+///////////////////////////////////////////////////////////////////////////////
+struct CollapseStats
+{
+    size_t      Variants = 0;       //!< 組み合わせの数.
+    size_t      Unique   = 0;       //!< コンパイルする組み合わせの数.
+    double      Time     = 0.0;     //!< 処理時間(ミリ秒).
+};
+
+//-----------------------------------------------------------------------------
+//      コンパイル結果を1つのパックファイルにまとめます.
+//-----------------------------------------------------------------------------
+bool WritePack(const std::vector<PackItem>& items, const std::string& packPath, const std::string& inputPath, bool compress, bool verify)
+{
+    asura::ShaderPackWriter writer(compress);
+
+    std::vector<uint8_t> data;
+    for(auto& item : items)
+    {
+        if (!asura::LoadBinary(item.Path, data))
+        {
+            fprintf_s(stderr, "Error : File Read Failed. path = %s\n", item.Path.c_str());
+            return false;
+        }
+
+        writer.Add(item.Technique, item.Pass, item.Stage, item.Key, data);
+    }
+
+    if (!writer.Write(packPath))
+    {
+        fprintf_s(stderr, "Error : Shader Pack Write Failed. path = %s\n", packPath.c_str());
+        return false;
+    }
+
+    // 書き出したファイルを読み直して, 全てのエントリーを引けることを確認する.
+    if (verify && !writer.Verify(packPath))
+    {
+        fprintf_s(stderr, "Error : Shader Pack Verify Failed. path = %s\n", packPath.c_str());
+        return false;
+    }
+
+    auto rawSize    = writer.GetRawSize();
+    auto storedSize = writer.GetStoredSize();
+    printf_s("Pack : entries = %zu, blobs = %zu, size = %llu bytes, raw = %llu bytes, stored = %llu bytes, ratio = %.2f, path = %s\n",
+        writer.GetEntryCount(),
+        writer.GetBlobCount(),
+        static_cast<unsigned long long>(writer.GetFileSize()),
+        static_cast<unsigned long long>(rawSize),
+        static_cast<unsigned long long>(storedSize),
+        (storedSize > 0) ? double(rawSize) / double(storedSize) : 1.0,
+        inputPath.c_str());
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ソースコードを出力します.
+//-----------------------------------------------------------------------------
+bool WriteSourceCode(const asura::FxParser& parser, const char* filename)
+{
+    FILE* pFile;
+
+    auto err = fopen_s(&pFile, filename, "w");
+    if ( err != 0 )
+    {
+        fprintf_s(stderr, "Error : File Open Failed. filename = %s", filename );
+        return false;
+    }
+
+    fprintf_s(pFile,"%s", parser.GetSourceCode());
+    fclose(pFile);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      依存ファイルに書けるようにパスをエスケープします.
+//-----------------------------------------------------------------------------
+std::string EscapeDepPath(const std::string& path)
+{
+    std::string result;
+    result.reserve(path.size());
+
+    for(auto c : path)
+    {
+        if (c == '\\')
+        { result += '/'; }
+        else if (c == ' ' || c == '#')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (c == '$')
+        { result += "$$"; }
+        else
+        { result += c; }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      make / ninja 形式の依存ファイルを出力します.
+//-----------------------------------------------------------------------------
+bool WriteDepFile(const asura::BuildManifest& manifest, const std::string& path, const std::string& target)
+{
+    // 入力ファイルと解決したインクルードファイルを全て列挙する.
+    auto text = EscapeDepPath(target);
+    text += ":";
+
+    for(auto& entry : manifest.GetEntries())
+    {
+        if (entry.Kind != asura::MANIFEST_INPUT)
+        { continue; }
+
+        text += " \\\n  ";
+        text += EscapeDepPath(entry.Path);
+    }
+
+    text += "\n";
+
+    if (!asura::WriteFileAtomic(path, text.data(), text.size()))
+    {
+        fprintf_s(stderr, "Error : Dependency File Write Failed. path = %s\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マニフェストファイルから入力ファイルパスを読み込みます.
+//-----------------------------------------------------------------------------
+bool ReadManifest(const char* path, std::vector<std::string>& result)
+{
+    FILE* pFile;
+
+    auto err = fopen_s(&pFile, path, "r");
+    if ( err != 0 )
+    {
+        fprintf_s(stderr, "Error : File Open Failed. filename = %s\n", path );
+        return false;
+    }
+
+    // 1行1ファイル. 空行と#で始まる行は読み飛ばす.
+    char line[2048];
+    while(fgets(line, sizeof(line), pFile) != nullptr)
+    {
+        std::string value = line;
+
+        auto head = value.find_first_not_of(" \t\r\n");
+        if (head == std::string::npos || value[head] == '#')
+        { continue; }
+
+        auto tail = value.find_last_not_of(" \t\r\n");
+        result.push_back(value.substr(head, tail - head + 1));
+    }
+
+    fclose(pFile);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      出力に影響する設定のハッシュ値を求めます.
+//-----------------------------------------------------------------------------
+std::string GetBuildOption(const asura::Argument& args, const char* argv0, const asura::ShaderCompilerBackend* pBackend)
+{
+    asura::Sha256 hash;
+
+    // asfxc 自身が差し替えられたら全て作り直す.
+    auto path = asura::GetExecutablePath(argv0);
+    hash.Update(path);
+
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0)
+    {
+        hash.Update(std::to_string(uint64_t(info.st_size)));
+        hash.Update(std::to_string(uint64_t(info.st_mtime)));
+    }
+
+    hash.Update(args.OutFxName);
+    hash.Update(args.OutXmlName);
+    hash.Update(args.OutBinName);
+    hash.Update(args.MetaXml    ? "meta_xml" : "");
+    hash.Update(args.MetaBinary ? "meta_bin" : "");
+    hash.Update(args.Compile  ? "compile" : "");
+    hash.Update(args.Strip    ? "strip"   : "");
+    hash.Update(args.StripOut ? "strip_out" : "");
+    hash.Update(args.Collapse ? "collapse"  : "");
+    hash.Update(args.Pack     ? "pack"      : "");
+    hash.Update(args.Compress ? "compress"  : "");
+
+    if (pBackend != nullptr)
+    {
+        hash.Update(pBackend->GetName());
+        hash.Update(pBackend->GetVersion());
+    }
+
+    return hash.Finish();
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカープロセスの起動コマンドを生成します.
+//-----------------------------------------------------------------------------
+std::vector<std::string> GetWorkerCommand(const asura::Argument& args, const char* argv0)
+{
+    // ワーカーは自分自身を -serve 付きで起動し, 同じバックエンドを使わせる.
+    std::vector<std::string> result;
+    result.push_back(asura::GetExecutablePath(argv0));
+    result.push_back("-serve");
+
+    if (args.Fake)
+    {
+        result.push_back("-fake");
+        result.push_back("-fake_delay");
+        result.push_back(std::to_string(args.FakeDelay));
+        result.push_back("-fake_crash");
+        result.push_back(std::to_string(args.FakeCrash));
+
+        if (!args.FakeFail.empty())
+        {
+            result.push_back("-fake_fail");
+            result.push_back(args.FakeFail);
+        }
+    }
+    else if (!args.Compiler.empty())
+    {
+        result.push_back("-compiler");
+        result.push_back(args.Compiler);
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      解析後にファイルが変更されていないかチェックします.
+//-----------------------------------------------------------------------------
+bool IsParseValid(const asura::FxParser& parser, asura::SourceCache& cache)
+{
+    // キャッシュから取り除かれていなければ同じファイルが返る.
+    for(auto& itr : parser.GetSourceFiles())
+    {
+        if (cache.Load(itr.second->FullPath).get() != itr.second.get())
+        { return false; }
+    }
+
+    for(auto& path : parser.GetMissingFiles())
+    {
+        if (cache.Load(path))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      解析結果を保持するキーを求めます.
+//-----------------------------------------------------------------------------
+std::string GetParseKey(const std::string& inputPath)
+{
+    std::string result;
+    result  = asura::GetFullPath(".");
+    result += "|";
+    result += asura::GetFullPath(inputPath);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      エフェクトファイルを解析します.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const asura::FxParser> ParseEffect
+(
+    const std::string&      inputPath,
+    asura::SourceCache*     pCache,
+    asura::ParseCache*      pParsed
+)
+{
+    // 常駐している場合は変更されていない解析結果を再利用する.
+    std::string key;
+    if (pParsed != nullptr && pCache != nullptr)
+    {
+        key = GetParseKey(inputPath);
+
+        std::shared_ptr<const asura::FxParser> parser;
+        {
+            std::lock_guard<std::mutex> locker(pParsed->Mutex);
+            auto itr = pParsed->Parsers.find(key);
+            if (itr != pParsed->Parsers.end())
+            { parser = itr->second; }
+        }
+
+        if (parser && IsParseValid(*parser, *pCache))
+        { return parser; }
+    }
+
+    auto parser = std::make_shared<asura::FxParser>();
+    parser->SetSourceCache(pCache);
+
+    if (!parser->Parse(inputPath.c_str()))
+    { return nullptr; }
+
+    if (!key.empty())
+    {
+        std::lock_guard<std::mutex> locker(pParsed->Mutex);
+        pParsed->Parsers[key] = parser;
+    }
+
+    return parser;
+}
+
+//-----------------------------------------------------------------------------
+//      エフェクトのステートを共通のステートテーブルに登録します.
+//-----------------------------------------------------------------------------
+template<typename T>
+bool AddRenderStates(const T& source, const std::string& inputPath, asura::RenderStateTable& table)
+{
+    if (!table.Add(source))
+    {
+        fprintf_s(stderr, "Error : Render State Id Collision. path = %s\n", inputPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      複数のエフェクトファイルを並列に処理します.
+//-----------------------------------------------------------------------------
+bool ProcessBatch
+(
+    const asura::Argument&      args,
+    asura::SourceCache*         pCache,
+    asura::ParseCache*          pParsed,
+    asura::CompileScheduler*    pScheduler
+)
+{
+    auto begin = std::chrono::steady_clock::now();
+
+    // 入力ごとに出力先ディレクトリを作成.
+    std::vector<BatchResult> results(args.InputPaths.size());
+    std::set<std::string>    used;
+    for(size_t i=0; i<args.InputPaths.size(); ++i)
+    {
+        results[i].OutputDir = asura::GetBatchOutputDir(args.OutputDir, args.InputPaths[i], used);
+        if (!CreateDirectoryA(results[i].OutputDir.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            fprintf_s(stderr, "Error : Create Directory Failed. path = %s\n", results[i].OutputDir.c_str());
+            return false;
+        }
+    }
+
+    // 共通のインクルードファイルは全ワーカーで共有する.
+    asura::SourceCache       localCache;
+    asura::ThreadPool        pool(args.ThreadCount);
+    asura::RenderStateTable  states;
+    auto& cache = (pCache != nullptr) ? *pCache : localCache;
+
+    for(size_t i=0; i<args.InputPaths.size(); ++i)
+    {
+        pool.Push([&, i]()
+        {
+            auto start = std::chrono::steady_clock::now();
+            results[i].Success = asura::ProcessFile(args.InputPaths[i], results[i].OutputDir, args, &cache, pParsed, pScheduler, &states);
+            auto end   = std::chrono::steady_clock::now();
+            results[i].Time = std::chrono::duration<double, std::milli>(end - start).count();
+        });
+    }
+
+    pool.Wait();
+
+    auto end = std::chrono::steady_clock::now();
+
+    uint32_t failed = 0;
+    for(size_t i=0; i<results.size(); ++i)
+    {
+        printf_s("%10.2f ms : %s%s\n", results[i].Time, args.InputPaths[i].c_str(), results[i].Success ? "" : " (failed)");
+        if (!results[i].Success)
+        { failed++; }
+    }
+
+    printf_s("Total : %zu files, %u failed, %u threads, %zu source files, wall = %.2f ms\n",
+        results.size(),
+        failed,
+        pool.GetThreadCount(),
+        cache.GetCount(),
+        std::chrono::duration<double, std::milli>(end - begin).count());
+
+    // 一部が失敗した場合は欠けたテーブルになるので出力しない.
+    if (failed > 0)
+    { return false; }
+
+    return asura::WriteRenderStateTable(
+        states,
+        args.OutputDir + "\\" + args.OutStateXmlName,
+        args.OutputDir + "\\" + args.OutStateBinName,
+        args.MetaXml,
+        args.MetaBinary,
+        args.Verify);
+}
+
+} // namespace
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-----------------------------------------------------------------------------
+bool ParseArg(int argc, char** argv, Argument& result)
+{
+    for(auto i=1; i<argc; ++i)
+    {
+        if (_stricmp(argv[i], "-o") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.OutputDir = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-c") == 0)
+        {
+            result.Compile = true;
+        }
+        else if (_stricmp(argv[i], "-stats") == 0)
+        {
+            result.Stats = true;
+        }
+        else if (_stricmp(argv[i], "-depfile") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.DepFile = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-deptarget") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.DepTarget = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-force") == 0)
+        {
+            result.Force = true;
+        }
+        else if (_stricmp(argv[i], "-verify") == 0)
+        {
+            // 書き出したファイルを確認するので, 更新の無い出力も作り直す.
+            result.Verify = true;
+            result.Force  = true;
+        }
+        else if (_stricmp(argv[i], "-strip") == 0)
+        {
+            result.Strip = true;
+        }
+        else if (_stricmp(argv[i], "-strip_out") == 0)
+        {
+            result.Strip    = true;
+            result.StripOut = true;
+        }
+        else if (_stricmp(argv[i], "-collapse") == 0)
+        {
+            result.Collapse = true;
+        }
+        else if (_stricmp(argv[i], "-pack") == 0)
+        {
+            result.Pack = true;
+        }
+        else if (_stricmp(argv[i], "-compress") == 0)
+        {
+            result.Pack     = true;
+            result.Compress = true;
+        }
+        else if (_stricmp(argv[i], "-meta") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                if (_stricmp(argv[i], "xml") == 0)
+                {
+                    result.MetaXml    = true;
+                    result.MetaBinary = false;
+                }
+                else if (_stricmp(argv[i], "bin") == 0)
+                {
+                    result.MetaXml    = false;
+                    result.MetaBinary = true;
+                }
+                else if (_stricmp(argv[i], "both") == 0)
+                {
+                    result.MetaXml    = true;
+                    result.MetaBinary = true;
+                }
+                else
+                {
+                    fprintf_s(stderr, "Error : Invalid Meta Format. format = %s\n", argv[i]);
+                    return false;
+                }
+            }
+        }
+        else if (_stricmp(argv[i], "-compiler") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.Compiler = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-cache") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.CacheDir = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-cache_size") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.CacheSize = strtoull(argv[i], nullptr, 10);
+            }
+        }
+        else if (_stricmp(argv[i], "-workers") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.WorkerCount = uint32_t(atoi(argv[i]));
+            }
+        }
+        else if (_stricmp(argv[i], "-serve") == 0)
+        {
+            result.Serve = true;
+        }
+        else if (_stricmp(argv[i], "-daemon") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.DaemonPath = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-client") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.ClientPath = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-watch") == 0)
+        {
+            result.Watch = true;
+        }
+        else if (_stricmp(argv[i], "-shutdown") == 0)
+        {
+            // デーモンへの終了要求. -client と組み合わせて使う.
+            result.Shutdown = true;
+        }
+        else if (_stricmp(argv[i], "-fake") == 0)
+        {
+            result.Fake = true;
+        }
+        else if (_stricmp(argv[i], "-fake_delay") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.FakeDelay = uint32_t(atoi(argv[i]));
+            }
+        }
+        else if (_stricmp(argv[i], "-fake_fail") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.FakeFail = argv[i];
+            }
+        }
+        else if (_stricmp(argv[i], "-fake_crash") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.FakeCrash = uint32_t(atoi(argv[i]));
+            }
+        }
+        else if (_stricmp(argv[i], "-j") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                i++;
+                result.ThreadCount = uint32_t(atoi(argv[i]));
+            }
+        }
+        else if (argv[i][0] == '@')
+        {
+            if (!ReadManifest(argv[i] + 1, result.InputPaths))
+            { return false; }
+        }
+        else
+        {
+            result.InputPaths.push_back(argv[i]);
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      コンパイラバックエンドを生成します.
+//-----------------------------------------------------------------------------
+ShaderCompilerBackend* CreateBackend(const Argument& args)
+{
+    if (args.Fake)
+    { return new FakeCompilerBackend(args.FakeDelay, args.FakeFail, args.FakeCrash); }
+
+    if (!args.Compiler.empty())
+    { return new ProcessCompilerBackend(args.Compiler); }
+
+#if defined(_WIN32)
+    return new D3DCompilerBackend();
+#else
+    return nullptr;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      バッチ処理用の出力先ディレクトリ名を決定します.
+//-----------------------------------------------------------------------------
+std::string GetBatchOutputDir(const std::string& outputDir, const std::string& inputPath, std::set<std::string>& used)
+{
+    // 入力ファイル名から拡張子を除いたものをディレクトリ名にする.
+    auto pos  = inputPath.find_last_of("\\/");
+    auto name = (pos != std::string::npos) ? inputPath.substr(pos + 1) : inputPath;
+
+    pos = name.find_last_of('.');
+    if (pos != std::string::npos && pos > 0)
+    { name = name.substr(0, pos); }
+
+    // 同名のファイルが複数ある場合は連番を付ける.
+    auto result = name;
+    for(auto i=1; used.find(result) != used.end(); ++i)
+    { result = name + "_" + std::to_string(i); }
+
+    used.insert(result);
+    return outputDir + "\\" + result;
+}
+
+//-----------------------------------------------------------------------------
+//      全ての入力のステートを共通のステートテーブルに登録します.
+//-----------------------------------------------------------------------------
+bool CollectRenderStates
+(
+    const Argument&             args,
+    SourceCache*                pCache,
+    ParseCache*                 pParsed,
+    RenderStateTable&           table
+)
+{
+    for(auto& inputPath : args.InputPaths)
+    {
+        auto pParser = ParseEffect(inputPath, pCache, pParsed);
+        if (!pParser)
+        {
+            fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", inputPath.c_str());
+            return false;
+        }
+
+        if (!AddRenderStates(*pParser, inputPath, table))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マニフェストに記録する設定のハッシュ値を求めます.
+//-----------------------------------------------------------------------------
+std::string GetManifestOption(const Argument& args, const std::string& inputPath)
+{
+    Sha256 option;
+    option.Update(args.BuildOption);
+    option.Update(inputPath);
+    return option.Finish();
+}
+
+//-----------------------------------------------------------------------------
+//      1つのエフェクトファイルを処理します.
+//-----------------------------------------------------------------------------
+bool ProcessFile
+(
+    const std::string&          inputPath,
+    const std::string&          outputDir,
+    const Argument&             args,
+    SourceCache*                pCache,
+    ParseCache*                 pParsed,
+    CompileScheduler*           pScheduler,
+    RenderStateTable*           pStates
+)
+{
+    auto manifestPath  = outputDir + "\\" + args.OutManifestName;
+    auto variationPath = outputDir + "\\" + args.OutXmlName;
+    auto binaryInfoPath = outputDir + "\\" + args.OutBinName;
+    auto sourcePath    = outputDir + "\\" + args.OutFxName;
+    auto packPath      = outputDir + "\\" + args.OutPackName;
+    auto statePath     = outputDir + "\\" + args.OutStateBinName;
+
+    // パックファイルにまとめる場合, 個々のバイナリは中間ファイルとして別のディレクトリに出力する.
+    auto binaryDir = args.Pack ? outputDir + "\\" + args.OutObjName : outputDir;
+
+    // 複数入力の場合は依存ファイルも入力ごとのディレクトリに出力する.
+    auto depPath   = args.DepFile;
+    auto depTarget = args.DepTarget.empty() ? (args.MetaXml ? variationPath : binaryInfoPath) : args.DepTarget;
+    if (!depPath.empty() && args.InputPaths.size() > 1)
+    {
+        auto pos = depPath.find_last_of("/\\");
+        depPath  = outputDir + "\\" + ((pos == std::string::npos) ? depPath : depPath.substr(pos + 1));
+    }
+
+    auto optionHash = GetManifestOption(args, inputPath);
+
+    // 入力と出力が前回から変わっていなければ何もしない.
+    BuildManifest prev;
+    auto hasPrev = !args.Force && prev.Load(manifestPath);
+    if (hasPrev && prev.IsUpToDate(optionHash))
+    {
+        if (args.Stats)
+        { printf_s("Manifest : up to date, entries = %zu, path = %s\n", prev.GetCount(), inputPath.c_str()); }
+
+        // 共通のステートテーブルが欠けないように, 出力済みのエフェクトも登録する.
+        // 前回書き出したステートを読めない場合だけ解析し直す.
+        MappedFile           stateFile;
+        VariationInfoReader  stateReader;
+        if (pStates != nullptr
+         && stateFile.Open(statePath.c_str())
+         && stateReader.Init(stateFile.GetView().data(), stateFile.GetView().size()))
+        {
+            if (!AddRenderStates(stateReader, inputPath, *pStates))
+            { return false; }
+        }
+        else if (pStates != nullptr)
+        {
+            auto pParser = ParseEffect(inputPath, pCache, pParsed);
+            if (!pParser)
+            {
+                fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", inputPath.c_str());
+                return false;
+            }
+
+            if (!AddRenderStates(*pParser, inputPath, *pStates))
+            { return false; }
+        }
+
+        return depPath.empty() || WriteDepFile(prev, depPath, depTarget);
+    }
+
+    // 途中で失敗した場合に古い記録が残らないように先に削除する.
+    remove(manifestPath.c_str());
+
+    BuildManifest manifest;
+    manifest.Reset(optionHash);
+
+    auto pParser = ParseEffect(inputPath, pCache, pParsed);
+    if (!pParser)
+    {
+        fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", inputPath.c_str());
+        return false;
+    }
+
+    auto& parser = *pParser;
+
+    if (pStates != nullptr && !AddRenderStates(parser, inputPath, *pStates))
+    { return false; }
+
+    for(auto& itr : parser.GetSourceFiles())
+    { manifest.AddInput(itr.second->Path, itr.second->Code); }
+
+    for(auto& path : parser.GetMissingFiles())
+    { manifest.AddMissing(path); }
+
+    if (args.Stats)
+    {
+        auto& stats = parser.GetIncludeStats();
+        printf_s("Include : opened = %u, unique = %u, directives = %u, resolved = %u, path = %s\n",
+            stats.OpenCount,
+            stats.UniqueCount,
+            stats.DirectiveCount,
+            stats.ResolveCount,
+            inputPath.c_str());
+    }
+
+    std::vector<KeywordVariant> variants;
+    if (!EnumerateVariants(parser, inputPath, variants))
+    { return false; }
+
+    // 内容が変わっていなければ書き出さない.
+    auto sourceHash = Sha256::Compute(parser.GetSourceCode(), parser.GetSourceCodeSize());
+    if (hasPrev && prev.IsOutputUpToDate(sourcePath, sourceHash))
+    { manifest.CopyOutput(prev, sourcePath); }
+    else
+    {
+        if (!WriteSourceCode(parser, sourcePath.c_str()))
+        {
+            fprintf_s(stderr, "Error : Source Code Write Failed. path = %s\n", sourcePath.c_str());
+            return false;
+        }
+
+        if (!manifest.AddOutputFile(sourcePath, sourceHash))
+        {
+            fprintf_s(stderr, "Error : File Read Failed. path = %s\n", sourcePath.c_str());
+            return false;
+        }
+    }
+
+    uint32_t reused = 0;
+
+    std::vector<CompileJob> jobs;
+    std::vector<std::string>       keys;
+    std::vector<VariantAlias>             aliases;
+    std::vector<PackItem>          packItems;
+
+    // エントリーポイントから到達可能な宣言だけをコンパイラに渡す.
+    SourceGraph graph;
+    std::map<std::string, std::pair<std::string, std::string>> strippedSources;
+
+    if (pScheduler != nullptr)
+    {
+        std::map<std::pair<std::string, std::string>, std::vector<uint32_t>> collapsedTargets;
+        CollapseStats collapseStats[SHADER_TYPE_COUNT];
+
+        if (args.Pack && !CreateDirectoryA(binaryDir.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            fprintf_s(stderr, "Error : Create Directory Failed. path = %s\n", binaryDir.c_str());
+            return false;
+        }
+
+        size_t jobSourceSize = 0;
+        size_t jobCount      = 0;
+        if (args.Strip)
+        { graph.Build(std::string_view(parser.GetSourceCode(), parser.GetSourceCodeSize())); }
+
+        auto& techniques = parser.GetTechniques();
+        for(size_t i=0; i<techniques.size(); ++i)
+        {
+            auto& tech = techniques[i];
+            for(size_t j=0; j<tech.Pass.size(); ++j)
+            {
+                auto& pass = tech.Pass[j];
+                for(size_t k=0; k<pass.Shaders.size(); ++k)
+                {
+                    auto& shader = pass.Shaders[k];
+
+                    std::string base = binaryDir + "\\";
+                    base += tech.Name;
+                    base += "_";
+                    base += pass.Name;
+                    base += "_";
+                    base += kShaderPrefix[shader.Type];
+
+                    CompileJob job;
+                    job.pSource     = parser.GetSourceCode();
+                    job.SourceSize  = parser.GetSourceCodeSize();
+                    job.SourcePath  = sourcePath;
+                    job.EntryPoint  = shader.EntryPoint;
+                    job.Profile     = shader.Profile;
+                    job.Flags       = 0;
+                    job.SourceHash  = sourceHash;
+
+                    if (args.Strip)
+                    {
+                        auto itr = strippedSources.find(shader.EntryPoint);
+                        if (itr == strippedSources.end())
+                        {
+                            std::string code;
+                            std::string hash;
+                            if (graph.Strip(shader.EntryPoint, code))
+                            { hash = Sha256::Compute(code.data(), code.size()); }
+                            itr = strippedSources.emplace(shader.EntryPoint, std::make_pair(std::move(code), std::move(hash))).first;
+                        }
+
+                        // エントリーポイントが見つからない場合は全体をコンパイルする.
+                        if (!itr->second.second.empty())
+                        {
+                            auto& code = itr->second.first;
+                            job.pSource     = code.data();
+                            job.SourceSize  = code.size();
+                            job.SourceHash  = itr->second.second;
+                            job.SourcePath.clear();
+
+                            if (args.StripOut)
+                            {
+                                job.SourcePath = base + ".src.hlsl";
+                                if (hasPrev && prev.IsOutputUpToDate(job.SourcePath, job.SourceHash))
+                                { manifest.CopyOutput(prev, job.SourcePath); }
+                                else if (WriteFileAtomic(job.SourcePath, code.data(), code.size()))
+                                { manifest.AddOutput(job.SourcePath, job.SourceHash, code.data(), code.size()); }
+                                else
+                                {
+                                    fprintf_s(stderr, "Error : Stripped Source Write Failed. path = %s\n", job.SourcePath.c_str());
+                                    return false;
+                                }
+                            }
+                        }
+                    }
+
+                    // 前処理後のソースコードが同じになる組み合わせは代表の1つだけコンパイルする.
+                    const std::vector<uint32_t>* pTargets = nullptr;
+                    if (args.Collapse && variants.size() > 1)
+                    {
+                        auto begin = std::chrono::steady_clock::now();
+
+                        auto key = std::make_pair(job.SourceHash, job.EntryPoint);
+                        auto itr = collapsedTargets.find(key);
+                        if (itr == collapsedTargets.end())
+                        {
+                            std::vector<uint32_t> targets;
+                            CollapseVariants(job, variants, targets);
+                            itr = collapsedTargets.emplace(key, std::move(targets)).first;
+                        }
+                        pTargets = &itr->second;
+
+                        VariantAlias alias;
+                        alias.Technique = i;
+                        alias.Pass      = j;
+                        alias.Shader    = k;
+                        alias.Targets   = itr->second;
+                        aliases.push_back(std::move(alias));
+
+                        auto& stats = collapseStats[shader.Type];
+                        stats.Variants += variants.size();
+                        for(size_t v=0; v<variants.size(); ++v)
+                        {
+                            if ((*pTargets)[v] == v)
+                            { stats.Unique++; }
+                        }
+                        stats.Time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+                    }
+
+                    // まとめた組み合わせも代表のバイナリを指すエントリーとして登録する.
+                    if (args.Pack)
+                    {
+                        for(size_t v=0; v<variants.size(); ++v)
+                        {
+                            auto target = (pTargets != nullptr) ? (*pTargets)[v] : uint32_t(v);
+
+                            PackItem item;
+                            item.Technique = tech.Name;
+                            item.Pass      = pass.Name;
+                            item.Stage     = kShaderPrefix[shader.Type];
+                            item.Key       = variants[v].Key;
+                            item.Path      = base + variants[target].Suffix + ".hlsl";
+                            packItems.push_back(std::move(item));
+                        }
+                    }
+
+                    // キーワードの組み合わせごとにコンパイルする.
+                    for(size_t v=0; v<variants.size(); ++v)
+                    {
+                        if (pTargets != nullptr && (*pTargets)[v] != v)
+                        { continue; }
+
+                        auto& variant    = variants[v];
+                        auto  variantJob = job;
+                        variantJob.Defines    = variant.Defines;
+                        variantJob.OutputPath = base + variant.Suffix + ".hlsl";
+
+                        jobSourceSize += variantJob.SourceSize;
+                        jobCount++;
+
+                        // 前回と同じ入力から生成した出力が残っていればコンパイルしない.
+                        auto key = pScheduler->MakeKey(variantJob);
+                        if (hasPrev && prev.IsOutputUpToDate(variantJob.OutputPath, key))
+                        {
+                            manifest.CopyOutput(prev, variantJob.OutputPath);
+                            reused++;
+                            continue;
+                        }
+
+                        keys.push_back(key);
+                        jobs.push_back(std::move(variantJob));
+                    }
+                }
+            }
+        }
+
+        if (args.Stats && args.Strip)
+        {
+            printf_s("Strip : declarations = %zu, entries = %zu, source = %zu bytes, average = %zu bytes, path = %s\n",
+                graph.GetDeclarationCount(),
+                strippedSources.size(),
+                parser.GetSourceCodeSize(),
+                (jobCount == 0) ? size_t(0) : jobSourceSize / jobCount,
+                inputPath.c_str());
+        }
+
+        for(size_t i=0; i<std::size(collapseStats); ++i)
+        {
+            auto& stats = collapseStats[i];
+            if (stats.Variants == 0)
+            { continue; }
+
+            printf_s("Collapse : stage = %s, variants = %zu, unique = %zu, ratio = %.2f, time = %.2f ms, path = %s\n",
+                kShaderPrefix[i],
+                stats.Variants,
+                stats.Unique,
+                double(stats.Variants) / double(stats.Unique),
+                stats.Time,
+                inputPath.c_str());
+        }
+    }
+
+    if (args.MetaXml)
+    {
+        if (!WriteVariationInfo(parser, variants, aliases, variationPath.c_str(), args.OutFxName.c_str()))
+        {
+            fprintf_s(stderr, "Error : ShaderVariation Info Write Failed. path = %s\n", variationPath.c_str());
+            return false;
+        }
+
+        if (!manifest.AddOutputFile(variationPath, ""))
+        {
+            fprintf_s(stderr, "Error : File Read Failed. path = %s\n", variationPath.c_str());
+            return false;
+        }
+    }
+
+    if (args.MetaBinary)
+    {
+        uint32_t fileSize = 0;
+        if (!WriteVariationBinary(parser, variants, aliases, binaryInfoPath, args.OutFxName.c_str(), fileSize))
+        {
+            fprintf_s(stderr, "Error : ShaderVariation Info Write Failed. path = %s\n", binaryInfoPath.c_str());
+            return false;
+        }
+
+        // 両方出力した場合は, バイナリを読み直して XML と同じ内容か確認する.
+        if (args.Verify && args.MetaXml && !VariationInfoWriter::Verify(binaryInfoPath, variationPath))
+        {
+            fprintf_s(stderr, "Error : ShaderVariation Info Verify Failed. path = %s\n", binaryInfoPath.c_str());
+            return false;
+        }
+
+        if (!manifest.AddOutputFile(binaryInfoPath, ""))
+        {
+            fprintf_s(stderr, "Error : File Read Failed. path = %s\n", binaryInfoPath.c_str());
+            return false;
+        }
+
+        if (args.Stats)
+        { printf_s("Meta : size = %u bytes, verified = %s, path = %s\n", fileSize, args.MetaXml ? "true" : "false", inputPath.c_str()); }
+    }
+
+    // 複数入力の場合は, 次回出力済みでも共通のステートテーブルに登録できるようにステートを残しておく.
+    if (args.InputPaths.size() > 1)
+    {
+        if (!WriteEffectRenderStates(parser, statePath))
+        {
+            fprintf_s(stderr, "Error : Render State Write Failed. path = %s\n", statePath.c_str());
+            return false;
+        }
+
+        if (!manifest.AddOutputFile(statePath, ""))
+        {
+            fprintf_s(stderr, "Error : File Read Failed. path = %s\n", statePath.c_str());
+            return false;
+        }
+    }
+
+    if (pScheduler != nullptr)
+    {
+        if (!pScheduler->Run(jobs))
+        { return false; }
+
+        for(size_t i=0; i<jobs.size(); ++i)
+        {
+            if (!manifest.AddOutputFile(jobs[i].OutputPath, keys[i]))
+            {
+                fprintf_s(stderr, "Error : File Read Failed. path = %s\n", jobs[i].OutputPath.c_str());
+                return false;
+            }
+        }
+
+        if (args.Pack)
+        {
+            if (!WritePack(packItems, packPath, inputPath, args.Compress, args.Verify))
+            { return false; }
+
+            if (!manifest.AddOutputFile(packPath, ""))
+            {
+                fprintf_s(stderr, "Error : File Read Failed. path = %s\n", packPath.c_str());
+                return false;
+            }
+        }
+    }
+
+    if (!manifest.Save(manifestPath))
+    {
+        fprintf_s(stderr, "Error : Manifest Write Failed. path = %s\n", manifestPath.c_str());
+        return false;
+    }
+
+    if (args.Stats)
+    { printf_s("Manifest : entries = %zu, reused = %u, path = %s\n", manifest.GetCount(), reused, inputPath.c_str()); }
+
+    return depPath.empty() || WriteDepFile(manifest, depPath, depTarget);
+}
+
+//-----------------------------------------------------------------------------
+//      コンパイラバックエンドとスケジューラを生成します.
+//-----------------------------------------------------------------------------
+bool CreateCompileContext(const Argument& args, const char* argv0, CompileContext& context)
+{
+    context.Backend.reset(CreateBackend(args));
+    if (!context.Backend)
+    {
+        fprintf_s(stderr, "Error : Compiler Backend Not Available. use -compiler option.\n");
+        return false;
+    }
+
+    // 常駐ワーカープロセスでコンパイルする.
+    if (args.WorkerCount > 0)
+    { context.Workers.reset(new WorkerPoolBackend(GetWorkerCommand(args, argv0), args.WorkerCount, *context.Backend)); }
+
+    if (!args.CacheDir.empty())
+    {
+        context.Cache.reset(new CompileCache(args.CacheDir, args.CacheSize * 1024 * 1024));
+        if (!context.Cache->Init())
+        {
+            fprintf_s(stderr, "Error : Cache Directory Create Failed. path = %s\n", args.CacheDir.c_str());
+            return false;
+        }
+    }
+
+    ShaderCompilerBackend* pBackend = context.Workers
+        ? static_cast<ShaderCompilerBackend*>(context.Workers.get())
+        : context.Backend.get();
+    context.Scheduler.reset(new CompileScheduler(pBackend, args.ThreadCount, context.Cache.get()));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      コンパイラバックエンドとスケジューラの設定を文字列にします.
+//-----------------------------------------------------------------------------
+std::string GetCompileConfig(const Argument& args)
+{
+    std::string result;
+    result += args.Compiler;
+    result += "|" + std::to_string(args.Fake ? 1 : 0);
+    result += "|" + std::to_string(args.FakeDelay);
+    result += "|" + args.FakeFail;
+    result += "|" + std::to_string(args.FakeCrash);
+    result += "|" + std::to_string(args.WorkerCount);
+    result += "|" + (args.CacheDir.empty() ? args.CacheDir : GetFullPath(args.CacheDir));
+    result += "|" + std::to_string(args.CacheSize);
+    result += "|" + std::to_string(args.ThreadCount);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      統計情報を取得します.
+//-----------------------------------------------------------------------------
+ContextStats GetContextStats(const CompileContext& context)
+{
+    ContextStats result = {};
+    if (context.Scheduler)
+    { result.Scheduler = context.Scheduler->GetStats(); }
+    if (context.Cache)
+    { result.Cache = context.Cache->GetStats(); }
+    if (context.Workers)
+    { result.RestartCount = context.Workers->GetRestartCount(); }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      前回からの統計情報を出力します.
+//-----------------------------------------------------------------------------
+void PrintContextStats(CompileContext& context, const ContextStats& prev)
+{
+    if (context.Scheduler)
+    {
+        auto stats = context.Scheduler->GetStats();
+        auto jobs   = stats.JobCount    - prev.Scheduler.JobCount;
+        auto unique = stats.UniqueCount - prev.Scheduler.UniqueCount;
+        printf_s("Compile : jobs = %u, unique = %u, saved = %u\n",
+            jobs,
+            unique,
+            jobs - unique);
+    }
+
+    if (context.Workers)
+    {
+        printf_s("Worker : count = %u, restarts = %u\n",
+            context.Workers->GetWorkerCount(),
+            context.Workers->GetRestartCount() - prev.RestartCount);
+    }
+
+    if (context.Cache)
+    {
+        context.Cache->Trim();
+
+        auto stats = context.Cache->GetStats();
+        printf_s("Cache : hit = %u, miss = %u, evict = %u, size = %llu bytes\n",
+            stats.HitCount   - prev.Cache.HitCount,
+            stats.MissCount  - prev.Cache.MissCount,
+            stats.EvictCount - prev.Cache.EvictCount,
+            static_cast<unsigned long long>(stats.TotalSize));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ビルドを実行します.
+//-----------------------------------------------------------------------------
+int RunBuild
+(
+    Argument&           args,
+    const char*         argv0,
+    CompileContext&     context,
+    SourceCache*        pCache,
+    ParseCache*         pParsed
+)
+{
+    ShaderCompilerBackend* pBackend = context.Workers
+        ? static_cast<ShaderCompilerBackend*>(context.Workers.get())
+        : context.Backend.get();
+    args.BuildOption = GetBuildOption(args, argv0, pBackend);
+
+    // 常駐している場合は前回までの統計情報を差し引く.
+    auto stats = GetContextStats(context);
+
+    // 複数入力の場合は入力ごとのディレクトリに出力する.
+    auto success = (args.InputPaths.size() > 1)
+        ? ProcessBatch(args, pCache, pParsed, context.Scheduler.get())
+        : ProcessFile(args.InputPaths[0], args.OutputDir, args, pCache, pParsed, context.Scheduler.get(), nullptr);
+
+    PrintContextStats(context, stats);
+
+    return success ? 0 : -1;
+}
+
+} // namespace asura
@@ -0,0 +1,71 @@
+﻿//-----------------------------------------------------------------------------
+// File : EffectDaemon.cpp
+// Desc : Effect Build Daemon Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "EffectDaemon.h"
+#include "EffectBuild.h"
+#include "CompileDaemon.h"
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      デーモンとして常駐します.
+//-----------------------------------------------------------------------------
+int RunDaemonServer(const std::string& path, const char* argv0)
+{
+    // リクエストをまたいで保持する状態.
+    // インクルードファイルはコピーして保持し, リクエストごとにタイムスタンプで検証する.
+    SourceCache                                             sources(true);
+    ParseCache                                              parsed;
+    std::map<std::string, std::unique_ptr<CompileContext>>  contexts;
+    CompileContext                                          empty;
+
+    return RunDaemon(path, [&](const std::vector<std::string>& request) -> int
+    {
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(argv0));
+        for(auto& itr : request)
+        { argv.push_back(const_cast<char*>(itr.c_str())); }
+
+        Argument args;
+        if (!ParseArg(int(argv.size()), argv.data(), args)
+         || args.InputPaths.empty()
+         || args.OutputDir.empty()
+         || args.Serve
+         || args.Watch
+         || !args.DaemonPath.empty()
+         || !args.ClientPath.empty())
+        {
+            fprintf_s(stderr, "Error : Invalid Arguments.\n");
+            return -1;
+        }
+
+        // 前回のリクエスト以降に変更されたファイルを破棄.
+        sources.Refresh();
+
+        auto pContext = &empty;
+        if (args.Compile)
+        {
+            auto& context = contexts[GetCompileConfig(args)];
+            if (!context)
+            {
+                std::unique_ptr<CompileContext> created(new CompileContext());
+                if (!CreateCompileContext(args, argv0, *created))
+                { return -1; }
+
+                context = std::move(created);
+            }
+            pContext = context.get();
+        }
+
+        return RunBuild(args, argv0, *pContext, &sources, &parsed);
+    });
+}
+
+} // namespace asura
@@ -0,0 +1,186 @@
+﻿//-----------------------------------------------------------------------------
+// File : EffectWatch.cpp
+// Desc : Effect Watch Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "EffectWatch.h"
+#include "BuildManifest.h"
+#include "FileWatcher.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kWatchTimeoutMsec = 1000;    // ファイル監視の待機時間(ミリ秒).
+
+//-----------------------------------------------------------------------------
+//      入力ファイルと依存ファイルを監視対象に登録します.
+//      処理後から登録までの間に変更された場合は true を返却します.
+//-----------------------------------------------------------------------------
+bool AddWatchFiles
+(
+    const asura::Argument&  args,
+    const std::string&      inputPath,
+    const std::string&      outputDir,
+    asura::FileWatcher&     watcher,
+    std::set<std::string>&  depends
+)
+{
+    // マニフェストには変更チェックだけで済んだ場合も依存ファイルが記録されている.
+    // 処理に失敗した場合は保存されないので, 前回の依存ファイルを監視し続ける.
+    asura::BuildManifest manifest;
+    if (manifest.Load(outputDir + "\\" + args.OutManifestName))
+    { depends.clear(); }
+
+    std::string key;
+    if (watcher.Add(inputPath, &key))
+    { depends.insert(key); }
+
+    // 後から作成されると解決結果が変わるので見つからなかったファイルも監視する.
+    for(auto& entry : manifest.GetEntries())
+    {
+        if (entry.Kind == asura::MANIFEST_OUTPUT)
+        { continue; }
+
+        if (watcher.Add(entry.Path, &key))
+        { depends.insert(key); }
+    }
+
+    // 登録前の変更は通知されないので記録と比較する.
+    return !manifest.GetEntries().empty() && !manifest.IsUpToDate(asura::GetManifestOption(args, inputPath));
+}
+
+} // namespace
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      入力ファイルの変更を監視して再処理します.
+//-----------------------------------------------------------------------------
+int RunWatch(Argument& args, const char* argv0, CompileContext& context)
+{
+    // 変更されていないインクルードファイルと解析結果は再利用する.
+    SourceCache         sources(true);
+    ParseCache          parsed;
+    FileWatcher         watcher;
+    if (!watcher.Init())
+    {
+        fprintf_s(stderr, "Error : File Watcher Init Failed.\n");
+        return -1;
+    }
+
+    // バッチ処理と同じ出力先ディレクトリを使う.
+    std::vector<std::string> outputDirs;
+    if (args.InputPaths.size() > 1)
+    {
+        std::set<std::string> used;
+        for(auto& path : args.InputPaths)
+        { outputDirs.push_back(GetBatchOutputDir(args.OutputDir, path, used)); }
+    }
+    else
+    { outputDirs.push_back(args.OutputDir); }
+
+    RunBuild(args, argv0, context, &sources, &parsed);
+
+    // 2回目以降はマニフェストで変更の無い出力を再利用する.
+    args.Force = false;
+
+    std::vector<std::set<std::string>>  depends(args.InputPaths.size());
+    std::vector<bool>                   stale  (args.InputPaths.size());
+    for(size_t i=0; i<args.InputPaths.size(); ++i)
+    { stale[i] = AddWatchFiles(args, args.InputPaths[i], outputDirs[i], watcher, depends[i]); }
+
+    printf_s("Watch : %zu files. press Ctrl+C to exit.\n", watcher.GetCount());
+    fflush(stdout);
+
+    ThreadPool               pool(args.ThreadCount);
+    std::vector<std::string> changed;
+    for(;;)
+    {
+        auto hasStale = std::find(stale.begin(), stale.end(), true) != stale.end();
+        if (!watcher.Wait(hasStale ? 0 : kWatchTimeoutMsec, changed) && !hasStale)
+        { continue; }
+
+        auto begin = std::chrono::steady_clock::now();
+
+        // 変更されたファイルだけを読み直す.
+        auto invalidated = sources.Refresh();
+
+        std::vector<size_t> targets;
+        for(size_t i=0; i<args.InputPaths.size(); ++i)
+        {
+            if (stale[i])
+            {
+                targets.push_back(i);
+                continue;
+            }
+
+            for(auto& key : changed)
+            {
+                if (depends[i].find(key) != depends[i].end())
+                {
+                    targets.push_back(i);
+                    break;
+                }
+            }
+        }
+
+        if (targets.empty())
+        { continue; }
+
+        auto stats = GetContextStats(context);
+        std::atomic<uint32_t> failed(0);
+        for(auto i : targets)
+        {
+            pool.Push([&, i]()
+            {
+                if (!ProcessFile(args.InputPaths[i], outputDirs[i], args, &sources, &parsed, context.Scheduler.get(), nullptr))
+                { failed++; }
+            });
+        }
+
+        pool.Wait();
+
+        // 共通のステートテーブルは解析結果を再利用して作り直す.
+        if (failed == 0 && args.InputPaths.size() > 1)
+        {
+            RenderStateTable states;
+            if (!CollectRenderStates(args, &sources, &parsed, states)
+             || !WriteRenderStateTable(
+                    states,
+                    args.OutputDir + "\\" + args.OutStateXmlName,
+                    args.OutputDir + "\\" + args.OutStateBinName,
+                    args.MetaXml,
+                    args.MetaBinary,
+                    args.Verify))
+            { failed++; }
+        }
+
+        for(auto i : targets)
+        { stale[i] = AddWatchFiles(args, args.InputPaths[i], outputDirs[i], watcher, depends[i]); }
+
+        auto end = std::chrono::steady_clock::now();
+
+        PrintContextStats(context, stats);
+        printf_s("Watch : changed = %zu files, invalidated = %zu files, rebuilt = %zu effects, failed = %u, latency = %.2f ms\n",
+            changed.size(),
+            invalidated,
+            targets.size(),
+            failed.load(),
+            std::chrono::duration<double, std::milli>(end - begin).count());
+        fflush(stdout);
+    }
+}
+
+} // namespace asura
@@ -0,0 +1,337 @@
+﻿//-----------------------------------------------------------------------------
+// File : FileWatcher.cpp
+// Desc : File Change Watcher Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "FileWatcher.h"
+#include "SourceCache.h"
+#include <algorithm>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <Windows.h>
+#else
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSettleMsec = 20;     // 続けて発生した通知をまとめる待機時間(ミリ秒).
+
+#if defined(_WIN32)
+static const char kSeparator = '\\';
+#else
+static const char kSeparator = '/';
+static const uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+#endif
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズと更新日時を取得します.
+//-----------------------------------------------------------------------------
+bool GetFileState(const std::string& path, uint64_t& size, int64_t& time)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    { return false; }
+
+    size = uint64_t(info.st_size);
+    time = int64_t(info.st_mtime);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      パスをディレクトリとファイル名に分割します.
+//-----------------------------------------------------------------------------
+void SplitPath(const std::string& path, std::string& directory, std::string& name)
+{
+    auto pos = path.find_last_of("/\\");
+    if (pos == std::string::npos)
+    {
+        directory = ".";
+        name      = path;
+    }
+    else
+    {
+        directory = (pos == 0) ? path.substr(0, 1) : path.substr(0, pos);
+        name      = path.substr(pos + 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ディレクトリとファイル名を連結します.
+//-----------------------------------------------------------------------------
+std::string JoinPath(const std::string& directory, const std::string& name, char separator)
+{
+    if (directory.empty() || directory.back() == '/' || directory.back() == '\\')
+    { return directory + name; }
+
+    return directory + separator + name;
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// FileWatcher class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+FileWatcher::FileWatcher()
+: m_Handle(-1)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+FileWatcher::~FileWatcher()
+{
+#if defined(_WIN32)
+    for(auto& itr : m_Directories)
+    { FindCloseChangeNotification(reinterpret_cast<HANDLE>(itr.second.Handle)); }
+#else
+    if (m_Handle >= 0)
+    { close(int(m_Handle)); }
+#endif
+
+    m_Directories.clear();
+    m_Files.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool FileWatcher::Init()
+{
+#if defined(_WIN32)
+    // ディレクトリごとに通知ハンドルを作成する.
+    m_Handle = 0;
+#else
+    m_Handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    return m_Handle >= 0;
+}
+
+//-----------------------------------------------------------------------------
+//      監視するファイルを追加します.
+//-----------------------------------------------------------------------------
+bool FileWatcher::Add(const std::string& path, std::string* pKey)
+{
+    // 存在しないファイルも絶対パスにできるようにディレクトリ側で解決する.
+    std::string directory;
+    std::string name;
+    SplitPath(path, directory, name);
+
+    auto fullDir  = GetFullPath(directory);
+    auto fullPath = JoinPath(fullDir, name, kSeparator);
+    auto key      = GetCanonicalPath(fullPath);
+    if (pKey != nullptr)
+    { *pKey = key; }
+
+    if (m_Files.find(key) != m_Files.end())
+    { return true; }
+
+    auto dirKey = GetCanonicalPath(fullDir);
+    if (m_Directories.find(dirKey) == m_Directories.end())
+    {
+        Directory dir;
+        dir.FullPath = fullDir;
+
+    #if defined(_WIN32)
+        auto handle = FindFirstChangeNotificationA(
+            fullDir.c_str(),
+            FALSE,
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+        if (handle == INVALID_HANDLE_VALUE)
+        { return false; }
+
+        dir.Handle = reinterpret_cast<intptr_t>(handle);
+    #else
+        auto handle = inotify_add_watch(int(m_Handle), fullDir.c_str(), kWatchMask);
+        if (handle < 0)
+        { return false; }
+
+        dir.Handle = handle;
+    #endif
+
+        m_Directories[dirKey] = dir;
+    }
+
+    Entry entry;
+    entry.FullPath  = fullPath;
+    entry.Directory = dirKey;
+    entry.Exists    = GetFileState(fullPath, entry.Size, entry.Time);
+    entry.Dirty     = false;
+
+    // 登録と同じ秒に更新されたファイルは次の通知で必ず変更扱いにする.
+    if (entry.Exists && entry.Time >= int64_t(time(nullptr)))
+    { entry.Time = -1; }
+
+    m_Files[key] = entry;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      監視しているファイルが変更されるまで待機します.
+//-----------------------------------------------------------------------------
+bool FileWatcher::Wait(uint32_t timeoutMsec, std::vector<std::string>& changed)
+{
+    changed.clear();
+
+    if (!ReadEvents(timeoutMsec))
+    { return false; }
+
+    // エディタの保存は複数の通知になるので落ち着くまで待つ.
+    while(ReadEvents(kSettleMsec))
+    { /* DO_NOTHING */ }
+
+    auto now = int64_t(time(nullptr));
+    for(auto& itr : m_Files)
+    {
+        auto& entry = itr.second;
+        if (!entry.Dirty)
+        { continue; }
+
+        entry.Dirty = false;
+
+        uint64_t size = 0;
+        int64_t  time = 0;
+        auto exists = GetFileState(entry.FullPath, size, time);
+        if (exists == entry.Exists && size == entry.Size && time == entry.Time)
+        { continue; }
+
+        entry.Exists = exists;
+        entry.Size   = size;
+        entry.Time   = (exists && time >= now) ? -1 : time;
+        changed.push_back(itr.first);
+    }
+
+    return !changed.empty();
+}
+
+//-----------------------------------------------------------------------------
+//      監視しているファイル数を取得します.
+//-----------------------------------------------------------------------------
+size_t FileWatcher::GetCount() const
+{ return m_Files.size(); }
+
+//-----------------------------------------------------------------------------
+//      通知を読み取ります.
+//-----------------------------------------------------------------------------
+bool FileWatcher::ReadEvents(uint32_t timeoutMsec)
+{
+#if defined(_WIN32)
+    // ファイル名は通知されないので, ディレクトリ内の監視ファイルを全て確認する.
+    std::vector<HANDLE>         handles;
+    std::vector<std::string>    keys;
+    for(auto& itr : m_Directories)
+    {
+        handles.push_back(reinterpret_cast<HANDLE>(itr.second.Handle));
+        keys   .push_back(itr.first);
+    }
+
+    auto received = false;
+    for(size_t offset = 0; offset < handles.size(); offset += MAXIMUM_WAIT_OBJECTS)
+    {
+        auto count = DWORD(std::min<size_t>(handles.size() - offset, MAXIMUM_WAIT_OBJECTS));
+
+        // 待機するのは最初のグループだけにする.
+        auto ret = WaitForMultipleObjects(count, &handles[offset], FALSE, (offset == 0) ? timeoutMsec : 0);
+        if (ret < WAIT_OBJECT_0 || ret >= WAIT_OBJECT_0 + count)
+        { continue; }
+
+        auto index = offset + (ret - WAIT_OBJECT_0);
+        FindNextChangeNotification(handles[index]);
+        MarkDirty(keys[index], std::string());
+        received = true;
+    }
+
+    return received;
+#else
+    pollfd fd = {};
+    fd.fd     = int(m_Handle);
+    fd.events = POLLIN;
+    if (poll(&fd, 1, int(timeoutMsec)) <= 0)
+    { return false; }
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    auto received = false;
+    for(;;)
+    {
+        auto size = read(int(m_Handle), buffer, sizeof(buffer));
+        if (size <= 0)
+        { break; }
+
+        for(ssize_t pos = 0; pos < size; )
+        {
+            auto pEvent = reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += sizeof(inotify_event) + pEvent->len;
+
+            // 取りこぼした場合は全てのファイルを確認する.
+            if (pEvent->mask & IN_Q_OVERFLOW)
+            {
+                for(auto& itr : m_Files)
+                { itr.second.Dirty = true; }
+                received = true;
+                continue;
+            }
+
+            if (pEvent->len == 0)
+            { continue; }
+
+            for(auto& itr : m_Directories)
+            {
+                if (itr.second.Handle != pEvent->wd)
+                { continue; }
+
+                MarkDirty(itr.first, pEvent->name);
+                received = true;
+                break;
+            }
+        }
+    }
+
+    return received;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      通知を受け取ったファイルに印を付けます.
+//-----------------------------------------------------------------------------
+void FileWatcher::MarkDirty(const std::string& directory, const std::string& name)
+{
+    // ファイル名が無い場合はディレクトリ内の全てのファイルが対象.
+    if (name.empty())
+    {
+        for(auto& itr : m_Files)
+        {
+            if (itr.second.Directory == directory)
+            { itr.second.Dirty = true; }
+        }
+        return;
+    }
+
+    auto itr = m_Files.find(GetCanonicalPath(JoinPath(directory, name, '\\')));
+    if (itr != m_Files.end())
+    { itr->second.Dirty = true; }
+}
+
+} // namespace asura
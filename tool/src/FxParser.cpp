@@ -9,9 +9,13 @@
 //-------------------------------------------------------------------------------------------------
 #include "FxParser.h"
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <new>
+#include <algorithm>
 #include <cassert>
-#include <fstream>
+#include <cctype>
+#include <iterator>
 
 
 #ifndef DLOG
@@ -59,6 +63,9 @@ const char* ToString(SHADER_TYPE value)
 
         case SHADER_TYPE_MESH:
             return "mesh";
+
+        default:
+            break;
     }
 
     return nullptr;
@@ -324,16 +331,200 @@ const char* ToString(BLEND_OP_TYPE type)
     }
 }
 
+//-----------------------------------------------------------------------------
+//      大文字小文字を区別せずに文字列を比較します.
+//-----------------------------------------------------------------------------
+bool IsEqualAsLower(std::string_view lhs, const char* rhs)
+{
+    auto size = strlen(rhs);
+    if (lhs.size() != size)
+    { return false; }
+
+    return (_strnicmp(lhs.data(), rhs, size) == 0);
+}
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kKeywordTableBits = 7;                        // キーワードハッシュテーブルのビット数.
+static const uint32_t kKeywordTableSize = 1u << kKeywordTableBits;  // キーワードハッシュテーブルのサイズ.
+
+// 全キーワードが別々のスロットに入るハッシュの初期値.
+// キーワードを追加して static_assert に失敗した場合は, 衝突しなくなるまでこの値を1ずつ増やして探す.
+static const uint32_t kKeywordSeed = 0x811ca4a2;
+
+///////////////////////////////////////////////////////////////////////////////
+// KEYWORD enum
+///////////////////////////////////////////////////////////////////////////////
+enum KEYWORD
+{
+    KEYWORD_NONE = 0,               //!< キーワードではない.
+    KEYWORD_TECHNIQUE,              //!< technique
+    KEYWORD_CBUFFER,                //!< cbuffer
+    KEYWORD_STRUCT,                 //!< struct
+    KEYWORD_PROPERTIES,             //!< properties
+    KEYWORD_KEYWORDS,               //!< keywords
+    KEYWORD_BLEND_STATE,            //!< BlendState
+    KEYWORD_RASTERIZER_STATE,       //!< RasterizerState
+    KEYWORD_DEPTH_STENCIL_STATE,    //!< DepthStencilState
+    KEYWORD_SHADER,                 //!< VertexShader など. 値は SHADER_TYPE.
+    KEYWORD_RESOURCE,               //!< Texture2D など. 値は RESOURCE_TYPE.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// KeywordEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct KeywordEntry
+{
+    const char*     Name;       //!< キーワード名.
+    KEYWORD         Keyword;    //!< キーワード種別.
+    uint32_t        Value;      //!< 種別ごとの値.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// KeywordTable structure
+///////////////////////////////////////////////////////////////////////////////
+struct KeywordTable
+{
+    uint8_t     Index[kKeywordTableSize];   //!< kKeywords へのインデックス+1 (0は空き).
+    size_t      MinLength;                  //!< キーワードの最小文字数.
+    size_t      MaxLength;                  //!< キーワードの最大文字数.
+    bool        Collided;                   //!< 同じスロットに入るキーワードがあったかどうか.
+};
+
+//-----------------------------------------------------------------------------
+// Keywords.
+//-----------------------------------------------------------------------------
+static constexpr KeywordEntry kKeywords[] = {
+    { "technique",              KEYWORD_TECHNIQUE,              0 },
+    { "cbuffer",                KEYWORD_CBUFFER,                0 },
+    { "struct",                 KEYWORD_STRUCT,                 0 },
+    { "properties",             KEYWORD_PROPERTIES,             0 },
+    { "keywords",               KEYWORD_KEYWORDS,               0 },
+    { "BlendState",             KEYWORD_BLEND_STATE,            0 },
+    { "RasterizerState",        KEYWORD_RASTERIZER_STATE,       0 },
+    { "DepthStencilState",      KEYWORD_DEPTH_STENCIL_STATE,    0 },
+
+    { "VertexShader",           KEYWORD_SHADER,     SHADER_TYPE_VERTEX },
+    { "PixelShader",            KEYWORD_SHADER,     SHADER_TYPE_PIXEL },
+    { "GeometryShader",         KEYWORD_SHADER,     SHADER_TYPE_GEOMETRY },
+    { "DomainShader",           KEYWORD_SHADER,     SHADER_TYPE_DOMAIN },
+    { "HullShader",             KEYWORD_SHADER,     SHADER_TYPE_HULL },
+    { "ComputeShader",          KEYWORD_SHADER,     SHADER_TYPE_COMPUTE },
+    { "AmplificationShader",    KEYWORD_SHADER,     SHADER_TYPE_AMPLIFICATION },
+    { "MeshShader",             KEYWORD_SHADER,     SHADER_TYPE_MESH },
+
+    { "Texture1D",              KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE1D },
+    { "Texture1DArray",         KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE1DARRAY },
+    { "Texture2D",              KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE2D },
+    { "Texture2DArray",         KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE2DARRAY },
+    { "Texture2DMS",            KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE2DMS },
+    { "Texture2DMSArray",       KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE2DMSARRAY },
+    { "Texture3D",              KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURE3D },
+    { "TextureCube",            KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURECUBE },
+    { "TextureCubeArray",       KEYWORD_RESOURCE,   RESOURCE_TYPE_TEXTURECUBEARRAY },
+    { "Buffer",                 KEYWORD_RESOURCE,   RESOURCE_TYPE_BUFFER },
+    { "ByteAddressBuffer",      KEYWORD_RESOURCE,   RESOURCE_TYPE_BYTEADDRESS_BUFFER },
+    { "StructuredBuffer",       KEYWORD_RESOURCE,   RESOURCE_TYPE_STRUCTURED_BUFFER },
+    { "RWTexture1D",            KEYWORD_RESOURCE,   RESOURCE_TYPE_RWTEXTURE1D },
+    { "RWTexture1DArray",       KEYWORD_RESOURCE,   RESOURCE_TYPE_RWTEXTURE1DARRAY },
+    { "RWTexture2D",            KEYWORD_RESOURCE,   RESOURCE_TYPE_RWTEXTURE2D },
+    { "RWTexture2DArray",       KEYWORD_RESOURCE,   RESOURCE_TYPE_RWTEXTURE2DARRAY },
+    { "RWTexture3D",            KEYWORD_RESOURCE,   RESOURCE_TYPE_RWTEXTURE3D },
+    { "RWBuffer",               KEYWORD_RESOURCE,   RESOURCE_TYPE_RWBUFFER },
+    { "RWByteAddressBuffer",    KEYWORD_RESOURCE,   RESOURCE_TYPE_RWBYTEADDRESS_BUFFER },
+    { "RWStructuredBuffer",     KEYWORD_RESOURCE,   RESOURCE_TYPE_RWSTRUCTURED_BUFFER },
+    { "SamplerState",           KEYWORD_RESOURCE,   RESOURCE_TYPE_SAMPLER_STATE },
+    { "SamplerComparisonState", KEYWORD_RESOURCE,   RESOURCE_TYPE_SAMPLER_COMPRISON_STATE },
+};
+
+//-----------------------------------------------------------------------------
+//      大文字小文字を区別しないハッシュ値を計算します(FNV-1a).
+//-----------------------------------------------------------------------------
+constexpr uint32_t HashAsLower(const char* value, size_t size)
+{
+    uint32_t hash = kKeywordSeed;
+    for(size_t i=0; i<size; ++i)
+    {
+        // 英字の大文字小文字を同一視する(記号の衝突は文字列比較で弾く).
+        hash ^= uint8_t(value[i]) | 0x20;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//-----------------------------------------------------------------------------
+//      ハッシュ値からスロット番号を求めます.
+//-----------------------------------------------------------------------------
+constexpr uint32_t GetKeywordSlot(uint32_t hash)
+{
+    // FNV-1a の下位ビットは初期値の下位ビットでしか変わらないので上位ビットを使う.
+    return hash >> (32 - kKeywordTableBits);
+}
+
+//-----------------------------------------------------------------------------
+//      キーワードの完全ハッシュテーブルを構築します.
+//-----------------------------------------------------------------------------
+constexpr KeywordTable BuildKeywordTable()
+{
+    KeywordTable table = {};
+    table.MinLength = SIZE_MAX;
+    table.MaxLength = 0;
+
+    for(size_t i=0; i<std::size(kKeywords); ++i)
+    {
+        auto size = std::char_traits<char>::length(kKeywords[i].Name);
+        if (size < table.MinLength)
+        { table.MinLength = size; }
+        if (size > table.MaxLength)
+        { table.MaxLength = size; }
+
+        auto slot = GetKeywordSlot(HashAsLower(kKeywords[i].Name, size));
+        if (table.Index[slot] != 0)
+        { table.Collided = true; }
+
+        table.Index[slot] = uint8_t(i + 1);
+    }
+
+    return table;
+}
+
+static constexpr KeywordTable kKeywordTable = BuildKeywordTable();
+static_assert(!kKeywordTable.Collided, "kKeywordSeed must map every keyword to its own slot.");
+
+//-----------------------------------------------------------------------------
+//      トークンに対応するキーワードを検索します.
+//-----------------------------------------------------------------------------
+KEYWORD FindKeyword(std::string_view token, uint32_t* pValue = nullptr)
+{
+    if (token.size() < kKeywordTable.MinLength || token.size() > kKeywordTable.MaxLength)
+    { return KEYWORD_NONE; }
+
+    // 衝突が無いので, 候補は1つだけ.
+    auto index = kKeywordTable.Index[GetKeywordSlot(HashAsLower(token.data(), token.size()))];
+    if (index == 0)
+    { return KEYWORD_NONE; }
+
+    auto& entry = kKeywords[index - 1];
+    if (!IsEqualAsLower(token, entry.Name))
+    { return KEYWORD_NONE; }
+
+    if (pValue != nullptr)
+    { *pValue = entry.Value; }
+
+    return entry.Keyword;
+}
+
 //-----------------------------------------------------------------------------
 //      POLYGON_MODE型を解析します.
 //-----------------------------------------------------------------------------
-POLYGON_MODE ParsePolygonMode(const char* value)
+POLYGON_MODE ParsePolygonMode(std::string_view value)
 {
     POLYGON_MODE result = POLYGON_MODE_SOLID;
 
-    if (_stricmp(value, "WIREFRAME") == 0)
+    if (IsEqualAsLower(value, "WIREFRAME"))
     { result = POLYGON_MODE_WIREFRAME; }
-    else if (_stricmp(value, "SOLID") == 0)
+    else if (IsEqualAsLower(value, "SOLID"))
     { result = POLYGON_MODE_SOLID; }
 
     return result;
@@ -342,29 +533,29 @@ POLYGON_MODE ParsePolygonMode(const char* value)
 //-----------------------------------------------------------------------------
 //      BLEND_TYPE型を解析します.
 //-----------------------------------------------------------------------------
-BLEND_TYPE ParseBlendType(const char* value)
+BLEND_TYPE ParseBlendType(std::string_view value)
 {
     BLEND_TYPE type = BLEND_TYPE_ZERO;
 
-    if (_stricmp(value, "ZERO") == 0)
+    if (IsEqualAsLower(value, "ZERO"))
     { type = BLEND_TYPE_ZERO; }
-    else if (_stricmp(value, "ONE") == 0)
+    else if (IsEqualAsLower(value, "ONE"))
     { type = BLEND_TYPE_ONE; }
-    else if (_stricmp(value, "SRC_COLOR") == 0)
+    else if (IsEqualAsLower(value, "SRC_COLOR"))
     { type = BLEND_TYPE_SRC_COLOR; }
-    else if (_stricmp(value, "INV_SRC_COLOR") == 0)
+    else if (IsEqualAsLower(value, "INV_SRC_COLOR"))
     { type = BLEND_TYPE_INV_SRC_COLOR; }
-    else if (_stricmp(value, "SRC_ALPHA") == 0)
+    else if (IsEqualAsLower(value, "SRC_ALPHA"))
     { type = BLEND_TYPE_SRC_ALPHA; }
-    else if (_stricmp(value, "INV_SRC_ALPHA") == 0)
+    else if (IsEqualAsLower(value, "INV_SRC_ALPHA"))
     { type = BLEND_TYPE_INV_SRC_ALPHA; }
-    else if (_stricmp(value, "DST_ALPHA") == 0)
+    else if (IsEqualAsLower(value, "DST_ALPHA"))
     { type = BLEND_TYPE_DST_ALPHA; }
-    else if (_stricmp(value, "INV_DST_ALPHA") == 0)
+    else if (IsEqualAsLower(value, "INV_DST_ALPHA"))
     { type = BLEND_TYPE_INV_DST_ALPHA; }
-    else if (_stricmp(value, "DST_COLOR") == 0)
+    else if (IsEqualAsLower(value, "DST_COLOR"))
     { type = BLEND_TYPE_DST_COLOR; }
-    else if (_stricmp(value, "INV_DST_COLOR") == 0)
+    else if (IsEqualAsLower(value, "INV_DST_COLOR"))
     { type = BLEND_TYPE_INV_DST_COLOR; }
 
     return type;
@@ -373,13 +564,13 @@ BLEND_TYPE ParseBlendType(const char* value)
 //-----------------------------------------------------------------------------
 //      FILTER_MODE型を解析します.
 //-----------------------------------------------------------------------------
-FILTER_MODE ParseFilterMode(const char* value)
+FILTER_MODE ParseFilterMode(std::string_view value)
 {
     FILTER_MODE result = FILTER_MODE_NEAREST;
 
-    if (_stricmp(value, "NEAREST") == 0)
+    if (IsEqualAsLower(value, "NEAREST"))
     { result = FILTER_MODE_NEAREST; }
-    else if (_stricmp(value, "LINEAR") == 0)
+    else if (IsEqualAsLower(value, "LINEAR"))
     { result = FILTER_MODE_LINEAR; }
 
     return result;
@@ -388,15 +579,15 @@ FILTER_MODE ParseFilterMode(const char* value)
 //-----------------------------------------------------------------------------
 //      MIPMAP_MODE型を解析します.
 //-----------------------------------------------------------------------------
-MIPMAP_MODE ParseMipmapMode(const char* value)
+MIPMAP_MODE ParseMipmapMode(std::string_view value)
 {
     MIPMAP_MODE result = MIPMAP_MODE_NEAREST;
 
-    if (_stricmp(value, "NEAREST") == 0)
+    if (IsEqualAsLower(value, "NEAREST"))
     { result = MIPMAP_MODE_NEAREST; }
-    else if (_stricmp(value, "LINEAR") == 0)
+    else if (IsEqualAsLower(value, "LINEAR"))
     { result = MIPMAP_MODE_LINEAR; }
-    else if (_stricmp(value, "NONE") == 0)
+    else if (IsEqualAsLower(value, "NONE"))
     { result = MIPMAP_MODE_NONE; }
 
     return result;
@@ -405,17 +596,17 @@ MIPMAP_MODE ParseMipmapMode(const char* value)
 //-----------------------------------------------------------------------------
 //      ADDRESS_MODE型を解析します.
 //-----------------------------------------------------------------------------
-ADDRESS_MODE ParseAddressMode(const char* value)
+ADDRESS_MODE ParseAddressMode(std::string_view value)
 {
     ADDRESS_MODE result = ADDRESS_MODE_CLAMP;
 
-    if (_stricmp(value, "CLAMP") == 0)
+    if (IsEqualAsLower(value, "CLAMP"))
     { result = ADDRESS_MODE_CLAMP; }
-    else if (_stricmp(value, "WRAP") == 0)
+    else if (IsEqualAsLower(value, "WRAP"))
     { result = ADDRESS_MODE_WRAP; }
-    else if (_stricmp(value, "MIRROR") == 0)
+    else if (IsEqualAsLower(value, "MIRROR"))
     { result = ADDRESS_MODE_MIRROR; }
-    else if (_stricmp(value, "BORDER") == 0)
+    else if (IsEqualAsLower(value, "BORDER"))
     { result = ADDRESS_MODE_BORDER; }
 
     return result;
@@ -424,15 +615,15 @@ ADDRESS_MODE ParseAddressMode(const char* value)
 //-----------------------------------------------------------------------------
 //      BORDER_COLOR型を解析します.
 //-----------------------------------------------------------------------------
-BORDER_COLOR ParseBorderColor(const char* value)
+BORDER_COLOR ParseBorderColor(std::string_view value)
 {
     BORDER_COLOR result = BORDER_COLOR_TRANSPARENT_BLACK;
 
-    if (_stricmp(value, "TRANSPARENT_BLACK") == 0)
+    if (IsEqualAsLower(value, "TRANSPARENT_BLACK"))
     { result = BORDER_COLOR_TRANSPARENT_BLACK; }
-    else if (_stricmp(value, "OPAQUE_BLACK") == 0)
+    else if (IsEqualAsLower(value, "OPAQUE_BLACK"))
     { result = BORDER_COLOR_OPAQUE_BLACK; }
-    else if (_stricmp(value, "OAPQUE_WHITE") == 0)
+    else if (IsEqualAsLower(value, "OAPQUE_WHITE"))
     { result = BORDER_COLOR_OPAQUE_WHITE; }
 
     return result;
@@ -441,15 +632,15 @@ BORDER_COLOR ParseBorderColor(const char* value)
 //-----------------------------------------------------------------------------
 //      CULL_TYPE型を解析します.
 //-----------------------------------------------------------------------------
-CULL_TYPE ParseCullType(const char* value)
+CULL_TYPE ParseCullType(std::string_view value)
 {
     CULL_TYPE result = CULL_TYPE_NONE;
 
-    if (_stricmp(value, "NONE") == 0)
+    if (IsEqualAsLower(value, "NONE"))
     { result = CULL_TYPE_NONE; }
-    else if (_stricmp(value, "FRONT") == 0)
+    else if (IsEqualAsLower(value, "FRONT"))
     { result = CULL_TYPE_FRONT; }
-    else if (_stricmp(value, "BACK") == 0)
+    else if (IsEqualAsLower(value, "BACK"))
     { result = CULL_TYPE_BACK; }
 
     return result;
@@ -458,23 +649,23 @@ CULL_TYPE ParseCullType(const char* value)
 //-----------------------------------------------------------------------------
 //      COMPARE_TYPE型を解析します.
 //-----------------------------------------------------------------------------
-COMPARE_TYPE ParseCompareType(const char* value)
+COMPARE_TYPE ParseCompareType(std::string_view value)
 {
     COMPARE_TYPE result = COMPARE_TYPE_NEVER;
 
-    if (_stricmp(value, "NEVER") == 0)
+    if (IsEqualAsLower(value, "NEVER"))
     { result = COMPARE_TYPE_NEVER; }
-    else if (_stricmp(value, "LESS") == 0)
+    else if (IsEqualAsLower(value, "LESS"))
     { result = COMPARE_TYPE_LESS; }
-    else if (_stricmp(value, "EQUAL") == 0)
+    else if (IsEqualAsLower(value, "EQUAL"))
     { result = COMPARE_TYPE_EQUAL; }
-    else if (_stricmp(value, "LEQUAL") == 0)
+    else if (IsEqualAsLower(value, "LEQUAL"))
     { result = COMPARE_TYPE_LEQUAL; }
-    else if (_stricmp(value, "GREATER") == 0)
+    else if (IsEqualAsLower(value, "GREATER"))
     { result = COMPARE_TYPE_GREATER; }
-    else if (_stricmp(value, "NEQUAL") == 0)
+    else if (IsEqualAsLower(value, "NEQUAL"))
     { result = COMPARE_TYPE_NEQUAL; }
-    else if (_stricmp(value, "GEQUAL") == 0)
+    else if (IsEqualAsLower(value, "GEQUAL"))
     { result = COMPARE_TYPE_GREATER; }
 
     return result;
@@ -483,25 +674,25 @@ COMPARE_TYPE ParseCompareType(const char* value)
 //-----------------------------------------------------------------------------
 //      STENCIL_OP_TYPE型を解析します.
 //-----------------------------------------------------------------------------
-STENCIL_OP_TYPE ParseStencilOpType(const char* value)
+STENCIL_OP_TYPE ParseStencilOpType(std::string_view value)
 {
     STENCIL_OP_TYPE result = STENCIL_OP_KEEP;
 
-    if (_stricmp(value, "KEEP") == 0)
+    if (IsEqualAsLower(value, "KEEP"))
     { result = STENCIL_OP_KEEP; }
-    else if (_stricmp(value, "ZERO") == 0)
+    else if (IsEqualAsLower(value, "ZERO"))
     { result = STENCIL_OP_ZERO; }
-    else if (_stricmp(value, "REPLACE") == 0)
+    else if (IsEqualAsLower(value, "REPLACE"))
     { result = STENCIL_OP_REPLACE; }
-    else if (_stricmp(value, "INCR_SAT") == 0)
+    else if (IsEqualAsLower(value, "INCR_SAT"))
     { result = STENCIL_OP_INCR_SAT; }
-    else if (_stricmp(value, "DECR_SAT") == 0)
+    else if (IsEqualAsLower(value, "DECR_SAT"))
     { result = STENCIL_OP_DECR_SAT; }
-    else if (_stricmp(value, "INVERT") == 0)
+    else if (IsEqualAsLower(value, "INVERT"))
     { result = STENCIL_OP_INVERT; }
-    else if (_stricmp(value, "INCR") == 0)
+    else if (IsEqualAsLower(value, "INCR"))
     { result = STENCIL_OP_INCR; }
-    else if (_stricmp(value, "DECR") == 0)
+    else if (IsEqualAsLower(value, "DECR"))
     { result = STENCIL_OP_DECR; }
 
     return result;
@@ -510,13 +701,13 @@ STENCIL_OP_TYPE ParseStencilOpType(const char* value)
 //-----------------------------------------------------------------------------
 //      DEPTH_WRITE_MASK型を解析します.
 //-----------------------------------------------------------------------------
-DEPTH_WRITE_MASK ParseDepthWriteMask(const char* value)
+DEPTH_WRITE_MASK ParseDepthWriteMask(std::string_view value)
 {
     DEPTH_WRITE_MASK result = DEPTH_WRITE_MASK_ALL;
 
-    if (_stricmp(value, "ALL") == 0)
+    if (IsEqualAsLower(value, "ALL"))
     { result = DEPTH_WRITE_MASK_ALL; }
-    else if (_stricmp(value, "ZERO") == 0)
+    else if (IsEqualAsLower(value, "ZERO"))
     { result = DEPTH_WRITE_MASK_ZERO; }
 
     return result;
@@ -525,24 +716,100 @@ DEPTH_WRITE_MASK ParseDepthWriteMask(const char* value)
 //-----------------------------------------------------------------------------
 //      BLEND_OP_TYPE型を解析します.
 //-----------------------------------------------------------------------------
-BLEND_OP_TYPE ParseBlendOpType(const char* value)
+BLEND_OP_TYPE ParseBlendOpType(std::string_view value)
 {
     BLEND_OP_TYPE result = BLEND_OP_TYPE_ADD;
 
-    if (_stricmp(value, "ADD") == 0)
+    if (IsEqualAsLower(value, "ADD"))
     { result = BLEND_OP_TYPE_ADD; }
-    else if (_stricmp(value, "SUB") == 0)
+    else if (IsEqualAsLower(value, "SUB"))
     { result = BLEND_OP_TYPE_SUB; }
-    else if (_stricmp(value, "REV_SUB") == 0)
+    else if (IsEqualAsLower(value, "REV_SUB"))
     { result = BLEND_OP_TYPE_REV_SUB; }
-    else if (_stricmp(value, "MIN") == 0)
+    else if (IsEqualAsLower(value, "MIN"))
     { result = BLEND_OP_TYPE_MIN; }
-    else if (_stricmp(value, "MAX") == 0)
+    else if (IsEqualAsLower(value, "MAX"))
     { result = BLEND_OP_TYPE_MAX; }
 
     return result;
 }
 
+//-----------------------------------------------------------------------------
+//      MEMBER_TYPE型を解析します.
+//-----------------------------------------------------------------------------
+MEMBER_TYPE ParseMemberType(std::string_view value)
+{
+    // 基本型ごとに BASE, 1x2..1x4, 2, 2x1..2x4, 3, 3x1..3x4, 4, 4x1..4x4 の順で並んでいるので,
+    // 基本型・行数・列数を読み取って列挙値を算出する.
+    if (value.size() < 3)
+    { return MEMBER_TYPE_UNKNOWN; }
+
+    MEMBER_TYPE base = MEMBER_TYPE_UNKNOWN;
+    const char* name = nullptr;
+
+    switch(value[0])
+    {
+        case 'b':
+            base = MEMBER_TYPE_BOOL;
+            name = "bool";
+            break;
+
+        case 'i':
+            base = MEMBER_TYPE_INT;
+            name = "int";
+            break;
+
+        case 'u':
+            base = MEMBER_TYPE_UINT;
+            name = "uint";
+            break;
+
+        case 'f':
+            base = MEMBER_TYPE_FLOAT;
+            name = "float";
+            break;
+
+        case 'd':
+            base = MEMBER_TYPE_DOUBLE;
+            name = "double";
+            break;
+
+        default:
+            return MEMBER_TYPE_UNKNOWN;
+    }
+
+    auto length = strlen(name);
+    if (value.compare(0, length, name) != 0)
+    { return MEMBER_TYPE_UNKNOWN; }
+
+    auto suffix = value.substr(length);
+
+    // スカラー.
+    if (suffix.empty() || suffix == "1")
+    { return base; }
+
+    auto row = suffix[0] - '0';
+    if (row < 1 || row > 4)
+    { return MEMBER_TYPE_UNKNOWN; }
+
+    // ベクトル.
+    if (suffix.size() == 1)
+    { return MEMBER_TYPE(base + 4 + (row - 2) * 5); }
+
+    if (suffix.size() != 3 || suffix[1] != 'x')
+    { return MEMBER_TYPE_UNKNOWN; }
+
+    auto col = suffix[2] - '0';
+    if (col < 1 || col > 4)
+    { return MEMBER_TYPE_UNKNOWN; }
+
+    // 行列(1x1は対応する列挙値が無い).
+    if (row == 1)
+    { return (col == 1) ? MEMBER_TYPE_UNKNOWN : MEMBER_TYPE(base + col - 1); }
+
+    return MEMBER_TYPE(base + 4 + (row - 2) * 5 + col);
+}
+
 //-----------------------------------------------------------------------------
 //      ファイルパスからディレクトリ名を取得します.
 //-----------------------------------------------------------------------------
@@ -591,57 +858,48 @@ std::string Replace
 }
 
 //-----------------------------------------------------------------------------
-//      文字列を置換します.
+//      改行コードをLFに変換しながら文字列を追加します.
 //-----------------------------------------------------------------------------
-std::string Replace
-(
-    const std::string& input,
-    const std::string& pattern,
-    const std::string& replace,
-    bool& hit
-)
+void AppendAsLF(std::string& output, const char* text, size_t size)
 {
-    std::string result = input;
-    auto pos = result.find(pattern);
-    hit = false;
-
-    while (pos != std::string::npos)
+    auto end = text + size;
+    while(text < end)
     {
-        result.replace(pos, pattern.length(), replace);
-        pos = result.find(pattern, pos + replace.length());
-        hit = true;
-    }
+        auto pos = static_cast<const char*>(memchr(text, '\n', end - text));
+        if (pos == nullptr)
+        {
+            output.append(text, end);
+            break;
+        }
 
-    return result;
+        output.append(text, pos);
+
+        // 直前の\rは\nに置き換える.
+        if (!output.empty() && output.back() == '\r')
+        { output.back() = '\n'; }
+        else
+        { output.push_back('\n'); }
+
+        text = pos + 1;
+    }
 }
 
 //-----------------------------------------------------------------------------
-//      ファイルをロードします.
+//      空白区切りで次の単語を取得します.
 //-----------------------------------------------------------------------------
-bool LoadFile(const char* filename, std::string& result)
+bool NextWord(std::string_view text, size_t& pos, std::string_view& word)
 {
-    FILE* pFile = nullptr;
-    auto err = fopen_s(&pFile, filename, "rb");
-    if (err != 0 || pFile == nullptr)
-    {
-        ELOG("Erorr : File Open Failed. path = %s", filename);
-        return false;
-    }
+    while(pos < text.size() && isspace(uint8_t(text[pos])))
+    { pos++; }
 
-    auto cur_pos = ftell(pFile);
-    fseek(pFile, 0, SEEK_END);
-    auto end_pos = ftell(pFile);
-    fseek(pFile, 0, SEEK_SET);
-
-    auto size = size_t(end_pos) - size_t(cur_pos);
-    auto pBuffer = new char[size + 1];
-    fread(pBuffer, size, 1, pFile);
-    pBuffer[size] = '\0';
-    fclose(pFile);
+    if (pos >= text.size())
+    { return false; }
 
-    result = pBuffer;
-    delete[] pBuffer;
+    auto begin = pos;
+    while(pos < text.size() && !isspace(uint8_t(text[pos])))
+    { pos++; }
 
+    word = text.substr(begin, pos - begin);
     return true;
 }
 
@@ -657,6 +915,8 @@ FxParser::FxParser()
 : m_Tokenizer    ()
 , m_Technieues   ()
 , m_ShaderCounter(0)
+, m_pSourceCache (nullptr)
+, m_IncludeStats ()
 { /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
@@ -684,12 +944,20 @@ void FxParser::Clear()
     m_Resources.clear();
     m_Properties.Values.clear();
     m_Properties.Textures.clear();
+    m_Keywords.Groups.clear();
+    m_Keywords.Rules.clear();
     m_ShaderCounter = 0;
     m_DirPaths.clear();
     m_DirPaths.shrink_to_fit();
     m_Includes.clear();
     m_Includes.shrink_to_fit();
+    m_IncludeMap.clear();
+    m_SourceFiles.clear();
+    m_MissingFiles.clear();
+    m_LocalCache.Clear();
+    m_IncludeStats = {};
     m_Expanded.clear();
+    m_Input = std::string_view();
     m_SourceCode.clear();
 }
 
@@ -704,48 +972,53 @@ bool FxParser::Parse(const char* filename)
         return false;
     }
 
-    if (!m_Tokenizer.Init(2048))
-    {
-        ELOG( "Error : Tokenizer Initialize failed." );
-        return false;
-    }
-
     m_SourceCode.clear();
-    m_SourceCode.reserve( m_Expanded.size() );
+    m_SourceCode.reserve( m_Input.size() );
 
     m_Tokenizer.SetSeparator( " \t\r\n,\"" );
     m_Tokenizer.SetCutOff( "{}()=#<>;" );
-    m_Tokenizer.SetBuffer( const_cast<char*>(m_Expanded.c_str()), m_Expanded.size() );
+    m_Tokenizer.SetBuffer( const_cast<char*>(m_Input.data()), m_Input.size() );
 
-    auto cur = m_Tokenizer.GetBuffer();
+    auto cur        = m_Tokenizer.GetBuffer();
+    auto terminator = false;    // 取り除いたブロックの直後かどうか.
 
     while(!m_Tokenizer.IsEnd())
     {
         bool output = true;
+        bool removed = terminator;
+        terminator = false;
 
+        // キーワードを判定.
+        auto keyword = FindKeyword(m_Tokenizer.GetAsView());
+
+        // 取り除いたブロックに続く ; も出力しない.
+        if (removed && m_Tokenizer.Compare(";"))
+        {
+            output = false;
+        }
         // プリプロセッサ系.
-        if (m_Tokenizer.Compare("#"))
+        else if (m_Tokenizer.Compare("#"))
         {
             ParsePreprocessor();
         }
         // テクニック.
-        else if (m_Tokenizer.CompareAsLower("technique"))
+        else if (keyword == KEYWORD_TECHNIQUE)
         {
             output = false;
             ParseTechnique();
         }
         // 定数バッファ.
-        else if (m_Tokenizer.CompareAsLower("cbuffer"))
+        else if (keyword == KEYWORD_CBUFFER)
         {
             ParseConstantBuffer();
         }
         // 構造体.
-        else if (m_Tokenizer.CompareAsLower("struct"))
+        else if (keyword == KEYWORD_STRUCT)
         {
             ParseStruct();
         }
         // プロパティ.
-        else if (m_Tokenizer.CompareAsLower("properties"))
+        else if (keyword == KEYWORD_PROPERTIES)
         {
             auto ptr = m_Tokenizer.GetPtr();
             auto size = (ptr - cur) - strlen("properties");
@@ -756,60 +1029,46 @@ bool FxParser::Parse(const char* filename)
             }
 
             ParseProperties();
-            output = false;
+            output     = false;
+            terminator = true;
+        }
+        // キーワード.
+        else if (keyword == KEYWORD_KEYWORDS)
+        {
+            auto ptr = m_Tokenizer.GetPtr();
+            auto size = (ptr - cur) - strlen("keywords");
+            if (size > 0)
+            {
+                m_SourceCode.append(cur, size);
+                cur = ptr;
+            }
+
+            ParseKeywords();
+            output     = false;
+            terminator = true;
         }
-        else if (
-           m_Tokenizer.CompareAsLower("Texture1D")
-        || m_Tokenizer.CompareAsLower("Texture1DArray")
-        || m_Tokenizer.CompareAsLower("Texture2D")
-        || m_Tokenizer.CompareAsLower("Texture2DArray")
-        || m_Tokenizer.CompareAsLower("Texture2DMS")
-        || m_Tokenizer.CompareAsLower("Texture2DMSArray")
-        || m_Tokenizer.CompareAsLower("Texture3D")
-        || m_Tokenizer.CompareAsLower("TextureCube")
-        || m_Tokenizer.CompareAsLower("TextureCubeArray")
-        || m_Tokenizer.CompareAsLower("Buffer")
-        || m_Tokenizer.CompareAsLower("ByteAddressBuffer")
-        || m_Tokenizer.CompareAsLower("StructuredBuffer")
-        || m_Tokenizer.CompareAsLower("RWTexture1D")
-        || m_Tokenizer.CompareAsLower("RWTexture1DArray")
-        || m_Tokenizer.CompareAsLower("RWTexture2D")
-        || m_Tokenizer.CompareAsLower("RWTexture2DArray")
-        || m_Tokenizer.CompareAsLower("RWTexture3D")
-        || m_Tokenizer.CompareAsLower("RWBuffer")
-        || m_Tokenizer.CompareAsLower("RWByteAddressBuffer")
-        || m_Tokenizer.CompareAsLower("RWStructuredBuffer")
-        || m_Tokenizer.CompareAsLower("SamplerState")
-        || m_Tokenizer.CompareAsLower("SamplerComparisonState"))
+        // リソース.
+        else if (keyword == KEYWORD_RESOURCE)
         {
             ParseResource();
         }
         // シェーダ.
-        else if (
-            m_Tokenizer.CompareAsLower("vertexshader") 
-         || m_Tokenizer.CompareAsLower("pixelshader")
-         || m_Tokenizer.CompareAsLower("geometryshader")
-         || m_Tokenizer.CompareAsLower("domainshader")
-         || m_Tokenizer.CompareAsLower("hullshader") 
-         || m_Tokenizer.CompareAsLower("computeshader")
-         || m_Tokenizer.CompareAsLower("amplificationshader")
-         || m_Tokenizer.CompareAsLower("meshshader")
-        )
+        else if (keyword == KEYWORD_SHADER)
         {
             output = false;
             ParseShader();
         }
-        else if (m_Tokenizer.CompareAsLower("BlendState"))
+        else if (keyword == KEYWORD_BLEND_STATE)
         {
             output = false;
             ParseBlendState();
         }
-        else if (m_Tokenizer.CompareAsLower("RasterizerState"))
+        else if (keyword == KEYWORD_RASTERIZER_STATE)
         {
             output = false;
             ParseRasterizerState();
         }
-        else if ((m_Tokenizer.CompareAsLower("DepthStencilState")))
+        else if (keyword == KEYWORD_DEPTH_STENCIL_STATE)
         {
             output = false;
             ParseDepthStencilState();
@@ -863,23 +1122,35 @@ bool FxParser::Load(const char* filename)
     m_DirPaths.push_back(dir);
 
     // インクルード情報を収集.
-    if (!CorrectIncludes(filename))
-    { return false; }
-
-    for(size_t i=0; i<m_Includes.size(); ++i)
-    { LoadFile(m_Includes[i].FindPath.c_str(), m_Includes[i].Code); }
+    auto pSource = CorrectIncludes(filename);
+    if (pSource == nullptr)
+    {
+        ELOG("Erorr : File Open Failed. path = %s", filename);
+        return false;
+    }
 
     m_Expanded.clear();
 
-    if (!LoadFile(filename, m_Expanded))
-    { return false; }
-
-    for(;;)
+    // 展開も改行コードの変換も不要なら, マップした内容をそのまま解析する.
+    auto& code = pSource->Code;
+    if (m_Includes.empty() && code.find('\r') == std::string_view::npos)
     {
-        if (!Expand(m_Expanded))
-        { break; }
+        m_Input = code;
+        return true;
     }
 
+    size_t totalSize = 0;
+    for(auto& itr : m_SourceFiles)
+    { totalSize += itr.second->Code.size(); }
+
+    m_Expanded.reserve(totalSize);
+
+    std::vector<const SourceFile*> stack;
+    std::set<const SourceFile*>    onceFiles;
+    if (!Expand(pSource, m_Expanded, stack, onceFiles))
+    { return false; }
+
+    m_Input = m_Expanded;
     return true;
 }
 
@@ -910,7 +1181,7 @@ void FxParser::ParseShader()
     else
     {
         // 変数名取得.
-        variable = std::string(m_Tokenizer.GetAsChar());
+        variable = std::string(m_Tokenizer.GetAsView());
         m_Tokenizer.Next();
         assert(m_Tokenizer.Compare("="));
         m_Tokenizer.Next();
@@ -920,10 +1191,10 @@ void FxParser::ParseShader()
     assert(m_Tokenizer.Compare("compile"));
 
     // プロファイル名を取得.
-    profile = std::string(m_Tokenizer.NextAsChar());
+    profile = std::string(m_Tokenizer.NextAsView());
    
     // エントリーポイント名を取得.
-    entryPoint = std::string(m_Tokenizer.NextAsChar());
+    entryPoint = std::string(m_Tokenizer.NextAsView());
 
     m_Tokenizer.Next();
     assert(m_Tokenizer.Compare("("));
@@ -940,7 +1211,7 @@ void FxParser::ParseShader()
         { break; }
        
         // メソッド引数を追加.
-        data.Arguments.push_back( std::string(m_Tokenizer.GetAsChar()) );
+        data.Arguments.push_back( std::string(m_Tokenizer.GetAsView()) );
 
         m_Tokenizer.Next();
     }
@@ -958,7 +1229,7 @@ void FxParser::ParseTechnique()
     m_Tokenizer.Next();
 
     // テクニック名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
 
     // テクニックブロック開始.
     m_Tokenizer.Next();
@@ -997,7 +1268,7 @@ void FxParser::ParsePass(Technique& technique)
     m_Tokenizer.Next();
 
     // パス名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
 
     // パスブロック開始.
     m_Tokenizer.Next();
@@ -1012,6 +1283,9 @@ void FxParser::ParsePass(Technique& technique)
 
     while(!m_Tokenizer.IsEnd())
     {
+        // キーワードを判定.
+        auto keyword = FindKeyword(m_Tokenizer.GetAsView());
+
         // パスブロック終了.
         if (m_Tokenizer.Compare("}"))
         {
@@ -1023,7 +1297,7 @@ void FxParser::ParsePass(Technique& technique)
         {
             blockCount++;
         }
-        else if (m_Tokenizer.CompareAsLower("RasterizerState"))
+        else if (keyword == KEYWORD_RASTERIZER_STATE)
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
@@ -1031,7 +1305,7 @@ void FxParser::ParsePass(Technique& technique)
             m_Tokenizer.Next();
 
             // 変数名を取得.
-            name = std::string(m_Tokenizer.GetAsChar());
+            name = std::string(m_Tokenizer.GetAsView());
 
             // 変数名からステートを引っ張ってくる.
             auto itr = m_RasterizerStates.find(name);
@@ -1042,7 +1316,7 @@ void FxParser::ParsePass(Technique& technique)
                 pass.RasterizerState = itr->first;
             }
         }
-        else if (m_Tokenizer.CompareAsLower("DepthStencilState"))
+        else if (keyword == KEYWORD_DEPTH_STENCIL_STATE)
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
@@ -1050,7 +1324,7 @@ void FxParser::ParsePass(Technique& technique)
             m_Tokenizer.Next();
 
             // 変数名を取得.
-            name = std::string(m_Tokenizer.GetAsChar());
+            name = std::string(m_Tokenizer.GetAsView());
 
             // 変数名からステートを引っ張ってくる.
             auto itr = m_DepthStencilStates.find(name);
@@ -1061,7 +1335,7 @@ void FxParser::ParsePass(Technique& technique)
                 pass.DepthStencilState = itr->first;
             }
         }
-        else if (m_Tokenizer.CompareAsLower("BlendState"))
+        else if (keyword == KEYWORD_BLEND_STATE)
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
@@ -1069,7 +1343,7 @@ void FxParser::ParsePass(Technique& technique)
             m_Tokenizer.Next();
 
             // 変数名を取得.
-            name = std::string(m_Tokenizer.GetAsChar());
+            name = std::string(m_Tokenizer.GetAsView());
 
             // 変数名からステートを引っ張ってくる.
             auto itr = m_BlendStates.find(name);
@@ -1081,15 +1355,7 @@ void FxParser::ParsePass(Technique& technique)
             }
         }
         // シェーダデータ.
-        else if (
-            m_Tokenizer.CompareAsLower("VertexShader")
-         || m_Tokenizer.CompareAsLower("PixelShader")
-         || m_Tokenizer.CompareAsLower("GeometryShader")
-         || m_Tokenizer.CompareAsLower("DomainShader")
-         || m_Tokenizer.CompareAsLower("HullShader")
-         || m_Tokenizer.CompareAsLower("ComputeShader")
-         || m_Tokenizer.CompareAsLower("AmplificationShader")
-         || m_Tokenizer.CompareAsLower("MeshShader"))
+        else if (keyword == KEYWORD_SHADER)
         {
             // シェーダタイプを取得.
             Shader shader = {};
@@ -1104,10 +1370,10 @@ void FxParser::ParsePass(Technique& technique)
             if (m_Tokenizer.Compare("compile"))
             {
                 // シェーダプロファイル名を取得.
-                shader.Profile      = std::string(m_Tokenizer.NextAsChar());
+                shader.Profile      = std::string(m_Tokenizer.NextAsView());
 
                 // エントリーポイント名を取得.
-                shader.EntryPoint   = std::string(m_Tokenizer.NextAsChar());
+                shader.EntryPoint   = std::string(m_Tokenizer.NextAsView());
 
                 // メソッド引数開始.
                 m_Tokenizer.Next();
@@ -1132,7 +1398,7 @@ void FxParser::ParsePass(Technique& technique)
                     }
 
                     // 引数を追加.
-                    shader.Arguments.push_back(m_Tokenizer.GetAsChar());
+                    shader.Arguments.emplace_back(m_Tokenizer.GetAsView());
 
                     // 次のトークンを取得.
                     m_Tokenizer.Next();
@@ -1148,7 +1414,7 @@ void FxParser::ParsePass(Technique& technique)
                 { m_Tokenizer.Next(); }
 
                 // 変数名を取得.
-                name = std::string(m_Tokenizer.GetAsChar());
+                name = std::string(m_Tokenizer.GetAsView());
 
                 // 変数名からシェーダを引っ張ってくる.
                 auto itr = m_Shaders.find(name);
@@ -1179,8 +1445,8 @@ void FxParser::ParsePreprocessor()
 
     if (m_Tokenizer.Compare("define"))
     {
-        auto tag = std::string(m_Tokenizer.NextAsChar());
-        auto val = std::string(m_Tokenizer.NextAsChar());
+        auto tag = std::string(m_Tokenizer.NextAsView());
+        auto val = std::string(m_Tokenizer.NextAsView());
         m_Defines[tag] = val;
     }
     else if (m_Tokenizer.Compare("elif"))
@@ -1215,7 +1481,7 @@ void FxParser::ParsePreprocessor()
     }
     else if (m_Tokenizer.Compare("undef"))
     {
-        auto tag = std::string(m_Tokenizer.NextAsChar());
+        auto tag = std::string(m_Tokenizer.NextAsView());
         m_Defines.erase(tag);
     }
 }
@@ -1228,7 +1494,7 @@ void FxParser::ParseBlendState()
     m_Tokenizer.Next();
 
     // ステート名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
 
     // ステートブロック開始.
     m_Tokenizer.Next();
@@ -1270,7 +1536,7 @@ void FxParser::ParseBlendState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            auto value = m_Tokenizer.NextAsChar();
+            auto value = m_Tokenizer.NextAsView();
             state.SrcBlend = ParseBlendType(value);
         }
         else if (m_Tokenizer.CompareAsLower("DstBlend"))
@@ -1278,7 +1544,7 @@ void FxParser::ParseBlendState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            auto value = m_Tokenizer.NextAsChar();
+            auto value = m_Tokenizer.NextAsView();
             state.DstBlend = ParseBlendType(value);
         }
         else if (m_Tokenizer.CompareAsLower("BlendOp"))
@@ -1286,7 +1552,7 @@ void FxParser::ParseBlendState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            auto value = m_Tokenizer.NextAsChar();
+            auto value = m_Tokenizer.NextAsView();
             state.BlendOp = ParseBlendOpType(value);
         }
         else if (m_Tokenizer.CompareAsLower("SrcBlendAlpha"))
@@ -1294,7 +1560,7 @@ void FxParser::ParseBlendState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            auto value = m_Tokenizer.NextAsChar();
+            auto value = m_Tokenizer.NextAsView();
             state.SrcBlendAlpha = ParseBlendType(value);
         }
         else if (m_Tokenizer.CompareAsLower("DstBlendAlpha"))
@@ -1302,7 +1568,7 @@ void FxParser::ParseBlendState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            auto value = m_Tokenizer.NextAsChar();
+            auto value = m_Tokenizer.NextAsView();
             state.DstBlendAlpha = ParseBlendType(value);
         }
         else if (m_Tokenizer.CompareAsLower("BlendOpAlpha"))
@@ -1310,7 +1576,7 @@ void FxParser::ParseBlendState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            auto value = m_Tokenizer.NextAsChar();
+            auto value = m_Tokenizer.NextAsView();
             state.BlendOpAlpha = ParseBlendOpType(value);
         }
         else if (m_Tokenizer.CompareAsLower("RenderTargetWriteMask"))
@@ -1337,7 +1603,7 @@ void FxParser::ParseRasterizerState()
     m_Tokenizer.Next();
 
     // ステート名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
 
     // ステートブロック開始.
     m_Tokenizer.Next();
@@ -1365,14 +1631,14 @@ void FxParser::ParseRasterizerState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.PolygonMode = ParsePolygonMode(m_Tokenizer.NextAsChar());
+            state.PolygonMode = ParsePolygonMode(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("CullMode"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.CullMode = ParseCullType(m_Tokenizer.NextAsChar());
+            state.CullMode = ParseCullType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("FrontCCW"))
         {
@@ -1432,7 +1698,7 @@ void FxParser::ParseDepthStencilState()
     m_Tokenizer.Next();
 
     // ステート名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
 
     // ステートブロック開始.
     m_Tokenizer.Next();
@@ -1467,14 +1733,14 @@ void FxParser::ParseDepthStencilState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.DepthWriteMask = ParseDepthWriteMask(m_Tokenizer.NextAsChar());
+            state.DepthWriteMask = ParseDepthWriteMask(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("DepthFunc"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.DepthFunc = ParseCompareType(m_Tokenizer.NextAsChar());
+            state.DepthFunc = ParseCompareType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("StencilEnable"))
         {
@@ -1502,56 +1768,56 @@ void FxParser::ParseDepthStencilState()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.FrontFaceStencilFail = ParseStencilOpType(m_Tokenizer.NextAsChar());
+            state.FrontFaceStencilFail = ParseStencilOpType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("FrontFaceStencilDepthFail"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.FrontFaceStencilDepthFail = ParseStencilOpType(m_Tokenizer.NextAsChar());
+            state.FrontFaceStencilDepthFail = ParseStencilOpType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("FrontFaceStencilPass"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.FrontFaceStencilPass = ParseStencilOpType(m_Tokenizer.NextAsChar());
+            state.FrontFaceStencilPass = ParseStencilOpType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("FrontFaceStencilFunc"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.FrontFaceStencilFunc = ParseCompareType(m_Tokenizer.NextAsChar());
+            state.FrontFaceStencilFunc = ParseCompareType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("BackFaceStencilFail"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.BackFaceStencilFail = ParseStencilOpType(m_Tokenizer.NextAsChar());
+            state.BackFaceStencilFail = ParseStencilOpType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("BackFaceStencilDepthFail"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.BackFaceStencilDepthFail = ParseStencilOpType(m_Tokenizer.NextAsChar());
+            state.BackFaceStencilDepthFail = ParseStencilOpType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("BackFaceStencilPass"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.BackFaceStencilPass = ParseStencilOpType(m_Tokenizer.NextAsChar());
+            state.BackFaceStencilPass = ParseStencilOpType(m_Tokenizer.NextAsView());
         }
         else if (m_Tokenizer.CompareAsLower("BackFaceStencilFunc"))
         {
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("="));
 
-            state.BackFaceStencilFunc = ParseCompareType(m_Tokenizer.NextAsChar());
+            state.BackFaceStencilFunc = ParseCompareType(m_Tokenizer.NextAsView());
         }
 
         m_Tokenizer.Next();
@@ -1569,7 +1835,7 @@ void FxParser::ParseConstantBuffer()
     m_Tokenizer.Next();
 
     // 定数バッファ名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
 
     // 定数バッファ名を設定.
     ConstantBuffer buffer = {};
@@ -1584,7 +1850,7 @@ void FxParser::ParseConstantBuffer()
         m_Tokenizer.Next(); // register
         assert(m_Tokenizer.Compare("("));
         m_Tokenizer.Next(); // "("
-        auto regStr = std::string(m_Tokenizer.GetAsChar());
+        auto regStr = std::string(m_Tokenizer.GetAsView());
         auto regNo  = std::stoi(regStr.substr(1));
         buffer.Register = uint32_t(regNo);
         m_Tokenizer.Next(); // bxx
@@ -1598,935 +1864,149 @@ void FxParser::ParseConstantBuffer()
 
     while(!m_Tokenizer.IsEnd())
     {
+        // メンバー型を判定.
+        auto type = ParseMemberType(m_Tokenizer.GetAsView());
+
         // テクニックブロック終了.
         if (m_Tokenizer.Compare("}"))
         {
             break;
         }
-        else if (m_Tokenizer.Compare("float"))
+        else if (type != MEMBER_TYPE_UNKNOWN)
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT, buffer, modifier);
+            ParseConstantBufferMember(type, buffer, modifier);
         }
-        else if (m_Tokenizer.Compare("float1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float1x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT1x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float1x3"))
+        else if (m_Tokenizer.Compare("row_major"))
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT1x3, buffer, modifier);
+            modifier = TYPE_MODIFIER_ROW_MAJOR;
+            m_Tokenizer.Next();
         }
-        else if (m_Tokenizer.Compare("float1x4"))
+        else if (m_Tokenizer.Compare("colum_major"))
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT1x4, buffer, modifier);
+            modifier = TYPE_MODIFIER_COLUMN_MAJOR;
+            m_Tokenizer.Next();
         }
-        else if (m_Tokenizer.Compare("float2"))
+        else
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT2, buffer, modifier);
+            auto name = std::string(m_Tokenizer.GetAsView());
+            if (m_Structures.find(name) != m_Structures.end())
+            {
+                ParseConstantBufferMember(MEMBER_TYPE_STRUCT, buffer, modifier);
+            }
+            else
+            {
+                // 次のトークンを取得.
+                m_Tokenizer.Next();
+            }
         }
-        else if (m_Tokenizer.Compare("float2x1"))
+    }
+
+    if (m_ConstantBuffers.find(name) == m_ConstantBuffers.end())
+    { m_ConstantBuffers[name] = buffer; }
+}
+
+//-----------------------------------------------------------------------------
+//      定数バッファのメンバーを解析します.
+//-----------------------------------------------------------------------------
+void FxParser::ParseConstantBufferMember
+(
+    MEMBER_TYPE     type,
+    ConstantBuffer& buffer,
+    TYPE_MODIFIER&  modifier
+)
+{
+    Member member = {};
+    member.Type         = type;
+    member.Modifier     = modifier;
+    member.PackOffset   = -1;
+
+    auto name = std::string(m_Tokenizer.NextAsView());
+    auto pos = name.find(";");
+    auto end = false;
+    if (pos != std::string::npos)
+    {
+        end = true;
+        name = name.substr(0, pos);
+    }
+
+    member.Name = name;
+
+    modifier = TYPE_MODIFIER_NONE;
+
+    if (end)
+    {
+        buffer.Members.push_back(member);
+        return;
+    }
+
+    m_Tokenizer.Next();
+    if (m_Tokenizer.Compare("packoffset"))
+    {
+        auto offsetStr  = std::string(m_Tokenizer.GetAsView());
+        pos = offsetStr.find(";");
+        auto offset     = std::stoi(offsetStr.substr(1, pos));
+        member.PackOffset = uint32_t(offset);
+    }
+
+    buffer.Members.push_back(member);
+}
+
+//-----------------------------------------------------------------------------
+//      構造体を解析します.
+//-----------------------------------------------------------------------------
+void FxParser::ParseStruct()
+{
+    m_Tokenizer.Next();
+
+    // 構造体名を取得.
+    auto name = std::string(m_Tokenizer.GetAsView());
+
+    // 構造体名を設定.
+    Structure structure;
+    structure.Name = name;
+
+    m_Tokenizer.Next();
+
+    assert(m_Tokenizer.Compare("{"));
+
+    TYPE_MODIFIER modifier = TYPE_MODIFIER_NONE;
+
+    while(!m_Tokenizer.IsEnd())
+    {
+        // メンバー型を判定.
+        auto type = ParseMemberType(m_Tokenizer.GetAsView());
+
+        // 構造体ブロック終了.
+        if (m_Tokenizer.Compare("}"))
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT2x1, buffer, modifier);
+            break;
         }
-        else if (m_Tokenizer.Compare("float2x2"))
+        else if (type != MEMBER_TYPE_UNKNOWN)
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT2x2, buffer, modifier);
+            ParseStructMember(type, structure, modifier);
         }
-        else if (m_Tokenizer.Compare("float2x3"))
+        else if (m_Tokenizer.Compare("row_major"))
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT2x3, buffer, modifier);
+            modifier = TYPE_MODIFIER_ROW_MAJOR;
+            m_Tokenizer.Next();
         }
-        else if (m_Tokenizer.Compare("float2x4"))
+        else if (m_Tokenizer.Compare("colum_major"))
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT2x4, buffer, modifier);
+            modifier = TYPE_MODIFIER_COLUMN_MAJOR;
+            m_Tokenizer.Next();
         }
-        else if (m_Tokenizer.Compare("float3"))
+        else 
         {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT3x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT3x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT3x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT3x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT4x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT4x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT4x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_FLOAT4x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT1x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT1x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT1x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT2x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT2x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT2x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT2x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT3x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT3x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT3x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT3x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT4x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT4x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT4x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_INT4x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT1x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT1x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT1x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT2x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT2x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT2x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT2x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT3x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT3x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT3x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT3x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT4x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT4x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT4x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_UINT4x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL1x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL1x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL1x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL2x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL2x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL2x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL2x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL3x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL3x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL3x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL3x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL4x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL4x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL4x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_BOOL4x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE1x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE1x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE1x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE2x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE2x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE2x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE2x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE3x1, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE3x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE3x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE3x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x1"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x2"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE4x2, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x3"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE4x3, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x4"))
-        {
-            ParseConstantBufferMember(MEMBER_TYPE_DOUBLE4x4, buffer, modifier);
-        }
-        else if (m_Tokenizer.Compare("row_major"))
-        {
-            modifier = TYPE_MODIFIER_ROW_MAJOR;
-            m_Tokenizer.Next();
-        }
-        else if (m_Tokenizer.Compare("colum_major"))
-        {
-            modifier = TYPE_MODIFIER_COLUMN_MAJOR;
-            m_Tokenizer.Next();
-        }
-        else
-        {
-            auto name = m_Tokenizer.GetAsChar();
-            if (m_Structures.find(name) != m_Structures.end())
-            {
-                ParseConstantBufferMember(MEMBER_TYPE_STRUCT, buffer, modifier);
-            }
-            else
-            {
-                // 次のトークンを取得.
-                m_Tokenizer.Next();
-            }
-        }
-    }
-
-    if (m_ConstantBuffers.find(name) == m_ConstantBuffers.end())
-    { m_ConstantBuffers[name] = buffer; }
-}
-
-//-----------------------------------------------------------------------------
-//      定数バッファのメンバーを解析します.
-//-----------------------------------------------------------------------------
-void FxParser::ParseConstantBufferMember
-(
-    MEMBER_TYPE     type,
-    ConstantBuffer& buffer,
-    TYPE_MODIFIER&  modifier
-)
-{
-    Member member = {};
-    member.Type         = type;
-    member.Modifier     = modifier;
-    member.PackOffset   = -1;
-
-    auto name = std::string(m_Tokenizer.NextAsChar());
-    auto pos = name.find(";");
-    auto end = false;
-    if (pos != std::string::npos)
-    {
-        end = true;
-        name = name.substr(0, pos);
-    }
-
-    member.Name = name;
-
-    modifier = TYPE_MODIFIER_NONE;
-
-    if (end)
-    {
-        buffer.Members.push_back(member);
-        return;
-    }
-
-    m_Tokenizer.Next();
-    if (m_Tokenizer.Compare("packoffset"))
-    {
-        auto offsetStr  = std::string(m_Tokenizer.GetAsChar());
-        pos = offsetStr.find(";");
-        auto offset     = std::stoi(offsetStr.substr(1, pos));
-        member.PackOffset = uint32_t(offset);
-    }
-
-    buffer.Members.push_back(member);
-}
-
-//-----------------------------------------------------------------------------
-//      構造体を解析します.
-//-----------------------------------------------------------------------------
-void FxParser::ParseStruct()
-{
-    m_Tokenizer.Next();
-
-    // 構造体名を取得.
-    auto name = std::string(m_Tokenizer.GetAsChar());
-
-    // 構造体名を設定.
-    Structure structure;
-    structure.Name = name;
-
-    m_Tokenizer.Next();
-
-    assert(m_Tokenizer.Compare("{"));
-
-    TYPE_MODIFIER modifier = TYPE_MODIFIER_NONE;
-
-    while(!m_Tokenizer.IsEnd())
-    {
-        // 構造体ブロック終了.
-        if (m_Tokenizer.Compare("}"))
-        {
-            break;
-        }
-        else if (m_Tokenizer.Compare("float"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float1"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float1x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT1x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float1x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT1x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float1x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT1x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float2"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float2x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT2x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float2x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT2x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float2x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT2x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float2x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT2x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT3x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT3x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT3x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float3x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT3x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT4x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT4x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT4x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("float4x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_FLOAT4x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT1x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT1x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int1x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT1x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT2x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT2x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT2x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int2x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT2x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT3x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT3x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT3x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int3x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT3x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT4x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT4x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT4x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("int4x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_INT4x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT1x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT1x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint1x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT1x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT2x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT2x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT2x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint2x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT2x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT3x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT3x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT3x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint3x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT3x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT4x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT4x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT4x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("uint4x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_UINT4x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL1x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL1x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool1x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL1x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL2x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL2x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL2x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool2x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL2x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL3x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL3x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL3x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool3x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL3x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL4x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL4x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL4x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("bool4x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_BOOL4x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE1x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE1x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double1x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE1x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE2x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE2x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE2x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double2x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE2x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE3x1, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE3x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE3x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double3x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE3x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x1"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x2"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE4x2, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x3"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE4x3, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("double4x4"))
-        {
-            ParseStructMember(MEMBER_TYPE_DOUBLE4x4, structure, modifier);
-        }
-        else if (m_Tokenizer.Compare("row_major"))
-        {
-            modifier = TYPE_MODIFIER_ROW_MAJOR;
-            m_Tokenizer.Next();
-        }
-        else if (m_Tokenizer.Compare("colum_major"))
-        {
-            modifier = TYPE_MODIFIER_COLUMN_MAJOR;
-            m_Tokenizer.Next();
-        }
-        else 
-        {
-            auto name = m_Tokenizer.GetAsChar();
-            if (m_Structures.find(name) != m_Structures.end())
-            {
-                ParseStructMember(MEMBER_TYPE_STRUCT, structure, modifier);
-            }
-            else
-            {
-                // 次のトークンを取得.
-                m_Tokenizer.Next();
-            }
+            auto name = std::string(m_Tokenizer.GetAsView());
+            if (m_Structures.find(name) != m_Structures.end())
+            {
+                ParseStructMember(MEMBER_TYPE_STRUCT, structure, modifier);
+            }
+            else
+            {
+                // 次のトークンを取得.
+                m_Tokenizer.Next();
+            }
         }
     }
 
@@ -2549,7 +2029,7 @@ void FxParser::ParseStructMember
     member.Modifier     = modifier;
     member.PackOffset   = -1;
 
-    auto name = std::string(m_Tokenizer.NextAsChar());
+    auto name = std::string(m_Tokenizer.NextAsView());
     auto pos = name.find(";");
     bool end = false;
     if (pos != std::string::npos)
@@ -2570,7 +2050,7 @@ void FxParser::ParseStructMember
     m_Tokenizer.Next();
     if (m_Tokenizer.Compare(":"))
     {
-        auto semantics = std::string(m_Tokenizer.NextAsChar());
+        auto semantics = std::string(m_Tokenizer.NextAsView());
         pos = semantics.find(";");
         semantics = semantics.substr(0, pos);
     }
@@ -2578,6 +2058,77 @@ void FxParser::ParseStructMember
     structure.Members.push_back(member);
 }
 
+//-----------------------------------------------------------------------------
+//      キーワードを解析します.
+//-----------------------------------------------------------------------------
+void FxParser::ParseKeywords()
+{
+    /*
+        keywords
+        {
+            multi_compile   _ FOG_LINEAR FOG_EXP;   // どれか1つ. _ はどれも定義しない.
+            shader_feature  NORMAL_MAP;             // _ NORMAL_MAP と同じ.
+            exclude         FOG_EXP NORMAL_MAP;     // 2つ以上を同時に有効にしない.
+            require         NORMAL_MAP FOG_LINEAR;  // NORMAL_MAP には FOG_LINEAR が必要.
+        }
+    */
+    m_Tokenizer.Next();
+    assert(m_Tokenizer.Compare("{"));
+
+    m_Tokenizer.Next();
+    while(!m_Tokenizer.IsEnd())
+    {
+        // ブロック終了.
+        if (m_Tokenizer.Compare("}"))
+        { break; }
+
+        std::vector<std::string>* pNames = nullptr;
+
+        if (m_Tokenizer.CompareAsLower("multi_compile"))
+        {
+            m_Keywords.Groups.push_back(KeywordGroup());
+            pNames = &m_Keywords.Groups.back().Keywords;
+        }
+        else if (m_Tokenizer.CompareAsLower("shader_feature"))
+        {
+            m_Keywords.Groups.push_back(KeywordGroup());
+            pNames = &m_Keywords.Groups.back().Keywords;
+            pNames->push_back("");
+        }
+        else if (m_Tokenizer.CompareAsLower("exclude"))
+        {
+            KeywordRule rule;
+            rule.Type = KEYWORD_RULE_EXCLUDE;
+            m_Keywords.Rules.push_back(rule);
+            pNames = &m_Keywords.Rules.back().Keywords;
+        }
+        else if (m_Tokenizer.CompareAsLower("require"))
+        {
+            KeywordRule rule;
+            rule.Type = KEYWORD_RULE_REQUIRE;
+            m_Keywords.Rules.push_back(rule);
+            pNames = &m_Keywords.Rules.back().Keywords;
+        }
+
+        // セミコロンまでキーワード名を読み取る.
+        if (pNames != nullptr)
+        {
+            m_Tokenizer.Next();
+            while(!m_Tokenizer.IsEnd() && !m_Tokenizer.Compare(";"))
+            {
+                if (m_Tokenizer.Compare("_"))
+                { pNames->push_back(""); }
+                else
+                { pNames->push_back(std::string(m_Tokenizer.GetAsView())); }
+
+                m_Tokenizer.Next();
+            }
+        }
+
+        m_Tokenizer.Next();
+    }
+}
+
 //-----------------------------------------------------------------------------
 //      プロパティを解析します.
 //-----------------------------------------------------------------------------
@@ -2632,17 +2183,17 @@ void FxParser::ParseProperties()
             // 次のフォーマット.
             // bool name("display") = default;
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("="));
-            auto defValue = std::string(m_Tokenizer.NextAsChar());
+            auto defValue = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(";"));
 
@@ -2665,11 +2216,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // int name("display", step, range(min, max)) = default;
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             auto step = m_Tokenizer.NextAsFloat();
             m_Tokenizer.Next();
 
@@ -2690,7 +2241,7 @@ void FxParser::ParseProperties()
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("="));
-            auto defValue = std::string(m_Tokenizer.NextAsChar());
+            auto defValue = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(";"));
 
@@ -2713,11 +2264,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // float name("display", step, range(min, max)) = default;
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             auto step = m_Tokenizer.NextAsFloat();
             m_Tokenizer.Next();
 
@@ -2738,7 +2289,7 @@ void FxParser::ParseProperties()
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("="));
-            auto defValue = std::string(m_Tokenizer.NextAsChar());
+            auto defValue = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(";"));
             m_Tokenizer.Next();
@@ -2763,11 +2314,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // float2 name("display", step, range(min, max)) = float2(default.x, default.y);
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             auto step = m_Tokenizer.NextAsFloat();
             m_Tokenizer.Next();
 
@@ -2792,8 +2343,8 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare("float2"));
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("("));
-            auto defValueX = std::string(m_Tokenizer.NextAsChar());
-            auto defValueY = std::string(m_Tokenizer.NextAsChar());
+            auto defValueX = std::string(m_Tokenizer.NextAsView());
+            auto defValueY = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
@@ -2820,11 +2371,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // float3 name("display", step, range(min, max)) = float3(default.x, default.y, default.z);
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             auto step = m_Tokenizer.NextAsFloat();
             m_Tokenizer.Next();
 
@@ -2849,9 +2400,9 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare("float3"));
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("("));
-            auto defValueX = std::string(m_Tokenizer.NextAsChar());
-            auto defValueY = std::string(m_Tokenizer.NextAsChar());
-            auto defValueZ = std::string(m_Tokenizer.NextAsChar());
+            auto defValueX = std::string(m_Tokenizer.NextAsView());
+            auto defValueY = std::string(m_Tokenizer.NextAsView());
+            auto defValueZ = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
@@ -2879,11 +2430,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // float4 name("display", step, range(min, max)) = float4(default.x, default.y, default.z, default.w);
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             auto step = m_Tokenizer.NextAsFloat();
             m_Tokenizer.Next();
 
@@ -2909,10 +2460,10 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare("float4"));
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("("));
-            auto defValueX = std::string(m_Tokenizer.NextAsChar());
-            auto defValueY = std::string(m_Tokenizer.NextAsChar());
-            auto defValueZ = std::string(m_Tokenizer.NextAsChar());
-            auto defValueW = std::string(m_Tokenizer.NextAsChar());
+            auto defValueX = std::string(m_Tokenizer.NextAsView());
+            auto defValueY = std::string(m_Tokenizer.NextAsView());
+            auto defValueZ = std::string(m_Tokenizer.NextAsView());
+            auto defValueW = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
@@ -2941,11 +2492,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // color3 name("display") = color3(default.r, default.g, default.b);
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare(")"));
@@ -2957,9 +2508,9 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare("color3"));
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("("));
-            auto defValueX = std::string(m_Tokenizer.NextAsChar());
-            auto defValueY = std::string(m_Tokenizer.NextAsChar());
-            auto defValueZ = std::string(m_Tokenizer.NextAsChar());
+            auto defValueX = std::string(m_Tokenizer.NextAsView());
+            auto defValueY = std::string(m_Tokenizer.NextAsView());
+            auto defValueZ = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
@@ -2985,11 +2536,11 @@ void FxParser::ParseProperties()
             // 次のフォーマット
             // color4 name("display") = color4(default.r, default.g, default.b, default.a);
 
-            auto name = std::string(m_Tokenizer.NextAsChar());
+            auto name = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare("("));
-            auto display_tag = std::string(m_Tokenizer.NextAsChar());
+            auto display_tag = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
 
             assert(m_Tokenizer.Compare(")"));
@@ -3001,10 +2552,10 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare("color4"));
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare("("));
-            auto defValueX = std::string(m_Tokenizer.NextAsChar());
-            auto defValueY = std::string(m_Tokenizer.NextAsChar());
-            auto defValueZ = std::string(m_Tokenizer.NextAsChar());
-            auto defValueW = std::string(m_Tokenizer.NextAsChar());
+            auto defValueX = std::string(m_Tokenizer.NextAsView());
+            auto defValueY = std::string(m_Tokenizer.NextAsView());
+            auto defValueZ = std::string(m_Tokenizer.NextAsView());
+            auto defValueW = std::string(m_Tokenizer.NextAsView());
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
@@ -3274,10 +2825,10 @@ void FxParser::ParseTextureProperty(PROPERTY_TYPE type)
     // textureXXX name("display", srgb) = default;
     auto srgb = false;
 
-    auto name = std::string(m_Tokenizer.NextAsChar());
+    auto name = std::string(m_Tokenizer.NextAsView());
     m_Tokenizer.Next();
     assert(m_Tokenizer.Compare("("));
-    auto display_tag = std::string(m_Tokenizer.NextAsChar());
+    auto display_tag = std::string(m_Tokenizer.NextAsView());
 
     m_Tokenizer.Next();
     if (!m_Tokenizer.Compare(")"))
@@ -3290,7 +2841,7 @@ void FxParser::ParseTextureProperty(PROPERTY_TYPE type)
     m_Tokenizer.Next();
     assert(m_Tokenizer.Compare("="));
 
-    auto defValue = std::string(m_Tokenizer.NextAsChar());
+    auto defValue = std::string(m_Tokenizer.NextAsView());
     m_Tokenizer.Next();
     assert(m_Tokenizer.Compare(";"));
     m_Tokenizer.Next();
@@ -3311,95 +2862,10 @@ void FxParser::ParseTextureProperty(PROPERTY_TYPE type)
 //-----------------------------------------------------------------------------
 void FxParser::ParseResource()
 {
-    Resource res = {};
-
-    if (m_Tokenizer.CompareAsLower("Texture1D"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE1D);
-    }
-    else if (m_Tokenizer.CompareAsLower("Texture1DArray"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE1DARRAY);
-    }
-    else if (m_Tokenizer.CompareAsLower("Texture2D"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE2D);
-    }
-    else if (m_Tokenizer.CompareAsLower("Texture2DArray"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE2DARRAY);
-    }
-    else if (m_Tokenizer.CompareAsLower("Texture2DMS"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE2DMS);
-    }
-    else if (m_Tokenizer.CompareAsLower("Texture2DMSArray"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE2DMSARRAY);
-    }
-    else if (m_Tokenizer.CompareAsLower("Texture3D"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURE3D);
-    }
-    else if (m_Tokenizer.CompareAsLower("TextureCube"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURECUBE);
-    }
-    else if (m_Tokenizer.CompareAsLower("TextureCubeArray"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_TEXTURECUBEARRAY);
-    }
-    else if (m_Tokenizer.CompareAsLower("Buffer"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_BUFFER);
-    }
-    else if (m_Tokenizer.CompareAsLower("ByteAddressBuffer"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_BYTEADDRESS_BUFFER);
-    }
-    else if (m_Tokenizer.CompareAsLower("StructuredBuffer"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_STRUCTURED_BUFFER);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWTexture1D"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWTEXTURE1D);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWTexture1DArray"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWTEXTURE1DARRAY);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWTexture2D"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWTEXTURE2D);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWTexture2DArray"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWTEXTURE2DARRAY);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWTexture3D"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWTEXTURE3D);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWBuffer"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWBUFFER);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWByteAddressBuffer"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWBYTEADDRESS_BUFFER);
-    }
-    else if (m_Tokenizer.CompareAsLower("RWStructuredBuffer"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_RWSTRUCTURED_BUFFER);
-    }
-    else if (m_Tokenizer.CompareAsLower("SamplerState"))
-    {
-        ParseResourceDetail(RESOURCE_TYPE_SAMPLER_STATE);
-    }
-    else if (m_Tokenizer.CompareAsLower("SamplerComparisonState"))
+    uint32_t type = 0;
+    if (FindKeyword(m_Tokenizer.GetAsView(), &type) == KEYWORD_RESOURCE)
     {
-        ParseResourceDetail(RESOURCE_TYPE_SAMPLER_COMPRISON_STATE);
+        ParseResourceDetail(RESOURCE_TYPE(type));
     }
 }
 
@@ -3416,73 +2882,11 @@ void FxParser::ParseResourceDetail(RESOURCE_TYPE type)
     {
         m_Tokenizer.Next();
 
-        if (m_Tokenizer.CompareAsLower("float"))
-        {
-            dataType = MEMBER_TYPE_FLOAT;
-        }
-        else if (m_Tokenizer.CompareAsLower("float2"))
-        {
-            dataType = MEMBER_TYPE_FLOAT2;
-        }
-        else if (m_Tokenizer.CompareAsLower("float3"))
-        {
-            dataType = MEMBER_TYPE_FLOAT3;
-        }
-        else if (m_Tokenizer.CompareAsLower("float4"))
-        {
-            dataType = MEMBER_TYPE_FLOAT4;
-        }
-        else if (m_Tokenizer.CompareAsLower("double"))
-        {
-            dataType = MEMBER_TYPE_DOUBLE;
-        }
-        else if (m_Tokenizer.CompareAsLower("double2"))
-        {
-            dataType = MEMBER_TYPE_DOUBLE2;
-        }
-        else if (m_Tokenizer.CompareAsLower("double3"))
-        {
-            dataType = MEMBER_TYPE_DOUBLE3;
-        }
-        else if (m_Tokenizer.CompareAsLower("double4"))
-        {
-            dataType = MEMBER_TYPE_DOUBLE4;
-        }
-        else if (m_Tokenizer.CompareAsLower("int"))
-        {
-            dataType = MEMBER_TYPE_INT;
-        }
-        else if (m_Tokenizer.CompareAsLower("int2"))
-        {
-            dataType = MEMBER_TYPE_INT2;
-        }
-        else if (m_Tokenizer.CompareAsLower("int3"))
-        {
-            dataType = MEMBER_TYPE_INT3;
-        }
-        else if (m_Tokenizer.CompareAsLower("int4"))
-        {
-            dataType = MEMBER_TYPE_INT4;
-        }
-        else if (m_Tokenizer.CompareAsLower("uint"))
-        {
-            dataType = MEMBER_TYPE_UINT;
-        }
-        else if (m_Tokenizer.CompareAsLower("uint2"))
-        {
-            dataType = MEMBER_TYPE_UINT2;
-        }
-        else if (m_Tokenizer.CompareAsLower("uint3"))
-        {
-            dataType = MEMBER_TYPE_UINT3;
-        }
-        else if (m_Tokenizer.CompareAsLower("uint4"))
-        {
-            dataType = MEMBER_TYPE_UINT4;
-        }
-        else
+        dataType = ParseMemberType(m_Tokenizer.GetAsView());
+
+        if (dataType == MEMBER_TYPE_UNKNOWN)
         {
-            auto name = m_Tokenizer.GetAsChar();
+            auto name = std::string(m_Tokenizer.GetAsView());
             if (m_Structures.find(name) != m_Structures.end())
             {
                 dataType = MEMBER_TYPE_STRUCT;
@@ -3494,7 +2898,7 @@ void FxParser::ParseResourceDetail(RESOURCE_TYPE type)
         m_Tokenizer.Next();
     }
 
-    auto name = std::string(m_Tokenizer.GetAsChar());
+    auto name = std::string(m_Tokenizer.GetAsView());
     auto pos = name.find(";");
     auto end = false;
     if (pos != std::string::npos)
@@ -3527,7 +2931,7 @@ void FxParser::ParseResourceDetail(RESOURCE_TYPE type)
         m_Tokenizer.Next(); // register
         assert(m_Tokenizer.Compare("("));
         m_Tokenizer.Next(); // "("
-        auto reg = std::string(m_Tokenizer.GetAsChar());
+        auto reg = std::string(m_Tokenizer.GetAsView());
         auto idx = std::stoi(reg.substr(1));
         res.Register = uint32_t(idx);
         m_Tokenizer.Next(); // txx
@@ -3546,42 +2950,13 @@ void FxParser::ParseResourceDetail(RESOURCE_TYPE type)
 //-----------------------------------------------------------------------------
 SHADER_TYPE FxParser::GetShaderType()
 {
-    SHADER_TYPE type = SHADER_TYPE(-1);
-
-    if (m_Tokenizer.CompareAsLower("vertexshader"))
-    {
-        type = SHADER_TYPE_VERTEX;
-    }
-    else if (m_Tokenizer.CompareAsLower("pixelshader"))
+    uint32_t type = 0;
+    if (FindKeyword(m_Tokenizer.GetAsView(), &type) == KEYWORD_SHADER)
     {
-        type = SHADER_TYPE_PIXEL;
-    }
-    else if (m_Tokenizer.CompareAsLower("geometryshader"))
-    {
-        type = SHADER_TYPE_GEOMETRY;
-    }
-    else if (m_Tokenizer.CompareAsLower("domainshader"))
-    {
-        type = SHADER_TYPE_DOMAIN;
-    }
-    else if (m_Tokenizer.CompareAsLower("hullshader"))
-    {
-        type = SHADER_TYPE_HULL;
-    }
-    else if (m_Tokenizer.CompareAsLower("computeshader"))
-    {
-        type = SHADER_TYPE_COMPUTE;
-    }
-    else if (m_Tokenizer.CompareAsLower("amplificationshader"))
-    {
-        type = SHADER_TYPE_AMPLIFICATION;
-    }
-    else if (m_Tokenizer.CompareAsLower("meshshader"))
-    {
-        type = SHADER_TYPE_MESH;
+        return SHADER_TYPE(type);
     }
 
-    return type;
+    return SHADER_TYPE(-1);
 }
 
 //-----------------------------------------------------------------------------
@@ -3644,84 +3019,190 @@ const std::vector<Technique>& FxParser::GetTechniques() const
 const Properties& FxParser::GetProperties() const
 { return m_Properties; }
 
+//-----------------------------------------------------------------------------
+//      キーワード宣言を取得します.
+//-----------------------------------------------------------------------------
+const Keywords& FxParser::GetKeywords() const
+{ return m_Keywords; }
+
+//-----------------------------------------------------------------------------
+//      インクルードの統計情報を取得します.
+//-----------------------------------------------------------------------------
+const IncludeStats& FxParser::GetIncludeStats() const
+{ return m_IncludeStats; }
+
+//-----------------------------------------------------------------------------
+//      読み込んだファイルを取得します.
+//-----------------------------------------------------------------------------
+const std::map<std::string, std::shared_ptr<const SourceFile>>& FxParser::GetSourceFiles() const
+{ return m_SourceFiles; }
+
+//-----------------------------------------------------------------------------
+//      インクルードの解決で見つからなかったファイルパスを取得します.
+//-----------------------------------------------------------------------------
+const std::set<std::string>& FxParser::GetMissingFiles() const
+{ return m_MissingFiles; }
+
+//-----------------------------------------------------------------------------
+//      ファイルの読み込みに使うキャッシュを設定します.
+//-----------------------------------------------------------------------------
+void FxParser::SetSourceCache(SourceCache* pCache)
+{ m_pSourceCache = pCache; }
+
 //-----------------------------------------------------------------------------
 //      インクルード文を収集します.
 //-----------------------------------------------------------------------------
-bool FxParser::CorrectIncludes(const char* filename)
+const SourceFile* FxParser::CorrectIncludes(const std::string& path)
 {
-    std::ifstream stream;
-    stream.open(filename, std::ios::in);
+    auto pCache = (m_pSourceCache != nullptr) ? m_pSourceCache : &m_LocalCache;
 
-    if (!stream.is_open())
+    bool opened = false;
+    auto source = pCache->Load(path, &opened);
+    if (opened)
+    { m_IncludeStats.OpenCount++; }
+
+    // 後から作成されると解決結果が変わるので記録しておく.
+    if (!source)
     {
-        return false;
+        m_MissingFiles.insert(path);
+        return nullptr;
     }
 
-    std::string line;
+    // 読み込み済みのファイルは再走査しない.
+    auto itr = m_SourceFiles.find(source->Key);
+    if (itr != m_SourceFiles.end())
+    { return itr->second.get(); }
+
+    // 循環インクルードでも止まるように走査前に登録する.
+    // マップはパーサーが破棄されるまで保持し, 内容はコピーせずに参照する.
+    m_SourceFiles[source->Key] = source;
+    m_IncludeStats.UniqueCount++;
+
+    auto& file = *source;
 
-    for (;;)
+    size_t           pos = 0;
+    std::string_view word;
+    for(;;)
     {
-        if (!stream)
+        // "#include" を含む単語の次の単語がファイル名.
+        pos = file.Code.find("#include", pos);
+        if (pos == std::string_view::npos)
         { break; }
 
-        if (stream.eof())
+        while(pos < file.Code.size() && !isspace(uint8_t(file.Code[pos])))
+        { pos++; }
+
+        if (!NextWord(file.Code, pos, word))
         { break; }
 
-        stream >> line;
+        m_IncludeStats.DirectiveCount++;
 
-        auto pos = line.find("#include");
-        if (pos != std::string::npos)
-        {
-            stream >> line;
+        Info info;
+        info.IncludeFile = "#include ";
+        info.IncludeFile += word;
+        info.pFile       = nullptr;
+
+        // 同じインクルード文は一度だけ解決する.
+        if (m_IncludeMap.find(info.IncludeFile) != m_IncludeMap.end())
+        { continue; }
 
-            Info info;
-            info.IncludeFile = "#include ";
-            info.IncludeFile += line;
+        m_IncludeStats.ResolveCount++;
 
-            line = Replace(line, "\"", "");
-            line = Replace(line, "<", "");
-            line = Replace(line, ">", "");
-            line = Replace(line, "\r\n", "");
+        std::string name;
+        for(auto c : word)
+        {
+            if (c != '\"' && c != '<' && c != '>')
+            { name += c; }
+        }
 
-            info.FindPath    = line;
+        info.FindPath = name;
 
-            for (size_t i = 0; i < m_DirPaths.size(); ++i)
+        for (size_t i = 0; i < m_DirPaths.size(); ++i)
+        {
+            auto findPath = m_DirPaths[i] + "\\" + name;
+            info.pFile = CorrectIncludes(findPath);
+            if (info.pFile != nullptr)
             {
-                auto path = m_DirPaths[i] + "\\" + line;
-                if (CorrectIncludes(path.c_str()))
-                {
-                    info.FindPath = path;
-                    break;
-                }
+                info.FindPath = findPath;
+                break;
             }
-
-            // ここで追加.
-            m_Includes.push_back(info);
         }
+
+        // 検索パスに無い場合はカレントディレクトリから探す.
+        if (info.pFile == nullptr)
+        { info.pFile = CorrectIncludes(name); }
+
+        if (info.pFile == nullptr)
+        { ELOG("Erorr : File Open Failed. path = %s", name.c_str()); }
+
+        m_IncludeMap[info.IncludeFile] = m_Includes.size();
+        m_Includes.push_back(info);
     }
 
-    stream.close();
-    return true;
+    return source.get();
 }
 
 //-----------------------------------------------------------------------------
 //      インクルード文を展開します.
 //-----------------------------------------------------------------------------
-bool FxParser::Expand(std::string& inout)
+bool FxParser::Expand
+(
+    const SourceFile*               pFile,
+    std::string&                    output,
+    std::vector<const SourceFile*>& stack,
+    std::set<const SourceFile*>&    onceFiles
+)
 {
-    bool find = false;
+    static const char   kDirective[]    = "#include ";
+    static const size_t kDirectiveSize  = sizeof(kDirective) - 1;
+
+    // 展開済みの #pragma once ファイルとインクルードガード付きのファイルは読み飛ばす.
+    // 展開中のファイルも含めるので, 互いにインクルードしていても循環しない.
+    if (onceFiles.find(pFile) != onceFiles.end())
+    { return true; }
+
+    if (std::find(stack.begin(), stack.end(), pFile) != stack.end())
+    {
+        ELOG("Error : Recursive Include. path = %s", pFile->Path.c_str());
+        return false;
+    }
+
+    if (pFile->PragmaOnce || pFile->IncludeGuard)
+    { onceFiles.insert(pFile); }
+
+    stack.push_back(pFile);
 
-    for (size_t i = 0; i < m_Includes.size(); ++i)
+    auto   input = pFile->Code;
+    size_t begin = 0;
+    auto   pos   = input.find(kDirective);
+
+    while(pos != std::string_view::npos)
     {
-        bool hit = false;
-        inout = Replace(inout, m_Includes[i].IncludeFile, m_Includes[i].Code, hit);
-        if (hit)
-        { find = true; }
+        // インクルード文の終端を探す.
+        auto end = pos + kDirectiveSize;
+        while(end < input.size() && !isspace(uint8_t(input[end])))
+        { end++; }
+
+        auto itr = m_IncludeMap.find(input.substr(pos, end - pos));
+        if (itr != m_IncludeMap.end())
+        {
+            AppendAsLF(output, input.data() + begin, pos - begin);
+            begin = end;
+
+            // 見つからなかったファイルは空として扱う.
+            auto pInclude = m_Includes[itr->second].pFile;
+            if (pInclude != nullptr && !Expand(pInclude, output, stack, onceFiles))
+            { return false; }
+        }
+
+        pos = input.find(kDirective, end);
     }
 
-    inout = Replace(inout, "\r\n", "\n");
+    AppendAsLF(output, input.data() + begin, input.size() - begin);
 
-    return find;
+    stack.pop_back();
+
+    return true;
 }
 
 } // namespace asura
@@ -0,0 +1,345 @@
+﻿//-----------------------------------------------------------------------------
+// File : KeywordPermutation.cpp
+// Desc : Shader Keyword Permutation Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "KeywordPermutation.h"
+#include "Sha256.h"
+#include <map>
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// KeywordPermutation class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+KeywordPermutation::KeywordPermutation()
+: m_Depth       (0)
+, m_Started     (false)
+, m_Finished    (false)
+, m_VisitCount  (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+KeywordPermutation::~KeywordPermutation()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool KeywordPermutation::Init(const Keywords& keywords, std::string& error)
+{
+    m_Groups.clear();
+    m_Rules.clear();
+    m_GroupRules.clear();
+
+    // キーワード名から位置を引けるようにする.
+    std::map<std::string, Item> items;
+    for(size_t i=0; i<keywords.Groups.size(); ++i)
+    {
+        auto& group = keywords.Groups[i];
+        if (group.Keywords.empty())
+        { continue; }
+
+        std::vector<std::string> names;
+        for(size_t j=0; j<group.Keywords.size(); ++j)
+        {
+            auto& name = group.Keywords[j];
+            if (!name.empty())
+            {
+                Item item;
+                item.Group = uint32_t(m_Groups.size());
+                item.Index = uint32_t(names.size());
+                if (!items.emplace(name, item).second)
+                {
+                    error = "keyword declared twice. name = " + name;
+                    return false;
+                }
+            }
+            names.push_back(name);
+        }
+
+        m_Groups.push_back(std::move(names));
+    }
+
+    m_GroupRules.resize(m_Groups.size());
+
+    for(auto& rule : keywords.Rules)
+    {
+        Rule item;
+        item.Type = rule.Type;
+
+        for(auto& name : rule.Keywords)
+        {
+            auto itr = items.find(name);
+            if (itr == items.end())
+            {
+                error = "undeclared keyword in rule. name = " + (name.empty() ? std::string("_") : name);
+                return false;
+            }
+            item.Items.push_back(itr->second);
+        }
+
+        if (item.Items.size() < 2)
+        {
+            error = "rule needs two or more keywords.";
+            return false;
+        }
+
+        // 規則が参照するグループが決まった時点で評価する.
+        auto index = uint32_t(m_Rules.size());
+        for(auto& itr : item.Items)
+        {
+            auto& rules = m_GroupRules[itr.Group];
+            if (rules.empty() || rules.back() != index)
+            { rules.push_back(index); }
+        }
+
+        m_Rules.push_back(std::move(item));
+    }
+
+    Reset();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      規則を満たす次の組み合わせを取得します.
+//-----------------------------------------------------------------------------
+bool KeywordPermutation::Next(std::vector<uint32_t>& selection)
+{
+    if (m_Finished)
+    { return false; }
+
+    // グループが無い場合は何も定義しない組み合わせが1つだけある.
+    if (m_Groups.empty())
+    {
+        m_Finished = true;
+        selection.clear();
+        return true;
+    }
+
+    if (!m_Started)
+    {
+        m_Started = true;
+        m_Depth   = 0;
+        m_Selection.assign(m_Groups.size(), 0);
+    }
+    else
+    {
+        // 前回の組み合わせの最後のグループから進める.
+        m_Depth = m_Groups.size() - 1;
+        m_Selection[m_Depth]++;
+    }
+
+    for(;;)
+    {
+        // このグループを使い切ったら1つ前のグループを進める.
+        if (m_Selection[m_Depth] >= m_Groups[m_Depth].size())
+        {
+            if (m_Depth == 0)
+            {
+                m_Finished = true;
+                return false;
+            }
+
+            m_Selection[m_Depth] = 0;
+            m_Depth--;
+            m_Selection[m_Depth]++;
+            continue;
+        }
+
+        m_VisitCount++;
+
+        // 規則に反する場合は以降のグループを展開しない.
+        if (!IsValid(uint32_t(m_Depth)))
+        {
+            m_Selection[m_Depth]++;
+            continue;
+        }
+
+        if (m_Depth + 1 == m_Groups.size())
+        {
+            selection = m_Selection;
+            return true;
+        }
+
+        m_Depth++;
+        m_Selection[m_Depth] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      列挙を最初からやり直します.
+//-----------------------------------------------------------------------------
+void KeywordPermutation::Reset()
+{
+    m_Selection.clear();
+    m_Depth      = 0;
+    m_Started    = false;
+    m_Finished   = false;
+    m_VisitCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      組み合わせのマクロ定義を取得します.
+//-----------------------------------------------------------------------------
+void KeywordPermutation::GetDefines(const std::vector<uint32_t>& selection, std::vector<std::string>& result) const
+{
+    result.clear();
+    for(size_t i=0; i<selection.size() && i<m_Groups.size(); ++i)
+    {
+        auto& name = m_Groups[i][selection[i]];
+        if (!name.empty())
+        { result.push_back(name + "=1"); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      組み合わせを表すキーを取得します.
+//-----------------------------------------------------------------------------
+std::string KeywordPermutation::GetKey(const std::vector<uint32_t>& selection) const
+{
+    std::string result;
+    for(size_t i=0; i<selection.size() && i<m_Groups.size(); ++i)
+    {
+        auto& name = m_Groups[i][selection[i]];
+        if (name.empty())
+        { continue; }
+
+        if (!result.empty())
+        { result += " "; }
+        result += name;
+    }
+
+    return result.empty() ? std::string("_") : result;
+}
+
+//-----------------------------------------------------------------------------
+//      規則を適用する前の組み合わせ数を取得します.
+//-----------------------------------------------------------------------------
+double KeywordPermutation::GetRawCount() const
+{
+    // 10^19 を超えることもあるので浮動小数で数える.
+    double result = 1.0;
+    for(auto& group : m_Groups)
+    { result *= double(group.size()); }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      規則を評価した部分的な組み合わせの数を取得します.
+//-----------------------------------------------------------------------------
+uint64_t KeywordPermutation::GetVisitCount() const
+{ return m_VisitCount; }
+
+//-----------------------------------------------------------------------------
+//      グループ数を取得します.
+//-----------------------------------------------------------------------------
+size_t KeywordPermutation::GetGroupCount() const
+{ return m_Groups.size(); }
+
+//-----------------------------------------------------------------------------
+//      規則数を取得します.
+//-----------------------------------------------------------------------------
+size_t KeywordPermutation::GetRuleCount() const
+{ return m_Rules.size(); }
+
+//-----------------------------------------------------------------------------
+//      決定したグループまでが規則を満たすかチェックします.
+//-----------------------------------------------------------------------------
+bool KeywordPermutation::IsValid(uint32_t group) const
+{
+    // 手前のグループは検証済みなので, このグループを参照する規則だけを調べる.
+    for(auto index : m_GroupRules[group])
+    {
+        auto& rule = m_Rules[index];
+
+        if (rule.Type == KEYWORD_RULE_EXCLUDE)
+        {
+            uint32_t count = 0;
+            for(auto& item : rule.Items)
+            {
+                if (item.Group <= group && m_Selection[item.Group] == item.Index)
+                { count++; }
+            }
+
+            if (count >= 2)
+            { return false; }
+        }
+        else if (rule.Type == KEYWORD_RULE_REQUIRE)
+        {
+            auto& head = rule.Items[0];
+            if (head.Group > group || m_Selection[head.Group] != head.Index)
+            { continue; }
+
+            for(size_t i=1; i<rule.Items.size(); ++i)
+            {
+                auto& item = rule.Items[i];
+                if (item.Group <= group && m_Selection[item.Group] != item.Index)
+                { return false; }
+            }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      キーワードの組み合わせを列挙します.
+//-----------------------------------------------------------------------------
+bool EnumerateVariants(const FxParser& parser, const std::string& inputPath, std::vector<KeywordVariant>& result)
+{
+    result.clear();
+
+    KeywordPermutation permutation;
+
+    std::string error;
+    if (!permutation.Init(parser.GetKeywords(), error))
+    {
+        fprintf_s(stderr, "Error : Invalid Keywords. %s, path = %s\n", error.c_str(), inputPath.c_str());
+        return false;
+    }
+
+    // 規則を満たす組み合わせだけを1つずつ取り出す.
+    std::vector<uint32_t> selection;
+    while(permutation.Next(selection))
+    {
+        KeywordVariant variant;
+        permutation.GetDefines(selection, variant.Defines);
+
+        // キーワードが無ければ従来通りのファイル名にする.
+        if (permutation.GetGroupCount() > 0)
+        {
+            variant.Key    = permutation.GetKey(selection);
+            variant.Suffix = "_" + Sha256::Compute(variant.Key.data(), variant.Key.size()).substr(0, 16);
+        }
+
+        result.push_back(std::move(variant));
+    }
+
+    if (permutation.GetGroupCount() > 0)
+    {
+        printf_s("Keyword : groups = %zu, rules = %zu, raw = %.0f, variants = %zu, pruned = %.0f, visited = %llu, path = %s\n",
+            permutation.GetGroupCount(),
+            permutation.GetRuleCount(),
+            permutation.GetRawCount(),
+            result.size(),
+            permutation.GetRawCount() - double(result.size()),
+            static_cast<unsigned long long>(permutation.GetVisitCount()),
+            inputPath.c_str());
+    }
+
+    return true;
+}
+
+} // namespace asura
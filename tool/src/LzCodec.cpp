@@ -0,0 +1,248 @@
+﻿//-----------------------------------------------------------------------------
+// File : LzCodec.cpp
+// Desc : LZ Compression Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "LzCodec.h"
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const size_t   kMinMatch   = 4;          // 最小一致長.
+static const size_t   kMaxOffset  = 0xFFFF;     // 最大オフセット.
+static const uint32_t kHashBits   = 14;         // ハッシュテーブルのビット数.
+static const uint32_t kSkipShift  = 6;          // 一致しない区間を読み飛ばす間隔の増え方.
+static const size_t   kWildCopy   = 16;         // まとめてコピーする単位.
+
+//-----------------------------------------------------------------------------
+//      4バイト読み込みます.
+//-----------------------------------------------------------------------------
+inline uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+//      kWildCopy 単位でコピーします. 末尾は最大 kWildCopy - 1 バイト書き過ぎます.
+//-----------------------------------------------------------------------------
+inline void WildCopy(uint8_t* pDst, const uint8_t* pSrc, size_t size)
+{
+    auto pEnd = pDst + size;
+    do
+    {
+        memcpy(pDst, pSrc, kWildCopy);
+        pDst += kWildCopy;
+        pSrc += kWildCopy;
+    }
+    while(pDst < pEnd);
+}
+
+//-----------------------------------------------------------------------------
+//      4バイトのハッシュ値を求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t Hash32(uint32_t value)
+{ return (value * 2654435761u) >> (32 - kHashBits); }
+
+//-----------------------------------------------------------------------------
+//      15 以上の長さの残りを書き出します.
+//-----------------------------------------------------------------------------
+inline void WriteLength(size_t length, std::vector<uint8_t>& result)
+{
+    while(length >= 255)
+    {
+        result.push_back(255);
+        length -= 255;
+    }
+    result.push_back(uint8_t(length));
+}
+
+//-----------------------------------------------------------------------------
+//      15 以上の長さの残りを読み込みます.
+//-----------------------------------------------------------------------------
+inline bool ReadLength(const uint8_t* pSrc, size_t srcSize, size_t& pos, size_t& length)
+{
+    uint8_t value;
+    do
+    {
+        if (pos >= srcSize)
+        { return false; }
+
+        value   = pSrc[pos++];
+        length += value;
+    }
+    while(value == 255);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      シーケンスを書き出します. matchLength が 0 の場合はリテラルのみです.
+//-----------------------------------------------------------------------------
+void WriteSequence
+(
+    const uint8_t*          pLiteral,
+    size_t                  literalLength,
+    size_t                  offset,
+    size_t                  matchLength,
+    std::vector<uint8_t>&   result
+)
+{
+    auto match = (matchLength > 0) ? matchLength - kMinMatch : 0;
+    auto token = uint8_t(((literalLength < 15) ? literalLength : 15) << 4)
+               | uint8_t( (match         < 15) ? match         : 15);
+    result.push_back(token);
+
+    if (literalLength >= 15)
+    { WriteLength(literalLength - 15, result); }
+
+    result.insert(result.end(), pLiteral, pLiteral + literalLength);
+
+    if (matchLength == 0)
+    { return; }
+
+    result.push_back(uint8_t(offset & 0xFF));
+    result.push_back(uint8_t(offset >> 8));
+
+    if (match >= 15)
+    { WriteLength(match - 15, result); }
+}
+
+} // namespace
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      データを圧縮します.
+//-----------------------------------------------------------------------------
+void LzCompress(const void* pSrc, size_t srcSize, std::vector<uint8_t>& result)
+{
+    result.clear();
+    result.reserve(srcSize + srcSize / 255 + 16);
+
+    auto src = static_cast<const uint8_t*>(pSrc);
+
+    // 位置 + 1 を保持し, 0 を未登録とする.
+    std::vector<uint32_t> table(size_t(1) << kHashBits, 0);
+
+    size_t anchor = 0;
+    size_t pos    = 0;
+    while(pos + kMinMatch <= srcSize)
+    {
+        auto value = Read32(src + pos);
+        auto hash  = Hash32(value);
+        auto cand  = size_t(table[hash]);
+        table[hash] = uint32_t(pos + 1);
+
+        if (cand == 0 || pos - (cand - 1) > kMaxOffset || Read32(src + cand - 1) != value)
+        {
+            // 一致しない区間が長くなるほど大きく読み飛ばす.
+            pos += 1 + ((pos - anchor) >> kSkipShift);
+            continue;
+        }
+
+        auto match  = cand - 1;
+        auto length = kMinMatch;
+        while(pos + length < srcSize && src[match + length] == src[pos + length])
+        { length++; }
+
+        // 一致を前方にも伸ばす.
+        while(pos > anchor && match > 0 && src[pos - 1] == src[match - 1])
+        {
+            pos--;
+            match--;
+            length++;
+        }
+
+        WriteSequence(src + anchor, pos - anchor, pos - match, length, result);
+
+        pos   += length;
+        anchor = pos;
+
+        // 一致の末尾も次の候補として登録する.
+        if (pos >= 2 && pos - 2 + kMinMatch <= srcSize)
+        { table[Hash32(Read32(src + pos - 2))] = uint32_t(pos - 2 + 1); }
+    }
+
+    WriteSequence(src + anchor, srcSize - anchor, 0, 0, result);
+}
+
+//-----------------------------------------------------------------------------
+//      データを展開します.
+//-----------------------------------------------------------------------------
+bool LzDecompress(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize)
+{
+    auto src = static_cast<const uint8_t*>(pSrc);
+    auto dst = static_cast<uint8_t*>(pDst);
+
+    size_t ip = 0;
+    size_t op = 0;
+    for(;;)
+    {
+        if (ip >= srcSize)
+        { return false; }
+
+        auto token = src[ip++];
+
+        size_t literal = token >> 4;
+        if (literal == 15 && !ReadLength(src, srcSize, ip, literal))
+        { return false; }
+
+        if (literal > srcSize - ip || literal > dstSize - op)
+        { return false; }
+
+        // 入出力の両方に余裕があれば書き過ぎを許してまとめてコピーする.
+        if (literal + kWildCopy <= srcSize - ip && literal + kWildCopy <= dstSize - op)
+        { WildCopy(dst + op, src + ip, literal); }
+        else
+        { memcpy(dst + op, src + ip, literal); }
+        ip += literal;
+        op += literal;
+
+        // 最後のシーケンスはリテラルのみ.
+        if (ip == srcSize)
+        { return op == dstSize; }
+
+        if (srcSize - ip < 2)
+        { return false; }
+
+        size_t offset = size_t(src[ip]) | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > op)
+        { return false; }
+
+        size_t length = token & 0xF;
+        if (length == 15 && !ReadLength(src, srcSize, ip, length))
+        { return false; }
+        length += kMinMatch;
+
+        if (length > dstSize - op)
+        { return false; }
+
+        auto from = dst + op - offset;
+        if (offset >= kWildCopy && length + kWildCopy <= dstSize - op)
+        { WildCopy(dst + op, from, length); }
+        else if (offset >= length)
+        { memcpy(dst + op, from, length); }
+        else
+        {
+            // 重なっている場合は繰り返しになるので1バイトずつコピーする.
+            for(size_t i=0; i<length; ++i)
+            { dst[op + i] = from[i]; }
+        }
+        op += length;
+    }
+}
+
+} // namespace asura
@@ -0,0 +1,146 @@
+﻿//-----------------------------------------------------------------------------
+// File : MappedFile.cpp
+// Desc : Memory Mapped File Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::MappedFile()
+: m_pData(nullptr)
+, m_Size (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{ Close(); }
+
+//-----------------------------------------------------------------------------
+//      ファイルを読み取り専用でメモリにマップします.
+//-----------------------------------------------------------------------------
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+#if defined(_WIN32)
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    { return false; }
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(hFile, &size))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    // 空ファイルはマップできないので, 空のまま成功扱いにする.
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(hFile);
+        return true;
+    }
+
+    auto hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(hFile);
+    if (hMapping == nullptr)
+    { return false; }
+
+    // ビューがマッピングを参照しているので, ハンドルはすぐ閉じてよい.
+    auto pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (pData == nullptr)
+    { return false; }
+
+    m_pData = static_cast<const char*>(pData);
+    m_Size  = size_t(size.QuadPart);
+#else
+    auto fd = open(path, O_RDONLY);
+    if (fd < 0)
+    { return false; }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    // 空ファイルはマップできないので, 空のまま成功扱いにする.
+    if (st.st_size == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    auto pData = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (pData == MAP_FAILED)
+    { return false; }
+
+    m_pData = static_cast<const char*>(pData);
+    m_Size  = size_t(st.st_size);
+#endif
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マップを解除します.
+//-----------------------------------------------------------------------------
+void MappedFile::Close()
+{
+    if (m_pData != nullptr)
+    {
+    #if defined(_WIN32)
+        UnmapViewOfFile(m_pData);
+    #else
+        munmap(const_cast<char*>(m_pData), m_Size);
+    #endif
+    }
+
+    m_pData = nullptr;
+    m_Size  = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルの内容を取得します.
+//-----------------------------------------------------------------------------
+std::string_view MappedFile::GetView() const
+{ return std::string_view(m_pData, m_Size); }
+
+} // namespace asura
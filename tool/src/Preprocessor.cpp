@@ -0,0 +1,851 @@
+﻿//-----------------------------------------------------------------------------
+// File : Preprocessor.cpp
+// Desc : Conditional Compilation Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "Preprocessor.h"
+#include <cstdlib>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const int kMaxExpandDepth = 32;  // マクロ展開の最大ネスト数.
+
+enum EXPR_TOKEN_KIND
+{
+    EXPR_NUMBER,        //!< 数値.
+    EXPR_IDENTIFIER,    //!< 識別子.
+    EXPR_PUNCTUATOR,    //!< 記号.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ExprToken structure
+///////////////////////////////////////////////////////////////////////////////
+struct ExprToken
+{
+    EXPR_TOKEN_KIND     Kind;       //!< 種別.
+    int64_t             Value;      //!< 数値.
+    std::string_view    Text;       //!< 文字列.
+};
+
+//-----------------------------------------------------------------------------
+//      識別子の先頭に使える文字かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsIdentifierHead(char c)
+{
+    return ('a' <= c && c <= 'z')
+        || ('A' <= c && c <= 'Z')
+        || c == '_';
+}
+
+//-----------------------------------------------------------------------------
+//      識別子に使える文字かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsIdentifier(char c)
+{ return IsIdentifierHead(c) || ('0' <= c && c <= '9'); }
+
+//-----------------------------------------------------------------------------
+//      数字かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsDigit(char c)
+{ return '0' <= c && c <= '9'; }
+
+//-----------------------------------------------------------------------------
+//      指定した記号かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsPunctuator(const ExprToken& token, std::string_view text)
+{ return token.Kind == EXPR_PUNCTUATOR && token.Text == text; }
+
+//-----------------------------------------------------------------------------
+//      数値トークンを生成します.
+//-----------------------------------------------------------------------------
+inline ExprToken MakeNumber(int64_t value)
+{
+    ExprToken token = {};
+    token.Kind  = EXPR_NUMBER;
+    token.Value = value;
+    return token;
+}
+
+//-----------------------------------------------------------------------------
+//      行末の \ で継続する行を含めた論理行の終端を探します.
+//-----------------------------------------------------------------------------
+size_t FindLineEnd(std::string_view code, size_t pos)
+{
+    for(;;)
+    {
+        auto lf = code.find('\n', pos);
+        if (lf == std::string_view::npos)
+        { return code.size(); }
+
+        auto last = lf;
+        if (last > pos && code[last - 1] == '\r')
+        { last--; }
+
+        if (last > pos && code[last - 1] == '\\')
+        {
+            pos = lf + 1;
+            continue;
+        }
+
+        return lf + 1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      空白とコメントを読み飛ばします.
+//-----------------------------------------------------------------------------
+size_t SkipBlank(std::string_view line, size_t pos, bool& comment)
+{
+    while(pos < line.size())
+    {
+        if (comment)
+        {
+            auto end = line.find("*/", pos);
+            if (end == std::string_view::npos)
+            { return line.size(); }
+
+            comment = false;
+            pos     = end + 2;
+            continue;
+        }
+
+        auto c    = line[pos];
+        auto next = (pos + 1 < line.size()) ? line[pos + 1] : '\0';
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f')
+        { pos++; }
+        else if (c == '\\' && (next == '\n' || next == '\r'))
+        { pos++; }
+        else if (c == '/' && next == '*')
+        {
+            comment = true;
+            pos    += 2;
+        }
+        else if (c == '/' && next == '/')
+        { return line.size(); }
+        else
+        { break; }
+    }
+
+    return pos;
+}
+
+//-----------------------------------------------------------------------------
+//      1行を走査し, 識別子ごとに関数を呼び出します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void ScanLine(std::string_view line, size_t pos, bool& comment, Func func)
+{
+    for(;;)
+    {
+        pos = SkipBlank(line, pos, comment);
+        if (pos >= line.size())
+        { return; }
+
+        auto c = line[pos];
+        if (c == '"' || c == '\'')
+        {
+            // 閉じていない場合は行末まで.
+            pos++;
+            while(pos < line.size() && line[pos] != c && line[pos] != '\n')
+            {
+                if (line[pos] == '\\')
+                { pos++; }
+                pos++;
+            }
+            pos++;
+        }
+        else if (IsIdentifierHead(c))
+        {
+            auto start = pos;
+            while(pos < line.size() && IsIdentifier(line[pos]))
+            { pos++; }
+            func(line.substr(start, pos - start));
+        }
+        else if (IsDigit(c))
+        {
+            // 1e5f などの接尾辞を識別子として扱わない.
+            while(pos < line.size() && (IsIdentifier(line[pos]) || line[pos] == '.'))
+            { pos++; }
+        }
+        else
+        { pos++; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      条件式を字句解析します.
+//-----------------------------------------------------------------------------
+bool Lex(std::string_view text, std::vector<ExprToken>& result)
+{
+    static const char* kOperators[] = { "&&", "||", "==", "!=", "<=", ">=", "<<", ">>", "++", "--" };
+
+    bool   comment = false;
+    size_t pos     = 0;
+    for(;;)
+    {
+        pos = SkipBlank(text, pos, comment);
+        if (pos >= text.size())
+        { return true; }
+
+        ExprToken token = {};
+        auto start = pos;
+        auto c     = text[pos];
+        if (IsIdentifierHead(c))
+        {
+            while(pos < text.size() && IsIdentifier(text[pos]))
+            { pos++; }
+
+            token.Kind = EXPR_IDENTIFIER;
+            token.Text = text.substr(start, pos - start);
+        }
+        else if (IsDigit(c))
+        {
+            while(pos < text.size() && IsIdentifier(text[pos]))
+            { pos++; }
+
+            // 整数の接尾辞は無視する.
+            auto number = std::string(text.substr(start, pos - start));
+            while(!number.empty() && strchr("uUlL", number.back()) != nullptr)
+            { number.pop_back(); }
+
+            char* end = nullptr;
+            token.Kind  = EXPR_NUMBER;
+            token.Value = int64_t(strtoull(number.c_str(), &end, 0));
+            if (number.empty() || *end != '\0')
+            { return false; }
+        }
+        else
+        {
+            token.Kind = EXPR_PUNCTUATOR;
+            token.Text = text.substr(start, 1);
+            for(auto op : kOperators)
+            {
+                if (text.compare(start, 2, op) == 0)
+                {
+                    token.Text = text.substr(start, 2);
+                    break;
+                }
+            }
+
+            // 文字リテラルなどは評価しない.
+            if (token.Text.size() == 1 && strchr("()!~-+*/%<>&^|?:", c) == nullptr)
+            { return false; }
+
+            pos += token.Text.size();
+        }
+
+        result.push_back(token);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      条件式のマクロを展開します.
+//-----------------------------------------------------------------------------
+bool Expand
+(
+    const std::vector<ExprToken>&                           tokens,
+    const std::unordered_map<std::string, std::string>&     values,
+    const std::unordered_set<std::string>&                  functions,
+    int                                                     depth,
+    std::vector<ExprToken>&                                 result
+)
+{
+    // 自己参照するマクロもここで打ち切る.
+    if (depth > kMaxExpandDepth)
+    { return false; }
+
+    for(size_t i=0; i<tokens.size(); ++i)
+    {
+        auto& token = tokens[i];
+        if (token.Kind != EXPR_IDENTIFIER)
+        {
+            result.push_back(token);
+            continue;
+        }
+
+        if (token.Text == "defined")
+        {
+            auto j     = i + 1;
+            auto paren = (j < tokens.size() && IsPunctuator(tokens[j], "("));
+            if (paren)
+            { j++; }
+
+            if (j >= tokens.size() || tokens[j].Kind != EXPR_IDENTIFIER)
+            { return false; }
+
+            auto name    = std::string(tokens[j].Text);
+            auto defined = values.find(name) != values.end() || functions.find(name) != functions.end();
+
+            if (paren)
+            {
+                j++;
+                if (j >= tokens.size() || !IsPunctuator(tokens[j], ")"))
+                { return false; }
+            }
+
+            result.push_back(MakeNumber(defined ? 1 : 0));
+            i = j;
+            continue;
+        }
+
+        auto name = std::string(token.Text);
+        if (functions.find(name) != functions.end())
+        { return false; }
+
+        auto itr = values.find(name);
+        if (itr == values.end())
+        {
+            // true / false の扱いはコンパイラによって異なるので評価しない.
+            if (token.Text == "true" || token.Text == "false")
+            { return false; }
+
+            // 未定義の識別子は 0 として扱う.
+            result.push_back(MakeNumber(0));
+            continue;
+        }
+
+        std::vector<ExprToken> body;
+        if (!Lex(itr->second, body))
+        { return false; }
+
+        if (!Expand(body, values, functions, depth + 1, result))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      二項演算子の優先順位を取得します. 二項演算子でなければ 0 を返却します.
+//-----------------------------------------------------------------------------
+int GetPrecedence(const ExprToken& token)
+{
+    static const struct { const char* Text; int Precedence; } kTable[] = {
+        { "||", 1 }, { "&&", 2 }, { "|" , 3 }, { "^" , 4 }, { "&" , 5 },
+        { "==", 6 }, { "!=", 6 },
+        { "<" , 7 }, { ">" , 7 }, { "<=", 7 }, { ">=", 7 },
+        { "<<", 8 }, { ">>", 8 },
+        { "+" , 9 }, { "-" , 9 },
+        { "*" , 10 }, { "/" , 10 }, { "%" , 10 },
+    };
+
+    if (token.Kind != EXPR_PUNCTUATOR)
+    { return 0; }
+
+    for(auto& item : kTable)
+    {
+        if (token.Text == item.Text)
+        { return item.Precedence; }
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ExprParser class
+///////////////////////////////////////////////////////////////////////////////
+class ExprParser
+{
+public:
+    //-------------------------------------------------------------------------
+    //      コンストラクタです.
+    //-------------------------------------------------------------------------
+    explicit ExprParser(const std::vector<ExprToken>& tokens)
+    : m_Tokens  (tokens)
+    , m_Pos     (0)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //      条件式を評価します.
+    //-------------------------------------------------------------------------
+    bool Parse(int64_t& value)
+    { return ParseConditional(value) && m_Pos == m_Tokens.size(); }
+
+private:
+    const std::vector<ExprToken>&   m_Tokens;   //!< トークン.
+    size_t                          m_Pos;      //!< 読み込み位置.
+
+    //-------------------------------------------------------------------------
+    //      指定した記号なら読み進めます.
+    //-------------------------------------------------------------------------
+    bool Accept(std::string_view text)
+    {
+        if (m_Pos < m_Tokens.size() && IsPunctuator(m_Tokens[m_Pos], text))
+        {
+            m_Pos++;
+            return true;
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    //      条件演算子を評価します.
+    //-------------------------------------------------------------------------
+    bool ParseConditional(int64_t& value)
+    {
+        if (!ParseBinary(1, value))
+        { return false; }
+
+        if (!Accept("?"))
+        { return true; }
+
+        int64_t lhs, rhs;
+        if (!ParseConditional(lhs) || !Accept(":") || !ParseConditional(rhs))
+        { return false; }
+
+        value = (value != 0) ? lhs : rhs;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //      二項演算子を評価します.
+    //-------------------------------------------------------------------------
+    bool ParseBinary(int precedence, int64_t& value)
+    {
+        if (!ParseUnary(value))
+        { return false; }
+
+        while(m_Pos < m_Tokens.size())
+        {
+            auto& op = m_Tokens[m_Pos];
+            auto  current = GetPrecedence(op);
+            if (current < precedence)
+            { return true; }
+
+            m_Pos++;
+
+            int64_t rhs;
+            if (!ParseBinary(current + 1, rhs))
+            { return false; }
+
+            // オーバーフローで未定義動作にならないように符号なしで計算する.
+            auto a = uint64_t(value);
+            auto b = uint64_t(rhs);
+            auto t = op.Text;
+            if      (t == "||") { value = (value != 0 || rhs != 0) ? 1 : 0; }
+            else if (t == "&&") { value = (value != 0 && rhs != 0) ? 1 : 0; }
+            else if (t == "|" ) { value = int64_t(a | b); }
+            else if (t == "^" ) { value = int64_t(a ^ b); }
+            else if (t == "&" ) { value = int64_t(a & b); }
+            else if (t == "==") { value = (value == rhs) ? 1 : 0; }
+            else if (t == "!=") { value = (value != rhs) ? 1 : 0; }
+            else if (t == "<" ) { value = (value <  rhs) ? 1 : 0; }
+            else if (t == ">" ) { value = (value >  rhs) ? 1 : 0; }
+            else if (t == "<=") { value = (value <= rhs) ? 1 : 0; }
+            else if (t == ">=") { value = (value >= rhs) ? 1 : 0; }
+            else if (t == "+" ) { value = int64_t(a + b); }
+            else if (t == "-" ) { value = int64_t(a - b); }
+            else if (t == "*" ) { value = int64_t(a * b); }
+            else if (t == "<<" || t == ">>")
+            {
+                if (rhs < 0 || rhs >= 64)
+                { return false; }
+                value = (t == "<<") ? int64_t(a << rhs) : (value >> rhs);
+            }
+            else
+            {
+                if (rhs == 0 || (value == INT64_MIN && rhs == -1))
+                { return false; }
+                value = (t == "/") ? (value / rhs) : (value % rhs);
+            }
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //      単項演算子を評価します.
+    //-------------------------------------------------------------------------
+    bool ParseUnary(int64_t& value)
+    {
+        if (m_Pos >= m_Tokens.size())
+        { return false; }
+
+        if (Accept("!"))
+        {
+            if (!ParseUnary(value))
+            { return false; }
+            value = (value == 0) ? 1 : 0;
+            return true;
+        }
+
+        if (Accept("~"))
+        {
+            if (!ParseUnary(value))
+            { return false; }
+            value = int64_t(~uint64_t(value));
+            return true;
+        }
+
+        if (Accept("-"))
+        {
+            if (!ParseUnary(value))
+            { return false; }
+            value = int64_t(0 - uint64_t(value));
+            return true;
+        }
+
+        if (Accept("+"))
+        { return ParseUnary(value); }
+
+        if (Accept("("))
+        { return ParseConditional(value) && Accept(")"); }
+
+        auto& token = m_Tokens[m_Pos];
+        if (token.Kind != EXPR_NUMBER)
+        { return false; }
+
+        m_Pos++;
+        value = token.Value;
+        return true;
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      行に含まれる改行だけを追加します.
+//-----------------------------------------------------------------------------
+void AppendNewlines(std::string_view line, std::string& result)
+{
+    for(auto c : line)
+    {
+        if (c == '\n')
+        { result.push_back('\n'); }
+    }
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// Preprocessor class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+Preprocessor::Preprocessor()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+Preprocessor::~Preprocessor()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      条件コンパイルを評価し, 有効な行だけを残したソースコードを生成します.
+//-----------------------------------------------------------------------------
+bool Preprocessor::Evaluate(std::string_view code, const std::vector<std::string>& defines, std::string& result)
+{
+    result.clear();
+    result.reserve(code.size());
+
+    m_Values    .clear();
+    m_Functions .clear();
+    m_Conditions.clear();
+
+    for(auto& define : defines)
+    {
+        auto pos  = define.find('=');
+        auto name = define.substr(0, pos);
+        m_Values[name] = (pos == std::string::npos) ? std::string("1") : define.substr(pos + 1);
+    }
+
+    auto ignore = [](std::string_view) {};
+
+    auto   comment = false;
+    size_t pos     = 0;
+    while(pos < code.size())
+    {
+        auto end  = FindLineEnd(code, pos);
+        auto line = code.substr(pos, end - pos);
+        pos = end;
+
+        // 前の行から続くコメントの後ろはディレクティブにならない.
+        auto continued = comment;
+        auto head      = SkipBlank(line, 0, comment);
+        if (!continued && head < line.size() && line[head] == '#')
+        {
+            auto start = SkipBlank(line, head + 1, comment);
+            auto last  = start;
+            while(last < line.size() && IsIdentifier(line[last]))
+            { last++; }
+
+            bool output = false;
+            if (!Directive(line.substr(start, last - start), line.substr(last), output))
+            { return false; }
+
+            ScanLine(line, last, comment, ignore);
+            if (output)
+            { result.append(line.data(), line.size()); }
+            else
+            { AppendNewlines(line, result); }
+            continue;
+        }
+
+        // 文字列の中の /* をコメントとして扱わないように無効な行も走査する.
+        ScanLine(line, head, comment, ignore);
+        if (IsActive())
+        { result.append(line.data(), line.size()); }
+        else
+        { AppendNewlines(line, result); }
+    }
+
+    return m_Conditions.empty();
+}
+
+//-----------------------------------------------------------------------------
+//      ソースコードから識別子として参照されているマクロ定義を探します.
+//-----------------------------------------------------------------------------
+void Preprocessor::FindReferences(std::string_view code, const std::vector<std::string>& defines, std::vector<uint32_t>& result)
+{
+    result.clear();
+
+    std::unordered_map<std::string_view, uint32_t> names;
+    for(size_t i=0; i<defines.size(); ++i)
+    {
+        auto define = std::string_view(defines[i]);
+        names[define.substr(0, define.find('='))] = uint32_t(i);
+    }
+
+    std::vector<bool> used(defines.size(), false);
+
+    auto   comment = false;
+    size_t pos     = 0;
+    while(pos < code.size())
+    {
+        auto end  = FindLineEnd(code, pos);
+        auto line = code.substr(pos, end - pos);
+        pos = end;
+
+        ScanLine(line, 0, comment, [&](std::string_view word)
+        {
+            auto itr = names.find(word);
+            if (itr != names.end())
+            { used[itr->second] = true; }
+        });
+    }
+
+    for(size_t i=0; i<used.size(); ++i)
+    {
+        if (used[i])
+        { result.push_back(uint32_t(i)); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      比較用に空白を正規化したソースコードを生成します.
+//-----------------------------------------------------------------------------
+void Preprocessor::Normalize(std::string_view code, std::string& result)
+{
+    result.clear();
+    result.reserve(code.size());
+
+    auto   comment = false;
+    size_t pos     = 0;
+    while(pos < code.size())
+    {
+        auto end  = FindLineEnd(code, pos);
+        auto line = code.substr(pos, end - pos);
+        pos = end;
+
+        auto   head = result.size();
+        size_t cur  = 0;
+        for(;;)
+        {
+            auto next = SkipBlank(line, cur, comment);
+            if (next >= line.size())
+            { break; }
+
+            if (next != cur && result.size() != head)
+            { result += ' '; }
+            cur = next;
+
+            auto c = line[cur];
+            if (c == '"' || c == '\'')
+            {
+                // 閉じていない場合は行末まで.
+                auto start = cur++;
+                while(cur < line.size() && line[cur] != c && line[cur] != '\n')
+                {
+                    if (line[cur] == '\\')
+                    { cur++; }
+                    cur++;
+                }
+                if (cur < line.size())
+                { cur++; }
+                result.append(line.substr(start, cur - start));
+            }
+            else
+            {
+                result += c;
+                cur++;
+            }
+        }
+
+        if (result.size() != head)
+        { result += '\n'; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      現在の行が有効かどうかチェックします.
+//-----------------------------------------------------------------------------
+bool Preprocessor::IsActive() const
+{ return m_Conditions.empty() || m_Conditions.back().Active; }
+
+//-----------------------------------------------------------------------------
+//      ディレクティブを処理します.
+//-----------------------------------------------------------------------------
+bool Preprocessor::Directive(std::string_view name, std::string_view text, bool& output)
+{
+    output = false;
+
+    if (name == "if" || name == "ifdef" || name == "ifndef")
+    {
+        Condition cond = {};
+        cond.Parent = IsActive();
+
+        if (cond.Parent)
+        {
+            bool value = false;
+            if (name == "if")
+            {
+                if (!Test(text, value))
+                { return false; }
+            }
+            else
+            {
+                std::vector<ExprToken> tokens;
+                if (!Lex(text, tokens) || tokens.empty() || tokens[0].Kind != EXPR_IDENTIFIER)
+                { return false; }
+
+                auto macro = std::string(tokens[0].Text);
+                value = m_Values.find(macro) != m_Values.end() || m_Functions.find(macro) != m_Functions.end();
+                if (name == "ifndef")
+                { value = !value; }
+            }
+
+            cond.Active = value;
+            cond.Taken  = value;
+        }
+
+        m_Conditions.push_back(cond);
+        return true;
+    }
+
+    if (name == "elif")
+    {
+        if (m_Conditions.empty() || m_Conditions.back().Else)
+        { return false; }
+
+        auto& cond = m_Conditions.back();
+        if (!cond.Parent || cond.Taken)
+        {
+            cond.Active = false;
+            return true;
+        }
+
+        bool value = false;
+        if (!Test(text, value))
+        { return false; }
+
+        cond.Active = value;
+        cond.Taken  = value;
+        return true;
+    }
+
+    if (name == "else")
+    {
+        if (m_Conditions.empty() || m_Conditions.back().Else)
+        { return false; }
+
+        auto& cond = m_Conditions.back();
+        cond.Else   = true;
+        cond.Active = cond.Parent && !cond.Taken;
+        cond.Taken  = true;
+        return true;
+    }
+
+    if (name == "endif")
+    {
+        if (m_Conditions.empty())
+        { return false; }
+
+        m_Conditions.pop_back();
+        return true;
+    }
+
+    // 未対応の条件ディレクティブは分岐を誤るので評価しない.
+    if (name == "elifdef" || name == "elifndef")
+    { return false; }
+
+    if (!IsActive())
+    { return true; }
+
+    // インクルード先で参照されるマクロは分からない.
+    if (name == "include")
+    { return false; }
+
+    if (name == "define" || name == "undef")
+    {
+        bool   comment = false;
+        size_t start   = SkipBlank(text, 0, comment);
+        size_t last    = start;
+        while(last < text.size() && IsIdentifier(text[last]))
+        { last++; }
+
+        if (last == start)
+        { return false; }
+
+        auto macro = std::string(text.substr(start, last - start));
+        m_Values   .erase(macro);
+        m_Functions.erase(macro);
+
+        if (name == "define")
+        {
+            if (last < text.size() && text[last] == '(')
+            { m_Functions.insert(macro); }
+            else
+            { m_Values[macro] = std::string(text.substr(last)); }
+        }
+    }
+
+    output = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      #if の条件式を評価します.
+//-----------------------------------------------------------------------------
+bool Preprocessor::Test(std::string_view text, bool& value) const
+{
+    std::vector<ExprToken> tokens;
+    if (!Lex(text, tokens))
+    { return false; }
+
+    std::vector<ExprToken> expanded;
+    if (!Expand(tokens, m_Values, m_Functions, 0, expanded))
+    { return false; }
+
+    int64_t result = 0;
+    ExprParser parser(expanded);
+    if (!parser.Parse(result))
+    { return false; }
+
+    value = (result != 0);
+    return true;
+}
+
+} // namespace asura
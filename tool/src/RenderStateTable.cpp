@@ -0,0 +1,603 @@
+﻿//-----------------------------------------------------------------------------
+// File : RenderStateTable.cpp
+// Desc : Render State Deduplication Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "RenderStateTable.h"
+#include "VariationInfoWriter.h"
+#include <array>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Type Definitions.
+//-----------------------------------------------------------------------------
+using RasterizerKey   = std::array<uint32_t, 8>;
+using DepthStencilKey = std::array<uint32_t, 14>;
+using BlendKey        = std::array<uint32_t, 9>;
+
+//-----------------------------------------------------------------------------
+//      浮動小数点数をビット列として比較できる値に変換します.
+//-----------------------------------------------------------------------------
+inline uint32_t ToBits(float value)
+{
+    uint32_t result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ステンシル演算が値を書き換えるかどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsStencilWrite(asura::STENCIL_OP_TYPE op)
+{ return op != asura::STENCIL_OP_KEEP; }
+
+//-----------------------------------------------------------------------------
+//      ステンシル比較が読み取りマスクを使うかどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsStencilRead(asura::COMPARE_TYPE func)
+{ return func != asura::COMPARE_TYPE_NEVER && func != asura::COMPARE_TYPE_ALWAYS; }
+
+//-----------------------------------------------------------------------------
+//      ブレンド演算がブレンド係数を使うかどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsBlendFactorUsed(asura::BLEND_OP_TYPE op)
+{ return op != asura::BLEND_OP_TYPE_MIN && op != asura::BLEND_OP_TYPE_MAX; }
+
+//-----------------------------------------------------------------------------
+//      正規化済みのステートを比較用の値の並びに変換します.
+//-----------------------------------------------------------------------------
+RasterizerKey ToKey(const asura::RasterizerState& state)
+{
+    return RasterizerKey{
+        uint32_t(state.PolygonMode),
+        uint32_t(state.CullMode),
+        uint32_t(state.FrontCCW),
+        state.DepthBias,
+        ToBits(state.DepthBiasClamp),
+        ToBits(state.SlopeScaledDepthBias),
+        uint32_t(state.DepthClipEnable),
+        uint32_t(state.EnableConservativeRaster),
+    };
+}
+
+//-----------------------------------------------------------------------------
+//      正規化済みのステートを比較用の値の並びに変換します.
+//-----------------------------------------------------------------------------
+DepthStencilKey ToKey(const asura::DepthStencilState& state)
+{
+    return DepthStencilKey{
+        uint32_t(state.DepthEnable),
+        uint32_t(state.DepthWriteMask),
+        uint32_t(state.DepthFunc),
+        uint32_t(state.StencilEnable),
+        uint32_t(state.StencilReadMask),
+        uint32_t(state.StencilWriteMask),
+        uint32_t(state.FrontFaceStencilFail),
+        uint32_t(state.FrontFaceStencilDepthFail),
+        uint32_t(state.FrontFaceStencilPass),
+        uint32_t(state.FrontFaceStencilFunc),
+        uint32_t(state.BackFaceStencilFail),
+        uint32_t(state.BackFaceStencilDepthFail),
+        uint32_t(state.BackFaceStencilPass),
+        uint32_t(state.BackFaceStencilFunc),
+    };
+}
+
+//-----------------------------------------------------------------------------
+//      正規化済みのステートを比較用の値の並びに変換します.
+//-----------------------------------------------------------------------------
+BlendKey ToKey(const asura::BlendState& state)
+{
+    return BlendKey{
+        uint32_t(state.AlphaToCoverageEnable),
+        uint32_t(state.BlendEnable),
+        uint32_t(state.SrcBlend),
+        uint32_t(state.DstBlend),
+        uint32_t(state.BlendOp),
+        uint32_t(state.SrcBlendAlpha),
+        uint32_t(state.DstBlendAlpha),
+        uint32_t(state.BlendOpAlpha),
+        uint32_t(state.RenderTargetWriteMask),
+    };
+}
+
+//-----------------------------------------------------------------------------
+//      メタデータのレコードをステートに変換します.
+//-----------------------------------------------------------------------------
+asura::RasterizerState ToState(const asura::VariationRasterizerState& record)
+{
+    asura::RasterizerState result;
+    result.PolygonMode              = asura::POLYGON_MODE(record.PolygonMode);
+    result.CullMode                 = asura::CULL_TYPE(record.CullMode);
+    result.FrontCCW                 = record.FrontCCW != 0;
+    result.DepthBias                = record.DepthBias;
+    result.DepthBiasClamp           = record.DepthBiasClamp;
+    result.SlopeScaledDepthBias     = record.SlopeScaledDepthBias;
+    result.DepthClipEnable          = record.DepthClipEnable != 0;
+    result.EnableConservativeRaster = record.EnableConservativeRaster != 0;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メタデータのレコードをステートに変換します.
+//-----------------------------------------------------------------------------
+asura::DepthStencilState ToState(const asura::VariationDepthStencilState& record)
+{
+    asura::DepthStencilState result;
+    result.DepthEnable                  = record.DepthEnable != 0;
+    result.DepthWriteMask               = asura::DEPTH_WRITE_MASK(record.DepthWriteMask);
+    result.DepthFunc                    = asura::COMPARE_TYPE(record.DepthFunc);
+    result.StencilEnable                = record.StencilEnable != 0;
+    result.StencilReadMask              = uint8_t(record.StencilReadMask);
+    result.StencilWriteMask             = uint8_t(record.StencilWriteMask);
+    result.FrontFaceStencilFail         = asura::STENCIL_OP_TYPE(record.FrontFaceStencilFail);
+    result.FrontFaceStencilDepthFail    = asura::STENCIL_OP_TYPE(record.FrontFaceStencilDepthFail);
+    result.FrontFaceStencilPass         = asura::STENCIL_OP_TYPE(record.FrontFaceStencilPass);
+    result.FrontFaceStencilFunc         = asura::COMPARE_TYPE(record.FrontFaceStencilFunc);
+    result.BackFaceStencilFail          = asura::STENCIL_OP_TYPE(record.BackFaceStencilFail);
+    result.BackFaceStencilDepthFail     = asura::STENCIL_OP_TYPE(record.BackFaceStencilDepthFail);
+    result.BackFaceStencilPass          = asura::STENCIL_OP_TYPE(record.BackFaceStencilPass);
+    result.BackFaceStencilFunc          = asura::COMPARE_TYPE(record.BackFaceStencilFunc);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メタデータのレコードをステートに変換します.
+//-----------------------------------------------------------------------------
+asura::BlendState ToState(const asura::VariationBlendState& record)
+{
+    asura::BlendState result;
+    result.AlphaToCoverageEnable    = record.AlphaToCoverageEnable != 0;
+    result.BlendEnable              = record.BlendEnable != 0;
+    result.SrcBlend                 = asura::BLEND_TYPE(record.SrcBlend);
+    result.DstBlend                 = asura::BLEND_TYPE(record.DstBlend);
+    result.BlendOp                  = asura::BLEND_OP_TYPE(record.BlendOp);
+    result.SrcBlendAlpha            = asura::BLEND_TYPE(record.SrcBlendAlpha);
+    result.DstBlendAlpha            = asura::BLEND_TYPE(record.DstBlendAlpha);
+    result.BlendOpAlpha             = asura::BLEND_OP_TYPE(record.BlendOpAlpha);
+    result.RenderTargetWriteMask    = uint8_t(record.RenderTargetWriteMask);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      値の並びの FNV-1a ハッシュ値を求めます.
+//-----------------------------------------------------------------------------
+template<size_t N>
+uint64_t ComputeHash(const std::array<uint32_t, N>& key)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(auto value : key)
+    {
+        for(auto i=0; i<4; ++i)
+        {
+            hash ^= uint8_t(value >> (i * 8));
+            hash *= 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+//-----------------------------------------------------------------------------
+//      ステートを正規化して登録します.
+//-----------------------------------------------------------------------------
+template<typename T>
+bool Insert(std::map<uint64_t, T>& table, const T& state)
+{
+    auto canonical = asura::Canonicalize(state);
+    auto key       = ToKey(canonical);
+    auto id        = ComputeHash(key);
+
+    auto result = table.emplace(id, canonical);
+    return result.second || ToKey(result.first->second) == key;
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// RenderStateTable class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+RenderStateTable::RenderStateTable()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+RenderStateTable::~RenderStateTable()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      エフェクトで定義されている全てのステートを登録します.
+//-----------------------------------------------------------------------------
+bool RenderStateTable::Add(const FxParser& parser)
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+
+    auto result = true;
+
+    for(auto& itr : parser.GetRasterizerStates())
+    { result &= Insert(m_RasterizerStates, itr.second); }
+
+    for(auto& itr : parser.GetDepthStencilStates())
+    { result &= Insert(m_DepthStencilStates, itr.second); }
+
+    for(auto& itr : parser.GetBlendStates())
+    { result &= Insert(m_BlendStates, itr.second); }
+
+    m_Named.RasterizerStates   += uint32_t(parser.GetRasterizerStates  ().size());
+    m_Named.DepthStencilStates += uint32_t(parser.GetDepthStencilStates().size());
+    m_Named.BlendStates        += uint32_t(parser.GetBlendStates       ().size());
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メタデータに記録されている全てのステートを登録します.
+//-----------------------------------------------------------------------------
+bool RenderStateTable::Add(const VariationInfoReader& reader)
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+
+    auto& header = *reader.GetHeader();
+    auto  result = true;
+
+    for(uint32_t i=0; i<header.RasterizerStates.Count; ++i)
+    { result &= Insert(m_RasterizerStates, ToState(reader.GetRasterizerStates()[i])); }
+
+    for(uint32_t i=0; i<header.DepthStencilStates.Count; ++i)
+    { result &= Insert(m_DepthStencilStates, ToState(reader.GetDepthStencilStates()[i])); }
+
+    for(uint32_t i=0; i<header.BlendStates.Count; ++i)
+    { result &= Insert(m_BlendStates, ToState(reader.GetBlendStates()[i])); }
+
+    m_Named.RasterizerStates   += header.RasterizerStates.Count;
+    m_Named.DepthStencilStates += header.DepthStencilStates.Count;
+    m_Named.BlendStates        += header.BlendStates.Count;
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      登録した名前付きステートの数を取得します.
+//-----------------------------------------------------------------------------
+RenderStateCount RenderStateTable::GetNamedCount() const
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    return m_Named;
+}
+
+//-----------------------------------------------------------------------------
+//      重複を除いたステートの数を取得します.
+//-----------------------------------------------------------------------------
+RenderStateCount RenderStateTable::GetUniqueCount() const
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+
+    RenderStateCount result;
+    result.RasterizerStates   = uint32_t(m_RasterizerStates  .size());
+    result.DepthStencilStates = uint32_t(m_DepthStencilStates.size());
+    result.BlendStates        = uint32_t(m_BlendStates       .size());
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      正規化済みのラスタライザーステートを取得します.
+//-----------------------------------------------------------------------------
+const std::map<uint64_t, RasterizerState>& RenderStateTable::GetRasterizerStates() const
+{ return m_RasterizerStates; }
+
+//-----------------------------------------------------------------------------
+//      正規化済みの深度ステンシルステートを取得します.
+//-----------------------------------------------------------------------------
+const std::map<uint64_t, DepthStencilState>& RenderStateTable::GetDepthStencilStates() const
+{ return m_DepthStencilStates; }
+
+//-----------------------------------------------------------------------------
+//      正規化済みのブレンドステートを取得します.
+//-----------------------------------------------------------------------------
+const std::map<uint64_t, BlendState>& RenderStateTable::GetBlendStates() const
+{ return m_BlendStates; }
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートを正規化します.
+//-----------------------------------------------------------------------------
+RasterizerState Canonicalize(const RasterizerState& state)
+{
+    auto result = state;
+
+    // -0 は 0 に揃える.
+    if (result.DepthBiasClamp == 0.0f)
+    { result.DepthBiasClamp = 0.0f; }
+
+    if (result.SlopeScaledDepthBias == 0.0f)
+    { result.SlopeScaledDepthBias = 0.0f; }
+
+    // バイアスが掛からなければクランプ値は使われない.
+    if (result.DepthBias == 0 && result.SlopeScaledDepthBias == 0.0f)
+    { result.DepthBiasClamp = 0.0f; }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートを正規化します.
+//-----------------------------------------------------------------------------
+DepthStencilState Canonicalize(const DepthStencilState& state)
+{
+    static const DepthStencilState kDefault = {};
+
+    auto result = state;
+
+    // 深度テストが無効な場合は書き込みも比較も行われない.
+    if (!result.DepthEnable)
+    {
+        result.DepthWriteMask = kDefault.DepthWriteMask;
+        result.DepthFunc      = kDefault.DepthFunc;
+    }
+
+    if (!result.StencilEnable)
+    {
+        result.StencilReadMask           = kDefault.StencilReadMask;
+        result.StencilWriteMask          = kDefault.StencilWriteMask;
+        result.FrontFaceStencilFail      = kDefault.FrontFaceStencilFail;
+        result.FrontFaceStencilDepthFail = kDefault.FrontFaceStencilDepthFail;
+        result.FrontFaceStencilPass      = kDefault.FrontFaceStencilPass;
+        result.FrontFaceStencilFunc      = kDefault.FrontFaceStencilFunc;
+        result.BackFaceStencilFail       = kDefault.BackFaceStencilFail;
+        result.BackFaceStencilDepthFail  = kDefault.BackFaceStencilDepthFail;
+        result.BackFaceStencilPass       = kDefault.BackFaceStencilPass;
+        result.BackFaceStencilFunc       = kDefault.BackFaceStencilFunc;
+        return result;
+    }
+
+    // 値を書き換える演算が無ければ書き込みマスクは使われない.
+    if (!IsStencilWrite(result.FrontFaceStencilFail)
+     && !IsStencilWrite(result.FrontFaceStencilDepthFail)
+     && !IsStencilWrite(result.FrontFaceStencilPass)
+     && !IsStencilWrite(result.BackFaceStencilFail)
+     && !IsStencilWrite(result.BackFaceStencilDepthFail)
+     && !IsStencilWrite(result.BackFaceStencilPass))
+    { result.StencilWriteMask = kDefault.StencilWriteMask; }
+
+    // 常に成功または失敗する比較では読み取りマスクは使われない.
+    if (!IsStencilRead(result.FrontFaceStencilFunc)
+     && !IsStencilRead(result.BackFaceStencilFunc))
+    { result.StencilReadMask = kDefault.StencilReadMask; }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートを正規化します.
+//-----------------------------------------------------------------------------
+BlendState Canonicalize(const BlendState& state)
+{
+    static const BlendState kDefault = {};
+
+    auto result = state;
+
+    // 書き込みマスクは RGBA の下位4ビットのみ有効.
+    result.RenderTargetWriteMask &= 0x0f;
+
+    // 何も書き込まなければブレンドしても結果は変わらない.
+    if (result.RenderTargetWriteMask == 0)
+    { result.BlendEnable = false; }
+
+    if (!result.BlendEnable)
+    {
+        result.SrcBlend      = kDefault.SrcBlend;
+        result.DstBlend      = kDefault.DstBlend;
+        result.BlendOp       = kDefault.BlendOp;
+        result.SrcBlendAlpha = kDefault.SrcBlendAlpha;
+        result.DstBlendAlpha = kDefault.DstBlendAlpha;
+        result.BlendOpAlpha  = kDefault.BlendOpAlpha;
+        return result;
+    }
+
+    // MIN/MAX 演算ではブレンド係数は使われない.
+    if (!IsBlendFactorUsed(result.BlendOp))
+    {
+        result.SrcBlend = kDefault.SrcBlend;
+        result.DstBlend = kDefault.DstBlend;
+    }
+
+    if (!IsBlendFactorUsed(result.BlendOpAlpha))
+    {
+        result.SrcBlendAlpha = kDefault.SrcBlendAlpha;
+        result.DstBlendAlpha = kDefault.DstBlendAlpha;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートの ID を求めます.
+//-----------------------------------------------------------------------------
+uint64_t GetStateId(const RasterizerState& state)
+{ return ComputeHash(ToKey(Canonicalize(state))); }
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートの ID を求めます.
+//-----------------------------------------------------------------------------
+uint64_t GetStateId(const DepthStencilState& state)
+{ return ComputeHash(ToKey(Canonicalize(state))); }
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートの ID を求めます.
+//-----------------------------------------------------------------------------
+uint64_t GetStateId(const BlendState& state)
+{ return ComputeHash(ToKey(Canonicalize(state))); }
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートを書き込みます. 名前が空の場合は name 属性を省略します.
+//-----------------------------------------------------------------------------
+void FormatRasterizerState(XmlWriter& writer, const std::string& name, uint64_t id, const RasterizerState& state)
+{
+    writer.Raw("    <rasterizer_state");
+    if (!name.empty())
+    { writer.Attribute("name", name); }
+    writer.AttributeHex("id",                          id);
+    writer.Attribute   ("polygon_mode",                ToString(state.PolygonMode));
+    writer.Attribute   ("cull_mode",                   ToString(state.CullMode));
+    writer.Attribute   ("front_ccw",                   state.FrontCCW ? "true" : "false");
+    writer.Attribute   ("depth_bias",                  state.DepthBias);
+    writer.Attribute   ("depth_bias_clamp",            state.DepthBiasClamp);
+    writer.Attribute   ("depth_clip_enable",           state.DepthClipEnable ? "true" : "false");
+    writer.Attribute   ("enable_consevative_raster",   state.EnableConservativeRaster ? "true" : "false");
+    writer.Raw(" />\n");
+}
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートを書き込みます. 名前が空の場合は name 属性を省略します.
+//-----------------------------------------------------------------------------
+void FormatDepthStencilState(XmlWriter& writer, const std::string& name, uint64_t id, const DepthStencilState& state)
+{
+    writer.Raw("    <depthsencil_state");
+    if (!name.empty())
+    { writer.Attribute("name", name); }
+    writer.AttributeHex("id",                               id);
+    writer.Attribute   ("depth_enable",                     state.DepthEnable ? "true" : "false");
+    writer.Attribute   ("depth_write_mask",                 ToString(state.DepthWriteMask));
+    writer.Attribute   ("depth_func",                       ToString(state.DepthFunc));
+    writer.Attribute   ("stencil_enable",                   state.StencilEnable ? "true" : "false");
+    writer.AttributeHex("stencil_read_mask",                state.StencilReadMask);
+    writer.AttributeHex("stencil_write_mask",               state.StencilWriteMask);
+    writer.Attribute   ("front_face_stencil_fail",          ToString(state.FrontFaceStencilFail));
+    writer.Attribute   ("front_face_stencil_depth_fail",    ToString(state.FrontFaceStencilDepthFail));
+    writer.Attribute   ("front_face_stencil_pass",          ToString(state.FrontFaceStencilPass));
+    writer.Attribute   ("back_face_stencil_fail",           ToString(state.BackFaceStencilFail));
+    writer.Attribute   ("back_face_stencil_depth_fail",     ToString(state.BackFaceStencilDepthFail));
+    writer.Attribute   ("back_face_stencil_pass",           ToString(state.BackFaceStencilPass));
+    writer.Attribute   ("back_face_stencil_func",           ToString(state.BackFaceStencilFunc));
+    writer.Raw(" />\n");
+}
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートを書き込みます. 名前が空の場合は name 属性を省略します.
+//-----------------------------------------------------------------------------
+void FormatBlendState(XmlWriter& writer, const std::string& name, uint64_t id, const BlendState& state)
+{
+    writer.Raw("    <blend_state");
+    if (!name.empty())
+    { writer.Attribute("name", name); }
+    writer.AttributeHex("id",                       id);
+    writer.Attribute   ("alpha_to_coverage_enable", state.AlphaToCoverageEnable ? "true" : "false");
+    writer.Attribute   ("blend_enable",             state.BlendEnable ? "true" : "false");
+    writer.Attribute   ("src_blend",                ToString(state.SrcBlend));
+    writer.Attribute   ("dst_blend",                ToString(state.DstBlend));
+    writer.Attribute   ("blend_op",                 ToString(state.BlendOp));
+    writer.Attribute   ("src_blend_alpha",          ToString(state.SrcBlendAlpha));
+    writer.Attribute   ("dst_blend_alpha",          ToString(state.DstBlendAlpha));
+    writer.Attribute   ("blend_op_alpha",           ToString(state.BlendOpAlpha));
+    writer.AttributeHex("render_target_write_mask", state.RenderTargetWriteMask);
+    writer.Raw(" />\n");
+}
+
+//-----------------------------------------------------------------------------
+//      エフェクトのステートだけをバイナリ形式で出力します.
+//-----------------------------------------------------------------------------
+bool WriteEffectRenderStates(const FxParser& parser, const std::string& path)
+{
+    VariationInfoWriter writer;
+
+    for(auto& itr : parser.GetRasterizerStates())
+    { writer.AddRasterizerState(itr.first, itr.second); }
+
+    for(auto& itr : parser.GetDepthStencilStates())
+    { writer.AddDepthStencilState(itr.first, itr.second); }
+
+    for(auto& itr : parser.GetBlendStates())
+    { writer.AddBlendState(itr.first, itr.second); }
+
+    return writer.Write(path);
+}
+
+//-----------------------------------------------------------------------------
+//      全エフェクト共通のステートテーブルを出力します.
+//-----------------------------------------------------------------------------
+bool WriteRenderStateTable
+(
+    const RenderStateTable&     table,
+    const std::string&          xmlPath,
+    const std::string&          binPath,
+    bool                        xml,
+    bool                        binary,
+    bool                        verify
+)
+{
+    // 正規化済みのステートを ID 順に並べるので, 処理順によらず同じ内容になる.
+    if (xml)
+    {
+        XmlWriter writer;
+        writer.Raw("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
+        writer.Raw("<root>\n");
+
+        for(auto& itr : table.GetRasterizerStates())
+        { FormatRasterizerState(writer, "", itr.first, itr.second); }
+
+        for(auto& itr : table.GetDepthStencilStates())
+        { FormatDepthStencilState(writer, "", itr.first, itr.second); }
+
+        for(auto& itr : table.GetBlendStates())
+        { FormatBlendState(writer, "", itr.first, itr.second); }
+
+        writer.Raw("</root>\n");
+
+        if (!writer.Flush(xmlPath.c_str()))
+        {
+            fprintf_s(stderr, "Error : Render State Table Write Failed. path = %s\n", xmlPath.c_str());
+            return false;
+        }
+    }
+
+    if (binary)
+    {
+        VariationInfoWriter writer;
+
+        for(auto& itr : table.GetRasterizerStates())
+        { writer.AddRasterizerState("", itr.second); }
+
+        for(auto& itr : table.GetDepthStencilStates())
+        { writer.AddDepthStencilState("", itr.second); }
+
+        for(auto& itr : table.GetBlendStates())
+        { writer.AddBlendState("", itr.second); }
+
+        if (!writer.Write(binPath))
+        {
+            fprintf_s(stderr, "Error : Render State Table Write Failed. path = %s\n", binPath.c_str());
+            return false;
+        }
+
+        if (verify && xml && !VariationInfoWriter::Verify(binPath, xmlPath))
+        {
+            fprintf_s(stderr, "Error : Render State Table Verify Failed. path = %s\n", binPath.c_str());
+            return false;
+        }
+    }
+
+    auto named  = table.GetNamedCount();
+    auto unique = table.GetUniqueCount();
+    printf_s("States : rasterizer = %u -> %u, depth_stencil = %u -> %u, blend = %u -> %u, path = %s\n",
+        named.RasterizerStates,     unique.RasterizerStates,
+        named.DepthStencilStates,   unique.DepthStencilStates,
+        named.BlendStates,          unique.BlendStates,
+        xml ? xmlPath.c_str() : binPath.c_str());
+
+    return true;
+}
+
+} // namespace asura
@@ -0,0 +1,211 @@
+﻿//-----------------------------------------------------------------------------
+// File : Sha256.cpp
+// Desc : SHA-256 Hash Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "Sha256.h"
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+//-----------------------------------------------------------------------------
+//      右回転します.
+//-----------------------------------------------------------------------------
+inline uint32_t RotR(uint32_t value, uint32_t count)
+{ return (value >> count) | (value << (32 - count)); }
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// Sha256 class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+Sha256::Sha256()
+: m_BlockSize(0)
+, m_TotalSize(0)
+{
+    m_State[0] = 0x6a09e667;
+    m_State[1] = 0xbb67ae85;
+    m_State[2] = 0x3c6ef372;
+    m_State[3] = 0xa54ff53a;
+    m_State[4] = 0x510e527f;
+    m_State[5] = 0x9b05688c;
+    m_State[6] = 0x1f83d9ab;
+    m_State[7] = 0x5be0cd19;
+}
+
+//-----------------------------------------------------------------------------
+//      データを追加します.
+//-----------------------------------------------------------------------------
+void Sha256::Update(const void* pData, size_t size)
+{
+    auto ptr = static_cast<const uint8_t*>(pData);
+    m_TotalSize += size;
+
+    // 前回の端数を埋める.
+    if (m_BlockSize > 0)
+    {
+        auto count = sizeof(m_Block) - m_BlockSize;
+        if (count > size)
+        { count = size; }
+
+        memcpy(m_Block + m_BlockSize, ptr, count);
+        m_BlockSize += count;
+        ptr         += count;
+        size        -= count;
+
+        if (m_BlockSize < sizeof(m_Block))
+        { return; }
+
+        Transform(m_Block);
+        m_BlockSize = 0;
+    }
+
+    // ブロック単位はコピーせずに処理する.
+    while (size >= sizeof(m_Block))
+    {
+        Transform(ptr);
+        ptr  += sizeof(m_Block);
+        size -= sizeof(m_Block);
+    }
+
+    if (size > 0)
+    {
+        memcpy(m_Block, ptr, size);
+        m_BlockSize = size;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      文字列を終端文字を含めて追加します.
+//-----------------------------------------------------------------------------
+void Sha256::Update(const std::string& value)
+{ Update(value.c_str(), value.size() + 1); }
+
+//-----------------------------------------------------------------------------
+//      ハッシュ値を16進文字列で取得します.
+//-----------------------------------------------------------------------------
+std::string Sha256::Finish()
+{
+    auto bits = m_TotalSize * 8;
+
+    // 0x80 と 0 で埋めて, 末尾8バイトにビット長を格納する.
+    uint8_t padding[72] = { 0x80 };
+    auto count = (m_BlockSize < 56) ? (56 - m_BlockSize) : (120 - m_BlockSize);
+    for(auto i=0; i<8; ++i)
+    { padding[count + i] = uint8_t(bits >> (56 - i * 8)); }
+
+    Update(padding, count + 8);
+
+    static const char kHex[] = "0123456789abcdef";
+
+    std::string result;
+    result.reserve(64);
+    for(auto i=0; i<8; ++i)
+    {
+        for(auto j=0; j<4; ++j)
+        {
+            auto value = uint8_t(m_State[i] >> (24 - j * 8));
+            result += kHex[value >> 4];
+            result += kHex[value & 0xf];
+        }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      データのハッシュ値を16進文字列で取得します.
+//-----------------------------------------------------------------------------
+std::string Sha256::Compute(const void* pData, size_t size)
+{
+    Sha256 hash;
+    hash.Update(pData, size);
+    return hash.Finish();
+}
+
+//-----------------------------------------------------------------------------
+//      1ブロックを処理します.
+//-----------------------------------------------------------------------------
+void Sha256::Transform(const uint8_t* pBlock)
+{
+    uint32_t w[64];
+    for(auto i=0; i<16; ++i)
+    {
+        w[i] = (uint32_t(pBlock[i * 4 + 0]) << 24)
+             | (uint32_t(pBlock[i * 4 + 1]) << 16)
+             | (uint32_t(pBlock[i * 4 + 2]) << 8)
+             | (uint32_t(pBlock[i * 4 + 3]));
+    }
+
+    for(auto i=16; i<64; ++i)
+    {
+        auto s0 = RotR(w[i - 15], 7) ^ RotR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        auto s1 = RotR(w[i - 2], 17) ^ RotR(w[i - 2],  19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto a = m_State[0];
+    auto b = m_State[1];
+    auto c = m_State[2];
+    auto d = m_State[3];
+    auto e = m_State[4];
+    auto f = m_State[5];
+    auto g = m_State[6];
+    auto h = m_State[7];
+
+    for(auto i=0; i<64; ++i)
+    {
+        auto s1  = RotR(e, 6) ^ RotR(e, 11) ^ RotR(e, 25);
+        auto ch  = (e & f) ^ (~e & g);
+        auto t1  = h + s1 + ch + kRoundConstants[i] + w[i];
+        auto s0  = RotR(a, 2) ^ RotR(a, 13) ^ RotR(a, 22);
+        auto maj = (a & b) ^ (a & c) ^ (b & c);
+        auto t2  = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    m_State[0] += a;
+    m_State[1] += b;
+    m_State[2] += c;
+    m_State[3] += d;
+    m_State[4] += e;
+    m_State[5] += f;
+    m_State[6] += g;
+    m_State[7] += h;
+}
+
+} // namespace asura
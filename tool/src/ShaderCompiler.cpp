@@ -0,0 +1,494 @@
+﻿//-----------------------------------------------------------------------------
+// File : ShaderCompiler.cpp
+// Desc : Shader Compiler Backend Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderCompiler.h"
+#include "Sha256.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <d3dcompiler.h>
+    #pragma comment(lib, "d3dcompiler.lib")
+#else
+    #include <spawn.h>
+    #include <fcntl.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    extern char** environ;
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      外部プロセスを実行し, 終了コードを取得します.
+//-----------------------------------------------------------------------------
+bool Execute(const std::vector<std::string>& args, const std::string& errPath, int& exitCode)
+{
+#if defined(_WIN32)
+    // コマンドライン文字列を組み立て.
+    std::string cmd;
+    for(size_t i=0; i<args.size(); ++i)
+    {
+        if (i > 0)
+        { cmd += " "; }
+
+        cmd += "\"";
+        cmd += args[i];
+        cmd += "\"";
+    }
+
+    SECURITY_ATTRIBUTES attr = {};
+    attr.nLength        = sizeof(attr);
+    attr.bInheritHandle = TRUE;
+
+    // 標準エラー出力をファイルにリダイレクト.
+    auto hErr = CreateFileA(
+        errPath.c_str(),
+        GENERIC_WRITE,
+        FILE_SHARE_READ,
+        &attr,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (hErr == INVALID_HANDLE_VALUE)
+    { return false; }
+
+    STARTUPINFOA        startup_info = {};
+    PROCESS_INFORMATION process_info = {};
+
+    startup_info.cb         = sizeof(STARTUPINFOA);
+    startup_info.dwFlags    = STARTF_USESTDHANDLES;
+    startup_info.hStdInput  = GetStdHandle(STD_INPUT_HANDLE);
+    startup_info.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    startup_info.hStdError  = hErr;
+
+    auto ret = CreateProcessA(
+        nullptr,
+        &cmd[0],
+        nullptr,
+        nullptr,
+        TRUE,
+        NORMAL_PRIORITY_CLASS,
+        nullptr,
+        nullptr,
+        &startup_info,
+        &process_info);
+
+    CloseHandle(hErr);
+
+    if (ret == 0)
+    { return false; }
+
+    WaitForSingleObject(process_info.hProcess, INFINITE);
+
+    DWORD code = 0;
+    GetExitCodeProcess(process_info.hProcess, &code);
+    exitCode = int(code);
+
+    CloseHandle(process_info.hProcess);
+    CloseHandle(process_info.hThread);
+
+    return true;
+#else
+    std::vector<char*> argv;
+    for(auto& arg : args)
+    { argv.push_back(const_cast<char*>(arg.c_str())); }
+    argv.push_back(nullptr);
+
+    // 標準エラー出力をファイルにリダイレクト.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 2, errPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    pid_t pid;
+    auto ret = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (ret != 0)
+    { return false; }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        { return false; }
+    }
+
+    exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      一時ファイル名の後ろに付ける番号を取得します.
+//-----------------------------------------------------------------------------
+std::string GetTempSuffix()
+{
+    // 同じファイルへの書き込みがプロセス間, スレッド間で衝突しないようにする.
+    static std::atomic<uint32_t> s_Counter(0);
+
+#if defined(_WIN32)
+    auto id = GetCurrentProcessId();
+#else
+    auto id = getpid();
+#endif
+    return "." + std::to_string(id) + "_" + std::to_string(s_Counter++) + ".tmp";
+}
+
+} // namespace
+
+
+namespace asura {
+
+#if defined(_WIN32)
+///////////////////////////////////////////////////////////////////////////////
+// D3DCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      シェーダをコンパイルします.
+//-----------------------------------------------------------------------------
+bool D3DCompilerBackend::Compile(const CompileJob& job, CompileResult& result)
+{
+    ID3DBlob* pBinary = nullptr;
+    ID3DBlob* pError  = nullptr;
+
+    // NAME=VALUE 形式を名前と値に分ける.
+    std::vector<std::string>        values(job.Defines.size() * 2);
+    std::vector<D3D_SHADER_MACRO>   macros;
+    for(size_t i=0; i<job.Defines.size(); ++i)
+    {
+        auto& define = job.Defines[i];
+        auto  pos    = define.find('=');
+        values[i * 2 + 0] = define.substr(0, pos);
+        values[i * 2 + 1] = (pos == std::string::npos) ? "1" : define.substr(pos + 1);
+
+        D3D_SHADER_MACRO macro = { values[i * 2 + 0].c_str(), values[i * 2 + 1].c_str() };
+        macros.push_back(macro);
+    }
+
+    D3D_SHADER_MACRO terminator = { nullptr, nullptr };
+    macros.push_back(terminator);
+
+    auto ret = D3DCompile(
+        job.pSource,
+        job.SourceSize,
+        nullptr,
+        macros.data(),
+        D3D_COMPILE_STANDARD_FILE_INCLUDE,
+        job.EntryPoint.c_str(),
+        job.Profile.c_str(),
+        job.Flags,
+        0,
+        &pBinary,
+        &pError);
+
+    if (pError != nullptr)
+    {
+        result.Message.assign(
+            static_cast<const char*>(pError->GetBufferPointer()),
+            pError->GetBufferSize());
+        pError->Release();
+        pError = nullptr;
+    }
+
+    if (FAILED(ret))
+    {
+        char code[32];
+        sprintf_s(code, "errcode = 0x%x, ", ret);
+        result.Message.insert(0, code);
+
+        if (pBinary != nullptr)
+        {
+            pBinary->Release();
+            pBinary = nullptr;
+        }
+
+        result.Success = false;
+        return false;
+    }
+
+    auto ptr = static_cast<const uint8_t*>(pBinary->GetBufferPointer());
+    result.Binary.assign(ptr, ptr + pBinary->GetBufferSize());
+
+    pBinary->Release();
+    pBinary = nullptr;
+
+    result.Success = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      バックエンド名を取得します.
+//-----------------------------------------------------------------------------
+const char* D3DCompilerBackend::GetName() const
+{ return "d3dcompiler"; }
+
+//-----------------------------------------------------------------------------
+//      バックエンドのバージョンを取得します.
+//-----------------------------------------------------------------------------
+std::string D3DCompilerBackend::GetVersion() const
+{ return "d3dcompiler_" + std::to_string(D3D_COMPILER_VERSION); }
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// ProcessCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ProcessCompilerBackend::ProcessCompilerBackend(const std::string& command)
+: m_Command(command)
+, m_Version("process:" + command)
+{
+    // 実行ファイルが差し替えられたら別バージョンとみなす.
+    struct stat info;
+    if (stat(command.c_str(), &info) == 0)
+    {
+        m_Version += ":" + std::to_string(uint64_t(info.st_size));
+        m_Version += ":" + std::to_string(uint64_t(info.st_mtime));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      シェーダをコンパイルします.
+//-----------------------------------------------------------------------------
+bool ProcessCompilerBackend::Compile(const CompileJob& job, CompileResult& result)
+{
+    auto outPath = job.OutputPath + ".out" + GetTempSuffix();
+    auto errPath = job.OutputPath + ".err" + GetTempSuffix();
+
+    // ソースコードがファイルに書き出されていない場合は一時ファイルを作る.
+    std::string tempPath;
+    if (job.SourcePath.empty())
+    {
+        tempPath = job.OutputPath + ".src" + GetTempSuffix();
+        if (!WriteFileAtomic(tempPath, job.pSource, job.SourceSize))
+        {
+            result.Message = "source write failed. path = " + tempPath;
+            result.Success = false;
+            return false;
+        }
+    }
+
+    std::vector<std::string> args;
+    args.push_back(m_Command);
+    args.push_back(tempPath.empty() ? job.SourcePath : tempPath);
+    args.push_back(job.EntryPoint);
+    args.push_back(job.Profile);
+    args.push_back(outPath);
+    for(auto& define : job.Defines)
+    { args.push_back(define); }
+
+    int exitCode = -1;
+    auto launched = Execute(args, errPath, exitCode);
+
+    if (!tempPath.empty())
+    { remove(tempPath.c_str()); }
+
+    if (!launched)
+    {
+        result.Message = "process launch failed. command = " + m_Command;
+        result.Success = false;
+        remove(errPath.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> message;
+    if (LoadBinary(errPath, message))
+    { result.Message.assign(message.begin(), message.end()); }
+    remove(errPath.c_str());
+
+    if (exitCode != 0 || !LoadBinary(outPath, result.Binary))
+    {
+        result.Message.insert(0, "exitcode = " + std::to_string(exitCode) + ", ");
+        result.Success = false;
+        remove(outPath.c_str());
+        return false;
+    }
+    remove(outPath.c_str());
+
+    result.Success = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      バックエンド名を取得します.
+//-----------------------------------------------------------------------------
+const char* ProcessCompilerBackend::GetName() const
+{ return "process"; }
+
+//-----------------------------------------------------------------------------
+//      バックエンドのバージョンを取得します.
+//-----------------------------------------------------------------------------
+std::string ProcessCompilerBackend::GetVersion() const
+{ return m_Version; }
+
+///////////////////////////////////////////////////////////////////////////////
+// FakeCompilerBackend class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+FakeCompilerBackend::FakeCompilerBackend(uint32_t delay, const std::string& failEntry, uint32_t crashCount)
+: m_Delay     (delay)
+, m_FailEntry (failEntry)
+, m_CrashCount(crashCount)
+, m_Count     (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      シェーダをコンパイルします.
+//-----------------------------------------------------------------------------
+bool FakeCompilerBackend::Compile(const CompileJob& job, CompileResult& result)
+{
+    if (m_CrashCount != 0 && ++m_Count == m_CrashCount)
+    { std::_Exit(3); }
+
+    if (m_Delay != 0)
+    { std::this_thread::sleep_for(std::chrono::milliseconds(m_Delay)); }
+
+    if (job.EntryPoint == m_FailEntry)
+    {
+        result.Message = "fake compile error. entry = " + job.EntryPoint;
+        result.Success = false;
+        return false;
+    }
+
+    // 受け取ったソースコードそのもののハッシュ値を含めて, 転送経路も検証できるようにする.
+    std::string text = "fake";
+    text += " entry="   + job.EntryPoint;
+    text += " profile=" + job.Profile;
+    text += " flags="   + std::to_string(job.Flags);
+    for(auto& define : job.Defines)
+    { text += " -D" + define; }
+    text += " source="  + Sha256::Compute(job.pSource, job.SourceSize);
+    text += "\n";
+
+    result.Binary.assign(text.begin(), text.end());
+    result.Success = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      バックエンド名を取得します.
+//-----------------------------------------------------------------------------
+const char* FakeCompilerBackend::GetName() const
+{ return "fake"; }
+
+//-----------------------------------------------------------------------------
+//      バックエンドのバージョンを取得します.
+//-----------------------------------------------------------------------------
+std::string FakeCompilerBackend::GetVersion() const
+{ return "1"; }
+
+//-----------------------------------------------------------------------------
+//      一時ファイルを経由してファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteFileAtomic(const std::string& path, const void* pData, size_t size)
+{
+    auto temp = path + GetTempSuffix();
+
+    FILE* pFile;
+    auto err = fopen_s(&pFile, temp.c_str(), "wb");
+    if (err != 0)
+    { return false; }
+
+    auto written = (size == 0) || (fwrite(pData, size, 1, pFile) == 1);
+    if (fclose(pFile) != 0 || !written)
+    {
+        remove(temp.c_str());
+        return false;
+    }
+
+#if defined(_WIN32)
+    if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+#else
+    if (rename(temp.c_str(), path.c_str()) != 0)
+#endif
+    {
+        remove(temp.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      一時ファイルを経由してハードリンクを作成します.
+//-----------------------------------------------------------------------------
+bool LinkFileAtomic(const std::string& target, const std::string& path)
+{
+    auto temp = path + GetTempSuffix();
+
+#if defined(_WIN32)
+    if (!CreateHardLinkA(temp.c_str(), target.c_str(), nullptr))
+    { return false; }
+
+    if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+#else
+    if (link(target.c_str(), temp.c_str()) != 0)
+    { return false; }
+
+    if (rename(temp.c_str(), path.c_str()) != 0)
+#endif
+    {
+        remove(temp.c_str());
+        return false;
+    }
+
+#if !defined(_WIN32)
+    // 既に同じファイルへのリンクだった場合, rename() は何もせずに成功するので一時ファイルが残る.
+    remove(temp.c_str());
+#endif
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadBinary(const std::string& path, std::vector<uint8_t>& result)
+{
+    FILE* pFile;
+    auto err = fopen_s(&pFile, path.c_str(), "rb");
+    if (err != 0)
+    { return false; }
+
+    fseek(pFile, 0, SEEK_END);
+    auto size = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+
+    if (size < 0)
+    {
+        fclose(pFile);
+        return false;
+    }
+
+    result.resize(size_t(size));
+    auto ret = (size == 0) || (fread(result.data(), size_t(size), 1, pFile) == 1);
+    fclose(pFile);
+
+    return ret;
+}
+
+} // namespace asura
@@ -0,0 +1,226 @@
+﻿//-----------------------------------------------------------------------------
+// File : ShaderPack.cpp
+// Desc : Shader Pack Format Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderPack.h"
+#include "LzCodec.h"
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      配列がファイルの範囲内に収まっているかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsInRange(size_t size, uint64_t offset, uint64_t count, uint64_t stride)
+{ return offset <= size && count <= (size - offset) / stride; }
+
+//-----------------------------------------------------------------------------
+//      エントリー名が一致するかチェックします.
+//-----------------------------------------------------------------------------
+bool IsMatch
+(
+    std::string_view name,
+    std::string_view technique,
+    std::string_view pass,
+    std::string_view stage,
+    std::string_view key
+)
+{
+    if (name.size() != technique.size() + pass.size() + stage.size() + key.size() + 3)
+    { return false; }
+
+    size_t pos = 0;
+    for(auto part : { technique, pass, stage })
+    {
+        if (name.compare(pos, part.size(), part) != 0 || name[pos + part.size()] != '\0')
+        { return false; }
+        pos += part.size() + 1;
+    }
+
+    return name.compare(pos, key.size(), key) == 0;
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackReader class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ShaderPackReader::ShaderPackReader()
+: m_pData   (nullptr)
+, m_Size    (0)
+, m_pHeader (nullptr)
+, m_pSlots  (nullptr)
+, m_pEntries(nullptr)
+, m_pNames  (nullptr)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+ShaderPackReader::~ShaderPackReader()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      メモリ上のパックファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool ShaderPackReader::Init(const void* pData, size_t size)
+{
+    Term();
+
+    if (pData == nullptr || size < sizeof(ShaderPackHeader))
+    { return false; }
+
+    if (reinterpret_cast<uintptr_t>(pData) % alignof(uint64_t) != 0)
+    { return false; }
+
+    auto pBytes  = static_cast<const uint8_t*>(pData);
+    auto pHeader = reinterpret_cast<const ShaderPackHeader*>(pBytes);
+    if (pHeader->Magic != kShaderPackMagic || pHeader->Version != kShaderPackVersion)
+    { return false; }
+
+    // 空きスロットが必ず残るようにしているので, 探索は必ず終わる.
+    auto slotCount = pHeader->SlotCount;
+    if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || pHeader->EntryCount >= slotCount)
+    { return false; }
+
+    if (pHeader->SlotOffset % alignof(uint64_t) != 0 || pHeader->EntryOffset % alignof(uint64_t) != 0)
+    { return false; }
+
+    if (!IsInRange(size, pHeader->SlotOffset,  slotCount,             sizeof(ShaderPackSlot))
+     || !IsInRange(size, pHeader->EntryOffset, pHeader->EntryCount,   sizeof(ShaderPackEntry))
+     || !IsInRange(size, pHeader->NameOffset,  pHeader->NameSize,     1))
+    { return false; }
+
+    m_pData    = pBytes;
+    m_Size     = size;
+    m_pHeader  = pHeader;
+    m_pSlots   = reinterpret_cast<const ShaderPackSlot*> (pBytes + pHeader->SlotOffset);
+    m_pEntries = reinterpret_cast<const ShaderPackEntry*>(pBytes + pHeader->EntryOffset);
+    m_pNames   = reinterpret_cast<const char*>           (pBytes + pHeader->NameOffset);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      読み込んだ内容を破棄します.
+//-----------------------------------------------------------------------------
+void ShaderPackReader::Term()
+{
+    m_pData    = nullptr;
+    m_Size     = 0;
+    m_pHeader  = nullptr;
+    m_pSlots   = nullptr;
+    m_pEntries = nullptr;
+    m_pNames   = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      シェーダバイナリを検索します.
+//-----------------------------------------------------------------------------
+bool ShaderPackReader::Find
+(
+    std::string_view    technique,
+    std::string_view    pass,
+    std::string_view    stage,
+    std::string_view    key,
+    ShaderPackBlob&     result
+) const
+{
+    if (m_pHeader == nullptr)
+    { return false; }
+
+    auto hash = ComputeShaderPackHash(technique, pass, stage, key);
+    auto mask = m_pHeader->SlotCount - 1;
+
+    // 線形探索で空きスロットに当たるまで調べる.
+    for(uint32_t i=0; i<m_pHeader->SlotCount; ++i)
+    {
+        auto& slot = m_pSlots[(hash + i) & mask];
+        if (slot.Entry == kShaderPackEmptySlot)
+        { return false; }
+
+        if (slot.Hash != hash)
+        { continue; }
+
+        if (slot.Entry >= m_pHeader->EntryCount)
+        { return false; }
+
+        auto& entry = m_pEntries[slot.Entry];
+        if (!IsInRange(size_t(m_pHeader->NameSize), entry.NameOffset, entry.NameSize, 1))
+        { return false; }
+
+        if (!IsMatch(std::string_view(m_pNames + entry.NameOffset, entry.NameSize), technique, pass, stage, key))
+        { continue; }
+
+        return GetBlob(slot.Entry, result);
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      エントリー番号を指定してシェーダバイナリを取得します.
+//-----------------------------------------------------------------------------
+bool ShaderPackReader::GetBlob(uint32_t index, ShaderPackBlob& result) const
+{
+    if (m_pHeader == nullptr || index >= m_pHeader->EntryCount)
+    { return false; }
+
+    auto& entry = m_pEntries[index];
+    if (!IsInRange(m_Size, entry.DataOffset, entry.DataSize, 1))
+    { return false; }
+
+    result.pData   = m_pData + entry.DataOffset;
+    result.Size    = size_t(entry.DataSize);
+    result.RawSize = size_t(entry.RawSize);
+    result.Codec   = entry.Codec;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      バイナリを展開します.
+//-----------------------------------------------------------------------------
+bool ShaderPackReader::Decode(const ShaderPackBlob& blob, void* pBuffer, size_t bufferSize)
+{
+    if (blob.RawSize > bufferSize || (pBuffer == nullptr && blob.RawSize > 0))
+    { return false; }
+
+    switch(blob.Codec)
+    {
+    case SHADER_PACK_CODEC_NONE:
+        {
+            if (blob.Size != blob.RawSize)
+            { return false; }
+
+            if (blob.Size > 0)
+            { memcpy(pBuffer, blob.pData, blob.Size); }
+        }
+        return true;
+
+    case SHADER_PACK_CODEC_LZ:
+        return LzDecompress(blob.pData, blob.Size, pBuffer, blob.RawSize);
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      エントリー数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t ShaderPackReader::GetCount() const
+{ return (m_pHeader != nullptr) ? m_pHeader->EntryCount : 0; }
+
+} // namespace asura
@@ -0,0 +1,282 @@
+﻿//-----------------------------------------------------------------------------
+// File : ShaderPackWriter.cpp
+// Desc : Shader Pack Writer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ShaderPackWriter.h"
+#include "ShaderCompiler.h"
+#include "LzCodec.h"
+#include "MappedFile.h"
+#include "Sha256.h"
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      指定した境界に切り上げます.
+//-----------------------------------------------------------------------------
+inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{ return (value + alignment - 1) / alignment * alignment; }
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// ShaderPackWriter class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ShaderPackWriter::ShaderPackWriter(bool compress)
+: m_Compress    (compress)
+, m_FileSize    (0)
+, m_RawSize     (0)
+, m_StoredSize  (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+ShaderPackWriter::~ShaderPackWriter()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      シェーダバイナリを追加します.
+//-----------------------------------------------------------------------------
+void ShaderPackWriter::Add
+(
+    const std::string&          technique,
+    const std::string&          pass,
+    const std::string&          stage,
+    const std::string&          key,
+    const std::vector<uint8_t>& data
+)
+{
+    auto hash = Sha256::Compute(data.data(), data.size());
+    auto blob = m_BlobIndex.find(hash);
+    if (blob == m_BlobIndex.end())
+    {
+        blob = m_BlobIndex.emplace(hash, uint32_t(m_Blobs.size())).first;
+        m_Blobs.push_back(data);
+    }
+
+    Item item;
+    item.Technique = technique;
+    item.Pass      = pass;
+    item.Stage     = stage;
+    item.Key       = key;
+    item.Blob      = blob->second;
+
+    item.Name.reserve(technique.size() + pass.size() + stage.size() + key.size() + 3);
+    item.Name += technique;
+    item.Name += '\0';
+    item.Name += pass;
+    item.Name += '\0';
+    item.Name += stage;
+    item.Name += '\0';
+    item.Name += key;
+
+    auto itr = m_Names.find(item.Name);
+    if (itr != m_Names.end())
+    {
+        m_Items[itr->second] = std::move(item);
+        return;
+    }
+
+    m_Names.emplace(item.Name, m_Items.size());
+    m_Items.push_back(std::move(item));
+}
+
+//-----------------------------------------------------------------------------
+//      パックファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool ShaderPackWriter::Write(const std::string& path)
+{
+    auto entryCount = uint32_t(m_Items.size());
+
+    // 負荷率を 0.5 以下にして, 空きスロットを必ず残す.
+    uint32_t slotCount = 1;
+    while(slotCount < entryCount * 2 || slotCount <= entryCount)
+    { slotCount <<= 1; }
+
+    uint64_t nameSize = 0;
+    for(auto& item : m_Items)
+    { nameSize += item.Name.size(); }
+
+    if (nameSize > UINT32_MAX)
+    { return false; }
+
+    ShaderPackHeader header = {};
+    header.Magic       = kShaderPackMagic;
+    header.Version     = kShaderPackVersion;
+    header.EntryCount  = entryCount;
+    header.SlotCount   = slotCount;
+    header.SlotOffset  = AlignUp(sizeof(ShaderPackHeader), alignof(uint64_t));
+    header.EntryOffset = AlignUp(header.SlotOffset + sizeof(ShaderPackSlot) * slotCount, alignof(uint64_t));
+    header.NameOffset  = header.EntryOffset + sizeof(ShaderPackEntry) * entryCount;
+    header.NameSize    = nameSize;
+
+    // 1つのシェーダだけを展開できるようにバイナリごとに圧縮する.
+    std::vector<std::vector<uint8_t>> compressed(m_Blobs.size());
+    m_RawSize    = 0;
+    m_StoredSize = 0;
+    for(size_t i=0; i<m_Blobs.size(); ++i)
+    {
+        if (m_Compress)
+        {
+            LzCompress(m_Blobs[i].data(), m_Blobs[i].size(), compressed[i]);
+            if (compressed[i].size() >= m_Blobs[i].size())
+            { compressed[i].clear(); }
+        }
+
+        m_RawSize    += m_Blobs[i].size();
+        m_StoredSize += compressed[i].empty() ? m_Blobs[i].size() : compressed[i].size();
+    }
+
+    // バイナリは mmap したまま使えるように境界を揃えて配置する.
+    std::vector<uint64_t> blobOffsets(m_Blobs.size());
+    auto size = header.NameOffset + nameSize;
+    for(size_t i=0; i<m_Blobs.size(); ++i)
+    {
+        size = AlignUp(size, kShaderPackAlignment);
+        blobOffsets[i] = size;
+        size += compressed[i].empty() ? m_Blobs[i].size() : compressed[i].size();
+    }
+
+    std::vector<uint8_t> buffer(size_t(size), 0);
+    auto pData = buffer.data();
+
+    memcpy(pData, &header, sizeof(header));
+
+    auto pSlots = reinterpret_cast<ShaderPackSlot*>(pData + header.SlotOffset);
+    for(uint32_t i=0; i<slotCount; ++i)
+    { pSlots[i].Entry = kShaderPackEmptySlot; }
+
+    auto pEntries   = reinterpret_cast<ShaderPackEntry*>(pData + header.EntryOffset);
+    auto nameOffset = uint32_t(0);
+    for(uint32_t i=0; i<entryCount; ++i)
+    {
+        auto& item  = m_Items[i];
+        auto& entry = pEntries[i];
+        auto& data  = compressed[item.Blob];
+        entry.DataOffset = blobOffsets[item.Blob];
+        entry.DataSize   = data.empty() ? m_Blobs[item.Blob].size() : data.size();
+        entry.RawSize    = m_Blobs[item.Blob].size();
+        entry.NameOffset = nameOffset;
+        entry.NameSize   = uint32_t(item.Name.size());
+        entry.Codec      = data.empty() ? SHADER_PACK_CODEC_NONE : SHADER_PACK_CODEC_LZ;
+
+        memcpy(pData + header.NameOffset + nameOffset, item.Name.data(), item.Name.size());
+        nameOffset += uint32_t(item.Name.size());
+
+        auto hash = ComputeShaderPackHash(item.Technique, item.Pass, item.Stage, item.Key);
+        auto slot = hash & (slotCount - 1);
+        while(pSlots[slot].Entry != kShaderPackEmptySlot)
+        { slot = (slot + 1) & (slotCount - 1); }
+
+        pSlots[slot].Hash  = hash;
+        pSlots[slot].Entry = i;
+    }
+
+    for(size_t i=0; i<m_Blobs.size(); ++i)
+    {
+        auto& data = compressed[i].empty() ? m_Blobs[i] : compressed[i];
+        if (!data.empty())
+        { memcpy(pData + blobOffsets[i], data.data(), data.size()); }
+    }
+
+    if (!WriteFileAtomic(path, buffer.data(), buffer.size()))
+    { return false; }
+
+    m_FileSize = size;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      書き出したパックファイルを読み直し, 追加した内容と一致するか検証します.
+//-----------------------------------------------------------------------------
+bool ShaderPackWriter::Verify(const std::string& path) const
+{
+    MappedFile file;
+    if (!file.Open(path.c_str()))
+    { return false; }
+
+    auto view = file.GetView();
+
+    ShaderPackReader reader;
+    if (!reader.Init(view.data(), view.size()))
+    { return false; }
+
+    if (reader.GetCount() != m_Items.size())
+    { return false; }
+
+    std::vector<uint8_t> buffer;
+    for(auto& item : m_Items)
+    {
+        ShaderPackBlob blob;
+        if (!reader.Find(item.Technique, item.Pass, item.Stage, item.Key, blob))
+        { return false; }
+
+        if (reinterpret_cast<uintptr_t>(blob.pData) % kShaderPackAlignment != 0)
+        { return false; }
+
+        auto& data = m_Blobs[item.Blob];
+        buffer.resize(blob.RawSize);
+        if (!ShaderPackReader::Decode(blob, buffer.data(), buffer.size()))
+        { return false; }
+
+        if (buffer != data)
+        { return false; }
+    }
+
+    // 登録していない名前は見つからないこと.
+    for(auto& item : m_Items)
+    {
+        ShaderPackBlob blob;
+        if (reader.Find(item.Technique, item.Pass, item.Stage, item.Key + " ", blob)
+         && m_Names.find(item.Name + " ") == m_Names.end())
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      エントリー数を取得します.
+//-----------------------------------------------------------------------------
+size_t ShaderPackWriter::GetEntryCount() const
+{ return m_Items.size(); }
+
+//-----------------------------------------------------------------------------
+//      重複を除いたバイナリ数を取得します.
+//-----------------------------------------------------------------------------
+size_t ShaderPackWriter::GetBlobCount() const
+{ return m_Blobs.size(); }
+
+//-----------------------------------------------------------------------------
+//      最後に書き出したパックファイルのサイズを取得します.
+//-----------------------------------------------------------------------------
+uint64_t ShaderPackWriter::GetFileSize() const
+{ return m_FileSize; }
+
+//-----------------------------------------------------------------------------
+//      最後に書き出したバイナリの展開後の合計サイズを取得します.
+//-----------------------------------------------------------------------------
+uint64_t ShaderPackWriter::GetRawSize() const
+{ return m_RawSize; }
+
+//-----------------------------------------------------------------------------
+//      最後に書き出したバイナリの格納時の合計サイズを取得します.
+//-----------------------------------------------------------------------------
+uint64_t ShaderPackWriter::GetStoredSize() const
+{ return m_StoredSize; }
+
+} // namespace asura
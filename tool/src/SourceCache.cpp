@@ -0,0 +1,348 @@
+﻿//-----------------------------------------------------------------------------
+// File : SourceCache.cpp
+// Desc : Source File Cache Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "SourceCache.h"
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      絶対パスを取得します.
+//-----------------------------------------------------------------------------
+std::string GetFullPath(const std::string& path)
+{
+    char buffer[_MAX_PATH] = {};
+    return (_fullpath(buffer, path.c_str(), _MAX_PATH) != nullptr) ? buffer : path;
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュのキーとして使う正規化済みパスを取得します.
+//-----------------------------------------------------------------------------
+std::string GetCanonicalPath(const std::string& fullPath)
+{
+    std::string result = fullPath;
+
+    // 区切り文字と大文字小文字の違いを吸収.
+    for(auto& c : result)
+    {
+        if (c == '/')
+        { c = '\\'; }
+        else if ('A' <= c && c <= 'Z')
+        { c = char(c - 'A' + 'a'); }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      #pragma once 指定があるかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool HasPragmaOnce(std::string_view code)
+{
+    auto pos = code.find("#pragma");
+    while(pos != std::string_view::npos)
+    {
+        // 行頭のディレクティブかどうか.
+        auto head = pos;
+        while(head > 0 && (code[head - 1] == ' ' || code[head - 1] == '\t'))
+        { head--; }
+
+        auto tail = pos + 7;
+        while(tail < code.size() && (code[tail] == ' ' || code[tail] == '\t'))
+        { tail++; }
+
+        if ((head == 0 || code[head - 1] == '\n')
+         && tail > pos + 7
+         && code.compare(tail, 4, "once") == 0)
+        { return true; }
+
+        pos = code.find("#pragma", pos + 7);
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      空白とコメントを読み飛ばします.
+//-----------------------------------------------------------------------------
+size_t SkipBlank(std::string_view code, size_t pos)
+{
+    while(pos < code.size())
+    {
+        if (isspace(uint8_t(code[pos])))
+        { pos++; }
+        else if (code.compare(pos, 2, "//") == 0)
+        {
+            pos = code.find('\n', pos);
+            if (pos == std::string_view::npos)
+            { pos = code.size(); }
+        }
+        else if (code.compare(pos, 2, "/*") == 0)
+        {
+            pos = code.find("*/", pos + 2);
+            pos = (pos == std::string_view::npos) ? code.size() : pos + 2;
+        }
+        else
+        { break; }
+    }
+
+    return pos;
+}
+
+//-----------------------------------------------------------------------------
+//      行末まで読み飛ばします. 複数行にまたがるコメントと行の継続は最後まで読み飛ばします.
+//-----------------------------------------------------------------------------
+size_t SkipLine(std::string_view code, size_t pos)
+{
+    while(pos < code.size() && code[pos] != '\n')
+    {
+        if (code.compare(pos, 2, "/*") == 0)
+        {
+            pos = code.find("*/", pos + 2);
+            pos = (pos == std::string_view::npos) ? code.size() : pos + 2;
+        }
+        else if (code.compare(pos, 2, "//") == 0)
+        {
+            pos = code.find('\n', pos);
+            if (pos == std::string_view::npos)
+            { pos = code.size(); }
+        }
+        else if (code[pos] == '"' || code[pos] == '\'')
+        {
+            auto quote = code[pos++];
+            while(pos < code.size() && code[pos] != quote && code[pos] != '\n')
+            { pos += (code[pos] == '\\') ? 2 : 1; }
+            pos++;
+        }
+        else if (code[pos] == '\\')
+        {
+            // 行の継続.
+            pos++;
+            if (pos < code.size() && code[pos] == '\r')
+            { pos++; }
+            pos++;
+        }
+        else
+        { pos++; }
+    }
+
+    return (pos < code.size()) ? pos : code.size();
+}
+
+//-----------------------------------------------------------------------------
+//      空白を読み飛ばして識別子を読み込みます.
+//-----------------------------------------------------------------------------
+std::string_view ReadWord(std::string_view code, size_t& pos)
+{
+    while(pos < code.size() && (code[pos] == ' ' || code[pos] == '\t'))
+    { pos++; }
+
+    auto begin = pos;
+    while(pos < code.size() && (isalnum(uint8_t(code[pos])) || code[pos] == '_'))
+    { pos++; }
+
+    return code.substr(begin, pos - begin);
+}
+
+//-----------------------------------------------------------------------------
+//      ファイル全体が #ifndef X / #define X / ... / #endif で囲まれているかチェックします.
+//-----------------------------------------------------------------------------
+bool HasIncludeGuard(std::string_view code)
+{
+    // 先頭のディレクティブは #ifndef X.
+    auto pos = SkipBlank(code, 0);
+    if (pos >= code.size() || code[pos] != '#')
+    { return false; }
+
+    pos++;
+    if (ReadWord(code, pos) != "ifndef")
+    { return false; }
+
+    auto guard = ReadWord(code, pos);
+    if (guard.empty())
+    { return false; }
+
+    // 次のディレクティブは #define X.
+    pos = SkipBlank(code, SkipLine(code, pos));
+    if (pos >= code.size() || code[pos] != '#')
+    { return false; }
+
+    pos++;
+    if (ReadWord(code, pos) != "define"
+     || ReadWord(code, pos) != guard
+     || (pos < code.size() && code[pos] == '('))
+    { return false; }
+
+    // 対応する #endif の後ろには空白とコメントしか無いこと.
+    auto depth = 1;
+    while(depth > 0)
+    {
+        pos = SkipBlank(code, SkipLine(code, pos));
+        if (pos >= code.size())
+        { return false; }
+
+        if (code[pos] != '#')
+        { continue; }
+
+        pos++;
+        auto directive = ReadWord(code, pos);
+        if (directive == "if" || directive == "ifdef" || directive == "ifndef")
+        { depth++; }
+        else if (directive == "endif")
+        { depth--; }
+        else if (depth == 1 && (directive == "else" || directive.substr(0, 4) == "elif"))
+        { return false; }
+    }
+
+    return SkipBlank(code, SkipLine(code, pos)) == code.size();
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズと更新日時を取得します.
+//-----------------------------------------------------------------------------
+bool GetFileStat(const std::string& path, uint64_t& size, int64_t& time)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    { return false; }
+
+    size = uint64_t(info.st_size);
+    time = int64_t(info.st_mtime);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SourceCache class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SourceCache::SourceCache(bool copy)
+: m_Copy(copy)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SourceCache::~SourceCache()
+{ Clear(); }
+
+//-----------------------------------------------------------------------------
+//      ファイルを取得します.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const SourceFile> SourceCache::Load(const std::string& path, bool* pOpened)
+{
+    auto fullPath = GetFullPath(path);
+    auto key      = GetCanonicalPath(fullPath);
+
+    if (pOpened != nullptr)
+    { *pOpened = false; }
+
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        auto itr = m_Files.find(key);
+        if (itr != m_Files.end())
+        { return itr->second; }
+    }
+
+    if (pOpened != nullptr)
+    { *pOpened = true; }
+
+    // 他のスレッドを待たせないようにロックの外で開く.
+    auto file = std::make_shared<SourceFile>();
+    file->FullPath = fullPath;
+    file->Size     = 0;
+    file->Time     = 0;
+    GetFileStat(fullPath, file->Size, file->Time);
+
+    // 読み込みと同じ秒に書き換えられると区別できないので次の Refresh() で取り除かせる.
+    if (file->Time >= int64_t(time(nullptr)))
+    { file->Time = -1; }
+
+    if (file->File.Open(path.c_str()))
+    {
+        file->Path         = path;
+        file->Key          = key;
+        file->Code         = file->File.GetView();
+        file->PragmaOnce   = HasPragmaOnce(file->Code);
+        file->IncludeGuard = HasIncludeGuard(file->Code);
+
+        if (m_Copy)
+        {
+            file->Buffer.assign(file->Code.data(), file->Code.size());
+            file->Code = file->Buffer;
+            file->File.Close();
+        }
+    }
+    else
+    {
+        // 開けなかったことも記録して, 検索パスの再試行を省く.
+        file.reset();
+    }
+
+    // 同時に開いた場合は先に登録された方を使う.
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    return m_Files.emplace(key, file).first->second;
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュを破棄します.
+//-----------------------------------------------------------------------------
+void SourceCache::Clear()
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    m_Files.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      読み込み後に変更されたファイルをキャッシュから取り除きます.
+//-----------------------------------------------------------------------------
+size_t SourceCache::Refresh()
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+
+    size_t count = 0;
+    for(auto itr = m_Files.begin(); itr != m_Files.end(); )
+    {
+        // 開けなかったファイルは再試行しても安価なので常に取り除く.
+        auto& file = itr->second;
+
+        uint64_t size = 0;
+        int64_t  time = 0;
+        if (!file
+         || !GetFileStat(file->FullPath, size, time)
+         || size != file->Size
+         || time != file->Time)
+        {
+            itr = m_Files.erase(itr);
+            count++;
+        }
+        else
+        { ++itr; }
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      登録されているファイル数を取得します.
+//-----------------------------------------------------------------------------
+size_t SourceCache::GetCount() const
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    return m_Files.size();
+}
+
+} // namespace asura
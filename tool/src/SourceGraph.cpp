@@ -0,0 +1,565 @@
+﻿//-----------------------------------------------------------------------------
+// File : SourceGraph.cpp
+// Desc : Source Declaration Graph Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "SourceGraph.h"
+#include <algorithm>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+enum TOKEN_KIND
+{
+    TOKEN_END,          //!< 終端.
+    TOKEN_NEWLINE,      //!< 改行.
+    TOKEN_IDENTIFIER,   //!< 識別子.
+    TOKEN_NUMBER,       //!< 数値.
+    TOKEN_STRING,       //!< 文字列.
+    TOKEN_PUNCTUATOR,   //!< 記号.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Token structure
+///////////////////////////////////////////////////////////////////////////////
+struct Token
+{
+    TOKEN_KIND  Kind;       //!< 種別.
+    size_t      Offset;     //!< 開始位置.
+    size_t      Size;       //!< サイズ.
+};
+
+//-----------------------------------------------------------------------------
+//      識別子に使える文字かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsIdentifier(char c)
+{
+    return ('a' <= c && c <= 'z')
+        || ('A' <= c && c <= 'Z')
+        || ('0' <= c && c <= '9')
+        || c == '_';
+}
+
+//-----------------------------------------------------------------------------
+//      数字かどうかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsDigit(char c)
+{ return '0' <= c && c <= '9'; }
+
+//-----------------------------------------------------------------------------
+//      行頭かどうかチェックします.
+//-----------------------------------------------------------------------------
+bool IsLineHead(std::string_view code, size_t pos)
+{
+    while(pos > 0 && (code[pos - 1] == ' ' || code[pos - 1] == '\t'))
+    { pos--; }
+
+    return pos == 0 || code[pos - 1] == '\n';
+}
+
+//-----------------------------------------------------------------------------
+//      行継続を考慮して次の行の先頭位置を取得します.
+//-----------------------------------------------------------------------------
+size_t FindLineEnd(std::string_view code, size_t pos)
+{
+    for(;;)
+    {
+        pos = code.find('\n', pos);
+        if (pos == std::string_view::npos)
+        { return code.size(); }
+
+        auto tail = pos;
+        if (tail > 0 && code[tail - 1] == '\r')
+        { tail--; }
+
+        pos++;
+        if (tail == 0 || code[tail - 1] != '\\')
+        { return pos; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      次のトークンを取得します.
+//-----------------------------------------------------------------------------
+size_t NextToken(std::string_view code, size_t pos, Token& token)
+{
+    auto size = code.size();
+    while(pos < size)
+    {
+        auto c = code[pos];
+        if (c == '\n')
+        {
+            token = { TOKEN_NEWLINE, pos, 1 };
+            return pos + 1;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f')
+        {
+            pos++;
+            continue;
+        }
+
+        // コメントは読み飛ばす.
+        if (c == '/' && pos + 1 < size && code[pos + 1] == '/')
+        {
+            pos = code.find('\n', pos);
+            if (pos == std::string_view::npos)
+            { pos = size; }
+            continue;
+        }
+
+        if (c == '/' && pos + 1 < size && code[pos + 1] == '*')
+        {
+            pos = code.find("*/", pos + 2);
+            pos = (pos == std::string_view::npos) ? size : pos + 2;
+            continue;
+        }
+
+        auto end = pos + 1;
+        if (IsIdentifier(c) && !IsDigit(c))
+        {
+            while(end < size && IsIdentifier(code[end]))
+            { end++; }
+
+            token = { TOKEN_IDENTIFIER, pos, end - pos };
+            return end;
+        }
+
+        if (IsDigit(c) || (c == '.' && end < size && IsDigit(code[end])))
+        {
+            while(end < size)
+            {
+                if (IsIdentifier(code[end]) || code[end] == '.')
+                { end++; }
+                else if ((code[end] == '+' || code[end] == '-')
+                      && (code[end - 1] == 'e' || code[end - 1] == 'E')
+                      && !(code[pos] == '0' && pos + 1 < size && (code[pos + 1] == 'x' || code[pos + 1] == 'X')))
+                { end++; }
+                else
+                { break; }
+            }
+
+            token = { TOKEN_NUMBER, pos, end - pos };
+            return end;
+        }
+
+        if (c == '"' || c == '\'')
+        {
+            while(end < size && code[end] != c && code[end] != '\n')
+            {
+                if (code[end] == '\\')
+                { end++; }
+                end++;
+            }
+            end = std::min(end + 1, size);
+
+            token = { TOKEN_STRING, pos, end - pos };
+            return end;
+        }
+
+        token = { TOKEN_PUNCTUATOR, pos, 1 };
+        return end;
+    }
+
+    token = { TOKEN_END, size, 0 };
+    return size;
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// SourceGraph class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SourceGraph::SourceGraph()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SourceGraph::~SourceGraph()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      ソースコードをトップレベルの宣言に分割し, 参照関係を構築します.
+//-----------------------------------------------------------------------------
+void SourceGraph::Build(std::string_view code)
+{
+    m_Code = code;
+    m_Declarations.clear();
+    m_Names       .clear();
+    m_Definitions .clear();
+    m_Roots       .clear();
+    m_Macros      .clear();
+
+    std::vector<uint32_t> defines;
+
+    size_t pos = 0;
+    while(pos < m_Code.size())
+    {
+        // 宣言の前にある空白やコメントは宣言に含める.
+        Token token;
+        auto next = pos;
+        do
+        { next = NextToken(m_Code, next, token); }
+        while(token.Kind == TOKEN_NEWLINE);
+
+        Declaration decl = {};
+        decl.Offset = pos;
+        defines.clear();
+
+        if (token.Kind == TOKEN_END)
+        {
+            pos = m_Code.size();
+            decl.Always = true;
+        }
+        else if (token.Kind == TOKEN_PUNCTUATOR && m_Code[token.Offset] == ';')
+        {
+            // テクニックなどを取り除いた後に残る空の宣言は出力しない.
+            pos = next;
+            decl.Size = pos - decl.Offset;
+            m_Declarations.push_back(std::move(decl));
+            continue;
+        }
+        else if (token.Kind == TOKEN_PUNCTUATOR && m_Code[token.Offset] == '#' && IsLineHead(m_Code, token.Offset))
+        { pos = ParseLine(token.Offset, decl); }
+        else
+        { pos = ParseDecl(token.Offset, decl, defines); }
+
+        decl.Size = pos - decl.Offset;
+
+        // 何も定義しない宣言は解析できなかったものとして残しておく.
+        if (defines.empty())
+        { decl.Always = true; }
+
+        auto index = uint32_t(m_Declarations.size());
+        for(auto id : defines)
+        {
+            auto& list = m_Definitions[id];
+            if (list.empty() || list.back() != index)
+            { list.push_back(index); }
+        }
+
+        std::sort(decl.References.begin(), decl.References.end());
+        decl.References.erase(std::unique(decl.References.begin(), decl.References.end()), decl.References.end());
+
+        if (decl.Always)
+        { m_Roots.insert(m_Roots.end(), decl.References.begin(), decl.References.end()); }
+
+        m_Declarations.push_back(std::move(decl));
+    }
+
+    std::sort(m_Roots.begin(), m_Roots.end());
+    m_Roots.erase(std::unique(m_Roots.begin(), m_Roots.end()), m_Roots.end());
+}
+
+//-----------------------------------------------------------------------------
+//      エントリーポイントから到達可能な宣言のみを含むソースコードを生成します.
+//-----------------------------------------------------------------------------
+bool SourceGraph::Strip(const std::string& entryPoint, std::string& result) const
+{
+    result.clear();
+
+    auto itr = m_Names.find(entryPoint);
+    if (itr == m_Names.end() || m_Definitions[itr->second].empty())
+    { return false; }
+
+    std::vector<bool>     marked (m_Definitions .size(), false);
+    std::vector<bool>     visited(m_Declarations.size(), false);
+    std::vector<uint32_t> stack  (m_Roots);
+    stack.push_back(itr->second);
+
+    while(!stack.empty())
+    {
+        auto id = stack.back();
+        stack.pop_back();
+
+        if (marked[id])
+        { continue; }
+        marked[id] = true;
+
+        for(auto index : m_Definitions[id])
+        {
+            if (visited[index])
+            { continue; }
+            visited[index] = true;
+
+            for(auto ref : m_Declarations[index].References)
+            {
+                if (!marked[ref])
+                { stack.push_back(ref); }
+            }
+        }
+    }
+
+    // 元の順序を保ったまま連結する.
+    size_t size = 0;
+    for(size_t i=0; i<m_Declarations.size(); ++i)
+    {
+        if (m_Declarations[i].Always || visited[i])
+        { size += m_Declarations[i].Size; }
+    }
+
+    result.reserve(size);
+    for(size_t i=0; i<m_Declarations.size(); ++i)
+    {
+        auto& decl = m_Declarations[i];
+        if (decl.Always || visited[i])
+        { result.append(m_Code.data() + decl.Offset, decl.Size); }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      宣言数を取得します.
+//-----------------------------------------------------------------------------
+size_t SourceGraph::GetDeclarationCount() const
+{ return m_Declarations.size(); }
+
+//-----------------------------------------------------------------------------
+//      識別子番号を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SourceGraph::Intern(std::string_view name)
+{
+    auto itr = m_Names.find(name);
+    if (itr != m_Names.end())
+    { return itr->second; }
+
+    auto id = uint32_t(m_Definitions.size());
+    m_Names.emplace(name, id);
+    m_Definitions.emplace_back();
+    return id;
+}
+
+//-----------------------------------------------------------------------------
+//      プリプロセッサ行を解析します.
+//-----------------------------------------------------------------------------
+size_t SourceGraph::ParseLine(size_t pos, Declaration& decl)
+{
+    auto end  = FindLineEnd(m_Code, pos);
+    auto line = m_Code.substr(0, end);
+
+    decl.Always = true;
+
+    // マクロ本体から参照される識別子も到達可能とする.
+    Token token;
+    std::string_view directive;
+    pos = NextToken(line, pos + 1, token);
+    while(token.Kind != TOKEN_END)
+    {
+        if (token.Kind == TOKEN_IDENTIFIER)
+        {
+            auto word = line.substr(token.Offset, token.Size);
+            if (directive.empty())
+            { directive = word; }
+            else
+            {
+                if (directive == "define" && decl.References.empty())
+                { m_Macros.insert(word); }
+
+                decl.References.push_back(Intern(word));
+            }
+        }
+
+        pos = NextToken(line, pos, token);
+    }
+
+    return end;
+}
+
+//-----------------------------------------------------------------------------
+//      トップレベルの宣言を解析します.
+//-----------------------------------------------------------------------------
+size_t SourceGraph::ParseDecl(size_t pos, Declaration& decl, std::vector<uint32_t>& defines)
+{
+    int     brace     = 0;          // {} のネスト.
+    int     paren     = 0;          // () のネスト.
+    int     square    = 0;          // [] のネスト.
+    bool    first     = true;       // 先頭のトークンかどうか.
+    bool    record    = false;      // struct, class, interface, cbuffer, tbuffer.
+    bool    aggregate = false;      // '}' の後に ';' まで続く宣言.
+    bool    buffer    = false;      // cbuffer, tbuffer.
+    bool    named     = false;      // 型名を登録済みかどうか.
+    bool    function  = false;      // 関数宣言かどうか.
+    bool    head      = true;       // 最初の '{' より前かどうか.
+    bool    assign    = false;      // 初期化子の中かどうか.
+    bool    declared  = false;      // 宣言子の名前を登録済みかどうか.
+    bool    member    = false;      // 直前のトークンが '.' かどうか.
+    int64_t last      = -1;         // 直前の識別子番号.
+
+    for(;;)
+    {
+        Token token;
+        auto next = NextToken(m_Code, pos, token);
+
+        if (token.Kind == TOKEN_END)
+        { return next; }
+
+        if (token.Kind == TOKEN_NEWLINE)
+        {
+            pos = next;
+            continue;
+        }
+
+        if (token.Kind == TOKEN_IDENTIFIER)
+        {
+            auto word = m_Code.substr(token.Offset, token.Size);
+            if (first)
+            {
+                buffer    = (word == "cbuffer" || word == "tbuffer");
+                record    = (word == "struct" || word == "class" || word == "interface" || buffer);
+                aggregate = (record && !buffer) || word == "typedef";
+                first     = false;
+            }
+            else if (record && !named && brace == 0)
+            {
+                defines.push_back(Intern(word));
+                named = true;
+            }
+
+            // メンバーアクセスは参照として扱わない.
+            if (member)
+            {
+                member = false;
+                last   = -1;
+                pos    = next;
+                continue;
+            }
+
+            // マクロで生成される宣言は解析できないので残しておく.
+            if (head && m_Macros.find(word) != m_Macros.end())
+            { decl.Always = true; }
+
+            auto id = Intern(word);
+            decl.References.push_back(id);
+            last = id;
+            pos  = next;
+            continue;
+        }
+
+        first  = false;
+        member = false;
+        pos    = next;
+
+        if (token.Kind != TOKEN_PUNCTUATOR)
+        {
+            last = -1;
+            continue;
+        }
+
+        auto c = m_Code[token.Offset];
+        if (c == '#' && IsLineHead(m_Code, token.Offset))
+        {
+            // 宣言の途中にある条件コンパイルは崩せないので残しておく.
+            decl.Always = true;
+            last = -1;
+            pos  = FindLineEnd(m_Code, token.Offset);
+            continue;
+        }
+
+        // 変数名と cbuffer のメンバー名を登録する.
+        auto top = (brace == 0 && !record && !function);
+        auto mem = (brace == 1 && buffer);
+        if ((top || mem) && paren == 0 && square == 0)
+        {
+            if (c == ':' || c == '[' || c == '=' || c == ',' || c == ';')
+            {
+                if (!declared && !assign && last >= 0)
+                {
+                    defines.push_back(uint32_t(last));
+                    declared = true;
+                }
+
+                if (c == '=')
+                { assign = true; }
+                else if (c == ',' || c == ';')
+                {
+                    declared = false;
+                    assign   = false;
+                }
+            }
+        }
+
+        switch(c)
+        {
+        case '.':
+            member = true;
+            break;
+
+        case '(':
+            if (brace == 0 && paren == 0 && square == 0 && !record && !function && !declared && !assign && last >= 0)
+            {
+                defines.push_back(uint32_t(last));
+                function = true;
+            }
+            paren++;
+            break;
+
+        case ')':
+            if (paren > 0)
+            { paren--; }
+            break;
+
+        case '[':
+            square++;
+            break;
+
+        case ']':
+            if (square > 0)
+            { square--; }
+            break;
+
+        case '{':
+            head = false;
+            brace++;
+            break;
+
+        case '}':
+            if (brace > 0)
+            { brace--; }
+
+            // 関数と cbuffer は '}' で終わる. 直後の ';' は含める.
+            if (brace == 0 && !aggregate && !assign)
+            {
+                auto tail = next;
+                do
+                { tail = NextToken(m_Code, tail, token); }
+                while(token.Kind == TOKEN_NEWLINE);
+
+                if (token.Kind == TOKEN_PUNCTUATOR && m_Code[token.Offset] == ';')
+                { return tail; }
+
+                return next;
+            }
+            break;
+
+        case ';':
+            if (brace == 0 && paren == 0)
+            {
+                // typedef や struct S { ... } s; の名前.
+                if (aggregate && last >= 0)
+                { defines.push_back(uint32_t(last)); }
+                return next;
+            }
+            break;
+        }
+
+        last = -1;
+    }
+}
+
+} // namespace asura
@@ -0,0 +1,177 @@
+﻿//-----------------------------------------------------------------------------
+// File : ThreadPool.cpp
+// Desc : Work Stealing Thread Pool Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "ThreadPool.h"
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Thread Local Variables.
+//-----------------------------------------------------------------------------
+thread_local const asura::ThreadPool*   t_pOwner    = nullptr;  // 実行中のスレッドプール.
+thread_local uint32_t                   t_Index     = 0;        // 実行中のワーカー番号.
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool(uint32_t threadCount)
+: m_Queued   (0)
+, m_Pending  (0)
+, m_NextQueue(0)
+, m_Exit     (false)
+{
+    if (threadCount == 0)
+    { threadCount = std::thread::hardware_concurrency(); }
+
+    if (threadCount == 0)
+    { threadCount = 1; }
+
+    m_Queues.resize(threadCount);
+    for(auto& queue : m_Queues)
+    { queue.reset(new Queue()); }
+
+    m_Threads.reserve(threadCount);
+    for(auto i=0u; i<threadCount; ++i)
+    { m_Threads.emplace_back(&ThreadPool::Run, this, i); }
+}
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        m_Exit = true;
+    }
+    m_WakeUp.notify_all();
+
+    for(auto& thread : m_Threads)
+    { thread.join(); }
+}
+
+//-----------------------------------------------------------------------------
+//      タスクを追加します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Push(std::function<void()>&& task)
+{
+    m_Pending++;
+
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+
+        // ワーカーから積んだタスクは自分のキューへ, それ以外は順番に配る.
+        auto index = (t_pOwner == this) ? t_Index : m_NextQueue;
+        if (t_pOwner != this)
+        { m_NextQueue = (m_NextQueue + 1) % uint32_t(m_Queues.size()); }
+
+        // 取り出し側で先に減算されないよう, 積む前に数える.
+        m_Queued++;
+
+        auto& queue = *m_Queues[index];
+        std::lock_guard<std::mutex> queueLocker(queue.Mutex);
+        queue.Tasks.push_back(std::move(task));
+    }
+
+    m_WakeUp.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+//      追加したタスクが全て完了するまで待機します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> locker(m_Mutex);
+    m_Done.wait(locker, [this]{ return m_Pending == 0; });
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッド数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t ThreadPool::GetThreadCount() const
+{ return uint32_t(m_Threads.size()); }
+
+//-----------------------------------------------------------------------------
+//      タスクを取り出します.
+//-----------------------------------------------------------------------------
+bool ThreadPool::Pop(uint32_t index, std::function<void()>& task)
+{
+    auto count = uint32_t(m_Queues.size());
+
+    // 自分のキューは先頭から, 他のキューは末尾から盗む.
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& queue = *m_Queues[(index + i) % count];
+
+        std::lock_guard<std::mutex> locker(queue.Mutex);
+        if (queue.Tasks.empty())
+        { continue; }
+
+        if (i == 0)
+        {
+            task = std::move(queue.Tasks.front());
+            queue.Tasks.pop_front();
+        }
+        else
+        {
+            task = std::move(queue.Tasks.back());
+            queue.Tasks.pop_back();
+        }
+
+        m_Queued--;
+        return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッドのメインループです.
+//-----------------------------------------------------------------------------
+void ThreadPool::Run(uint32_t index)
+{
+    t_pOwner = this;
+    t_Index  = index;
+
+    std::function<void()> task;
+    for(;;)
+    {
+        if (Pop(index, task))
+        {
+            task();
+            task = nullptr;
+
+            if (m_Pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> locker(m_Mutex);
+                m_Done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> locker(m_Mutex);
+        m_WakeUp.wait(locker, [this]{ return m_Exit || m_Queued > 0; });
+        if (m_Exit && m_Queued == 0)
+        { break; }
+    }
+
+    t_pOwner = nullptr;
+}
+
+} // namespace asura
@@ -8,7 +8,185 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include "Tokenizer.h"
-#include <new>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define ENABLE_SIMD_SCAN    (1)
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#else
+    #define ENABLE_SIMD_SCAN    (0)
+#endif
+
+#if ENABLE_SIMD_SCAN && !defined(_MSC_VER)
+    #define TARGET_SSSE3    __attribute__((target("ssse3")))
+    #define TARGET_AVX2     __attribute__((target("avx2")))
+#else
+    #define TARGET_SSSE3
+    #define TARGET_AVX2
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+constexpr int    kScalarPrefix   = 16;   // SIMD走査の前に1バイトずつ判定するバイト数.
+constexpr size_t kNumberLength   = 64;   // 数値変換に用いる最大文字数.
+
+#if ENABLE_SIMD_SCAN
+//-----------------------------------------------------------------------------
+//      CPUID命令を実行します.
+//-----------------------------------------------------------------------------
+void GetCpuId(int leaf, int subleaf, int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      拡張制御レジスタを取得します.
+//-----------------------------------------------------------------------------
+uint64_t GetXCR0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t(edx) << 32) | eax;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      最下位の立っているビット位置を取得します.
+//-----------------------------------------------------------------------------
+inline uint32_t FindFirstBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return uint32_t(index);
+#else
+    return uint32_t(__builtin_ctz(mask));
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      16バイト単位で文字クラスを走査します.
+//-----------------------------------------------------------------------------
+//! @param[in]  member  true なら文字クラスに含まれる文字を, false なら含まれない文字を探します.
+//! @return     見つかった位置を返却します. 見つからない場合は走査済みのバイト数を返却します.
+TARGET_SSSE3
+size_t ScanSSE(const uint8_t* ptr, size_t size, const uint8_t* lo, const uint8_t* hi, bool member)
+{
+    const auto lutLo  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+    const auto lutHi  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+    const auto nibble = _mm_set1_epi8(0x0f);
+    const auto zero   = _mm_setzero_si128();
+    const auto invert = member ? 0xffffu : 0u;
+
+    size_t i = 0;
+    for(; i + 16 <= size; i += 16)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+        auto l = _mm_shuffle_epi8(lutLo, _mm_and_si128(v, nibble));
+        auto h = _mm_shuffle_epi8(lutHi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+
+        // 文字クラスに含まれない位置のビットが立つ.
+        auto bits = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(l, h), zero)));
+        bits ^= invert;
+        if (bits != 0)
+        { return i + FindFirstBit(bits); }
+    }
+
+    return i;
+}
+
+//-----------------------------------------------------------------------------
+//      32バイト単位で文字クラスを走査します.
+//-----------------------------------------------------------------------------
+//! @param[in]  member  true なら文字クラスに含まれる文字を, false なら含まれない文字を探します.
+//! @return     見つかった位置を返却します. 見つからない場合は走査済みのバイト数を返却します.
+TARGET_AVX2
+size_t ScanAVX2(const uint8_t* ptr, size_t size, const uint8_t* lo, const uint8_t* hi, bool member)
+{
+    const auto lutLo  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo)));
+    const auto lutHi  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)));
+    const auto nibble = _mm256_set1_epi8(0x0f);
+    const auto zero   = _mm256_setzero_si256();
+    const auto invert = member ? 0xffffffffu : 0u;
+
+    size_t i = 0;
+    for(; i + 32 <= size; i += 32)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+        auto l = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(v, nibble));
+        auto h = _mm256_shuffle_epi8(lutHi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+
+        // 文字クラスに含まれない位置のビットが立つ.
+        auto bits = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(l, h), zero)));
+        bits ^= invert;
+        if (bits != 0)
+        { return i + FindFirstBit(bits); }
+    }
+
+    return i;
+}
+#endif//ENABLE_SIMD_SCAN
+
+//-----------------------------------------------------------------------------
+//      CPUがサポートする走査モードを取得します.
+//-----------------------------------------------------------------------------
+SCAN_MODE DetectScanMode()
+{
+#if ENABLE_SIMD_SCAN
+    static const SCAN_MODE s_Mode = []()
+    {
+        int regs[4] = {};
+        GetCpuId(0, 0, regs);
+        auto maxLeaf = regs[0];
+
+        GetCpuId(1, 0, regs);
+        auto ssse3   = (regs[2] & (0x1 << 9))  != 0;
+        auto osxsave = (regs[2] & (0x1 << 27)) != 0;
+        auto avx     = (regs[2] & (0x1 << 28)) != 0;
+
+        // OSがYMMレジスタを保存するかどうか.
+        auto ymm = osxsave && avx && ((GetXCR0() & 0x6) == 0x6);
+
+        auto avx2 = false;
+        if (maxLeaf >= 7 && ymm)
+        {
+            GetCpuId(7, 0, regs);
+            avx2 = (regs[1] & (0x1 << 5)) != 0;
+        }
+
+        if (avx2)
+        { return SCAN_MODE_AVX2; }
+        if (ssse3)
+        { return SCAN_MODE_SSE; }
+
+        return SCAN_MODE_SCALAR;
+    }();
+
+    return s_Mode;
+#else
+    return SCAN_MODE_SCALAR;
+#endif
+}
+
+} // namespace
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -21,11 +199,10 @@
 Tokenizer::Tokenizer()
 : m_pBuffer     (nullptr)
 , m_pPtr        (nullptr)
-, m_pToken      (nullptr)
-, m_Separator   ()
-, m_CutOff      ()
+, m_Token       ()
 , m_BufferSize  (0)
-{ /* DO_NOTHING */ }
+, m_ScanMode    (DetectScanMode())
+{ ResetCharType(); }
 
 //-----------------------------------------------------------------------------
 //      デストラクタです.
@@ -33,33 +210,14 @@ Tokenizer::Tokenizer()
 Tokenizer::~Tokenizer()
 { Term(); }
 
-//-----------------------------------------------------------------------------
-//      初期化処理を行います.
-//-----------------------------------------------------------------------------
-bool Tokenizer::Init(uint32_t size)
-{
-    m_pToken = new(std::nothrow) char[size];
-    if (m_pToken == nullptr)
-    { return false; }
-
-    memset(m_pToken, 0, sizeof(char) * size);
-
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 //      終了処理を行います.
 //-----------------------------------------------------------------------------
 void Tokenizer::Term()
 {
-    if (m_pToken != nullptr)
-    {
-        delete [] m_pToken;
-        m_pToken = nullptr;
-    }
+    m_Token = std::string_view();
 
-    m_Separator .clear();
-    m_CutOff    .clear();
+    ResetCharType();
 
     m_pPtr          = nullptr;
     m_pBuffer       = nullptr;
@@ -70,13 +228,168 @@ void Tokenizer::Term()
 //      区切り文字を設定します.
 //-----------------------------------------------------------------------------
 void Tokenizer::SetSeparator(const char *separator)
-{ m_Separator = std::string(separator); }
+{ SetCharType(separator, CHAR_TYPE_SEPARATOR); }
 
 //-----------------------------------------------------------------------------
 //      切り出し文字を設定します.
 //-----------------------------------------------------------------------------
 void Tokenizer::SetCutOff(const char *cutoff)
-{ m_CutOff = std::string(cutoff); }
+{ SetCharType(cutoff, CHAR_TYPE_CUTOFF); }
+
+//-----------------------------------------------------------------------------
+//      走査モードを設定します.
+//-----------------------------------------------------------------------------
+void Tokenizer::SetScanMode(SCAN_MODE mode)
+{
+    // CPUがサポートしていないモードは使用しない.
+    auto support = DetectScanMode();
+    if (mode == SCAN_MODE_AUTO || mode > support)
+    { mode = support; }
+
+    m_ScanMode = mode;
+}
+
+//-----------------------------------------------------------------------------
+//      走査モードを取得します.
+//-----------------------------------------------------------------------------
+SCAN_MODE Tokenizer::GetScanMode() const
+{ return m_ScanMode; }
+
+//-----------------------------------------------------------------------------
+//      文字種別テーブルをリセットします.
+//-----------------------------------------------------------------------------
+void Tokenizer::ResetCharType()
+{
+    memset(m_CharType, CHAR_TYPE_NONE, sizeof(m_CharType));
+    m_CharType['\0'] = CHAR_TYPE_TERMINATOR;
+
+    BuildCharClass(CHAR_TYPE_SEPARATOR, m_SkipClass);
+    BuildCharClass(CHAR_TYPE_SEPARATOR | CHAR_TYPE_CUTOFF | CHAR_TYPE_TERMINATOR, m_SplitClass);
+}
+
+//-----------------------------------------------------------------------------
+//      文字種別テーブルを設定します.
+//-----------------------------------------------------------------------------
+void Tokenizer::SetCharType(const char* chars, uint8_t type)
+{
+    // 以前の設定を解除.
+    for(auto i=0; i<256; ++i)
+    { m_CharType[i] &= ~type; }
+
+    auto p = reinterpret_cast<const uint8_t*>(chars);
+    while(*p != '\0')
+    {
+        m_CharType[*p] |= type;
+        p++;
+    }
+
+    BuildCharClass(CHAR_TYPE_SEPARATOR, m_SkipClass);
+    BuildCharClass(CHAR_TYPE_SEPARATOR | CHAR_TYPE_CUTOFF | CHAR_TYPE_TERMINATOR, m_SplitClass);
+}
+
+//-----------------------------------------------------------------------------
+//      SIMD走査用の文字クラスを構築します.
+//-----------------------------------------------------------------------------
+void Tokenizer::BuildCharClass(uint8_t mask, CharClass& result) const
+{
+    // 上位4bitごとにビットを割り当て, 下位4bitのテーブルとの論理積で判定する.
+    // 上位4bitの種類が8を超える場合はSIMD走査できない.
+    memset(&result, 0, sizeof(result));
+
+    uint8_t  bits[16] = {};
+    uint32_t count    = 0;
+
+    for(auto c=0; c<256; ++c)
+    {
+        if ((m_CharType[c] & mask) == 0)
+        { continue; }
+
+        auto hi = c >> 4;
+        if (bits[hi] == 0)
+        {
+            if (count >= 8)
+            { return; }
+
+            bits[hi] = uint8_t(0x1 << count);
+            count++;
+        }
+
+        result.Lo[c & 0xf] |= bits[hi];
+        result.Hi[hi]       = bits[hi];
+    }
+
+    result.Valid = true;
+}
+
+//-----------------------------------------------------------------------------
+//      区切り文字を読み飛ばします.
+//-----------------------------------------------------------------------------
+uint8_t* Tokenizer::SkipSeparator(uint8_t* ptr) const
+{
+    // 終端文字が無いバッファ(メモリマップなど)もあるので, 末尾を超えて読まない.
+    auto end = reinterpret_cast<uint8_t*>(m_pBuffer) + m_BufferSize;
+
+    // 大半は短いので, 先頭の数バイトは1バイトずつ判定する.
+    for(auto i=0; i<kScalarPrefix; ++i)
+    {
+        if (ptr >= end || (m_CharType[*ptr] & CHAR_TYPE_SEPARATOR) == 0)
+        { return ptr; }
+
+        ptr++;
+    }
+
+#if ENABLE_SIMD_SCAN
+    if (m_SkipClass.Valid && ptr < end)
+    {
+        auto size = size_t(end - ptr);
+        if (m_ScanMode == SCAN_MODE_AVX2)
+        { ptr += ScanAVX2(ptr, size, m_SkipClass.Lo, m_SkipClass.Hi, false); }
+        else if (m_ScanMode == SCAN_MODE_SSE)
+        { ptr += ScanSSE(ptr, size, m_SkipClass.Lo, m_SkipClass.Hi, false); }
+    }
+#endif
+
+    // 残りは1バイトずつ.
+    while (ptr < end && (m_CharType[*ptr] & CHAR_TYPE_SEPARATOR))
+    { ptr++; }
+
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//      区切り文字, 切り出し文字, 終端文字のいずれかを探します.
+//-----------------------------------------------------------------------------
+uint8_t* Tokenizer::FindSplit(uint8_t* ptr) const
+{
+    const uint8_t split = CHAR_TYPE_SEPARATOR | CHAR_TYPE_CUTOFF | CHAR_TYPE_TERMINATOR;
+    auto end = reinterpret_cast<uint8_t*>(m_pBuffer) + m_BufferSize;
+
+    // 大半は短いので, 先頭の数バイトは1バイトずつ判定する.
+    for(auto i=0; i<kScalarPrefix; ++i)
+    {
+        if (ptr >= end || (m_CharType[*ptr] & split))
+        { return ptr; }
+
+        ptr++;
+    }
+
+#if ENABLE_SIMD_SCAN
+    if (m_SplitClass.Valid && ptr < end)
+    {
+        auto size = size_t(end - ptr);
+        if (m_ScanMode == SCAN_MODE_AVX2)
+        { ptr += ScanAVX2(ptr, size, m_SplitClass.Lo, m_SplitClass.Hi, true); }
+        else if (m_ScanMode == SCAN_MODE_SSE)
+        { ptr += ScanSSE(ptr, size, m_SplitClass.Lo, m_SplitClass.Hi, true); }
+    }
+#endif
+
+    // 残りは1バイトずつ.
+    while (ptr < end && (m_CharType[*ptr] & split) == 0)
+    { ptr++; }
+
+    return ptr;
+}
 
 //-----------------------------------------------------------------------------
 //      バッファを設定します.
@@ -97,36 +410,34 @@ void Tokenizer::Next()
 {
     auto sizeP = size_t(m_pPtr - m_pBuffer);
     if (sizeP >= m_BufferSize)
-    { return; }
-
-    auto p = m_pPtr;
-    auto q = m_pToken;
+    {
+        // 終端に達した後は空トークンとする.
+        m_Token = std::string_view();
+        return;
+    }
 
     // 区切り文字はスキップする
-    while ((*p) != '\0' && strchr(m_Separator.c_str(), *p))
-    { p++; }
+    auto end = reinterpret_cast<uint8_t*>(m_pBuffer) + m_BufferSize;
+    auto p   = SkipSeparator(reinterpret_cast<uint8_t*>(m_pPtr));
+    auto e   = p;
 
-    // 切り出し文字とヒットするか判定
-    if (strchr(m_CutOff.c_str(), *p))
+    // 切り出し文字とヒットするか判定(末尾まで区切り文字なら空トークン)
+    if (p < end && (m_CharType[*p] & CHAR_TYPE_CUTOFF))
     {
         //切り出し文字とヒットしたら，単体トークンとする
-        (*(q++)) = (*(p++));
+        e++;
     }
     else
     {
         //区切り文字または切り出し文字以外ならトークンとする
-        std::string split = m_Separator + m_CutOff;
-        while (*p != '\0' && !strchr(split.c_str(), *p))
-        {
-            (*(q++)) = (*(p++));
-        }
+        e = FindSplit(p);
     }
 
-    //抜き出した分だけバッファを進める
-    m_pPtr = p;
+    // バッファ上の位置をそのままトークンとする(コピーしない).
+    m_Token = std::string_view(reinterpret_cast<char*>(p), size_t(e - p));
 
-    //文字列として返すためにNULL終端文字を加える
-    *q = '\0';
+    //抜き出した分だけバッファを進める
+    m_pPtr = reinterpret_cast<char*>(e);
 }
 
 //-----------------------------------------------------------------------------
@@ -136,8 +447,7 @@ void Tokenizer::SkipTo(const char* text)
 {
     while(!IsEnd())
     {
-        auto ret = Contain(text);
-        if (ret != nullptr)
+        if (Contain(text))
         {
             Next();
             break;
@@ -152,20 +462,18 @@ void Tokenizer::SkipTo(const char* text)
 //-----------------------------------------------------------------------------
 void Tokenizer::SkipLine()
 {
-    auto p = m_pPtr;
-    auto q = m_pToken;
+    auto p   = m_pPtr;
+    auto end = m_pBuffer + m_BufferSize;
 
     // 区切り文字はスキップする
-    while ((*p) != '\0' && strchr(" \t", *p))
+    while (p < end && (*p) != '\0' && strchr(" \t", *p))
     { p++; }
 
-    auto pos = strstr(p, "\n");
+    auto pos = static_cast<char*>(memchr(p, '\n', size_t(end - p)));
     if (pos != nullptr)
     {
-        m_pPtr = pos;
-        auto size = pos - p;
-        memcpy(m_pToken, p, size);
-        m_pToken[size] = '\0';
+        m_pPtr  = pos;
+        m_Token = std::string_view(p, size_t(pos - p));
     }
 }
 
@@ -173,37 +481,43 @@ void Tokenizer::SkipLine()
 //      指定された文字列とトークンが一致するかチェックします.
 //-----------------------------------------------------------------------------
 bool Tokenizer::Compare(const char *token) const
-{ return (strcmp(m_pToken, token) == 0); }
+{ return m_Token == token; }
 
 //-----------------------------------------------------------------------------
 //      指定された文字列とトークンが一致するかチェックします.
 //-----------------------------------------------------------------------------
 bool Tokenizer::CompareAsLower(const char *token) const
-{ return (_stricmp(m_pToken, token) == 0); }
+{
+    auto size = strlen(token);
+    if (m_Token.size() != size)
+    { return false; }
+
+    return (_strnicmp(m_Token.data(), token, size) == 0);
+}
 
 //-----------------------------------------------------------------------------
 //      指定された文字列と部分一致するかどうかチェックします.
 //-----------------------------------------------------------------------------
-char* Tokenizer::Contain(const char* token) const
-{ return strstr(m_pToken, token); }
+bool Tokenizer::Contain(const char* token) const
+{ return m_Token.find(token) != std::string_view::npos; }
 
 //-----------------------------------------------------------------------------
 //      最後かどうかチェックします.
 //-----------------------------------------------------------------------------
 bool Tokenizer::IsEnd() const
 {
-    if (*m_pPtr == '\0' || m_pPtr == nullptr)
+    if (m_pPtr == nullptr)
     { return true; }
 
     auto sizeP = size_t(m_pPtr - m_pBuffer);
-    return (sizeP >= m_BufferSize);
+    return (sizeP >= m_BufferSize || *m_pPtr == '\0');
 }
 
 //-----------------------------------------------------------------------------
 //      トークンが有効かどうかチェックします.
 //-----------------------------------------------------------------------------
 bool Tokenizer::IsValidToken() const
-{ return (*m_pToken != '\0' && m_pToken != nullptr); }
+{ return !m_Token.empty(); }
 
 //-----------------------------------------------------------------------------
 //      バッファを取得します.
@@ -218,37 +532,49 @@ char* Tokenizer::GetPtr() const
 { return m_pPtr; }
 
 //-----------------------------------------------------------------------------
-//      char型としてトークンを取得します.
+//      文字列ビューとしてトークンを取得します.
 //-----------------------------------------------------------------------------
-char* Tokenizer::GetAsChar() const
-{ return m_pToken; }
+std::string_view Tokenizer::GetAsView() const
+{ return m_Token; }
 
 //-----------------------------------------------------------------------------
 //      double型としてトークンを取得します.
 //-----------------------------------------------------------------------------
 double Tokenizer::GetAsDouble() const
-{ return atof(m_pToken); }
+{
+    char number[kNumberLength];
+    CopyToken(number, kNumberLength);
+    return atof(number);
+}
 
 //-----------------------------------------------------------------------------
 //      float型としてトークンを取得します.
 //-----------------------------------------------------------------------------
 float Tokenizer::GetAsFloat() const
-{ return static_cast<float>(atof(m_pToken)); }
+{
+    char number[kNumberLength];
+    CopyToken(number, kNumberLength);
+    return static_cast<float>(atof(number));
+}
 
 //-----------------------------------------------------------------------------
 //      int型としてトークンを取得します.
 //-----------------------------------------------------------------------------
 int Tokenizer::GetAsInt() const
-{ return atoi(m_pToken); }
+{
+    char number[kNumberLength];
+    CopyToken(number, kNumberLength);
+    return atoi(number);
+}
 
 //-----------------------------------------------------------------------------
 //      bool型としてトークンを取得します.
 //-----------------------------------------------------------------------------
 bool Tokenizer::GetAsBool() const
 {
-    if (_stricmp(m_pToken, "TRUE") == 0)
+    if (CompareAsLower("TRUE"))
     { return true; }
-    else if (_stricmp(m_pToken, "FALSE") == 0)
+    else if (CompareAsLower("FALSE"))
     { return false; }
 
     return false;
@@ -258,15 +584,19 @@ bool Tokenizer::GetAsBool() const
 //      uint32_t型としてトークンを取得します.
 //-----------------------------------------------------------------------------
 uint32_t Tokenizer::GetAsUint() const
-{ return strtoul(m_pToken, nullptr, 0); }
+{
+    char number[kNumberLength];
+    CopyToken(number, kNumberLength);
+    return strtoul(number, nullptr, 0);
+}
 
 //-----------------------------------------------------------------------------
-//      次のトークンを取得して，char型として返却します.
+//      次のトークンを取得して，文字列ビューとして返却します.
 //-----------------------------------------------------------------------------
-char* Tokenizer::NextAsChar()
+std::string_view Tokenizer::NextAsView()
 {
     Next();
-    return GetAsChar();
+    return GetAsView();
 }
 
 //-----------------------------------------------------------------------------
@@ -313,3 +643,13 @@ uint32_t Tokenizer::NextAsUint()
     Next();
     return GetAsUint();
 }
+
+//-----------------------------------------------------------------------------
+//      数値変換用にトークンをNULL終端文字付きでコピーします.
+//-----------------------------------------------------------------------------
+void Tokenizer::CopyToken(char* buffer, size_t bufferSize) const
+{
+    auto size = std::min(m_Token.size(), bufferSize - 1);
+    memcpy(buffer, m_Token.data(), size);
+    buffer[size] = '\0';
+}
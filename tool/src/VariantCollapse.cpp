@@ -0,0 +1,69 @@
+﻿//-----------------------------------------------------------------------------
+// File : VariantCollapse.cpp
+// Desc : Keyword Variant Collapse Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "VariantCollapse.h"
+#include "Preprocessor.h"
+#include "SourceGraph.h"
+#include "Sha256.h"
+#include <map>
+
+
+namespace asura {
+
+//-----------------------------------------------------------------------------
+//      前処理後のソースコードが同じになるキーワードの組み合わせをまとめます.
+//-----------------------------------------------------------------------------
+void CollapseVariants(const CompileJob& job, const std::vector<KeywordVariant>& variants, std::vector<uint32_t>& result)
+{
+    Preprocessor                    preprocessor;
+    SourceGraph                     graph;
+    std::map<std::string, uint32_t> representatives;
+    std::vector<uint32_t>           references;
+    std::string                     code;
+    std::string                     stripped;
+    std::string                     normalized;
+
+    result.resize(variants.size());
+    for(size_t i=0; i<variants.size(); ++i)
+    {
+        auto& defines = variants[i].Defines;
+
+        Sha256 hash;
+        if (preprocessor.Evaluate(std::string_view(job.pSource, job.SourceSize), defines, code))
+        {
+            // 無効になった分岐からしか参照されない宣言も取り除く.
+            std::string_view source = code;
+            graph.Build(code);
+            if (graph.Strip(job.EntryPoint, stripped))
+            { source = stripped; }
+
+            // 条件式以外で参照されるマクロは値も比較する.
+            Preprocessor::FindReferences(source, defines, references);
+
+            // 無効な分岐が残した空行や字下げの違いでは区別しない.
+            Preprocessor::Normalize(source, normalized);
+
+            hash.Update("evaluated");
+            hash.Update(normalized.data(), normalized.size());
+            for(auto index : references)
+            { hash.Update(defines[index]); }
+        }
+        else
+        {
+            // 評価できない場合はまとめない.
+            hash.Update("failed");
+            hash.Update(std::to_string(i));
+        }
+
+        auto itr = representatives.emplace(hash.Finish(), uint32_t(i)).first;
+        result[i] = itr->second;
+    }
+}
+
+} // namespace asura
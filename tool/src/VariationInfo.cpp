@@ -0,0 +1,323 @@
+﻿//-----------------------------------------------------------------------------
+// File : VariationInfo.cpp
+// Desc : Shader Variation Info Binary Format Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "VariationInfo.h"
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      配列がファイルの範囲内に収まっているかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsInRange(size_t size, const asura::VariationInfoSection& section, size_t stride)
+{
+    return section.Offset % alignof(uint32_t) == 0
+        && section.Offset <= size
+        && section.Count  <= (size - section.Offset) / stride;
+}
+
+//-----------------------------------------------------------------------------
+//      番号の範囲が配列に収まっているかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsInRange(uint32_t index, uint32_t count, uint32_t total)
+{ return index <= total && count <= total - index; }
+
+//-----------------------------------------------------------------------------
+//      参照番号が有効かチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsValidIndex(uint32_t index, uint32_t total)
+{ return index == asura::kVariationInfoNone || index < total; }
+
+//-----------------------------------------------------------------------------
+//      文字列が文字列テーブルに収まり, 終端されているかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsValidString(const char* pStrings, uint32_t stringSize, const asura::VariationInfoString& value)
+{
+    return value.Offset < stringSize
+        && value.Length < stringSize - value.Offset
+        && pStrings[value.Offset + value.Length] == '\0';
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoReader class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+VariationInfoReader::VariationInfoReader()
+: m_pData   (nullptr)
+, m_pHeader (nullptr)
+, m_pStrings(nullptr)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+VariationInfoReader::~VariationInfoReader()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      メモリ上のメタデータを読み込みます.
+//-----------------------------------------------------------------------------
+bool VariationInfoReader::Init(const void* pData, size_t size)
+{
+    Term();
+
+    if (pData == nullptr || size < sizeof(VariationInfoHeader))
+    { return false; }
+
+    if (reinterpret_cast<uintptr_t>(pData) % alignof(uint32_t) != 0)
+    { return false; }
+
+    auto pBytes  = static_cast<const uint8_t*>(pData);
+    auto pHeader = reinterpret_cast<const VariationInfoHeader*>(pBytes);
+    if (pHeader->Magic != kVariationInfoMagic || pHeader->Version != kVariationInfoVersion)
+    { return false; }
+
+    if (pHeader->FileSize < sizeof(VariationInfoHeader) || pHeader->FileSize > size)
+    { return false; }
+
+    size = pHeader->FileSize;
+
+    // 文字列テーブルは空文字列用に最低1バイトあり, 必ず '\0' で終わる.
+    if (pHeader->StringOffset > size
+     || pHeader->StringSize == 0
+     || pHeader->StringSize > size - pHeader->StringOffset)
+    { return false; }
+
+    auto pStrings   = reinterpret_cast<const char*>(pBytes + pHeader->StringOffset);
+    auto stringSize = pHeader->StringSize;
+    if (pStrings[stringSize - 1] != '\0')
+    { return false; }
+
+    if (!IsInRange(size, pHeader->RasterizerStates,   sizeof(VariationRasterizerState))
+     || !IsInRange(size, pHeader->DepthStencilStates, sizeof(VariationDepthStencilState))
+     || !IsInRange(size, pHeader->BlendStates,        sizeof(VariationBlendState))
+     || !IsInRange(size, pHeader->ValueProperties,    sizeof(VariationValueProperty))
+     || !IsInRange(size, pHeader->TextureProperties,  sizeof(VariationTextureProperty))
+     || !IsInRange(size, pHeader->KeywordGroups,      sizeof(VariationKeywordGroup))
+     || !IsInRange(size, pHeader->Keywords,           sizeof(VariationInfoString))
+     || !IsInRange(size, pHeader->Variants,           sizeof(VariationVariant))
+     || !IsInRange(size, pHeader->Techniques,         sizeof(VariationTechnique))
+     || !IsInRange(size, pHeader->Passes,             sizeof(VariationPass))
+     || !IsInRange(size, pHeader->Shaders,            sizeof(VariationShader))
+     || !IsInRange(size, pHeader->Aliases,            sizeof(VariationAlias)))
+    { return false; }
+
+    m_pData    = pBytes;
+    m_pHeader  = pHeader;
+    m_pStrings = pStrings;
+
+    // 取得関数で検証しなくて済むように, 文字列と番号を全て検証しておく.
+    auto IsValid = [&](const VariationInfoString& value)
+    { return IsValidString(pStrings, stringSize, value); };
+
+    auto valid = IsValid(pHeader->Source);
+
+    for(uint32_t i=0; valid && i<pHeader->RasterizerStates.Count; ++i)
+    { valid = IsValid(GetRasterizerStates()[i].Name); }
+
+    for(uint32_t i=0; valid && i<pHeader->DepthStencilStates.Count; ++i)
+    { valid = IsValid(GetDepthStencilStates()[i].Name); }
+
+    for(uint32_t i=0; valid && i<pHeader->BlendStates.Count; ++i)
+    { valid = IsValid(GetBlendStates()[i].Name); }
+
+    for(uint32_t i=0; valid && i<pHeader->ValueProperties.Count; ++i)
+    {
+        auto& prop = GetValueProperties()[i];
+        valid = IsValid(prop.Name) && IsValid(prop.DisplayTag);
+        for(auto& value : prop.DefaultValue)
+        { valid = valid && IsValid(value); }
+    }
+
+    for(uint32_t i=0; valid && i<pHeader->TextureProperties.Count; ++i)
+    {
+        auto& prop = GetTextureProperties()[i];
+        valid = IsValid(prop.Name) && IsValid(prop.DisplayTag) && IsValid(prop.DefaultValue);
+    }
+
+    for(uint32_t i=0; valid && i<pHeader->KeywordGroups.Count; ++i)
+    {
+        auto& group = GetKeywordGroups()[i];
+        valid = IsInRange(group.KeywordIndex, group.KeywordCount, pHeader->Keywords.Count);
+    }
+
+    for(uint32_t i=0; valid && i<pHeader->Keywords.Count; ++i)
+    { valid = IsValid(GetKeywords()[i]); }
+
+    for(uint32_t i=0; valid && i<pHeader->Variants.Count; ++i)
+    { valid = IsValid(GetVariants()[i].Key) && IsValid(GetVariants()[i].Suffix); }
+
+    for(uint32_t i=0; valid && i<pHeader->Techniques.Count; ++i)
+    {
+        auto& technique = GetTechniques()[i];
+        valid = IsValid(technique.Name)
+             && IsInRange(technique.PassIndex, technique.PassCount, pHeader->Passes.Count);
+    }
+
+    for(uint32_t i=0; valid && i<pHeader->Passes.Count; ++i)
+    {
+        auto& pass = GetPasses()[i];
+        valid = IsValid(pass.Name)
+             && IsInRange(pass.ShaderIndex, pass.ShaderCount, pHeader->Shaders.Count)
+             && IsValidIndex(pass.RasterizerState,   pHeader->RasterizerStates.Count)
+             && IsValidIndex(pass.DepthStencilState, pHeader->DepthStencilStates.Count)
+             && IsValidIndex(pass.BlendState,        pHeader->BlendStates.Count);
+    }
+
+    for(uint32_t i=0; valid && i<pHeader->Shaders.Count; ++i)
+    {
+        auto& shader = GetShaders()[i];
+        valid = IsValid(shader.Profile)
+             && IsValid(shader.EntryPoint)
+             && IsInRange(shader.AliasIndex, shader.AliasCount, pHeader->Aliases.Count);
+    }
+
+    for(uint32_t i=0; valid && i<pHeader->Aliases.Count; ++i)
+    {
+        auto& alias = GetAliases()[i];
+        valid = alias.Variant < pHeader->Variants.Count
+             && alias.Target  < pHeader->Variants.Count;
+    }
+
+    if (!valid)
+    {
+        Term();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      読み込んだ内容を破棄します.
+//-----------------------------------------------------------------------------
+void VariationInfoReader::Term()
+{
+    m_pData    = nullptr;
+    m_pHeader  = nullptr;
+    m_pStrings = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      ヘッダーを取得します.
+//-----------------------------------------------------------------------------
+const VariationInfoHeader* VariationInfoReader::GetHeader() const
+{ return m_pHeader; }
+
+//-----------------------------------------------------------------------------
+//      文字列を取得します.
+//-----------------------------------------------------------------------------
+std::string_view VariationInfoReader::GetString(const VariationInfoString& value) const
+{ return std::string_view(m_pStrings + value.Offset, value.Length); }
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステート配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationRasterizerState* VariationInfoReader::GetRasterizerStates() const
+{ return static_cast<const VariationRasterizerState*>(GetSection(m_pHeader->RasterizerStates)); }
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステート配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationDepthStencilState* VariationInfoReader::GetDepthStencilStates() const
+{ return static_cast<const VariationDepthStencilState*>(GetSection(m_pHeader->DepthStencilStates)); }
+
+//-----------------------------------------------------------------------------
+//      ブレンドステート配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationBlendState* VariationInfoReader::GetBlendStates() const
+{ return static_cast<const VariationBlendState*>(GetSection(m_pHeader->BlendStates)); }
+
+//-----------------------------------------------------------------------------
+//      値プロパティ配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationValueProperty* VariationInfoReader::GetValueProperties() const
+{ return static_cast<const VariationValueProperty*>(GetSection(m_pHeader->ValueProperties)); }
+
+//-----------------------------------------------------------------------------
+//      テクスチャプロパティ配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationTextureProperty* VariationInfoReader::GetTextureProperties() const
+{ return static_cast<const VariationTextureProperty*>(GetSection(m_pHeader->TextureProperties)); }
+
+//-----------------------------------------------------------------------------
+//      キーワードグループ配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationKeywordGroup* VariationInfoReader::GetKeywordGroups() const
+{ return static_cast<const VariationKeywordGroup*>(GetSection(m_pHeader->KeywordGroups)); }
+
+//-----------------------------------------------------------------------------
+//      キーワード配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationInfoString* VariationInfoReader::GetKeywords() const
+{ return static_cast<const VariationInfoString*>(GetSection(m_pHeader->Keywords)); }
+
+//-----------------------------------------------------------------------------
+//      キーワードの組み合わせ配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationVariant* VariationInfoReader::GetVariants() const
+{ return static_cast<const VariationVariant*>(GetSection(m_pHeader->Variants)); }
+
+//-----------------------------------------------------------------------------
+//      テクニック配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationTechnique* VariationInfoReader::GetTechniques() const
+{ return static_cast<const VariationTechnique*>(GetSection(m_pHeader->Techniques)); }
+
+//-----------------------------------------------------------------------------
+//      パス配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationPass* VariationInfoReader::GetPasses() const
+{ return static_cast<const VariationPass*>(GetSection(m_pHeader->Passes)); }
+
+//-----------------------------------------------------------------------------
+//      シェーダ配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationShader* VariationInfoReader::GetShaders() const
+{ return static_cast<const VariationShader*>(GetSection(m_pHeader->Shaders)); }
+
+//-----------------------------------------------------------------------------
+//      別名配列を取得します.
+//-----------------------------------------------------------------------------
+const VariationAlias* VariationInfoReader::GetAliases() const
+{ return static_cast<const VariationAlias*>(GetSection(m_pHeader->Aliases)); }
+
+//-----------------------------------------------------------------------------
+//      テクニックを名前から検索します.
+//-----------------------------------------------------------------------------
+uint32_t VariationInfoReader::FindTechnique(std::string_view name) const
+{
+    if (m_pHeader == nullptr)
+    { return kVariationInfoNone; }
+
+    auto pTechniques = GetTechniques();
+    for(uint32_t i=0; i<m_pHeader->Techniques.Count; ++i)
+    {
+        if (GetString(pTechniques[i].Name) == name)
+        { return i; }
+    }
+
+    return kVariationInfoNone;
+}
+
+//-----------------------------------------------------------------------------
+//      配列の先頭を取得します.
+//-----------------------------------------------------------------------------
+const void* VariationInfoReader::GetSection(const VariationInfoSection& section) const
+{ return m_pData + section.Offset; }
+
+} // namespace asura
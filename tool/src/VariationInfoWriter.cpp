@@ -0,0 +1,1144 @@
+﻿//-----------------------------------------------------------------------------
+// File : VariationInfoWriter.cpp
+// Desc : Shader Variation Info Binary Writer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "VariationInfoWriter.h"
+#include "RenderStateTable.h"
+#include "ShaderCompiler.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <cstring>
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// XmlElement structure
+///////////////////////////////////////////////////////////////////////////////
+struct XmlElement
+{
+    std::string                                         Tag;        //!< タグ名.
+    std::vector<std::pair<std::string, std::string>>    Attributes; //!< 属性.
+
+    bool operator == (const XmlElement& value) const
+    { return Tag == value.Tag && Attributes == value.Attributes; }
+};
+
+//-----------------------------------------------------------------------------
+//      配列をセクションとして追加します.
+//-----------------------------------------------------------------------------
+template<typename T>
+void AppendSection(const std::vector<T>& items, asura::VariationInfoSection& section, std::vector<uint8_t>& result)
+{
+    section.Offset = uint32_t(result.size());
+    section.Count  = uint32_t(items.size());
+
+    if (!items.empty())
+    {
+        auto pBytes = reinterpret_cast<const uint8_t*>(items.data());
+        result.insert(result.end(), pBytes, pBytes + items.size() * sizeof(T));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      XML の文字参照を元に戻します.
+//-----------------------------------------------------------------------------
+bool Unescape(std::string_view value, std::string& result)
+{
+    static const struct { const char* Name; char Value; } kEntities[] = {
+        { "&amp;",  '&'  },
+        { "&lt;",   '<'  },
+        { "&gt;",   '>'  },
+        { "&quot;", '\"' },
+        { "&apos;", '\'' },
+    };
+
+    result.clear();
+    for(size_t i=0; i<value.size(); ++i)
+    {
+        if (value[i] != '&')
+        {
+            result += value[i];
+            continue;
+        }
+
+        auto found = false;
+        for(auto& entity : kEntities)
+        {
+            auto length = strlen(entity.Name);
+            if (value.compare(i, length, entity.Name) == 0)
+            {
+                result += entity.Value;
+                i     += length - 1;
+                found  = true;
+                break;
+            }
+        }
+
+        if (!found)
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      XML の開始タグと属性を順番に取り出します.
+//-----------------------------------------------------------------------------
+bool ParseXml(std::string_view text, std::vector<XmlElement>& result)
+{
+    auto IsSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+
+    size_t pos = 0;
+    for(;;)
+    {
+        pos = text.find('<', pos);
+        if (pos == std::string_view::npos)
+        { return true; }
+
+        // 宣言, コメント, 終了タグは比較対象外.
+        if (text.compare(pos, 2, "<?") == 0)
+        {
+            pos = text.find("?>", pos);
+            if (pos == std::string_view::npos)
+            { return false; }
+            continue;
+        }
+        if (text.compare(pos, 4, "<!--") == 0)
+        {
+            pos = text.find("-->", pos);
+            if (pos == std::string_view::npos)
+            { return false; }
+            continue;
+        }
+        if (text.compare(pos, 2, "</") == 0)
+        {
+            pos = text.find('>', pos);
+            if (pos == std::string_view::npos)
+            { return false; }
+            continue;
+        }
+
+        XmlElement element;
+        auto begin = ++pos;
+        while(pos < text.size() && !IsSpace(text[pos]) && text[pos] != '/' && text[pos] != '>')
+        { pos++; }
+        element.Tag = std::string(text.substr(begin, pos - begin));
+
+        for(;;)
+        {
+            while(pos < text.size() && IsSpace(text[pos]))
+            { pos++; }
+
+            if (pos >= text.size())
+            { return false; }
+
+            if (text[pos] == '/' || text[pos] == '>')
+            { break; }
+
+            auto equal = text.find('=', pos);
+            if (equal == std::string_view::npos || equal + 1 >= text.size() || text[equal + 1] != '\"')
+            { return false; }
+
+            auto close = text.find('\"', equal + 2);
+            if (close == std::string_view::npos)
+            { return false; }
+
+            std::string value;
+            if (!Unescape(text.substr(equal + 2, close - equal - 2), value))
+            { return false; }
+
+            element.Attributes.emplace_back(std::string(text.substr(pos, equal - pos)), std::move(value));
+            pos = close + 1;
+        }
+
+        result.push_back(std::move(element));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      真偽値を XML と同じ表記に変換します.
+//-----------------------------------------------------------------------------
+inline std::string ToBoolString(uint32_t value)
+{ return value ? "true" : "false"; }
+
+//-----------------------------------------------------------------------------
+//      マスク値を XML と同じ表記に変換します.
+//-----------------------------------------------------------------------------
+inline std::string ToMaskString(uint32_t value)
+{
+    char buf[16];
+    sprintf_s(buf, "0x%x", value);
+    return buf;
+}
+
+//-----------------------------------------------------------------------------
+//      ステート ID を XML と同じ表記に変換します.
+//-----------------------------------------------------------------------------
+inline std::string ToIdString(const asura::VariationStateId& value)
+{
+    char buf[24];
+    sprintf_s(buf, "0x%llx", static_cast<unsigned long long>(asura::ToStateId(value)));
+    return buf;
+}
+
+//-----------------------------------------------------------------------------
+//      値プロパティのタグ名を取得します.
+//-----------------------------------------------------------------------------
+const char* GetValuePropertyTag(uint32_t type)
+{
+    switch(type)
+    {
+    case asura::PROPERTY_TYPE_BOOL:     return "bool";
+    case asura::PROPERTY_TYPE_INT:      return "int";
+    case asura::PROPERTY_TYPE_FLOAT:    return "float";
+    case asura::PROPERTY_TYPE_FLOAT2:   return "float2";
+    case asura::PROPERTY_TYPE_FLOAT3:   return "float3";
+    case asura::PROPERTY_TYPE_FLOAT4:   return "float4";
+    case asura::PROPERTY_TYPE_COLOR3:   return "color3";
+    case asura::PROPERTY_TYPE_COLOR4:   return "color4";
+    default:                            return nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャプロパティのタグ名を取得します.
+//-----------------------------------------------------------------------------
+const char* GetTexturePropertyTag(uint32_t type)
+{
+    switch(type)
+    {
+    case asura::PROPERTY_TYPE_TEXTURE1D:            return "map1d";
+    case asura::PROPERTY_TYPE_TEXTURE1D_ARRAY:      return "map1darray";
+    case asura::PROPERTY_TYPE_TEXTURE2D:            return "map2d";
+    case asura::PROPERTY_TYPE_TEXTURE2D_ARRAY:      return "map2darray";
+    case asura::PROPERTY_TYPE_TEXTURE3D:            return "map3d";
+    case asura::PROPERTY_TYPE_TEXTURECUBE:          return "mapcube";
+    case asura::PROPERTY_TYPE_TEXTURECUBE_ARRAY:    return "mapcubearray";
+    default:                                        return nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      バイナリの内容から variation.xml と同じ並びの要素を作成します.
+//-----------------------------------------------------------------------------
+void BuildElements(const asura::VariationInfoReader& reader, std::vector<XmlElement>& result)
+{
+    auto& header = *reader.GetHeader();
+
+    auto Add = [&](const char* tag)
+    {
+        result.emplace_back();
+        result.back().Tag = tag;
+    };
+    auto Attr = [&](const char* name, std::string value)
+    { result.back().Attributes.emplace_back(name, std::move(value)); };
+    auto Str = [&](const asura::VariationInfoString& value)
+    { return std::string(reader.GetString(value)); };
+    auto Name = [&](const asura::VariationInfoString& value)
+    {
+        if (value.Length > 0)
+        { Attr("name", Str(value)); }
+    };
+
+    // 全エフェクト共通のステートテーブルはソースコードとステート名を持たない.
+    Add("root");
+    if (header.Source.Length > 0)
+    {
+        Add("source");
+        Attr("path", Str(header.Source));
+    }
+
+    for(uint32_t i=0; i<header.RasterizerStates.Count; ++i)
+    {
+        auto& state = reader.GetRasterizerStates()[i];
+        Add("rasterizer_state");
+        Name(state.Name);
+        Attr("id",                          ToIdString(state.Id));
+        Attr("polygon_mode",                asura::ToString(asura::POLYGON_MODE(state.PolygonMode)));
+        Attr("cull_mode",                   asura::ToString(asura::CULL_TYPE(state.CullMode)));
+        Attr("front_ccw",                   ToBoolString(state.FrontCCW));
+        Attr("depth_bias",                  std::to_string(state.DepthBias));
+        Attr("depth_bias_clamp",            std::to_string(state.DepthBiasClamp));
+        Attr("depth_clip_enable",           ToBoolString(state.DepthClipEnable));
+        Attr("enable_consevative_raster",   ToBoolString(state.EnableConservativeRaster));
+    }
+
+    for(uint32_t i=0; i<header.DepthStencilStates.Count; ++i)
+    {
+        auto& state = reader.GetDepthStencilStates()[i];
+        Add("depthsencil_state");
+        Name(state.Name);
+        Attr("id",                              ToIdString(state.Id));
+        Attr("depth_enable",                    ToBoolString(state.DepthEnable));
+        Attr("depth_write_mask",                asura::ToString(asura::DEPTH_WRITE_MASK(state.DepthWriteMask)));
+        Attr("depth_func",                      asura::ToString(asura::COMPARE_TYPE(state.DepthFunc)));
+        Attr("stencil_enable",                  ToBoolString(state.StencilEnable));
+        Attr("stencil_read_mask",               ToMaskString(state.StencilReadMask));
+        Attr("stencil_write_mask",              ToMaskString(state.StencilWriteMask));
+        Attr("front_face_stencil_fail",         asura::ToString(asura::STENCIL_OP_TYPE(state.FrontFaceStencilFail)));
+        Attr("front_face_stencil_depth_fail",   asura::ToString(asura::STENCIL_OP_TYPE(state.FrontFaceStencilDepthFail)));
+        Attr("front_face_stencil_pass",         asura::ToString(asura::STENCIL_OP_TYPE(state.FrontFaceStencilPass)));
+        Attr("back_face_stencil_fail",          asura::ToString(asura::STENCIL_OP_TYPE(state.BackFaceStencilFail)));
+        Attr("back_face_stencil_depth_fail",    asura::ToString(asura::STENCIL_OP_TYPE(state.BackFaceStencilDepthFail)));
+        Attr("back_face_stencil_pass",          asura::ToString(asura::STENCIL_OP_TYPE(state.BackFaceStencilPass)));
+        Attr("back_face_stencil_func",          asura::ToString(asura::COMPARE_TYPE(state.BackFaceStencilFunc)));
+    }
+
+    for(uint32_t i=0; i<header.BlendStates.Count; ++i)
+    {
+        auto& state = reader.GetBlendStates()[i];
+        Add("blend_state");
+        Name(state.Name);
+        Attr("id",                          ToIdString(state.Id));
+        Attr("alpha_to_coverage_enable",    ToBoolString(state.AlphaToCoverageEnable));
+        Attr("blend_enable",                ToBoolString(state.BlendEnable));
+        Attr("src_blend",                   asura::ToString(asura::BLEND_TYPE(state.SrcBlend)));
+        Attr("dst_blend",                   asura::ToString(asura::BLEND_TYPE(state.DstBlend)));
+        Attr("blend_op",                    asura::ToString(asura::BLEND_OP_TYPE(state.BlendOp)));
+        Attr("src_blend_alpha",             asura::ToString(asura::BLEND_TYPE(state.SrcBlendAlpha)));
+        Attr("dst_blend_alpha",             asura::ToString(asura::BLEND_TYPE(state.DstBlendAlpha)));
+        Attr("blend_op_alpha",              asura::ToString(asura::BLEND_OP_TYPE(state.BlendOpAlpha)));
+        Attr("render_target_write_mask",    ToMaskString(state.RenderTargetWriteMask));
+    }
+
+    if (header.ValueProperties.Count > 0 || header.TextureProperties.Count > 0)
+    {
+        static const char* kComponents[][4] = {
+            { "x", "y", "z", "w" },
+            { "r", "g", "b", "a" },
+        };
+
+        Add("properties");
+        for(uint32_t i=0; i<header.ValueProperties.Count; ++i)
+        {
+            auto& prop = reader.GetValueProperties()[i];
+            auto  tag  = GetValuePropertyTag(prop.Type);
+            if (tag == nullptr)
+            { continue; }
+
+            Add(tag);
+            Attr("name",        Str(prop.Name));
+            Attr("display_tag", Str(prop.DisplayTag));
+
+            auto isColor = (prop.Type == asura::PROPERTY_TYPE_COLOR3 || prop.Type == asura::PROPERTY_TYPE_COLOR4);
+            if (prop.Type != asura::PROPERTY_TYPE_BOOL && !isColor)
+            {
+                Attr("step", std::to_string(prop.Step));
+                Attr("min",  std::to_string(prop.Min));
+                Attr("max",  std::to_string(prop.Max));
+            }
+
+            uint32_t count = 1;
+            switch(prop.Type)
+            {
+            case asura::PROPERTY_TYPE_FLOAT2:   count = 2; break;
+            case asura::PROPERTY_TYPE_FLOAT3:   count = 3; break;
+            case asura::PROPERTY_TYPE_FLOAT4:   count = 4; break;
+            case asura::PROPERTY_TYPE_COLOR3:   count = 3; break;
+            case asura::PROPERTY_TYPE_COLOR4:   count = 4; break;
+            default:                            break;
+            }
+
+            if (count == 1 && !isColor)
+            {
+                Attr("default", Str(prop.DefaultValue[0]));
+                continue;
+            }
+
+            for(uint32_t j=0; j<count; ++j)
+            { Attr(kComponents[isColor ? 1 : 0][j], Str(prop.DefaultValue[j])); }
+        }
+
+        for(uint32_t i=0; i<header.TextureProperties.Count; ++i)
+        {
+            auto& prop = reader.GetTextureProperties()[i];
+            auto  tag  = GetTexturePropertyTag(prop.Type);
+            if (tag == nullptr)
+            { continue; }
+
+            Add(tag);
+            Attr("name",        Str(prop.Name));
+            Attr("display_tag", Str(prop.DisplayTag));
+            Attr("srgb",        ToBoolString(prop.EnableSRGB));
+            Attr("default",     Str(prop.DefaultValue));
+        }
+    }
+
+    if (header.KeywordGroups.Count > 0)
+    {
+        Add("keywords");
+        for(uint32_t i=0; i<header.KeywordGroups.Count; ++i)
+        {
+            auto& group = reader.GetKeywordGroups()[i];
+            if (group.KeywordCount == 0)
+            { continue; }
+
+            std::string names;
+            for(uint32_t j=0; j<group.KeywordCount; ++j)
+            {
+                auto name = reader.GetString(reader.GetKeywords()[group.KeywordIndex + j]);
+                if (!names.empty())
+                { names += " "; }
+                names += name.empty() ? "_" : std::string(name);
+            }
+
+            Add("group");
+            Attr("keywords", names);
+        }
+
+        for(uint32_t i=0; i<header.Variants.Count; ++i)
+        {
+            Add("variant");
+            Attr("key",    Str(reader.GetVariants()[i].Key));
+            Attr("suffix", Str(reader.GetVariants()[i].Suffix));
+        }
+    }
+
+    for(uint32_t i=0; i<header.Techniques.Count; ++i)
+    {
+        auto& technique = reader.GetTechniques()[i];
+        Add("technique");
+        Attr("name", Str(technique.Name));
+
+        for(uint32_t j=0; j<technique.PassCount; ++j)
+        {
+            auto& pass = reader.GetPasses()[technique.PassIndex + j];
+            Add("pass");
+            Attr("name", Str(pass.Name));
+
+            for(uint32_t k=0; k<pass.ShaderCount; ++k)
+            {
+                auto& shader = reader.GetShaders()[pass.ShaderIndex + k];
+                Add("shader");
+                Attr("type",    asura::ToString(asura::SHADER_TYPE(shader.Type)));
+                Attr("profile", Str(shader.Profile));
+                Attr("name",    Str(shader.EntryPoint));
+
+                for(uint32_t v=0; v<shader.AliasCount; ++v)
+                {
+                    auto& alias = reader.GetAliases()[shader.AliasIndex + v];
+                    Add("alias");
+                    Attr("suffix", Str(reader.GetVariants()[alias.Variant].Suffix));
+                    Attr("target", Str(reader.GetVariants()[alias.Target].Suffix));
+                }
+            }
+
+            if (pass.RasterizerState != asura::kVariationInfoNone)
+            {
+                auto& state = reader.GetRasterizerStates()[pass.RasterizerState];
+                Add("rs");
+                Attr("name", Str(state.Name));
+                Attr("id",   ToIdString(state.Id));
+            }
+            if (pass.DepthStencilState != asura::kVariationInfoNone)
+            {
+                auto& state = reader.GetDepthStencilStates()[pass.DepthStencilState];
+                Add("dss");
+                Attr("name", Str(state.Name));
+                Attr("id",   ToIdString(state.Id));
+            }
+            if (pass.BlendState != asura::kVariationInfoNone)
+            {
+                auto& state = reader.GetBlendStates()[pass.BlendState];
+                Add("bs");
+                Attr("name", Str(state.Name));
+                Attr("id",   ToIdString(state.Id));
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      値プロパティを書き込みます.
+//-----------------------------------------------------------------------------
+void FormatValueProperty
+(
+    asura::XmlWriter&           writer,
+    const asura::ValueProperty& prop,
+    const char*                 tag,
+    bool                        range,
+    const char* const*          components,
+    size_t                      count
+)
+{
+    const std::string* values[] = {
+        &prop.DefaultValue0,
+        &prop.DefaultValue1,
+        &prop.DefaultValue2,
+        &prop.DefaultValue3,
+    };
+
+    writer.Raw("        <");
+    writer.Raw(tag);
+    writer.Attribute("name",        prop.Name);
+    writer.Attribute("display_tag", prop.DisplayTag);
+
+    if (range)
+    {
+        writer.Attribute("step", prop.Step);
+        writer.Attribute("min",  prop.Min);
+        writer.Attribute("max",  prop.Max);
+    }
+
+    for(size_t i=0; i<count; ++i)
+    { writer.Attribute(components[i], *values[i]); }
+
+    writer.Raw(" />\n");
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャプロパティを書き込みます.
+//-----------------------------------------------------------------------------
+void FormatTextureProperty(asura::XmlWriter& writer, const asura::TextureProperty& prop, const char* tag)
+{
+    writer.Raw("        <");
+    writer.Raw(tag);
+    writer.Attribute("name",        prop.Name);
+    writer.Attribute("display_tag", prop.DisplayTag);
+    writer.Attribute("srgb",        prop.EnableSRGB ? "true" : "false");
+    writer.Attribute("default",     prop.DefaultValue);
+    writer.Raw(" />\n");
+}
+
+//-----------------------------------------------------------------------------
+//      パスが参照するステートを, 名前と重複を除いたステート ID で書き込みます.
+//-----------------------------------------------------------------------------
+template<typename T>
+void FormatStateReference
+(
+    asura::XmlWriter&                   writer,
+    const char*                         tag,
+    const std::string&                  name,
+    const std::map<std::string, T>&     states
+)
+{
+    if (name.empty())
+    { return; }
+
+    writer.Raw("            <");
+    writer.Raw(tag);
+    writer.Attribute("name", name);
+
+    auto itr = states.find(name);
+    if (itr != states.end())
+    { writer.AttributeHex("id", asura::GetStateId(itr->second)); }
+
+    writer.Raw("/>\n");
+}
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// VariationInfoWriter class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+VariationInfoWriter::VariationInfoWriter()
+: m_Source  ()
+, m_FileSize(0)
+{
+    // 空文字列は先頭の '\0' を指す.
+    m_Strings.push_back('\0');
+    m_StringIndex[""] = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+VariationInfoWriter::~VariationInfoWriter()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      ソースコードのパスを設定します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::SetSource(const std::string& path)
+{ m_Source = AddString(path); }
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddRasterizerState(const std::string& name, const RasterizerState& state)
+{
+    VariationRasterizerState record = {};
+    record.Name                     = AddString(name);
+    record.Id                       = ToVariationStateId(GetStateId(state));
+    record.PolygonMode              = state.PolygonMode;
+    record.CullMode                 = state.CullMode;
+    record.FrontCCW                 = state.FrontCCW;
+    record.DepthBias                = state.DepthBias;
+    record.DepthBiasClamp           = state.DepthBiasClamp;
+    record.SlopeScaledDepthBias     = state.SlopeScaledDepthBias;
+    record.DepthClipEnable          = state.DepthClipEnable;
+    record.EnableConservativeRaster = state.EnableConservativeRaster;
+
+    m_RasterizerIndex[name] = uint32_t(m_RasterizerStates.size());
+    m_RasterizerStates.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddDepthStencilState(const std::string& name, const DepthStencilState& state)
+{
+    VariationDepthStencilState record = {};
+    record.Name                         = AddString(name);
+    record.Id                           = ToVariationStateId(GetStateId(state));
+    record.DepthEnable                  = state.DepthEnable;
+    record.DepthWriteMask               = state.DepthWriteMask;
+    record.DepthFunc                    = state.DepthFunc;
+    record.StencilEnable                = state.StencilEnable;
+    record.StencilReadMask              = state.StencilReadMask;
+    record.StencilWriteMask             = state.StencilWriteMask;
+    record.FrontFaceStencilFail         = state.FrontFaceStencilFail;
+    record.FrontFaceStencilDepthFail    = state.FrontFaceStencilDepthFail;
+    record.FrontFaceStencilPass         = state.FrontFaceStencilPass;
+    record.FrontFaceStencilFunc         = state.FrontFaceStencilFunc;
+    record.BackFaceStencilFail          = state.BackFaceStencilFail;
+    record.BackFaceStencilDepthFail     = state.BackFaceStencilDepthFail;
+    record.BackFaceStencilPass          = state.BackFaceStencilPass;
+    record.BackFaceStencilFunc          = state.BackFaceStencilFunc;
+
+    m_DepthStencilIndex[name] = uint32_t(m_DepthStencilStates.size());
+    m_DepthStencilStates.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddBlendState(const std::string& name, const BlendState& state)
+{
+    VariationBlendState record = {};
+    record.Name                     = AddString(name);
+    record.Id                       = ToVariationStateId(GetStateId(state));
+    record.AlphaToCoverageEnable    = state.AlphaToCoverageEnable;
+    record.BlendEnable              = state.BlendEnable;
+    record.SrcBlend                 = state.SrcBlend;
+    record.DstBlend                 = state.DstBlend;
+    record.BlendOp                  = state.BlendOp;
+    record.SrcBlendAlpha            = state.SrcBlendAlpha;
+    record.DstBlendAlpha            = state.DstBlendAlpha;
+    record.BlendOpAlpha             = state.BlendOpAlpha;
+    record.RenderTargetWriteMask    = state.RenderTargetWriteMask;
+
+    m_BlendIndex[name] = uint32_t(m_BlendStates.size());
+    m_BlendStates.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      値プロパティを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddValueProperty(const ValueProperty& prop)
+{
+    VariationValueProperty record = {};
+    record.Name             = AddString(prop.Name);
+    record.DisplayTag       = AddString(prop.DisplayTag);
+    record.Type             = prop.Type;
+    record.Offset           = prop.Offset;
+    record.Min              = prop.Min;
+    record.Max              = prop.Max;
+    record.Step             = prop.Step;
+    record.DefaultValue[0]  = AddString(prop.DefaultValue0);
+    record.DefaultValue[1]  = AddString(prop.DefaultValue1);
+    record.DefaultValue[2]  = AddString(prop.DefaultValue2);
+    record.DefaultValue[3]  = AddString(prop.DefaultValue3);
+
+    m_ValueProperties.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャプロパティを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddTextureProperty(const TextureProperty& prop)
+{
+    VariationTextureProperty record = {};
+    record.Name         = AddString(prop.Name);
+    record.DisplayTag   = AddString(prop.DisplayTag);
+    record.Type         = prop.Type;
+    record.EnableSRGB   = prop.EnableSRGB;
+    record.DefaultValue = AddString(prop.DefaultValue);
+
+    m_TextureProperties.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      キーワードグループを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddKeywordGroup(const KeywordGroup& group)
+{
+    VariationKeywordGroup record = {};
+    record.KeywordIndex = uint32_t(m_Keywords.size());
+    record.KeywordCount = uint32_t(group.Keywords.size());
+
+    for(auto& keyword : group.Keywords)
+    { m_Keywords.push_back(AddString(keyword)); }
+
+    m_KeywordGroups.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      キーワードの組み合わせを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddVariant(const std::string& key, const std::string& suffix)
+{
+    VariationVariant record = {};
+    record.Key    = AddString(key);
+    record.Suffix = AddString(suffix);
+
+    m_Variants.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      テクニックを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddTechnique(const std::string& name)
+{
+    VariationTechnique record = {};
+    record.Name      = AddString(name);
+    record.PassIndex = uint32_t(m_Passes.size());
+    record.PassCount = 0;
+
+    m_Techniques.push_back(record);
+}
+
+//-----------------------------------------------------------------------------
+//      最後に追加したテクニックにパスを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddPass(const Pass& pass)
+{
+    assert(!m_Techniques.empty());
+
+    auto FindIndex = [](const std::map<std::string, uint32_t>& table, const std::string& name)
+    {
+        auto itr = table.find(name);
+        return (itr != table.end()) ? itr->second : kVariationInfoNone;
+    };
+
+    VariationPass record = {};
+    record.Name              = AddString(pass.Name);
+    record.ShaderIndex       = uint32_t(m_Shaders.size());
+    record.ShaderCount       = 0;
+    record.RasterizerState   = FindIndex(m_RasterizerIndex,   pass.RasterizerState);
+    record.DepthStencilState = FindIndex(m_DepthStencilIndex, pass.DepthStencilState);
+    record.BlendState        = FindIndex(m_BlendIndex,        pass.BlendState);
+
+    m_Passes.push_back(record);
+    m_Techniques.back().PassCount++;
+}
+
+//-----------------------------------------------------------------------------
+//      最後に追加したパスにシェーダを追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddShader(const Shader& shader)
+{
+    assert(!m_Passes.empty());
+
+    VariationShader record = {};
+    record.Type       = shader.Type;
+    record.Profile    = AddString(shader.Profile);
+    record.EntryPoint = AddString(shader.EntryPoint);
+    record.AliasIndex = uint32_t(m_Aliases.size());
+    record.AliasCount = 0;
+
+    m_Shaders.push_back(record);
+    m_Passes.back().ShaderCount++;
+}
+
+//-----------------------------------------------------------------------------
+//      最後に追加したシェーダに別名を追加します.
+//-----------------------------------------------------------------------------
+void VariationInfoWriter::AddAlias(uint32_t variant, uint32_t target)
+{
+    assert(!m_Shaders.empty());
+
+    VariationAlias record = {};
+    record.Variant = variant;
+    record.Target  = target;
+
+    m_Aliases.push_back(record);
+    m_Shaders.back().AliasCount++;
+}
+
+//-----------------------------------------------------------------------------
+//      メタデータを書き出します.
+//-----------------------------------------------------------------------------
+bool VariationInfoWriter::Write(const std::string& path)
+{
+    VariationInfoHeader header = {};
+    header.Magic   = kVariationInfoMagic;
+    header.Version = kVariationInfoVersion;
+    header.Source  = m_Source;
+
+    // レコードは全て4バイト単位なので, 詰めて並べれば境界は揃う.
+    std::vector<uint8_t> data(sizeof(header));
+    AppendSection(m_RasterizerStates,   header.RasterizerStates,    data);
+    AppendSection(m_DepthStencilStates, header.DepthStencilStates,  data);
+    AppendSection(m_BlendStates,        header.BlendStates,         data);
+    AppendSection(m_ValueProperties,    header.ValueProperties,     data);
+    AppendSection(m_TextureProperties,  header.TextureProperties,   data);
+    AppendSection(m_KeywordGroups,      header.KeywordGroups,       data);
+    AppendSection(m_Keywords,           header.Keywords,            data);
+    AppendSection(m_Variants,           header.Variants,            data);
+    AppendSection(m_Techniques,         header.Techniques,          data);
+    AppendSection(m_Passes,             header.Passes,              data);
+    AppendSection(m_Shaders,            header.Shaders,             data);
+    AppendSection(m_Aliases,            header.Aliases,             data);
+
+    header.StringOffset = uint32_t(data.size());
+    header.StringSize   = uint32_t(m_Strings.size());
+    data.insert(data.end(), m_Strings.begin(), m_Strings.end());
+
+    if (data.size() > UINT32_MAX)
+    { return false; }
+
+    header.FileSize = uint32_t(data.size());
+    memcpy(data.data(), &header, sizeof(header));
+
+    if (!WriteFileAtomic(path, data.data(), data.size()))
+    { return false; }
+
+    m_FileSize = header.FileSize;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      書き出したメタデータが XML と同じ内容か検証します.
+//-----------------------------------------------------------------------------
+bool VariationInfoWriter::Verify(const std::string& path, const std::string& xmlPath)
+{
+    MappedFile file;
+    if (!file.Open(path.c_str()))
+    { return false; }
+
+    auto view = file.GetView();
+    VariationInfoReader reader;
+    if (!reader.Init(view.data(), view.size()))
+    { return false; }
+
+    std::vector<uint8_t> xml;
+    if (!LoadBinary(xmlPath, xml))
+    { return false; }
+
+    std::vector<XmlElement> expected;
+    BuildElements(reader, expected);
+
+    std::vector<XmlElement> actual;
+    if (!ParseXml(std::string_view(reinterpret_cast<const char*>(xml.data()), xml.size()), actual))
+    { return false; }
+
+    return expected == actual;
+}
+
+//-----------------------------------------------------------------------------
+//      最後に書き出したメタデータのサイズを取得します.
+//-----------------------------------------------------------------------------
+uint32_t VariationInfoWriter::GetFileSize() const
+{ return m_FileSize; }
+
+//-----------------------------------------------------------------------------
+//      文字列を文字列テーブルに追加します.
+//-----------------------------------------------------------------------------
+VariationInfoString VariationInfoWriter::AddString(const std::string& value)
+{
+    VariationInfoString result = {};
+    result.Length = uint32_t(value.size());
+
+    auto itr = m_StringIndex.find(value);
+    if (itr != m_StringIndex.end())
+    {
+        result.Offset = itr->second;
+        return result;
+    }
+
+    result.Offset = uint32_t(m_Strings.size());
+    m_Strings.append(value);
+    m_Strings.push_back('\0');
+    m_StringIndex.emplace(value, result.Offset);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      バリエーション情報を XML 形式でバッファに書き込みます.
+//-----------------------------------------------------------------------------
+void FormatVariationInfo
+(
+    XmlWriter&                          writer,
+    const FxParser&                     parser,
+    const std::vector<KeywordVariant>&  variants,
+    const std::vector<VariantAlias>&    aliases,
+    const char*                         hlslpath
+)
+{
+    static const char* kDefault[] = { "default" };
+    static const char* kVector [] = { "x", "y", "z", "w" };
+    static const char* kColor  [] = { "r", "g", "b", "a" };
+
+    writer.Raw("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
+    writer.Raw("<root>\n");
+    writer.Raw("    <source");
+    writer.Attribute("path", hlslpath);
+    writer.Raw(" />\n");
+
+    for(auto& itr : parser.GetRasterizerStates())
+    { FormatRasterizerState(writer, itr.first, GetStateId(itr.second), itr.second); }
+
+    for(auto& itr : parser.GetDepthStencilStates())
+    { FormatDepthStencilState(writer, itr.first, GetStateId(itr.second), itr.second); }
+
+    for(auto& itr : parser.GetBlendStates())
+    { FormatBlendState(writer, itr.first, GetStateId(itr.second), itr.second); }
+
+    auto& properties = parser.GetProperties();
+    if (!properties.Values.empty() || !properties.Textures.empty())
+    {
+        writer.Raw("    <properties>\n");
+        for(auto& prop : properties.Values)
+        {
+            switch(prop.Type)
+            {
+            case PROPERTY_TYPE_BOOL:     FormatValueProperty(writer, prop, "bool",   false, kDefault, 1); break;
+            case PROPERTY_TYPE_INT:      FormatValueProperty(writer, prop, "int",    true,  kDefault, 1); break;
+            case PROPERTY_TYPE_FLOAT:    FormatValueProperty(writer, prop, "float",  true,  kDefault, 1); break;
+            case PROPERTY_TYPE_FLOAT2:   FormatValueProperty(writer, prop, "float2", true,  kVector,  2); break;
+            case PROPERTY_TYPE_FLOAT3:   FormatValueProperty(writer, prop, "float3", true,  kVector,  3); break;
+            case PROPERTY_TYPE_FLOAT4:   FormatValueProperty(writer, prop, "float4", true,  kVector,  4); break;
+            case PROPERTY_TYPE_COLOR3:   FormatValueProperty(writer, prop, "color3", false, kColor,   3); break;
+            case PROPERTY_TYPE_COLOR4:   FormatValueProperty(writer, prop, "color4", false, kColor,   4); break;
+            default:                            break;
+            }
+        }
+
+        for(auto& prop : properties.Textures)
+        {
+            switch(prop.Type)
+            {
+            case PROPERTY_TYPE_TEXTURE1D:            FormatTextureProperty(writer, prop, "map1d");        break;
+            case PROPERTY_TYPE_TEXTURE1D_ARRAY:      FormatTextureProperty(writer, prop, "map1darray");   break;
+            case PROPERTY_TYPE_TEXTURE2D:            FormatTextureProperty(writer, prop, "map2d");        break;
+            case PROPERTY_TYPE_TEXTURE2D_ARRAY:      FormatTextureProperty(writer, prop, "map2darray");   break;
+            case PROPERTY_TYPE_TEXTURE3D:            FormatTextureProperty(writer, prop, "map3d");        break;
+            case PROPERTY_TYPE_TEXTURECUBE:          FormatTextureProperty(writer, prop, "mapcube");      break;
+            case PROPERTY_TYPE_TEXTURECUBE_ARRAY:    FormatTextureProperty(writer, prop, "mapcubearray"); break;
+            default:                                        break;
+            }
+        }
+        writer.Raw("    </properties>\n\n");
+    }
+
+    if (!parser.GetKeywords().Groups.empty())
+    {
+        writer.Raw("    <keywords>\n");
+        for(auto& group : parser.GetKeywords().Groups)
+        {
+            if (group.Keywords.empty())
+            { continue; }
+
+            writer.Raw("        <group keywords=\"");
+            for(size_t i=0; i<group.Keywords.size(); ++i)
+            {
+                if (i > 0)
+                { writer.Raw(" "); }
+
+                if (group.Keywords[i].empty())
+                { writer.Raw("_"); }
+                else
+                { writer.Escape(group.Keywords[i]); }
+            }
+            writer.Raw("\" />\n");
+        }
+
+        // シェーダの出力ファイル名は テクニック名_パス名_ステージ + suffix となる.
+        for(auto& variant : variants)
+        {
+            writer.Raw("        <variant");
+            writer.Attribute("key",    variant.Key);
+            writer.Attribute("suffix", variant.Suffix);
+            writer.Raw(" />\n");
+        }
+
+        writer.Raw("    </keywords>\n\n");
+    }
+
+    size_t aliasIndex = 0;
+
+    auto& techniques = parser.GetTechniques();
+    for(size_t i=0; i<techniques.size(); ++i)
+    {
+        auto& technique = techniques[i];
+
+        writer.Raw("    <technique");
+        writer.Attribute("name", technique.Name);
+        writer.Raw(">\n");
+
+        for(size_t j=0; j<technique.Pass.size(); ++j)
+        {
+            auto& pass = technique.Pass[j];
+
+            writer.Raw("        <pass");
+            writer.Attribute("name", pass.Name);
+            writer.Raw(">\n");
+
+            for(size_t k=0; k<pass.Shaders.size(); ++k)
+            {
+                auto& shader = pass.Shaders[k];
+
+                const VariantAlias* pAlias = nullptr;
+                if (aliasIndex < aliases.size()
+                 && aliases[aliasIndex].Technique == i
+                 && aliases[aliasIndex].Pass      == j
+                 && aliases[aliasIndex].Shader    == k)
+                { pAlias = &aliases[aliasIndex++]; }
+
+                writer.Raw("            <shader");
+                writer.Attribute("type",    ToString(shader.Type));
+                writer.Attribute("profile", shader.Profile);
+                writer.Attribute("name",    shader.EntryPoint);
+
+                if (pAlias == nullptr)
+                {
+                    writer.Raw("/>\n");
+                    continue;
+                }
+
+                // まとめた組み合わせは代表の出力ファイルを参照する.
+                writer.Raw(">\n");
+                for(size_t v=0; v<pAlias->Targets.size(); ++v)
+                {
+                    auto target = pAlias->Targets[v];
+                    if (target == v)
+                    { continue; }
+
+                    writer.Raw("                <alias");
+                    writer.Attribute("suffix", variants[v].Suffix);
+                    writer.Attribute("target", variants[target].Suffix);
+                    writer.Raw("/>\n");
+                }
+                writer.Raw("            </shader>\n");
+            }
+            FormatStateReference(writer, "rs",  pass.RasterizerState,   parser.GetRasterizerStates());
+            FormatStateReference(writer, "dss", pass.DepthStencilState, parser.GetDepthStencilStates());
+            FormatStateReference(writer, "bs",  pass.BlendState,        parser.GetBlendStates());
+
+            writer.Raw("        </pass>\n");
+        }
+
+        writer.Raw("    </technique>\n\n");
+    }
+
+    writer.Raw("</root>\n");
+}
+
+//-----------------------------------------------------------------------------
+//      バリエーション情報を出力します.
+//-----------------------------------------------------------------------------
+bool WriteVariationInfo
+(
+    const FxParser&                     parser,
+    const std::vector<KeywordVariant>&  variants,
+    const std::vector<VariantAlias>&    aliases,
+    const char*                         xmlpath,
+    const char*                         hlslpath
+)
+{
+    XmlWriter writer;
+    FormatVariationInfo(writer, parser, variants, aliases, hlslpath);
+
+    if (!writer.Flush(xmlpath))
+    {
+        fprintf_s(stderr, "Error : File Open Failed. filename = %s", xmlpath );
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      バリエーション情報をバイナリ形式で出力します.
+//-----------------------------------------------------------------------------
+bool WriteVariationBinary
+(
+    const FxParser&                     parser,
+    const std::vector<KeywordVariant>&  variants,
+    const std::vector<VariantAlias>&    aliases,
+    const std::string&                  binpath,
+    const char*                         hlslpath,
+    uint32_t&                           fileSize
+)
+{
+    VariationInfoWriter writer;
+    writer.SetSource(hlslpath);
+
+    for(auto& itr : parser.GetRasterizerStates())
+    { writer.AddRasterizerState(itr.first, itr.second); }
+
+    for(auto& itr : parser.GetDepthStencilStates())
+    { writer.AddDepthStencilState(itr.first, itr.second); }
+
+    for(auto& itr : parser.GetBlendStates())
+    { writer.AddBlendState(itr.first, itr.second); }
+
+    for(auto& prop : parser.GetProperties().Values)
+    { writer.AddValueProperty(prop); }
+
+    for(auto& prop : parser.GetProperties().Textures)
+    { writer.AddTextureProperty(prop); }
+
+    for(auto& group : parser.GetKeywords().Groups)
+    { writer.AddKeywordGroup(group); }
+
+    for(auto& variant : variants)
+    { writer.AddVariant(variant.Key, variant.Suffix); }
+
+    size_t aliasIndex = 0;
+
+    auto& techniques = parser.GetTechniques();
+    for(size_t i=0; i<techniques.size(); ++i)
+    {
+        auto& technique = techniques[i];
+        writer.AddTechnique(technique.Name);
+
+        for(size_t j=0; j<technique.Pass.size(); ++j)
+        {
+            auto& pass = technique.Pass[j];
+            writer.AddPass(pass);
+
+            for(size_t k=0; k<pass.Shaders.size(); ++k)
+            {
+                writer.AddShader(pass.Shaders[k]);
+
+                if (aliasIndex < aliases.size()
+                 && aliases[aliasIndex].Technique == i
+                 && aliases[aliasIndex].Pass      == j
+                 && aliases[aliasIndex].Shader    == k)
+                {
+                    // 代表と同じ組み合わせは別名にしない.
+                    auto& targets = aliases[aliasIndex++].Targets;
+                    for(size_t v=0; v<targets.size(); ++v)
+                    {
+                        if (targets[v] != v)
+                        { writer.AddAlias(uint32_t(v), targets[v]); }
+                    }
+                }
+            }
+        }
+    }
+
+    if (!writer.Write(binpath))
+    { return false; }
+
+    fileSize = writer.GetFileSize();
+    return true;
+}
+
+} // namespace asura
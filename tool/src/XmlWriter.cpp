@@ -0,0 +1,164 @@
+﻿//-----------------------------------------------------------------------------
+// File : XmlWriter.cpp
+// Desc : Buffered XML Writer Module.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "XmlWriter.h"
+#include <charconv>
+#include <cstdio>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const size_t kInitialCapacity = 1024 * 1024;   // バッファの初期サイズ.
+
+} // namespace
+
+
+namespace asura {
+
+///////////////////////////////////////////////////////////////////////////////
+// XmlWriter class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+XmlWriter::XmlWriter()
+{ m_Buffer.reserve(kInitialCapacity); }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+XmlWriter::~XmlWriter()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      書き込んだ内容を破棄します.
+//-----------------------------------------------------------------------------
+void XmlWriter::Reset()
+{ m_Buffer.clear(); }
+
+//-----------------------------------------------------------------------------
+//      文字列をそのまま書き込みます.
+//-----------------------------------------------------------------------------
+void XmlWriter::Raw(std::string_view text)
+{ m_Buffer.append(text.data(), text.size()); }
+
+//-----------------------------------------------------------------------------
+//      文字列を属性値としてエスケープして書き込みます.
+//-----------------------------------------------------------------------------
+void XmlWriter::Escape(std::string_view text)
+{
+    // エスケープが不要な区間はまとめて書き込む.
+    size_t begin = 0;
+    for(size_t i=0; i<text.size(); ++i)
+    {
+        const char* pEntity = nullptr;
+        switch(text[i])
+        {
+        case '&':   pEntity = "&amp;";  break;
+        case '<':   pEntity = "&lt;";   break;
+        case '>':   pEntity = "&gt;";   break;
+        case '\"':  pEntity = "&quot;"; break;
+        case '\'':  pEntity = "&apos;"; break;
+        default:    continue;
+        }
+
+        m_Buffer.append(text.data() + begin, i - begin);
+        m_Buffer.append(pEntity);
+        begin = i + 1;
+    }
+
+    m_Buffer.append(text.data() + begin, text.size() - begin);
+}
+
+//-----------------------------------------------------------------------------
+//      属性を書き込みます.
+//-----------------------------------------------------------------------------
+void XmlWriter::Attribute(std::string_view name, std::string_view value)
+{
+    m_Buffer += ' ';
+    Raw(name);
+    m_Buffer.append("=\"", 2);
+    Escape(value);
+    m_Buffer += '\"';
+}
+
+//-----------------------------------------------------------------------------
+//      整数値の属性を10進数で書き込みます.
+//-----------------------------------------------------------------------------
+void XmlWriter::Attribute(std::string_view name, uint32_t value)
+{
+    char buf[16];
+    auto ret = std::to_chars(buf, buf + sizeof(buf), value);
+
+    m_Buffer += ' ';
+    Raw(name);
+    m_Buffer.append("=\"", 2);
+    m_Buffer.append(buf, ret.ptr - buf);
+    m_Buffer += '\"';
+}
+
+//-----------------------------------------------------------------------------
+//      浮動小数点数の属性を小数点以下6桁で書き込みます.
+//-----------------------------------------------------------------------------
+void XmlWriter::Attribute(std::string_view name, float value)
+{
+    // FLT_MAX でも整数部は39桁なので収まる.
+    char buf[64];
+    auto ret = std::to_chars(buf, buf + sizeof(buf), double(value), std::chars_format::fixed, 6);
+
+    m_Buffer += ' ';
+    Raw(name);
+    m_Buffer.append("=\"", 2);
+    m_Buffer.append(buf, ret.ptr - buf);
+    m_Buffer += '\"';
+}
+
+//-----------------------------------------------------------------------------
+//      整数値の属性を 0x 付きの16進数で書き込みます.
+//-----------------------------------------------------------------------------
+void XmlWriter::AttributeHex(std::string_view name, uint64_t value)
+{
+    char buf[24];
+    auto ret = std::to_chars(buf, buf + sizeof(buf), value, 16);
+
+    m_Buffer += ' ';
+    Raw(name);
+    m_Buffer.append("=\"0x", 4);
+    m_Buffer.append(buf, ret.ptr - buf);
+    m_Buffer += '\"';
+}
+
+//-----------------------------------------------------------------------------
+//      書き込んだ内容を1回の書き込みでファイルに出力します.
+//-----------------------------------------------------------------------------
+bool XmlWriter::Flush(const char* path) const
+{
+    // 改行コードはこれまでの出力と同じくテキストモードに任せる.
+    FILE* pFile;
+    auto err = fopen_s(&pFile, path, "w");
+    if (err != 0)
+    { return false; }
+
+    auto written = fwrite(m_Buffer.data(), 1, m_Buffer.size(), pFile);
+    auto closed  = fclose(pFile);
+
+    return written == m_Buffer.size() && closed == 0;
+}
+
+//-----------------------------------------------------------------------------
+//      書き込んだ内容のサイズを取得します.
+//-----------------------------------------------------------------------------
+size_t XmlWriter::GetSize() const
+{ return m_Buffer.size(); }
+
+} // namespace asura
@@ -0,0 +1,22 @@
+// b.hlsli と c.hlsli は互いにインクルードする.
+#ifndef B_HLSLI
+#define B_HLSLI
+
+#include "c.hlsli"
+
+struct VSInputC
+{
+    float3 position : POSITION;
+    float2 texcoord : TEXCOORD0;
+};
+
+VSOutputC VSFunc_C(const VSInputC input)
+{
+    VSOutputC output = (VSOutputC)0;
+    output.position = float4(input.position, 1.0f);
+    output.texcoord = input.texcoord;
+
+    return output;
+};
+
+#endif // B_HLSLI
@@ -0,0 +1,20 @@
+#ifndef C_HLSLI
+#define C_HLSLI
+
+#include "b.hlsli"
+
+struct VSOutputC
+{
+    float4 position : SV_POSITION;
+    float2 texcoord : TEXCOORD0;
+};
+
+Texture2D textureC : register(t0);
+SamplerState samplerC : register(s0);
+
+float4 ShadeC(VSOutputC input)
+{
+    return textureC.Sample(samplerC, input.texcoord);
+}
+
+#endif
@@ -0,0 +1,38 @@
+keywords
+{
+    multi_compile _ FOG_A FOG_B;
+    shader_feature SHADOW;
+};
+
+#if defined(FOG_A)
+float4 Fog(float4 color)
+{
+    return color * 0.5;
+}
+#endif
+
+float4 VSMain(float4 position : POSITION) : SV_POSITION
+{
+    return position;
+}
+
+float4 PSMain() : SV_TARGET0
+{
+    float4 color = 1;
+#if defined(FOG_A)
+    color = Fog(color);
+#endif
+#if defined(SHADOW)
+    color *= 0.25;
+#endif
+    return color;
+}
+
+technique Default
+{
+    pass P0
+    {
+        VertexShader = compile vs_6_0 VSMain();
+        PixelShader  = compile ps_6_0 PSMain();
+    }
+}
@@ -0,0 +1,17 @@
+#include "b.hlsli"
+#include "c.hlsli"
+#include "b.hlsli"
+
+float4 PSFunc_C(VSOutputC input) : SV_TARGET0
+{
+    return ShadeC(input);
+};
+
+technique C
+{
+    pass P0
+    {
+         VertexShader = compile vs_6_0 VSFunc_C();
+         PixelShader = compile ps_6_0 PSFunc_C();
+    }
+}
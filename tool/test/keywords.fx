@@ -0,0 +1,35 @@
+keywords
+{
+    multi_compile   _ FOG_LINEAR FOG_EXP;
+    shader_feature  NORMAL_MAP;
+    exclude         FOG_EXP NORMAL_MAP;
+    require         NORMAL_MAP FOG_LINEAR;
+};
+
+float4 VSMain(float4 position : POSITION) : SV_POSITION
+{
+    return position;
+}
+
+float4 PSMain() : SV_TARGET0
+{
+    float4 color = 1;
+#if defined(FOG_LINEAR)
+    color *= 0.5;
+#elif defined(FOG_EXP)
+    color *= 0.25;
+#endif
+#if defined(NORMAL_MAP)
+    color.rgb = color.bgr;
+#endif
+    return color;
+}
+
+technique Default
+{
+    pass P0
+    {
+        VertexShader = compile vs_6_0 VSMain();
+        PixelShader  = compile ps_6_0 PSMain();
+    }
+}
@@ -0,0 +1,737 @@
+﻿//-----------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Test Entry Point.
+// Copyright(c) Project Asura All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "FxParser.h"
+#include "Tokenizer.h"
+#include "MappedFile.h"
+#include "LzCodec.h"
+#include "ShaderPack.h"
+#include "ShaderPackWriter.h"
+#include "VariationInfoWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <direct.h>
+#else
+    #include <dirent.h>
+    #include <unistd.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const int    kFuzzCount      = 20000;    // ランダムな入力で比較する回数.
+static const size_t kFuzzMaxSize    = 300;      // ランダムな入力の最大長.
+static const char*  kScanModeName[] = {
+    "auto",
+    "scalar",
+    "sse",
+    "avx2",
+};
+
+// 入力に使う文字. 区切り文字, 切り出し文字, 英数字, 非ASCII文字を混ぜる.
+static const char kFuzzChars[] = " \t\r\n,\"{}()=#<>;abcdefgXYZ019_\x80\xff\xe3";
+
+static const char*  kPackPath       = "asfxc_test.pack";    // テストで書き出すパックファイル.
+static const int    kPackFlipCount  = 2000;                 // パックファイルを壊して読み込む回数.
+static const size_t kPackGuardSize  = 64;                   // 展開先の後ろに置く書き込み検出用の領域.
+static const uint8_t kPackGuardByte = 0xCD;                 // 書き込み検出用の値.
+
+static const char*  kVariationXmlPath   = "asfxc_test.variation.xml";   // テストで書き出すバリエーション情報.
+static const char*  kVariationBinPath   = "asfxc_test.variation.bin";   // テストで書き出すバリエーション情報.
+static const char*  kFixtureSuffix      = ".fx";                        // テストに使うエフェクトファイルの拡張子.
+
+///////////////////////////////////////////////////////////////////////////////
+// PackItem structure
+///////////////////////////////////////////////////////////////////////////////
+struct PackItem
+{
+    std::string             Technique;  //!< テクニック名.
+    std::string             Pass;       //!< パス名.
+    std::string             Stage;      //!< シェーダステージ名.
+    std::string             Key;        //!< キーワードの組み合わせを表すキー.
+    std::vector<uint8_t>    Data;       //!< シェーダバイナリ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// DelimiterSet structure
+///////////////////////////////////////////////////////////////////////////////
+struct DelimiterSet
+{
+    const char*     Separator;      //!< 区切り文字.
+    const char*     CutOff;         //!< 切り出し文字.
+};
+
+// FxParser と同じ組み合わせと, 上位ビットが立った文字を含む組み合わせ.
+static const DelimiterSet kDelimiterSets[] = {
+    { " \t\r\n,\"", "{}()=#<>;" },
+    { " \x80\xff",  "a\xe3" },
+};
+
+//-----------------------------------------------------------------------------
+//      指定した走査モードでトークンを切り出します.
+//-----------------------------------------------------------------------------
+void Tokenize(std::string source, SCAN_MODE mode, const DelimiterSet& set, std::vector<std::string>& result)
+{
+    result.clear();
+
+    Tokenizer tokenizer;
+    tokenizer.SetScanMode(mode);
+    tokenizer.SetSeparator(set.Separator);
+    tokenizer.SetCutOff(set.CutOff);
+    tokenizer.SetBuffer(&source[0], source.size());
+
+    while(!tokenizer.IsEnd())
+    {
+        result.emplace_back(tokenizer.GetAsView());
+        tokenizer.Next();
+    }
+    result.emplace_back(tokenizer.GetAsView());
+
+    // 終端に達した後のトークン.
+    tokenizer.Next();
+    result.emplace_back(tokenizer.GetAsView());
+}
+
+//-----------------------------------------------------------------------------
+//      スカラー走査と結果が一致するかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool CheckParity(const std::string& source, SCAN_MODE mode, const DelimiterSet& set)
+{
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+
+    Tokenize(source, SCAN_MODE_SCALAR, set, expected);
+    Tokenize(source, mode, set, actual);
+
+    // 終端に達した後は空トークンになること.
+    return expected == actual && actual.back().empty();
+}
+
+//-----------------------------------------------------------------------------
+//      ランダムな入力で走査モード間の一致をテストします.
+//-----------------------------------------------------------------------------
+int TestTokenizerFuzz(SCAN_MODE mode)
+{
+    // 失敗を再現できるようにシードは固定する.
+    std::mt19937 random(42);
+
+    auto charCount = strlen(kFuzzChars);
+    auto failed    = 0;
+    std::string source;
+
+    for(auto i=0; i<kFuzzCount; ++i)
+    {
+        source.clear();
+
+        auto size = random() % kFuzzMaxSize;
+        for(size_t j=0; j<size; ++j)
+        { source += kFuzzChars[random() % charCount]; }
+
+        // SIMD幅をまたぐ長い区切り文字とトークンも混ぜる.
+        if (random() % 4 == 0)
+        { source.append(random() % 100, ' '); }
+        if (random() % 4 == 0)
+        { source.append(random() % 100, 'a'); }
+
+        for(auto& set : kDelimiterSets)
+        {
+            if (!CheckParity(source, mode, set))
+            { failed++; }
+        }
+    }
+
+    printf_s("TokenizerTest : mode = %s, cases = %d, failed = %d\n",
+        kScanModeName[mode],
+        kFuzzCount * int(sizeof(kDelimiterSets) / sizeof(kDelimiterSets[0])),
+        failed);
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      エフェクトファイルで走査モード間の一致をテストします.
+//-----------------------------------------------------------------------------
+int TestTokenizerFile(SCAN_MODE mode, const char* path)
+{
+    asura::FxParser parser;
+    if (!parser.Parse(path))
+    {
+        fprintf_s(stderr, "Error : Shader Parse Failed. path = %s\n", path);
+        return 1;
+    }
+
+    std::string source(parser.GetSourceCode(), parser.GetSourceCodeSize());
+
+    auto failed = 0;
+    for(auto& set : kDelimiterSets)
+    {
+        if (!CheckParity(source, mode, set))
+        { failed++; }
+    }
+
+    printf_s("TokenizerTest : mode = %s, failed = %d, path = %s\n",
+        kScanModeName[mode],
+        failed,
+        path);
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      展開先の範囲外に書き込まずに展開できるかチェックします.
+//-----------------------------------------------------------------------------
+bool DecodeShaderPackBlob(const asura::ShaderPackBlob& blob, std::vector<uint8_t>& result, bool& overrun)
+{
+    result.assign(blob.RawSize + kPackGuardSize, kPackGuardByte);
+    auto ret = asura::ShaderPackReader::Decode(blob, result.data(), blob.RawSize);
+
+    overrun = false;
+    for(auto i=blob.RawSize; i<result.size(); ++i)
+    {
+        if (result[i] != kPackGuardByte)
+        { overrun = true; }
+    }
+
+    result.resize(blob.RawSize);
+    return ret;
+}
+
+//-----------------------------------------------------------------------------
+//      パックファイルの内容が追加したエントリーと一致するかチェックします.
+//-----------------------------------------------------------------------------
+int CheckShaderPack(const void* pData, size_t size, const std::vector<PackItem>& items, int (&codecCount)[2])
+{
+    asura::ShaderPackReader reader;
+    if (!reader.Init(pData, size))
+    { return 1; }
+
+    auto failed = 0;
+    if (reader.GetCount() != items.size())
+    { failed++; }
+
+    std::vector<uint8_t> decoded;
+    for(auto& item : items)
+    {
+        asura::ShaderPackBlob blob = {};
+        bool overrun = false;
+        if (!reader.Find(item.Technique, item.Pass, item.Stage, item.Key, blob)
+         || !DecodeShaderPackBlob(blob, decoded, overrun)
+         || overrun
+         || decoded != item.Data)
+        {
+            failed++;
+            continue;
+        }
+
+        // 圧縮して小さくならないバイナリは無圧縮で格納されること.
+        if (blob.Codec == asura::SHADER_PACK_CODEC_LZ)
+        {
+            codecCount[1]++;
+            if (blob.Size >= blob.RawSize)
+            { failed++; }
+        }
+        else
+        {
+            codecCount[0]++;
+            if (blob.Codec != asura::SHADER_PACK_CODEC_NONE || blob.Size != blob.RawSize)
+            { failed++; }
+        }
+
+        // 登録していない名前は見つからないこと.
+        if (reader.Find(item.Technique, item.Pass, item.Stage, item.Key + "_", blob))
+        { failed++; }
+    }
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      パックファイルが範囲外を指していないかチェックします.
+//-----------------------------------------------------------------------------
+int CheckShaderPackRange(const void* pData, size_t size, const std::vector<PackItem>& items)
+{
+    asura::ShaderPackReader reader;
+    if (!reader.Init(pData, size))
+    { return 0; }
+
+    auto pBegin = static_cast<const uint8_t*>(pData);
+    auto failed = 0;
+    std::vector<uint8_t> decoded;
+    for(auto& item : items)
+    {
+        asura::ShaderPackBlob blob = {};
+        if (!reader.Find(item.Technique, item.Pass, item.Stage, item.Key, blob))
+        { continue; }
+
+        auto pBytes = static_cast<const uint8_t*>(blob.pData);
+        if (pBytes < pBegin || size_t(pBytes - pBegin) > size || blob.Size > size - size_t(pBytes - pBegin))
+        {
+            failed++;
+            continue;
+        }
+
+        // 壊れたバイナリは展開に失敗してもよいが, 展開先の範囲外に書き込まないこと.
+        bool overrun = false;
+        if (blob.RawSize <= size * 256)
+        {
+            DecodeShaderPackBlob(blob, decoded, overrun);
+            if (overrun)
+            { failed++; }
+        }
+    }
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      LzDecompress() が不正なデータを受け付けないかテストします.
+//-----------------------------------------------------------------------------
+int TestLzCodec(const std::vector<PackItem>& items, int& cases)
+{
+    auto failed = 0;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> decoded;
+    for(auto& item : items)
+    {
+        auto& data = item.Data;
+        asura::LzCompress(data.data(), data.size(), compressed);
+
+        cases++;
+        decoded.assign(data.size() + kPackGuardSize, kPackGuardByte);
+        if (!asura::LzDecompress(compressed.data(), compressed.size(), decoded.data(), data.size())
+         || memcmp(decoded.data(), data.data(), data.size()) != 0)
+        { failed++; }
+
+        // 展開後のサイズが合わない場合は失敗すること.
+        cases++;
+        if (asura::LzDecompress(compressed.data(), compressed.size(), decoded.data(), data.size() + 1))
+        { failed++; }
+
+        cases++;
+        if (!data.empty() && asura::LzDecompress(compressed.data(), compressed.size(), decoded.data(), data.size() - 1))
+        { failed++; }
+
+        // 途中で切れたデータは失敗すること.
+        for(size_t i=0; i<compressed.size(); ++i)
+        {
+            cases++;
+            if (asura::LzDecompress(compressed.data(), i, decoded.data(), data.size()))
+            { failed++; }
+        }
+
+        // 末尾に余分なデータがある場合は失敗すること.
+        compressed.push_back(0);
+        cases++;
+        if (asura::LzDecompress(compressed.data(), compressed.size(), decoded.data(), data.size()))
+        { failed++; }
+    }
+
+    // 一致位置が不正なデータは失敗すること. 先頭は正しいデータ.
+    static const uint8_t kStreams[][6] = {
+        { 0x10, 'A', 0x01, 0x00, 0x10, 'B' },   // "A" + "AAAA" + "B".
+        { 0x10, 'A', 0x00, 0x00, 0x10, 'B' },   // オフセットが 0.
+        { 0x10, 'A', 0x02, 0x00, 0x10, 'B' },   // 展開済みの範囲より前を指す.
+        { 0xF0, 'A', 0x01, 0x00, 0x10, 'B' },   // リテラル長が入力を超える.
+    };
+    for(size_t i=0; i<sizeof(kStreams) / sizeof(kStreams[0]); ++i)
+    {
+        uint8_t buffer[6] = {};
+        cases++;
+        if (asura::LzDecompress(kStreams[i], sizeof(kStreams[i]), buffer, sizeof(buffer)) != (i == 0))
+        { failed++; }
+    }
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      パックファイルの書き出しと読み込みをテストします.
+//-----------------------------------------------------------------------------
+int TestShaderPack()
+{
+    // 失敗を再現できるようにシードは固定する.
+    std::mt19937 random(42);
+
+    std::vector<PackItem> items;
+    for(auto technique : { "Default", "Shadow" })
+    {
+        for(auto pass : { "P0", "P1" })
+        {
+            for(auto stage : { "vs", "ps" })
+            {
+                for(auto key : { "", "FOG_LINEAR", "FOG_EXP2 SHADOW_HIGH" })
+                {
+                    PackItem item;
+                    item.Technique = technique;
+                    item.Pass      = pass;
+                    item.Stage     = stage;
+                    item.Key       = key;
+                    // 半分は繰り返しの多い圧縮しやすいバイナリにする.
+                    auto compressible = (items.size() % 2) == 0;
+                    item.Data.resize(random() % 600);
+                    for(size_t i=0; i<item.Data.size(); ++i)
+                    { item.Data[i] = compressible ? uint8_t(i / 16) : uint8_t(random()); }
+                    items.push_back(std::move(item));
+                }
+            }
+        }
+    }
+
+    // 同じ内容のバイナリと空のバイナリも混ぜる.
+    items[1].Data = items[0].Data;
+    items[2].Data.clear();
+
+    asura::ShaderPackWriter writer(true);
+    for(auto& item : items)
+    { writer.Add(item.Technique, item.Pass, item.Stage, item.Key, item.Data); }
+
+    if (!writer.Write(kPackPath))
+    {
+        fprintf_s(stderr, "Error : Shader Pack Write Failed. path = %s\n", kPackPath);
+        return 1;
+    }
+
+    // 8バイト境界に揃えたバッファに読み込む.
+    std::vector<uint64_t> buffer;
+    size_t size = 0;
+    {
+        asura::MappedFile file;
+        if (!file.Open(kPackPath))
+        {
+            fprintf_s(stderr, "Error : File Open Failed. path = %s\n", kPackPath);
+            return 1;
+        }
+
+        auto view = file.GetView();
+        size = view.size();
+        buffer.resize(size / sizeof(uint64_t) + 1);
+        memcpy(buffer.data(), view.data(), size);
+    }
+    remove(kPackPath);
+
+    auto pData  = reinterpret_cast<uint8_t*>(buffer.data());
+    auto cases  = 1;
+    int  codecCount[2] = {};
+    auto failed = CheckShaderPack(pData, size, items, codecCount);
+
+    // 無圧縮と圧縮の両方のエントリーが含まれること.
+    if (codecCount[0] == 0 || codecCount[1] == 0)
+    { failed++; }
+
+    // 途中で切れたファイルは読み込めないか, 範囲外を指さないこと.
+    for(size_t i=0; i<size; ++i)
+    {
+        cases++;
+        failed += CheckShaderPackRange(pData, i, items);
+
+        asura::ShaderPackReader reader;
+        if (i < sizeof(asura::ShaderPackHeader) && reader.Init(pData, i))
+        { failed++; }
+    }
+
+    // ヘッダーが不正なファイルは読み込めないこと.
+    {
+        std::vector<uint64_t> copy;
+        auto pHeader = reinterpret_cast<asura::ShaderPackHeader*>(buffer.data());
+        auto header  = *pHeader;
+
+        std::vector<asura::ShaderPackHeader> corrupted(6, header);
+        corrupted[0].Magic      ^= 1;
+        corrupted[1].Version    += 1;
+        corrupted[2].SlotCount   = 3;
+        corrupted[3].EntryCount  = header.SlotCount;
+        corrupted[4].SlotOffset  = size;
+        corrupted[5].NameOffset  = size + 1;
+
+        asura::ShaderPackReader reader;
+        for(auto& value : corrupted)
+        {
+            cases++;
+            *pHeader = value;
+            if (reader.Init(pData, size))
+            { failed++; }
+        }
+        *pHeader = header;
+
+        // 8バイト境界に無いデータは読み込めないこと.
+        copy.resize(buffer.size() + 1);
+        memcpy(reinterpret_cast<uint8_t*>(copy.data()) + 1, pData, size);
+
+        cases++;
+        if (reader.Init(reinterpret_cast<uint8_t*>(copy.data()) + 1, size))
+        { failed++; }
+    }
+
+    // 壊れたファイルでも範囲外を指さないこと.
+    for(auto i=0; i<kPackFlipCount; ++i)
+    {
+        std::vector<uint64_t> copy = buffer;
+        auto pCopy = reinterpret_cast<uint8_t*>(copy.data());
+        for(auto j=0; j<4; ++j)
+        { pCopy[random() % size] ^= uint8_t(1 + random() % 255); }
+
+        cases++;
+        failed += CheckShaderPackRange(pCopy, size, items);
+    }
+
+    failed += TestLzCodec(items, cases);
+
+    printf_s("ShaderPackTest : entries = %zu, none = %d, lz = %d, bytes = %zu, cases = %d, failed = %d\n",
+        items.size(),
+        codecCount[0],
+        codecCount[1],
+        size,
+        cases,
+        failed);
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      テスト用のエフェクトファイルを置いたディレクトリを取得します.
+//-----------------------------------------------------------------------------
+std::string GetFixtureDir()
+{
+    // このファイルと同じディレクトリに置いてある.
+    std::string path = __FILE__;
+    auto pos = path.find_last_of("/\\");
+    return (pos != std::string::npos) ? path.substr(0, pos) : ".";
+}
+
+//-----------------------------------------------------------------------------
+//      作業ディレクトリを変更します.
+//-----------------------------------------------------------------------------
+bool SetWorkDir(const std::string& path)
+{
+#if defined(_WIN32)
+    return _chdir(path.c_str()) == 0;
+#else
+    return chdir(path.c_str()) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//      作業ディレクトリ内のエフェクトファイルを列挙します.
+//-----------------------------------------------------------------------------
+void ListFixtures(std::vector<std::string>& result)
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    auto pattern = std::string("*") + kFixtureSuffix;
+    auto handle  = FindFirstFileA(pattern.c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+    { return; }
+
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        { continue; }
+
+        result.push_back(data.cFileName);
+    }
+    while (FindNextFileA(handle, &data));
+
+    FindClose(handle);
+#else
+    auto suffixLen = strlen(kFixtureSuffix);
+
+    auto pDir = opendir(".");
+    if (pDir == nullptr)
+    { return; }
+
+    while (auto pEntry = readdir(pDir))
+    {
+        std::string name = pEntry->d_name;
+        if (name.size() <= suffixLen || name.compare(name.size() - suffixLen, suffixLen, kFixtureSuffix) != 0)
+        { continue; }
+
+        result.push_back(name);
+    }
+
+    closedir(pDir);
+#endif
+
+    // 実行ごとに順番が変わらないようにする.
+    std::sort(result.begin(), result.end());
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルの先頭部分だけを書き出します.
+//-----------------------------------------------------------------------------
+bool TruncateFile(const char* path, size_t size)
+{
+    std::vector<uint8_t> data;
+    {
+        asura::MappedFile file;
+        if (!file.Open(path))
+        { return false; }
+
+        auto view = file.GetView();
+        data.assign(view.data(), view.data() + std::min(size, view.size()));
+    }
+
+    FILE* pFile = nullptr;
+    if (fopen_s(&pFile, path, "wb") != 0)
+    { return false; }
+
+    auto written = data.empty() || fwrite(data.data(), data.size(), 1, pFile) == 1;
+    fclose(pFile);
+    return written;
+}
+
+//-----------------------------------------------------------------------------
+//      XML 形式とバイナリ形式のバリエーション情報が一致するかチェックします.
+//-----------------------------------------------------------------------------
+int CheckVariationInfo(const std::string& path)
+{
+    asura::FxParser parser;
+    if (!parser.Parse(path.c_str()))
+    {
+        fprintf_s(stderr, "Error : Parse Failed. path = %s\n", path.c_str());
+        return 1;
+    }
+
+    std::vector<asura::KeywordVariant> variants;
+    if (!asura::EnumerateVariants(parser, path, variants))
+    { return 1; }
+
+    // 別名のレコードも比較されるように, 隣り合う組み合わせを偶数番目にまとめる.
+    std::vector<asura::VariantAlias> aliases;
+    auto& techniques = parser.GetTechniques();
+    for(size_t i=0; i<techniques.size() && variants.size() > 1; ++i)
+    {
+        for(size_t j=0; j<techniques[i].Pass.size(); ++j)
+        {
+            for(size_t k=0; k<techniques[i].Pass[j].Shaders.size(); ++k)
+            {
+                asura::VariantAlias alias;
+                alias.Technique = i;
+                alias.Pass      = j;
+                alias.Shader    = k;
+                for(size_t v=0; v<variants.size(); ++v)
+                { alias.Targets.push_back(uint32_t(v & ~size_t(1))); }
+                aliases.push_back(std::move(alias));
+            }
+        }
+    }
+
+    uint32_t fileSize = 0;
+    if (!asura::WriteVariationInfo(parser, variants, aliases, kVariationXmlPath, path.c_str())
+     || !asura::WriteVariationBinary(parser, variants, aliases, kVariationBinPath, path.c_str(), fileSize))
+    {
+        fprintf_s(stderr, "Error : Variation Info Write Failed. path = %s\n", path.c_str());
+        return 1;
+    }
+
+    auto failed = 0;
+    if (!asura::VariationInfoWriter::Verify(kVariationBinPath, kVariationXmlPath))
+    { failed++; }
+
+    // 途中で切れた XML は一致しないこと.
+    asura::MappedFile xml;
+    size_t xmlSize = xml.Open(kVariationXmlPath) ? xml.GetView().size() : 0;
+    xml.Close();
+
+    if (!TruncateFile(kVariationXmlPath, xmlSize / 2)
+     || asura::VariationInfoWriter::Verify(kVariationBinPath, kVariationXmlPath))
+    { failed++; }
+
+    // 途中で切れたバイナリは読み込めないこと.
+    if (!TruncateFile(kVariationBinPath, fileSize - 1)
+     || asura::VariationInfoWriter::Verify(kVariationBinPath, kVariationXmlPath))
+    { failed++; }
+
+    remove(kVariationXmlPath);
+    remove(kVariationBinPath);
+
+    printf_s("VariationInfoTest : variants = %zu, bytes = %u, failed = %d, path = %s\n",
+        variants.size(),
+        fileSize,
+        failed,
+        path.c_str());
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      テスト用のエフェクトファイルすべてでバリエーション情報をテストします.
+//-----------------------------------------------------------------------------
+int TestVariationInfo()
+{
+    // インクルードファイルを見つけられるようにディレクトリを移動する.
+    auto dir = GetFixtureDir();
+    if (!SetWorkDir(dir))
+    {
+        fprintf_s(stderr, "Error : Change Directory Failed. path = %s\n", dir.c_str());
+        return 1;
+    }
+
+    std::vector<std::string> fixtures;
+    ListFixtures(fixtures);
+    if (fixtures.empty())
+    {
+        fprintf_s(stderr, "Error : Test File Not Found. path = %s\n", dir.c_str());
+        return 1;
+    }
+
+    auto failed = 0;
+    for(auto& path : fixtures)
+    { failed += CheckVariationInfo(path); }
+
+    return failed;
+}
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    auto failed = 0;
+
+    for(auto mode : { SCAN_MODE_SSE, SCAN_MODE_AVX2 })
+    {
+        // CPUが対応していないモードはテストしない.
+        Tokenizer tokenizer;
+        tokenizer.SetScanMode(mode);
+        if (tokenizer.GetScanMode() != mode)
+        {
+            printf_s("TokenizerTest : mode = %s, skipped\n", kScanModeName[mode]);
+            continue;
+        }
+
+        failed += TestTokenizerFuzz(mode);
+
+        for(auto i=1; i<argc; ++i)
+        { failed += TestTokenizerFile(mode, argv[i]); }
+    }
+
+    failed += TestShaderPack();
+
+    // 作業ディレクトリを移動するので最後に実行する.
+    failed += TestVariationInfo();
+
+    if (failed > 0)
+    {
+        fprintf_s(stderr, "Error : Test Failed. failed = %d\n", failed);
+        return -1;
+    }
+
+    return 0;
+}